@@ -0,0 +1,126 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapAtlas.h"
+#include "BitmapRegion.h"
+#include "BitmapTexture.h"
+
+#include "Engine/Texture2D.h"
+
+namespace
+{
+	/* The images going to one page, uploaded together once they are all placed. */
+	struct FAtlasPageUpload
+	{
+		TArray<FConstBitmapView> Sources;
+		TArray<FIntPoint> Positions;
+	};
+}
+
+UBitmapAtlas::UBitmapAtlas()
+	: PageSize(2048)
+	, Padding(2)
+{
+}
+
+void UBitmapAtlas::Init(int32 InPageSize, int32 InPadding)
+{
+	check(Pages.Num() == 0);
+	PageSize = FMath::Max(InPageSize, 1);
+	Padding = FMath::Max(InPadding, 0);
+}
+
+bool UBitmapAtlas::AddPage()
+{
+	TArray<FColor> Empty;
+	Empty.SetNumZeroed(PageSize * PageSize);
+	UTexture2D* Page = FBitmapTexture::CreateTransient(Empty.GetData(), FImageSize(PageSize, PageSize), false, EBitmapTextureCompression::None);
+	if (!Page)
+	{
+		return false;
+	}
+
+	Pages.Add(Page);
+	Packers.Add(FBitmapAtlasPacker(FImageSize(PageSize, PageSize)));
+	return true;
+}
+
+int32 UBitmapAtlas::Add(const TArray<FConstBitmapView>& Bitmaps, TArray<FBitmapAtlasEntry>& OutEntries)
+{
+	OutEntries.Reset();
+	OutEntries.SetNum(Bitmaps.Num());
+
+	// Tallest first, then widest: the packer fills the pages much better than in whatever order the images came
+	TArray<int32> Order;
+	Order.SetNumUninitialized(Bitmaps.Num());
+	for (int32 Index = 0; Index < Bitmaps.Num(); Index++)
+	{
+		Order[Index] = Index;
+	}
+	Order.StableSort([&Bitmaps](int32 A, int32 B)
+	{
+		return Bitmaps[A].Height != Bitmaps[B].Height ? Bitmaps[A].Height > Bitmaps[B].Height : Bitmaps[A].Width > Bitmaps[B].Width;
+	});
+
+	// Every image is copied with its padding into its own slot first, which is what gets uploaded
+	TArray<TArray<FColor>> Slots;
+	Slots.SetNum(Bitmaps.Num());
+	TArray<FAtlasPageUpload> Uploads;
+	Uploads.SetNum(Pages.Num());
+	int32 NumAdded = 0;
+
+	for (int32 Index : Order)
+	{
+		const FConstBitmapView& Bitmap = Bitmaps[Index];
+		const FImageSize SlotSize(Bitmap.Width + 2 * Padding, Bitmap.Height + 2 * Padding);
+		if (Bitmap.Width <= 0 || Bitmap.Height <= 0)
+		{
+			continue;
+		}
+		if (SlotSize.X > PageSize || SlotSize.Y > PageSize)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("A %dx%d image doesn't fit in the %dx%d pages of the atlas with its padding, it is left out."), Bitmap.Width, Bitmap.Height, PageSize, PageSize);
+			continue;
+		}
+
+		// Images go in the first page with room for them, so older pages keep filling up as images are added
+		FIntPoint Position;
+		int32 PageIndex = 0;
+		while (PageIndex < Packers.Num() && !Packers[PageIndex].Insert(SlotSize, Position))
+		{
+			PageIndex++;
+		}
+		if (PageIndex == Packers.Num())
+		{
+			if (!AddPage())
+			{
+				UE_LOG(LogTemp, Error, TEXT("Failed to create a %dx%d atlas page."), PageSize, PageSize);
+				break;
+			}
+			Uploads.AddDefaulted();
+			Packers[PageIndex].Insert(SlotSize, Position);
+		}
+
+		TArray<FColor>& Slot = Slots[Index];
+		Slot.SetNumUninitialized(SlotSize.X * SlotSize.Y);
+		FBitmapRegion::Pad(Bitmap, Padding, Padding, Padding, Padding, EBitmapBorderMode::Clamp, FColor(0, 0, 0, 0), FBitmapView(Slot.GetData(), SlotSize));
+		Uploads[PageIndex].Sources.Add(FConstBitmapView(Slot.GetData(), SlotSize));
+		Uploads[PageIndex].Positions.Add(Position);
+
+		FBitmapAtlasEntry& Entry = OutEntries[Index];
+		Entry.Texture = Pages[PageIndex];
+		Entry.Page = PageIndex;
+		Entry.Rect = FImageRect(Position.X + Padding, Position.Y + Padding, Bitmap.Width, Bitmap.Height);
+		Entry.UVMin = FVector2D((float)Entry.Rect.X / PageSize, (float)Entry.Rect.Y / PageSize);
+		Entry.UVMax = FVector2D((float)(Entry.Rect.X + Entry.Rect.Width) / PageSize, (float)(Entry.Rect.Y + Entry.Rect.Height) / PageSize);
+		NumAdded++;
+	}
+
+	for (int32 PageIndex = 0; PageIndex < Uploads.Num(); PageIndex++)
+	{
+		if (Uploads[PageIndex].Sources.Num() > 0)
+		{
+			FBitmapTexture::UploadBitmaps(Pages[PageIndex], Uploads[PageIndex].Sources, Uploads[PageIndex].Positions);
+		}
+	}
+	return NumAdded;
+}
@@ -0,0 +1,131 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapAtlasPacker.h"
+
+namespace
+{
+	FORCEINLINE bool RectsOverlap(const FImageRect& A, const FImageRect& B)
+	{
+		return A.X < B.X + B.Width && B.X < A.X + A.Width && A.Y < B.Y + B.Height && B.Y < A.Y + A.Height;
+	}
+
+	FORCEINLINE bool RectContains(const FImageRect& Outer, const FImageRect& Inner)
+	{
+		return Inner.X >= Outer.X && Inner.Y >= Outer.Y && Inner.X + Inner.Width <= Outer.X + Outer.Width && Inner.Y + Inner.Height <= Outer.Y + Outer.Height;
+	}
+}
+
+FBitmapAtlasPacker::FBitmapAtlasPacker(FImageSize InBinSize)
+	: BinSize(InBinSize)
+	, UsedArea(0)
+{
+	if (BinSize.X > 0 && BinSize.Y > 0)
+	{
+		FreeRects.Add(FImageRect(0, 0, BinSize.X, BinSize.Y));
+	}
+}
+
+bool FBitmapAtlasPacker::Insert(FImageSize Size, FIntPoint& OutPosition)
+{
+	if (Size.X <= 0 || Size.Y <= 0)
+	{
+		return false;
+	}
+
+	int32 BestIndex = INDEX_NONE;
+	int32 BestShortSide = MAX_int32;
+	int32 BestLongSide = MAX_int32;
+
+	for (int32 Index = 0; Index < FreeRects.Num(); Index++)
+	{
+		const FImageRect& Free = FreeRects[Index];
+		if (Size.X > Free.Width || Size.Y > Free.Height)
+		{
+			continue;
+		}
+
+		// Leftovers on each side of the rectangle, the smaller one first
+		const int32 LeftoverX = Free.Width - Size.X;
+		const int32 LeftoverY = Free.Height - Size.Y;
+		const int32 ShortSide = FMath::Min(LeftoverX, LeftoverY);
+		const int32 LongSide = FMath::Max(LeftoverX, LeftoverY);
+		if (ShortSide < BestShortSide || (ShortSide == BestShortSide && LongSide < BestLongSide))
+		{
+			BestIndex = Index;
+			BestShortSide = ShortSide;
+			BestLongSide = LongSide;
+		}
+	}
+
+	if (BestIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FImageRect Used(FreeRects[BestIndex].X, FreeRects[BestIndex].Y, Size.X, Size.Y);
+	SplitFreeRects(Used);
+	PruneFreeRects();
+
+	UsedArea += (int64)Size.X * Size.Y;
+	OutPosition = FIntPoint(Used.X, Used.Y);
+	return true;
+}
+
+float FBitmapAtlasPacker::GetOccupancy() const
+{
+	const int64 BinArea = (int64)BinSize.X * BinSize.Y;
+	return BinArea > 0 ? (float)((double)UsedArea / BinArea) : 0.0f;
+}
+
+void FBitmapAtlasPacker::SplitFreeRects(const FImageRect& Used)
+{
+	const int32 NumRects = FreeRects.Num();
+	for (int32 Index = NumRects - 1; Index >= 0; Index--)
+	{
+		const FImageRect Free = FreeRects[Index];
+		if (!RectsOverlap(Free, Used))
+		{
+			continue;
+		}
+		FreeRects.RemoveAtSwap(Index, 1, false);
+
+		// The free space left on each side of Used, each spanning the whole of Free the other way
+		if (Used.X > Free.X)
+		{
+			FreeRects.Add(FImageRect(Free.X, Free.Y, Used.X - Free.X, Free.Height));
+		}
+		if (Used.X + Used.Width < Free.X + Free.Width)
+		{
+			FreeRects.Add(FImageRect(Used.X + Used.Width, Free.Y, Free.X + Free.Width - Used.X - Used.Width, Free.Height));
+		}
+		if (Used.Y > Free.Y)
+		{
+			FreeRects.Add(FImageRect(Free.X, Free.Y, Free.Width, Used.Y - Free.Y));
+		}
+		if (Used.Y + Used.Height < Free.Y + Free.Height)
+		{
+			FreeRects.Add(FImageRect(Free.X, Used.Y + Used.Height, Free.Width, Free.Y + Free.Height - Used.Y - Used.Height));
+		}
+	}
+}
+
+void FBitmapAtlasPacker::PruneFreeRects()
+{
+	for (int32 Index = 0; Index < FreeRects.Num(); Index++)
+	{
+		for (int32 Other = Index + 1; Other < FreeRects.Num(); Other++)
+		{
+			if (RectContains(FreeRects[Other], FreeRects[Index]))
+			{
+				FreeRects.RemoveAtSwap(Index, 1, false);
+				Index--;
+				break;
+			}
+			if (RectContains(FreeRects[Index], FreeRects[Other]))
+			{
+				FreeRects.RemoveAtSwap(Other, 1, false);
+				Other--;
+			}
+		}
+	}
+}
@@ -0,0 +1,436 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Console commands timing the bitmap operations, to check how they scale on a given machine. Results go to the log.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "ImageUtils.h"
+#include "BitmapParallel.h"
+#include "BitmapConvolution.h"
+#include "BitmapGuidedFilter.h"
+#include "BitmapMorphology.h"
+#include "BitmapResampler.h"
+#include "BitmapMipChain.h"
+#include "BitmapBlockCompression.h"
+#include "BitmapOrientation.h"
+#include "BitmapWarp.h"
+#include "BitmapPyramid.h"
+
+namespace
+{
+	const int32 BenchmarkRuns = 3;
+
+	TArray<FColor> MakeBenchmarkBitmap(int32 Width, int32 Height, int32 Seed = 1234)
+	{
+		FRandomStream Random(Seed);
+
+		TArray<FColor> Bitmap;
+		Bitmap.SetNumUninitialized(Width * Height);
+		for (FColor& Pixel : Bitmap)
+		{
+			Pixel = FColor(Random.RandRange(0, 255), Random.RandRange(0, 255), Random.RandRange(0, 255), Random.RandRange(0, 255));
+		}
+		return Bitmap;
+	}
+
+	/* Best time in seconds over a few runs, after a warm up run. */
+	template<typename BodyType>
+	double TimeBestOf(const BodyType& Body)
+	{
+		Body();
+
+		double BestTime = TNumericLimits<double>::Max();
+		for (int32 Run = 0; Run < BenchmarkRuns; Run++)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Body();
+			BestTime = FMath::Min(BestTime, FPlatformTime::Seconds() - StartTime);
+		}
+		return BestTime;
+	}
+
+	/* Runs Body with ImageIO.MaxThreads set from 1 to the number of workers and logs the timings and speedups. */
+	template<typename BodyType>
+	void RunThreadScalingBenchmark(const TCHAR* Name, const BodyType& Body)
+	{
+		IConsoleVariable* MaxThreads = IConsoleManager::Get().FindConsoleVariable(TEXT("ImageIO.MaxThreads"));
+		if (!MaxThreads)
+		{
+			return;
+		}
+
+		const int32 PreviousMaxThreads = MaxThreads->GetInt();
+		MaxThreads->Set(0, ECVF_SetByConsole);
+		const int32 NumWorkers = FBitmapParallel::GetNumWorkers();
+
+		double SingleThreadTime = 0.0;
+		for (int32 NumThreads = 1; NumThreads <= NumWorkers; NumThreads++)
+		{
+			MaxThreads->Set(NumThreads, ECVF_SetByConsole);
+
+			const double Time = TimeBestOf(Body);
+			if (NumThreads == 1)
+			{
+				SingleThreadTime = Time;
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("%s, %d thread(s): %.2f ms (x%.2f)"), Name, NumThreads, Time * 1000.0, SingleThreadTime / FMath::Max(Time, 1e-9));
+		}
+
+		MaxThreads->Set(PreviousMaxThreads, ECVF_SetByConsole);
+	}
+
+	/* ImageIO.Benchmark.Convolution [Width] [Height] [KernelSize] */
+	void BenchmarkConvolution(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3840;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2160;
+		const int32 KernelSize = Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 1, 31) : 5;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+
+		// A random kernel is never separable, so this times the direct tiled engine
+		FRandomStream Random(5678);
+		FBitmapFilter Filter;
+		Filter.Size = FImageSize(KernelSize, KernelSize);
+		Filter.Filter.SetNumUninitialized(KernelSize * KernelSize);
+		for (float& Value : Filter.Filter)
+		{
+			Value = Random.FRandRange(-1.0f, 1.0f);
+		}
+		Filter.Factor = 1.0f / (KernelSize * KernelSize);
+		Filter.ColourChannel = EFilterColourChannel::RGBA;
+
+		const FString Name = FString::Printf(TEXT("ImageIO convolution %dx%d, %dx%d kernel"), Width, Height, KernelSize, KernelSize);
+		RunThreadScalingBenchmark(*Name, [&]()
+		{
+			FBitmapConvolution::Convolve(FConstBitmapView(Bitmap.GetData(), FImageSize(Width, Height)), Filter, FBitmapView(Result.GetData(), FImageSize(Width, Height)));
+		});
+	}
+
+	/* ImageIO.Benchmark.ConvolutionMethods [Width] [Height]: times the direct and FFT paths for growing kernels next to the cost model's pick. */
+	void BenchmarkConvolutionMethods(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1920;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 1080;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+
+		FRandomStream Random(5678);
+		for (int32 KernelSize : { 3, 5, 7, 9, 11, 13, 15, 21, 31 })
+		{
+			FBitmapFilter Filter;
+			Filter.Size = FImageSize(KernelSize, KernelSize);
+			Filter.Filter.SetNumUninitialized(KernelSize * KernelSize);
+			for (float& Value : Filter.Filter)
+			{
+				Value = Random.FRandRange(0.0f, 1.0f);
+			}
+			Filter.Factor = 1.0f / (KernelSize * KernelSize);
+
+			const double DirectTime = TimeBestOf([&]()
+			{
+				FBitmapConvolution::Convolve(FConstBitmapView(Bitmap.GetData(), FImageSize(Width, Height)), Filter, FBitmapView(Result.GetData(), FImageSize(Width, Height)));
+			});
+			const double FFTTime = TimeBestOf([&]()
+			{
+				FBitmapConvolution::ConvolveFFT(FConstBitmapView(Bitmap.GetData(), FImageSize(Width, Height)), Filter, FBitmapView(Result.GetData(), FImageSize(Width, Height)));
+			});
+
+			const EBitmapConvolutionMethod Method = FBitmapConvolution::ChooseMethod(FImageSize(Width, Height), Filter, false);
+			UE_LOG(LogTemp, Display, TEXT("ImageIO convolution %dx%d, %dx%d kernel: direct %.2f ms, FFT %.2f ms, cost model picks %s"), Width, Height, KernelSize, KernelSize,
+				DirectTime * 1000.0, FFTTime * 1000.0, Method == EBitmapConvolutionMethod::FFT ? TEXT("FFT") : TEXT("direct"));
+		}
+	}
+
+	/* ImageIO.Benchmark.Smoothing [Width] [Height] [Radius] */
+	void BenchmarkSmoothing(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3840;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2160;
+		const int32 Radius = Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 1, (int32)FBitmapGuidedFilter::MaxRadius) : 8;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+
+		const FString Name = FString::Printf(TEXT("ImageIO guided filter %dx%d, radius %d"), Width, Height, Radius);
+		RunThreadScalingBenchmark(*Name, [&]()
+		{
+			FBitmapGuidedFilter::Filter(FConstBitmapView(Bitmap.GetData(), FImageSize(Width, Height)), Radius, 0.1f, EFilterColourChannel::RGBA, FBitmapView(Result.GetData(), FImageSize(Width, Height)));
+		});
+	}
+
+	/* ImageIO.Benchmark.Morphology [Width] [Height] [Radius]: erosion of the alpha channel (a mask) and of all 4 channels. */
+	void BenchmarkMorphology(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3840;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2160;
+		const int32 Radius = Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 0, (int32)FBitmapMorphology::MaxRadius) : 10;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+
+		for (EFilterColourChannel ColourChannel : { EFilterColourChannel::A, EFilterColourChannel::RGBA })
+		{
+			const FString Name = FString::Printf(TEXT("ImageIO erosion %dx%d, radius %d, %s"), Width, Height, Radius, ColourChannel == EFilterColourChannel::A ? TEXT("A") : TEXT("RGBA"));
+			RunThreadScalingBenchmark(*Name, [&]()
+			{
+				FBitmapMorphology::Apply(FConstBitmapView(Bitmap.GetData(), FImageSize(Width, Height)), EBitmapMorphologyOperation::Erode, Radius, Radius, ColourChannel, FBitmapView(Result.GetData(), FImageSize(Width, Height)));
+			});
+		}
+	}
+
+	/* ImageIO.Benchmark.Resize [Width] [Height] [NewWidth] [NewHeight]: FImageUtils::ImageResize (what ResizeBitmap used to call) next to every resampling filter. */
+	void BenchmarkResize(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3840;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2160;
+		const int32 NewWidth = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 1280;
+		const int32 NewHeight = Args.Num() > 3 ? FMath::Max(1, FCString::Atoi(*Args[3])) : 720;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(NewWidth * NewHeight);
+
+		const double ImageUtilsTime = TimeBestOf([&]()
+		{
+			TArray<FColor> Resized;
+			FImageUtils::ImageResize(Width, Height, Bitmap, NewWidth, NewHeight, Resized, false);
+		});
+		UE_LOG(LogTemp, Display, TEXT("ImageIO resize %dx%d to %dx%d, FImageUtils::ImageResize: %.2f ms"), Width, Height, NewWidth, NewHeight, ImageUtilsTime * 1000.0);
+
+		const UEnum* FilterEnum = StaticEnum<EBitmapResampleFilter>();
+		for (int32 Filter = (int32)EBitmapResampleFilter::Box; Filter <= (int32)EBitmapResampleFilter::Lanczos3; Filter++)
+		{
+			for (bool bLinearLight : { false, true })
+			{
+				const double Time = TimeBestOf([&]()
+				{
+					FBitmapResampler::Resize(FConstBitmapView(Bitmap.GetData(), FImageSize(Width, Height)), (EBitmapResampleFilter)Filter, bLinearLight, true, FBitmapView(Result.GetData(), FImageSize(NewWidth, NewHeight)));
+				});
+				UE_LOG(LogTemp, Display, TEXT("ImageIO resize %dx%d to %dx%d, %s%s: %.2f ms (x%.2f)"), Width, Height, NewWidth, NewHeight, *FilterEnum->GetNameStringByValue(Filter),
+					bLinearLight ? TEXT(" in linear light") : TEXT(""), Time * 1000.0, ImageUtilsTime / FMath::Max(Time, 1e-9));
+			}
+		}
+	}
+
+	/* ImageIO.Benchmark.Mips [Width] [Height]: the whole mip chain CreateTexture2DFromBitmap builds when asked to, in linear light. */
+	void BenchmarkMips(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 4096;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 4096;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		const FImageSize Size(Width, Height);
+		TArray<TArray<FColor>> Levels;
+		TArray<FColor*> Mips;
+		for (int32 MipIndex = 1; MipIndex < FBitmapMipChain::GetNumMips(Size); MipIndex++)
+		{
+			const FImageSize MipSize = FBitmapMipChain::GetMipSize(Size, MipIndex);
+			Levels.AddDefaulted_GetRef().SetNumUninitialized(MipSize.X * MipSize.Y);
+		}
+		for (TArray<FColor>& Level : Levels)
+		{
+			Mips.Add(Level.GetData());
+		}
+
+		const FString Name = FString::Printf(TEXT("ImageIO mip chain %dx%d, %d levels"), Width, Height, Mips.Num());
+		RunThreadScalingBenchmark(*Name, [&]()
+		{
+			FBitmapMipChain::Generate(FConstBitmapView(Bitmap.GetData(), Size), true, Mips);
+		});
+	}
+
+	/* ImageIO.Benchmark.Compression [Width] [Height]: every block compressed format CreateTexture2DFromBitmap can produce. */
+	void BenchmarkCompression(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(4, FCString::Atoi(*Args[0])) : 2048;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(4, FCString::Atoi(*Args[1])) : 2048;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		const FImageSize Size(Width, Height);
+		TArray<uint8> Compressed;
+
+		const UEnum* CompressionEnum = StaticEnum<EBitmapTextureCompression>();
+		for (int32 Compression = (int32)EBitmapTextureCompression::BC1; Compression <= (int32)EBitmapTextureCompression::BC7; Compression++)
+		{
+			Compressed.SetNumUninitialized(FBitmapBlockCompression::GetCompressedSize(Size, (EBitmapTextureCompression)Compression));
+
+			const FString Name = FString::Printf(TEXT("ImageIO %s compression %dx%d"), *CompressionEnum->GetNameStringByValue(Compression), Width, Height);
+			RunThreadScalingBenchmark(*Name, [&]()
+			{
+				FBitmapBlockCompression::Compress(FConstBitmapView(Bitmap.GetData(), Size), (EBitmapTextureCompression)Compression, Compressed.GetData());
+			});
+		}
+	}
+
+	/* ImageIO.Benchmark.Orientation [Width] [Height]: every orientation, next to a quarter turn reading one pixel at a time. */
+	void BenchmarkOrientation(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 7680;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 4320;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		const FImageSize Size(Width, Height);
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Width * Height);
+
+		const double NaiveTime = TimeBestOf([&]()
+		{
+			for (int32 Y = 0; Y < Width; Y++)
+			{
+				for (int32 X = 0; X < Height; X++)
+				{
+					Result[(int64)Y * Height + X] = Bitmap[(int64)(Height - 1 - X) * Width + Y];
+				}
+			}
+		});
+		UE_LOG(LogTemp, Display, TEXT("ImageIO orientation %dx%d, pixel by pixel Rotate90: %.2f ms"), Width, Height, NaiveTime * 1000.0);
+
+		const UEnum* OrientationEnum = StaticEnum<EBitmapOrientation>();
+		for (int32 Orientation = (int32)EBitmapOrientation::Rotate90; Orientation <= (int32)EBitmapOrientation::Transverse; Orientation++)
+		{
+			const FString Name = FString::Printf(TEXT("ImageIO orientation %dx%d, %s"), Width, Height, *OrientationEnum->GetNameStringByValue(Orientation));
+			RunThreadScalingBenchmark(*Name, [&]()
+			{
+				FBitmapOrientation::Reorient(FConstBitmapView(Bitmap.GetData(), Size), (EBitmapOrientation)Orientation, FBitmapView(Result.GetData(), FBitmapOrientation::GetOrientedSize(Size, (EBitmapOrientation)Orientation)));
+			});
+		}
+	}
+
+	/* ImageIO.Benchmark.Warp [Width] [Height]: a rotation (affine) and a perspective warp with every filter. */
+	void BenchmarkWarp(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3840;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2160;
+
+		const TArray<FColor> Bitmap = MakeBenchmarkBitmap(Width, Height);
+		const FImageSize Size(Width, Height);
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Width * Height);
+
+		// 10 degrees around the centre
+		FBitmapHomography Rotation;
+		const double Cos = FMath::Cos(PI / 18.0);
+		const double Sin = FMath::Sin(PI / 18.0);
+		Rotation.M[0][0] = Cos;
+		Rotation.M[0][1] = -Sin;
+		Rotation.M[1][0] = Sin;
+		Rotation.M[1][1] = Cos;
+		Rotation.M[0][2] = Width * 0.5 * (1.0 - Cos) + Height * 0.5 * Sin;
+		Rotation.M[1][2] = Height * 0.5 * (1.0 - Cos) - Width * 0.5 * Sin;
+
+		// The top edge pulled in by a quarter on each side
+		const FVector2D Corners[4] = { FVector2D(Width * 0.25f, 0.0f), FVector2D(Width * 0.75f, 0.0f), FVector2D(Width, Height), FVector2D(0.0f, Height) };
+		FBitmapHomography SquareToQuad;
+		FBitmapHomography::MakeUnitSquareToQuad(Corners, SquareToQuad);
+		const FBitmapHomography Perspective = SquareToQuad * FBitmapHomography::MakeScale(1.0 / Width, 1.0 / Height);
+
+		const UEnum* FilterEnum = StaticEnum<EBitmapSampleFilter>();
+		for (int32 Filter = (int32)EBitmapSampleFilter::Nearest; Filter <= (int32)EBitmapSampleFilter::Bicubic; Filter++)
+		{
+			const FString FilterName = FilterEnum->GetNameStringByValue(Filter);
+			RunThreadScalingBenchmark(*FString::Printf(TEXT("ImageIO warp %dx%d, rotation, %s"), Width, Height, *FilterName), [&]()
+			{
+				FBitmapWarp::Warp(FConstBitmapView(Bitmap.GetData(), Size), Rotation, (EBitmapSampleFilter)Filter, EBitmapBorderMode::Constant, FColor(0, 0, 0, 0), FBitmapView(Result.GetData(), Size));
+			});
+			RunThreadScalingBenchmark(*FString::Printf(TEXT("ImageIO warp %dx%d, perspective, %s"), Width, Height, *FilterName), [&]()
+			{
+				FBitmapWarp::Warp(FConstBitmapView(Bitmap.GetData(), Size), Perspective, (EBitmapSampleFilter)Filter, EBitmapBorderMode::Constant, FColor(0, 0, 0, 0), FBitmapView(Result.GetData(), Size));
+			});
+		}
+	}
+
+	/* ImageIO.Benchmark.Pyramid [Width] [Height]: building a Laplacian pyramid, collapsing it, and a multiband blend across a vertical seam. */
+	void BenchmarkPyramid(const TArray<FString>& Args)
+	{
+		const int32 Width = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3840;
+		const int32 Height = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2160;
+
+		const FImageSize Size(Width, Height);
+		const TArray<FColor> BitmapA = MakeBenchmarkBitmap(Width, Height);
+		const TArray<FColor> BitmapB = MakeBenchmarkBitmap(Width, Height, 5678);
+		TArray<FColor> Mask;
+		Mask.SetNumUninitialized(Width * Height);
+		for (int32 Index = 0; Index < Mask.Num(); Index++)
+		{
+			Mask[Index] = Index % Width < Width / 2 ? FColor::White : FColor::Black;
+		}
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Width * Height);
+
+		FBitmapPyramid Pyramid;
+		RunThreadScalingBenchmark(*FString::Printf(TEXT("ImageIO pyramid %dx%d, Laplacian"), Width, Height), [&]()
+		{
+			Pyramid.BuildLaplacian(FConstBitmapView(BitmapA.GetData(), Size), 0);
+		});
+		RunThreadScalingBenchmark(*FString::Printf(TEXT("ImageIO pyramid %dx%d, Laplacian and collapse"), Width, Height), [&]()
+		{
+			Pyramid.BuildLaplacian(FConstBitmapView(BitmapA.GetData(), Size), 0);
+			Pyramid.Collapse();
+		});
+		RunThreadScalingBenchmark(*FString::Printf(TEXT("ImageIO pyramid %dx%d, multiband blend"), Width, Height), [&]()
+		{
+			FBitmapPyramid::BlendMultiband(FConstBitmapView(BitmapA.GetData(), Size), FConstBitmapView(BitmapB.GetData(), Size), FConstBitmapView(Mask.GetData(), Size), 0,
+				FBitmapView(Result.GetData(), Size));
+		});
+	}
+}
+
+static FAutoConsoleCommand BenchmarkConvolutionCommand(
+	TEXT("ImageIO.Benchmark.Convolution"),
+	TEXT("Times ApplyBitmapFilter's direct convolution from 1 to N threads. Arguments: [Width] [Height] [KernelSize]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkConvolution));
+
+static FAutoConsoleCommand BenchmarkConvolutionMethodsCommand(
+	TEXT("ImageIO.Benchmark.ConvolutionMethods"),
+	TEXT("Times direct and FFT convolution for kernels from 3x3 to 31x31 and shows which one ApplyBitmapFilter would pick. Arguments: [Width] [Height]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkConvolutionMethods));
+
+static FAutoConsoleCommand BenchmarkSmoothingCommand(
+	TEXT("ImageIO.Benchmark.Smoothing"),
+	TEXT("Times SmoothBitmap's guided filter from 1 to N threads. Arguments: [Width] [Height] [Radius]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkSmoothing));
+
+static FAutoConsoleCommand BenchmarkMorphologyCommand(
+	TEXT("ImageIO.Benchmark.Morphology"),
+	TEXT("Times ApplyBitmapMorphology's erosion on one and on 4 channels from 1 to N threads. Arguments: [Width] [Height] [Radius]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkMorphology));
+
+static FAutoConsoleCommand BenchmarkResizeCommand(
+	TEXT("ImageIO.Benchmark.Resize"),
+	TEXT("Times ResizeBitmap's filters against FImageUtils::ImageResize. Arguments: [Width] [Height] [NewWidth] [NewHeight]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkResize));
+
+static FAutoConsoleCommand BenchmarkMipsCommand(
+	TEXT("ImageIO.Benchmark.Mips"),
+	TEXT("Times the mip chain generation of CreateTexture2DFromBitmap from 1 to N threads. Arguments: [Width] [Height]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkMips));
+
+static FAutoConsoleCommand BenchmarkCompressionCommand(
+	TEXT("ImageIO.Benchmark.Compression"),
+	TEXT("Times BC1, BC3 and BC7 texture compression from 1 to N threads. Arguments: [Width] [Height]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkCompression));
+
+static FAutoConsoleCommand BenchmarkOrientationCommand(
+	TEXT("ImageIO.Benchmark.Orientation"),
+	TEXT("Times ReorientBitmap's rotations, flips and transposes from 1 to N threads. Arguments: [Width] [Height]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkOrientation));
+
+static FAutoConsoleCommand BenchmarkWarpCommand(
+	TEXT("ImageIO.Benchmark.Warp"),
+	TEXT("Times WarpBitmap on a rotation and a perspective warp with every filter, from 1 to N threads. Arguments: [Width] [Height]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkWarp));
+
+static FAutoConsoleCommand BenchmarkPyramidCommand(
+	TEXT("ImageIO.Benchmark.Pyramid"),
+	TEXT("Times Laplacian pyramids and BlendBitmapsMultiband from 1 to N threads. Arguments: [Width] [Height]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkPyramid));
@@ -0,0 +1,759 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapBlockCompression.h"
+#include "BitmapParallel.h"
+
+namespace
+{
+	// 16 RGBA pixels of a 4x4 block, row by row
+	typedef uint8 FBlockPixels[16][4];
+
+	void LoadBlock(FConstBitmapView Pixels, int32 BlockX, int32 BlockY, FBlockPixels& Block)
+	{
+		for (int32 Y = 0; Y < 4; Y++)
+		{
+			const FColor* Row = Pixels.GetRow(FMath::Min(BlockY * 4 + Y, Pixels.Height - 1));
+			for (int32 X = 0; X < 4; X++)
+			{
+				FMemory::Memcpy(Block[Y * 4 + X], &Row[FMath::Min(BlockX * 4 + X, Pixels.Width - 1)], 4);
+			}
+		}
+	}
+
+	/* Packs Bits bits at a time into a 128 bit block, lowest bits first. */
+	struct FBlockBitWriter
+	{
+		uint64 Words[2];
+		int32 Position;
+
+		FBlockBitWriter() : Position(0)
+		{
+			Words[0] = 0;
+			Words[1] = 0;
+		}
+
+		void Write(uint32 Value, int32 Bits)
+		{
+			for (int32 Bit = 0; Bit < Bits; Bit++, Position++)
+			{
+				Words[Position >> 6] |= (uint64)((Value >> Bit) & 1) << (Position & 63);
+			}
+		}
+	};
+
+	/***** BC1 colours *****/
+
+	FORCEINLINE int32 Expand5(int32 Value)
+	{
+		return (Value << 3) | (Value >> 2);
+	}
+
+	FORCEINLINE int32 Expand6(int32 Value)
+	{
+		return (Value << 2) | (Value >> 4);
+	}
+
+	FORCEINLINE uint16 Pack565(const float (&Colour)[3])
+	{
+		const int32 Red = FMath::Clamp((int32)(Colour[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		const int32 Green = FMath::Clamp((int32)(Colour[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+		const int32 Blue = FMath::Clamp((int32)(Colour[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		return (uint16)((Red << 11) | (Green << 5) | Blue);
+	}
+
+	FORCEINLINE void Unpack565(uint16 Colour, int32 (&Out)[3])
+	{
+		Out[0] = Expand5(Colour >> 11);
+		Out[1] = Expand6((Colour >> 5) & 63);
+		Out[2] = Expand5(Colour & 31);
+	}
+
+	/* For each 8 bit value, the pair of 5 or 6 bit endpoints whose 2/3 : 1/3 mix comes closest, so flat blocks keep their exact colour. */
+	struct FSingleColourTables
+	{
+		uint8 Match5[256][2];
+		uint8 Match6[256][2];
+
+		FSingleColourTables()
+		{
+			Build(Match5, 32, &Expand5);
+			Build(Match6, 64, &Expand6);
+		}
+
+		static void Build(uint8 (&Table)[256][2], int32 NumValues, int32 (*Expand)(int32))
+		{
+			for (int32 Value = 0; Value < 256; Value++)
+			{
+				int32 BestError = MAX_int32;
+				for (int32 First = 0; First < NumValues; First++)
+				{
+					for (int32 Second = 0; Second < NumValues; Second++)
+					{
+						const int32 Mixed = (2 * Expand(First) + Expand(Second)) / 3;
+						// Endpoints far apart make the block fragile against the other channels, so it costs a little
+						const int32 Error = FMath::Abs(Mixed - Value) * 100 + FMath::Abs(Expand(First) - Expand(Second));
+						if (Error < BestError)
+						{
+							BestError = Error;
+							Table[Value][0] = (uint8)First;
+							Table[Value][1] = (uint8)Second;
+						}
+					}
+				}
+			}
+		}
+	};
+
+	const FSingleColourTables& GetSingleColourTables()
+	{
+		static const FSingleColourTables Tables;
+		return Tables;
+	}
+
+	/* Colours of a pair of endpoints: 4 colours, or 3 colours and transparent black. */
+	void MakeColourPalette(uint16 Colour0, uint16 Colour1, bool bFourColours, int32 (&Palette)[4][3])
+	{
+		Unpack565(Colour0, Palette[0]);
+		Unpack565(Colour1, Palette[1]);
+		for (int32 Channel = 0; Channel < 3; Channel++)
+		{
+			if (bFourColours)
+			{
+				Palette[2][Channel] = (2 * Palette[0][Channel] + Palette[1][Channel]) / 3;
+				Palette[3][Channel] = (Palette[0][Channel] + 2 * Palette[1][Channel]) / 3;
+			}
+			else
+			{
+				Palette[2][Channel] = (Palette[0][Channel] + Palette[1][Channel]) / 2;
+				Palette[3][Channel] = 0;
+			}
+		}
+	}
+
+	/* Closest palette colour of every pixel, 2 bits each. Transparent pixels (when Transparent isn't null) take index 3 for free. */
+	uint32 PickColourIndices(const FBlockPixels& Block, const bool* Transparent, const int32 (&Palette)[4][3], int32 NumColours, int32& OutError)
+	{
+		uint32 Indices = 0;
+		OutError = 0;
+		for (int32 Pixel = 0; Pixel < 16; Pixel++)
+		{
+			if (Transparent && Transparent[Pixel])
+			{
+				Indices |= 3u << (Pixel * 2);
+				continue;
+			}
+
+			int32 BestIndex = 0;
+			int32 BestError = MAX_int32;
+			for (int32 Index = 0; Index < NumColours; Index++)
+			{
+				const int32 Red = Block[Pixel][0] - Palette[Index][0];
+				const int32 Green = Block[Pixel][1] - Palette[Index][1];
+				const int32 Blue = Block[Pixel][2] - Palette[Index][2];
+				const int32 Error = Red * Red + Green * Green + Blue * Blue;
+				if (Error < BestError)
+				{
+					BestError = Error;
+					BestIndex = Index;
+				}
+			}
+			Indices |= (uint32)BestIndex << (Pixel * 2);
+			OutError += BestError;
+		}
+		return Indices;
+	}
+
+	/* Principal axis of Count points of Dimensions channels, by power iteration on their covariance. Returns false when the points are all the same. */
+	template<int32 Dimensions>
+	bool FindPrincipalAxis(const float (*Points)[Dimensions], int32 Count, float (&Mean)[Dimensions], float (&Axis)[Dimensions])
+	{
+		for (int32 Channel = 0; Channel < Dimensions; Channel++)
+		{
+			Mean[Channel] = 0.0f;
+			for (int32 Point = 0; Point < Count; Point++)
+			{
+				Mean[Channel] += Points[Point][Channel];
+			}
+			Mean[Channel] /= Count;
+		}
+
+		float Covariance[Dimensions][Dimensions] = {};
+		for (int32 Point = 0; Point < Count; Point++)
+		{
+			for (int32 Row = 0; Row < Dimensions; Row++)
+			{
+				for (int32 Column = Row; Column < Dimensions; Column++)
+				{
+					Covariance[Row][Column] += (Points[Point][Row] - Mean[Row]) * (Points[Point][Column] - Mean[Column]);
+				}
+			}
+		}
+
+		float Trace = 0.0f;
+		for (int32 Row = 0; Row < Dimensions; Row++)
+		{
+			Trace += Covariance[Row][Row];
+			for (int32 Column = 0; Column < Row; Column++)
+			{
+				Covariance[Row][Column] = Covariance[Column][Row];
+			}
+		}
+		if (Trace < 1e-3f)
+		{
+			return false;
+		}
+
+		// Starting from the diagonal of the box the points sit in converges quickly in practice
+		for (int32 Channel = 0; Channel < Dimensions; Channel++)
+		{
+			float Min = Points[0][Channel];
+			float Max = Points[0][Channel];
+			for (int32 Point = 1; Point < Count; Point++)
+			{
+				Min = FMath::Min(Min, Points[Point][Channel]);
+				Max = FMath::Max(Max, Points[Point][Channel]);
+			}
+			Axis[Channel] = Max - Min;
+		}
+
+		for (int32 Iteration = 0; Iteration < 8; Iteration++)
+		{
+			float Next[Dimensions];
+			float Length = 0.0f;
+			for (int32 Row = 0; Row < Dimensions; Row++)
+			{
+				Next[Row] = 0.0f;
+				for (int32 Column = 0; Column < Dimensions; Column++)
+				{
+					Next[Row] += Covariance[Row][Column] * Axis[Column];
+				}
+				Length = FMath::Max(Length, FMath::Abs(Next[Row]));
+			}
+			if (Length < 1e-6f)
+			{
+				// The starting guess was orthogonal to the spread, any channel with some variance will do
+				for (int32 Row = 0; Row < Dimensions; Row++)
+				{
+					Next[Row] = Covariance[Row][Row];
+				}
+				Length = 1.0f;
+			}
+			for (int32 Row = 0; Row < Dimensions; Row++)
+			{
+				Axis[Row] = Next[Row] / Length;
+			}
+		}
+		return true;
+	}
+
+	/* Endpoints of a line through Count points minimising the error of their Weights-interpolated indices: a 2x2 least squares fit per channel.
+	Weights[Index] is the share of the first endpoint. Returns false when every point uses the same weight.
+	*/
+	template<int32 Dimensions>
+	bool FitEndpoints(const float (*Points)[Dimensions], const int32* Indices, int32 Count, const float* Weights, float (&First)[Dimensions], float (&Second)[Dimensions])
+	{
+		float AA = 0.0f;
+		float AB = 0.0f;
+		float BB = 0.0f;
+		float AX[Dimensions] = {};
+		float BX[Dimensions] = {};
+		for (int32 Point = 0; Point < Count; Point++)
+		{
+			const float A = Weights[Indices[Point]];
+			const float B = 1.0f - A;
+			AA += A * A;
+			AB += A * B;
+			BB += B * B;
+			for (int32 Channel = 0; Channel < Dimensions; Channel++)
+			{
+				AX[Channel] += A * Points[Point][Channel];
+				BX[Channel] += B * Points[Point][Channel];
+			}
+		}
+
+		const float Determinant = AA * BB - AB * AB;
+		if (FMath::Abs(Determinant) < 1e-6f)
+		{
+			return false;
+		}
+		for (int32 Channel = 0; Channel < Dimensions; Channel++)
+		{
+			First[Channel] = FMath::Clamp((AX[Channel] * BB - BX[Channel] * AB) / Determinant, 0.0f, 255.0f);
+			Second[Channel] = FMath::Clamp((BX[Channel] * AA - AX[Channel] * AB) / Determinant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	/* Colour half of a BC1 or BC3 block. With bAllowTransparent (BC1), pixels with alpha under 128 come out transparent through the 3 colour mode. */
+	void EncodeColourBlock(const FBlockPixels& Block, bool bAllowTransparent, uint8* Out)
+	{
+		bool Transparent[16];
+		float Points[16][3];
+		int32 NumPoints = 0;
+		for (int32 Pixel = 0; Pixel < 16; Pixel++)
+		{
+			Transparent[Pixel] = bAllowTransparent && Block[Pixel][3] < 128;
+			if (!Transparent[Pixel])
+			{
+				Points[NumPoints][0] = Block[Pixel][0];
+				Points[NumPoints][1] = Block[Pixel][1];
+				Points[NumPoints][2] = Block[Pixel][2];
+				NumPoints++;
+			}
+		}
+
+		// The 3 colour mode (Colour0 <= Colour1) is only used for blocks with transparent pixels
+		const bool bFourColours = NumPoints == 16;
+		const int32 NumColours = bFourColours ? 4 : 3;
+		uint16 Colour0 = 0;
+		uint16 Colour1 = 0;
+		uint32 Indices = 0xFFFFFFFF;
+
+		float Mean[3];
+		float Axis[3];
+		if (NumPoints == 0)
+		{
+			// Fully transparent, every index already points at transparent black
+		}
+		else if (!FindPrincipalAxis<3>(Points, NumPoints, Mean, Axis))
+		{
+			// One colour: mixed exactly from the closest endpoints through the 2/3 index, or the closest single endpoint in the 3 colour mode
+			const int32 Red = (int32)Points[0][0];
+			const int32 Green = (int32)Points[0][1];
+			const int32 Blue = (int32)Points[0][2];
+			if (bFourColours)
+			{
+				const FSingleColourTables& Tables = GetSingleColourTables();
+				Colour0 = (uint16)((Tables.Match5[Red][0] << 11) | (Tables.Match6[Green][0] << 5) | Tables.Match5[Blue][0]);
+				Colour1 = (uint16)((Tables.Match5[Red][1] << 11) | (Tables.Match6[Green][1] << 5) | Tables.Match5[Blue][1]);
+				if (Colour0 < Colour1)
+				{
+					Swap(Colour0, Colour1);
+				}
+			}
+			else
+			{
+				Colour0 = Colour1 = Pack565(Points[0]);
+			}
+
+			int32 Palette[4][3];
+			int32 Error;
+			MakeColourPalette(Colour0, Colour1, Colour0 > Colour1, Palette);
+			Indices = PickColourIndices(Block, Transparent, Palette, Colour0 > Colour1 ? 4 : 3, Error);
+		}
+		else
+		{
+			// Start from the pixels furthest apart along the axis, then refine the endpoints against the indices they give
+			float MinProjection = MAX_flt;
+			float MaxProjection = -MAX_flt;
+			float Endpoints[2][3];
+			for (int32 Point = 0; Point < NumPoints; Point++)
+			{
+				const float Projection = Points[Point][0] * Axis[0] + Points[Point][1] * Axis[1] + Points[Point][2] * Axis[2];
+				if (Projection < MinProjection)
+				{
+					MinProjection = Projection;
+					FMemory::Memcpy(Endpoints[1], Points[Point], sizeof(Endpoints[1]));
+				}
+				if (Projection > MaxProjection)
+				{
+					MaxProjection = Projection;
+					FMemory::Memcpy(Endpoints[0], Points[Point], sizeof(Endpoints[0]));
+				}
+			}
+
+			static const float FourColourWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+			static const float ThreeColourWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+			const float* Weights = bFourColours ? FourColourWeights : ThreeColourWeights;
+
+			int32 BestError = MAX_int32;
+			for (int32 Iteration = 0; Iteration < 3; Iteration++)
+			{
+				const uint16 First = Pack565(Endpoints[0]);
+				const uint16 Second = Pack565(Endpoints[1]);
+
+				// Palettes are symmetric, the endpoints are put in the order of the mode once the best ones are known
+				int32 Palette[4][3];
+				int32 Error;
+				MakeColourPalette(First, Second, bFourColours, Palette);
+				const uint32 Candidate = PickColourIndices(Block, Transparent, Palette, NumColours, Error);
+				if (Error >= BestError)
+				{
+					break;
+				}
+				BestError = Error;
+				Colour0 = First;
+				Colour1 = Second;
+				Indices = Candidate;
+
+				int32 PointIndices[16];
+				for (int32 Pixel = 0, Point = 0; Pixel < 16; Pixel++)
+				{
+					if (!Transparent[Pixel])
+					{
+						PointIndices[Point++] = (Candidate >> (Pixel * 2)) & 3;
+					}
+				}
+				if (!FitEndpoints<3>(Points, PointIndices, NumPoints, Weights, Endpoints[0], Endpoints[1]))
+				{
+					break;
+				}
+			}
+
+			// The endpoint order selects the mode: swapping them mirrors the indices (0 <-> 1, and 2 <-> 3 with 4 colours)
+			if (bFourColours ? Colour0 < Colour1 : Colour0 > Colour1)
+			{
+				Swap(Colour0, Colour1);
+				for (int32 Pixel = 0; Pixel < 16; Pixel++)
+				{
+					const uint32 Index = (Indices >> (Pixel * 2)) & 3;
+					if (bFourColours || Index < 2)
+					{
+						Indices ^= 1u << (Pixel * 2);
+					}
+				}
+			}
+			else if (bFourColours && Colour0 == Colour1)
+			{
+				// Equal endpoints read as the 3 colour mode, where index 0 is still the right colour and index 3 would be transparent
+				Indices = 0;
+			}
+		}
+
+		FMemory::Memcpy(Out, &Colour0, 2);
+		FMemory::Memcpy(Out + 2, &Colour1, 2);
+		FMemory::Memcpy(Out + 4, &Indices, 4);
+	}
+
+	/***** BC3 alpha *****/
+
+	/* 8 level alpha block: the block's extremes as endpoints and 3 bit indices. */
+	void EncodeAlphaBlock(const FBlockPixels& Block, uint8* Out)
+	{
+		int32 Min = 255;
+		int32 Max = 0;
+		for (int32 Pixel = 0; Pixel < 16; Pixel++)
+		{
+			Min = FMath::Min(Min, (int32)Block[Pixel][3]);
+			Max = FMath::Max(Max, (int32)Block[Pixel][3]);
+		}
+
+		// Alpha0 > Alpha1 selects 6 interpolated levels. When both are the same every index 0 is exact anyway
+		int32 Palette[8];
+		Palette[0] = Max;
+		Palette[1] = Min;
+		for (int32 Index = 2; Index < 8; Index++)
+		{
+			Palette[Index] = ((8 - Index) * Max + (Index - 1) * Min) / 7;
+		}
+
+		uint64 Indices = 0;
+		if (Max > Min)
+		{
+			for (int32 Pixel = 0; Pixel < 16; Pixel++)
+			{
+				int32 BestIndex = 0;
+				int32 BestError = MAX_int32;
+				for (int32 Index = 0; Index < 8; Index++)
+				{
+					const int32 Error = FMath::Abs(Block[Pixel][3] - Palette[Index]);
+					if (Error < BestError)
+					{
+						BestError = Error;
+						BestIndex = Index;
+					}
+				}
+				Indices |= (uint64)BestIndex << (Pixel * 3);
+			}
+		}
+
+		Out[0] = (uint8)Max;
+		Out[1] = (uint8)Min;
+		for (int32 Byte = 0; Byte < 6; Byte++)
+		{
+			Out[2 + Byte] = (uint8)(Indices >> (Byte * 8));
+		}
+	}
+
+	/***** BC7 mode 6 *****/
+
+	// Share of the second endpoint for each 4 bit index, out of 64
+	const int32 BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	/* Rounds an RGBA endpoint to the closest values with Bit as their shared lowest bit, 7 bits per channel above it. */
+	void QuantiseBC7Endpoint(const float (&Endpoint)[4], int32 Bit, int32 (&OutValues)[4])
+	{
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			OutValues[Channel] = FMath::Clamp((int32)((Endpoint[Channel] - Bit) * 0.5f + 0.5f), 0, 127);
+		}
+	}
+
+	/* Closest of the 16 levels of every pixel. Gives up as soon as the error reaches ErrorLimit, returning it. */
+	int32 PickBC7Indices(const FBlockPixels& Block, const int32 (&First)[4], const int32 (&Second)[4], int32 ErrorLimit, int32 (&OutIndices)[16])
+	{
+		int32 Palette[16][4];
+		for (int32 Index = 0; Index < 16; Index++)
+		{
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				Palette[Index][Channel] = ((64 - BC7Weights4[Index]) * First[Channel] + BC7Weights4[Index] * Second[Channel] + 32) >> 6;
+			}
+		}
+
+		int32 TotalError = 0;
+		for (int32 Pixel = 0; Pixel < 16; Pixel++)
+		{
+			int32 BestIndex = 0;
+			int32 BestError = MAX_int32;
+			for (int32 Index = 0; Index < 16; Index++)
+			{
+				int32 Error = 0;
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					const int32 Difference = Block[Pixel][Channel] - Palette[Index][Channel];
+					Error += Difference * Difference;
+				}
+				if (Error < BestError)
+				{
+					BestError = Error;
+					BestIndex = Index;
+				}
+			}
+			OutIndices[Pixel] = BestIndex;
+			TotalError += BestError;
+			if (TotalError >= ErrorLimit)
+			{
+				return ErrorLimit;
+			}
+		}
+		return TotalError;
+	}
+
+	void EncodeBC7Block(const FBlockPixels& Block, uint8* Out)
+	{
+		float Points[16][4];
+		for (int32 Pixel = 0; Pixel < 16; Pixel++)
+		{
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				Points[Pixel][Channel] = Block[Pixel][Channel];
+			}
+		}
+		// The line is cut where the pixels project furthest along the axis
+		float Endpoints[2][4];
+		float Mean[4];
+		float Axis[4];
+		if (FindPrincipalAxis<4>(Points, 16, Mean, Axis))
+		{
+			float AxisLength = 0.0f;
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				AxisLength += Axis[Channel] * Axis[Channel];
+			}
+			float MinProjection = MAX_flt;
+			float MaxProjection = -MAX_flt;
+			for (int32 Pixel = 0; Pixel < 16; Pixel++)
+			{
+				float Projection = 0.0f;
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					Projection += (Points[Pixel][Channel] - Mean[Channel]) * Axis[Channel];
+				}
+				MinProjection = FMath::Min(MinProjection, Projection / AxisLength);
+				MaxProjection = FMath::Max(MaxProjection, Projection / AxisLength);
+			}
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				Endpoints[0][Channel] = FMath::Clamp(Mean[Channel] + MinProjection * Axis[Channel], 0.0f, 255.0f);
+				Endpoints[1][Channel] = FMath::Clamp(Mean[Channel] + MaxProjection * Axis[Channel], 0.0f, 255.0f);
+			}
+		}
+		else
+		{
+			// One colour: odd values are endpoints with both lowest bits set, even ones are reached half way between their odd neighbours or
+			// are endpoints with both lowest bits clear. Which works best for all 4 channels is left to the lowest bit search below.
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				const int32 Value = Block[0][Channel];
+				Endpoints[0][Channel] = (float)((Value & 1) ? Value : FMath::Max(Value - 1, 0));
+				Endpoints[1][Channel] = (float)((Value & 1) ? Value : Value + 1);
+			}
+		}
+
+		float Weights[16];
+		for (int32 Index = 0; Index < 16; Index++)
+		{
+			Weights[Index] = (64 - BC7Weights4[Index]) / 64.0f;
+		}
+
+		// Opaque blocks have to decode to alpha 255 exactly, or masked and alpha tested materials see through them
+		bool bOpaque = true;
+		for (int32 Pixel = 0; Pixel < 16; Pixel++)
+		{
+			bOpaque &= Block[Pixel][3] == 255;
+		}
+
+		int32 BestError = MAX_int32;
+		int32 BestValues[2][4] = {};
+		int32 BestBits[2] = {};
+		int32 BestIndices[16] = {};
+		for (int32 Iteration = 0; Iteration < 3 && BestError > 0; Iteration++)
+		{
+			// Each endpoint's lowest bit is shared by its 4 channels: no choice suits every channel, e.g. opaque black needs 0 in RGB and
+			// 1 in alpha. The 4 combinations are tried on the whole block and the one with the smallest error is kept, refinements keep it.
+			// Opaque blocks only get both bits set, the only way to alpha 255, at the cost of RGB endpoints landing on odd values.
+			int32 CandidateValues[2][2][4];
+			for (int32 Endpoint = 0; Endpoint < 2; Endpoint++)
+			{
+				if (bOpaque)
+				{
+					Endpoints[Endpoint][3] = 255.0f;
+				}
+				for (int32 Bit = 0; Bit < 2; Bit++)
+				{
+					QuantiseBC7Endpoint(Endpoints[Endpoint], Bit, CandidateValues[Endpoint][Bit]);
+				}
+			}
+
+			int32 Error = MAX_int32;
+			int32 Values[2][4];
+			int32 Bits[2];
+			int32 Indices[16];
+			const int32 NumCombinations = Iteration == 0 && !bOpaque ? 4 : 1;
+			for (int32 Combination = 0; Combination < NumCombinations; Combination++)
+			{
+				const int32 FirstBit = bOpaque ? 1 : Iteration == 0 ? Combination & 1 : BestBits[0];
+				const int32 SecondBit = bOpaque ? 1 : Iteration == 0 ? Combination >> 1 : BestBits[1];
+
+				int32 First[4];
+				int32 Second[4];
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					First[Channel] = CandidateValues[0][FirstBit][Channel] << 1 | FirstBit;
+					Second[Channel] = CandidateValues[1][SecondBit][Channel] << 1 | SecondBit;
+				}
+
+				int32 CombinationIndices[16];
+				const int32 CombinationError = PickBC7Indices(Block, First, Second, Error, CombinationIndices);
+				if (CombinationError < Error)
+				{
+					Error = CombinationError;
+					FMemory::Memcpy(Values[0], CandidateValues[0][FirstBit], sizeof(Values[0]));
+					FMemory::Memcpy(Values[1], CandidateValues[1][SecondBit], sizeof(Values[1]));
+					Bits[0] = FirstBit;
+					Bits[1] = SecondBit;
+					FMemory::Memcpy(Indices, CombinationIndices, sizeof(Indices));
+				}
+			}
+
+			if (Error >= BestError)
+			{
+				break;
+			}
+			BestError = Error;
+			FMemory::Memcpy(BestValues, Values, sizeof(Values));
+			FMemory::Memcpy(BestBits, Bits, sizeof(Bits));
+			FMemory::Memcpy(BestIndices, Indices, sizeof(Indices));
+
+			if (!FitEndpoints<4>(Points, Indices, 16, Weights, Endpoints[0], Endpoints[1]))
+			{
+				break;
+			}
+		}
+
+		// The first pixel's index is stored with 3 bits, its top bit has to be 0: swapping the endpoints mirrors the indices
+		if (BestIndices[0] & 8)
+		{
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				Swap(BestValues[0][Channel], BestValues[1][Channel]);
+			}
+			Swap(BestBits[0], BestBits[1]);
+			for (int32& Index : BestIndices)
+			{
+				Index = 15 - Index;
+			}
+		}
+
+		FBlockBitWriter Writer;
+		Writer.Write(1 << 6, 7);
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			Writer.Write(BestValues[0][Channel], 7);
+			Writer.Write(BestValues[1][Channel], 7);
+		}
+		Writer.Write(BestBits[0], 1);
+		Writer.Write(BestBits[1], 1);
+		Writer.Write(BestIndices[0], 3);
+		for (int32 Pixel = 1; Pixel < 16; Pixel++)
+		{
+			Writer.Write(BestIndices[Pixel], 4);
+		}
+		FMemory::Memcpy(Out, Writer.Words, 16);
+	}
+}
+
+EPixelFormat FBitmapBlockCompression::GetPixelFormat(EBitmapTextureCompression Compression)
+{
+	switch (Compression)
+	{
+	case EBitmapTextureCompression::BC1:
+		return PF_DXT1;
+	case EBitmapTextureCompression::BC3:
+		return PF_DXT5;
+	case EBitmapTextureCompression::BC7:
+		return PF_BC7;
+	default:
+		return PF_R8G8B8A8;
+	}
+}
+
+int64 FBitmapBlockCompression::GetCompressedSize(FImageSize Size, EBitmapTextureCompression Compression)
+{
+	if (Compression == EBitmapTextureCompression::None)
+	{
+		return (int64)Size.X * Size.Y * 4;
+	}
+	const int64 NumBlocks = (int64)((Size.X + 3) / 4) * ((Size.Y + 3) / 4);
+	return NumBlocks * (Compression == EBitmapTextureCompression::BC1 ? 8 : 16);
+}
+
+void FBitmapBlockCompression::Compress(FConstBitmapView Pixels, EBitmapTextureCompression Compression, void* Dst)
+{
+	const FImageSize Size = Pixels.GetSize();
+	if (Size.X <= 0 || Size.Y <= 0 || Compression == EBitmapTextureCompression::None)
+	{
+		return;
+	}
+
+	const int32 NumBlocksX = (Size.X + 3) / 4;
+	const int32 NumBlocksY = (Size.Y + 3) / 4;
+	const int32 BlockBytes = Compression == EBitmapTextureCompression::BC1 ? 8 : 16;
+
+	FBitmapParallel::ForRange(NumBlocksY, FMath::Max(1, 256 / NumBlocksX), [&](int32 Start, int32 End)
+	{
+		FBlockPixels Block;
+		for (int32 BlockY = Start; BlockY < End; BlockY++)
+		{
+			uint8* Out = (uint8*)Dst + (int64)BlockY * NumBlocksX * BlockBytes;
+			for (int32 BlockX = 0; BlockX < NumBlocksX; BlockX++, Out += BlockBytes)
+			{
+				LoadBlock(Pixels, BlockX, BlockY, Block);
+				switch (Compression)
+				{
+				case EBitmapTextureCompression::BC1:
+					EncodeColourBlock(Block, true, Out);
+					break;
+				case EBitmapTextureCompression::BC3:
+					EncodeAlphaBlock(Block, Out);
+					EncodeColourBlock(Block, false, Out + 8);
+					break;
+				default:
+					EncodeBC7Block(Block, Out);
+					break;
+				}
+			}
+		}
+	});
+}
@@ -0,0 +1,304 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapBlur.h"
+#include "BitmapLinePass.h"
+#include "BitmapChannels.h"
+
+namespace
+{
+	/* Sliding window average along one line with clamp-to-edge borders: one add and one subtract per pixel whatever the radius. */
+	void BoxFilterLine(const FColor* In, FColor* Out, int32 Length, int32 Radius)
+	{
+		const uint32 WindowSize = 2 * Radius + 1;
+
+		// 8.24 fixed point 1 / WindowSize, so the average is a multiply and a shift
+		const uint64 Reciprocal = ((1ull << 24) + WindowSize / 2) / WindowSize;
+		const uint64 Rounding = 1ull << 23;
+
+		uint32 SumR = 0;
+		uint32 SumG = 0;
+		uint32 SumB = 0;
+		uint32 SumA = 0;
+		for (int32 Index = -Radius; Index <= Radius; Index++)
+		{
+			const FColor& Pixel = In[FMath::Clamp(Index, 0, Length - 1)];
+			SumR += Pixel.R;
+			SumG += Pixel.G;
+			SumB += Pixel.B;
+			SumA += Pixel.A;
+		}
+
+		for (int32 Index = 0; Index < Length; Index++)
+		{
+			Out[Index] = FColor(
+				(uint8)FMath::Min<uint64>((SumR * Reciprocal + Rounding) >> 24, 255),
+				(uint8)FMath::Min<uint64>((SumG * Reciprocal + Rounding) >> 24, 255),
+				(uint8)FMath::Min<uint64>((SumB * Reciprocal + Rounding) >> 24, 255),
+				(uint8)FMath::Min<uint64>((SumA * Reciprocal + Rounding) >> 24, 255));
+
+			// Slide the window: the pixel entering on the right in, the one leaving on the left out
+			const FColor& Entering = In[FMath::Min(Index + Radius + 1, Length - 1)];
+			const FColor& Leaving = In[FMath::Max(Index - Radius, 0)];
+			SumR += Entering.R - Leaving.R;
+			SumG += Entering.G - Leaving.G;
+			SumB += Entering.B - Leaving.B;
+			SumA += Entering.A - Leaving.A;
+		}
+	}
+
+	/* Young / van Vliet recursive gaussian coefficients ("Recursive implementation of the Gaussian filter", 1995), already divided by b0. */
+	struct FRecursiveGaussianCoefficients
+	{
+		float B;
+		float B1;
+		float B2;
+		float B3;
+
+		explicit FRecursiveGaussianCoefficients(float Sigma)
+		{
+			Sigma = FMath::Max(Sigma, 0.5f);
+
+			const float Q = Sigma >= 2.5f
+				? 0.98711f * Sigma - 0.96330f
+				: 3.97156f - 4.14554f * FMath::Sqrt(1.0f - 0.26891f * Sigma);
+			const float Q2 = Q * Q;
+			const float Q3 = Q2 * Q;
+
+			const float Coefficient0 = 1.57825f + 2.44413f * Q + 1.4281f * Q2 + 0.422205f * Q3;
+			const float Coefficient1 = 2.44413f * Q + 2.85619f * Q2 + 1.26661f * Q3;
+			const float Coefficient2 = -(1.4281f * Q2 + 1.26661f * Q3);
+			const float Coefficient3 = 0.422205f * Q3;
+
+			B1 = Coefficient1 / Coefficient0;
+			B2 = Coefficient2 / Coefficient0;
+			B3 = Coefficient3 / Coefficient0;
+			B = 1.0f - (B1 + B2 + B3);
+		}
+	};
+
+	FORCEINLINE VectorRegister LoadBlurSample(const FColor& Pixel)
+	{
+		return VectorLoadByte4(&Pixel);
+	}
+
+	FORCEINLINE VectorRegister LoadBlurSample(const VectorRegister& Value)
+	{
+		return Value;
+	}
+
+	/* Forward then backward 3rd order recursion along one line, all 4 channels at once. The borders start from the edge value, as if it repeated forever. */
+	template<typename InType>
+	void RecursiveGaussianLine(const InType* In, VectorRegister* Out, int32 Length, const FRecursiveGaussianCoefficients& Coefficients)
+	{
+		const VectorRegister B = VectorSetFloat1(Coefficients.B);
+		const VectorRegister B1 = VectorSetFloat1(Coefficients.B1);
+		const VectorRegister B2 = VectorSetFloat1(Coefficients.B2);
+		const VectorRegister B3 = VectorSetFloat1(Coefficients.B3);
+
+		VectorRegister Previous1 = LoadBlurSample(In[0]);
+		VectorRegister Previous2 = Previous1;
+		VectorRegister Previous3 = Previous1;
+		for (int32 Index = 0; Index < Length; Index++)
+		{
+			VectorRegister Value = VectorMultiply(B, LoadBlurSample(In[Index]));
+			Value = VectorMultiplyAdd(B1, Previous1, Value);
+			Value = VectorMultiplyAdd(B2, Previous2, Value);
+			Value = VectorMultiplyAdd(B3, Previous3, Value);
+
+			Out[Index] = Value;
+			Previous3 = Previous2;
+			Previous2 = Previous1;
+			Previous1 = Value;
+		}
+
+		Previous1 = Out[Length - 1];
+		Previous2 = Previous1;
+		Previous3 = Previous1;
+		for (int32 Index = Length - 1; Index >= 0; Index--)
+		{
+			VectorRegister Value = VectorMultiply(B, Out[Index]);
+			Value = VectorMultiplyAdd(B1, Previous1, Value);
+			Value = VectorMultiplyAdd(B2, Previous2, Value);
+			Value = VectorMultiplyAdd(B3, Previous3, Value);
+
+			Out[Index] = Value;
+			Previous3 = Previous2;
+			Previous2 = Previous1;
+			Previous1 = Value;
+		}
+	}
+
+	/* Runs the box filters in Radii one after the other along a line, ping-ponging between Out and Temp. */
+	void BoxFilterLineRepeated(const FColor* In, FColor* Out, FColor* Temp, int32 Length, const TArray<int32>& Radii)
+	{
+		// Count the buffers back from the last pass, which has to land in Out
+		FColor* Buffers[2] = { Out, Temp };
+
+		const FColor* Source = In;
+		for (int32 Pass = 0; Pass < Radii.Num(); Pass++)
+		{
+			FColor* Destination = Buffers[(Radii.Num() - 1 - Pass) % 2];
+			BoxFilterLine(Source, Destination, Length, Radii[Pass]);
+			Source = Destination;
+		}
+	}
+
+	/* Separable blur made of box filters: all the boxes on the rows, then all the boxes on the columns. */
+	void BoxBlurPasses(FConstBitmapView Src, const TArray<int32>& Radii, EFilterColourChannel ColourChannel, FBitmapView Dst)
+	{
+		TArray<FColor> Transposed;
+		Transposed.SetNumUninitialized(Src.Width * Src.Height);
+		const FBitmapView TransposedView(Transposed.GetData(), Src.Height, Src.Width, Src.Height);
+
+		auto MakeLineFilter = [&Radii](int32 Length)
+		{
+			return [&Radii, Length]()
+			{
+				TArray<FColor> Temp;
+				Temp.SetNumUninitialized(Length);
+				return [&Radii, Length, Temp](const FColor* In, FColor* Out) mutable
+				{
+					BoxFilterLineRepeated(In, Out, Temp.GetData(), Length, Radii);
+				};
+			};
+		};
+
+		FBitmapLinePass::Run(Src, TransposedView, MakeLineFilter(Src.Width));
+		FBitmapLinePass::Run<FColor, FColor, FColor>(TransposedView, Dst, MakeLineFilter(Src.Height), [ColourChannel](const FColor& Pixel)
+		{
+			return BitmapChannels::FinishFilteredPixel(Pixel, ColourChannel);
+		});
+	}
+}
+
+void FBitmapBlur::BoxBlur(FConstBitmapView Src, int32 Radius, EFilterColourChannel ColourChannel, FBitmapView Dst)
+{
+	if (Src.Width <= 0 || Src.Height <= 0)
+	{
+		return;
+	}
+
+	TArray<int32> Radii = { FMath::Max(Radius, 0) };
+	BoxBlurPasses(Src, Radii, ColourChannel, Dst);
+}
+
+void FBitmapBlur::BoxGaussianBlur(FConstBitmapView Src, float Sigma, EFilterColourChannel ColourChannel, FBitmapView Dst)
+{
+	if (Src.Width <= 0 || Src.Height <= 0)
+	{
+		return;
+	}
+
+	int32 BoxRadii[3];
+	GetBoxRadiiForGaussian(Sigma, BoxRadii);
+
+	TArray<int32> Radii = { BoxRadii[0], BoxRadii[1], BoxRadii[2] };
+	BoxBlurPasses(Src, Radii, ColourChannel, Dst);
+}
+
+void FBitmapBlur::RecursiveGaussianBlur(FConstBitmapView Src, float Sigma, EFilterColourChannel ColourChannel, FBitmapView Dst)
+{
+	if (Src.Width <= 0 || Src.Height <= 0)
+	{
+		return;
+	}
+
+	const FRecursiveGaussianCoefficients Coefficients(Sigma);
+
+	TArray<VectorRegister> Transposed;
+	Transposed.SetNumUninitialized(Src.Width * Src.Height);
+	const TBitmapView<VectorRegister> TransposedView(Transposed.GetData(), Src.Height, Src.Width, Src.Height);
+
+	FBitmapLinePass::Run(Src, TransposedView, [&]()
+	{
+		const int32 Length = Src.Width;
+		return [&Coefficients, Length](const FColor* In, VectorRegister* Out)
+		{
+			RecursiveGaussianLine(In, Out, Length, Coefficients);
+		};
+	});
+
+	// Half added for rounding, VectorStoreByte4 truncates (and saturates)
+	const VectorRegister Rounding = VectorSetFloat1(0.5f);
+
+	FBitmapLinePass::Run<VectorRegister, VectorRegister, FColor>(TransposedView, Dst, [&]()
+	{
+		const int32 Length = Src.Height;
+		return [&Coefficients, Length](const VectorRegister* In, VectorRegister* Out)
+		{
+			RecursiveGaussianLine(In, Out, Length, Coefficients);
+		};
+	},
+	[Rounding, ColourChannel](const VectorRegister& Value)
+	{
+		FColor Pixel;
+		VectorStoreByte4(VectorAdd(Value, Rounding), &Pixel);
+		return BitmapChannels::FinishFilteredPixel(Pixel, ColourChannel);
+	});
+}
+
+void FBitmapBlur::Blur(FConstBitmapView Src, float Radius, EBitmapBlurMethod Method, EFilterColourChannel ColourChannel, FBitmapView Dst)
+{
+	const float Sigma = FMath::Max(Radius / 3.0f, 0.5f);
+
+	switch (Method)
+	{
+	case EBitmapBlurMethod::Box:
+		BoxBlur(Src, FMath::RoundToInt(Radius), ColourChannel, Dst);
+		break;
+
+	case EBitmapBlurMethod::FastGaussian:
+		BoxGaussianBlur(Src, Sigma, ColourChannel, Dst);
+		break;
+
+	case EBitmapBlurMethod::Gaussian:
+		RecursiveGaussianBlur(Src, Sigma, ColourChannel, Dst);
+		break;
+	}
+}
+
+int32 FBitmapBlur::GetReach(float Radius, EBitmapBlurMethod Method)
+{
+	const float Sigma = FMath::Max(Radius / 3.0f, 0.5f);
+
+	switch (Method)
+	{
+	case EBitmapBlurMethod::Box:
+		return FMath::Max(FMath::RoundToInt(Radius), 0);
+
+	case EBitmapBlurMethod::FastGaussian:
+	{
+		// Each box pass spreads the edge of the rectangle a box radius further in
+		int32 BoxRadii[3];
+		GetBoxRadiiForGaussian(Sigma, BoxRadii);
+		return BoxRadii[0] + BoxRadii[1] + BoxRadii[2];
+	}
+
+	default:
+		return FMath::CeilToInt(12.0f * Sigma);
+	}
+}
+
+void FBitmapBlur::GetBoxRadiiForGaussian(float Sigma, int32 OutRadii[3])
+{
+	// Three boxes of width W have the variance of a gaussian with 12 * Sigma² = 3 * (W² - 1).
+	// Widths have to be odd, so mix the two odd widths around the ideal one to land on the right variance (Kovesi, "Fast almost-gaussian filtering").
+	const int32 NumBoxes = 3;
+	const float Variance12 = 12.0f * Sigma * Sigma;
+
+	int32 LowerWidth = FMath::FloorToInt(FMath::Sqrt(Variance12 / NumBoxes + 1.0f));
+	if (LowerWidth % 2 == 0)
+	{
+		LowerWidth--;
+	}
+	LowerWidth = FMath::Max(LowerWidth, 1);
+	const int32 UpperWidth = LowerWidth + 2;
+
+	const float IdealLowerCount = (Variance12 - NumBoxes * LowerWidth * LowerWidth - 4 * NumBoxes * LowerWidth - 3 * NumBoxes) / (-4.0f * LowerWidth - 4.0f);
+	const int32 LowerCount = FMath::Clamp(FMath::RoundToInt(IdealLowerCount), 0, NumBoxes);
+
+	for (int32 Box = 0; Box < NumBoxes; Box++)
+	{
+		OutRadii[Box] = ((Box < LowerCount ? LowerWidth : UpperWidth) - 1) / 2;
+	}
+}
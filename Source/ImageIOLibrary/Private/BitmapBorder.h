@@ -0,0 +1,57 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// What reading outside a bitmap returns, shared by every operation that reads neighbours.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+namespace BitmapBorder
+{
+	/* Maps a coordinate that may be outside [0, Length) back into it. Returns INDEX_NONE when a Constant border should be read instead. */
+	FORCEINLINE int32 ResolveIndex(int32 Index, int32 Length, EBitmapBorderMode BorderMode)
+	{
+		if ((uint32)Index < (uint32)Length)
+		{
+			return Index;
+		}
+
+		switch (BorderMode)
+		{
+		case EBitmapBorderMode::Clamp:
+			return FMath::Clamp(Index, 0, Length - 1);
+
+		case EBitmapBorderMode::Wrap:
+		{
+			const int32 Wrapped = Index % Length;
+			return Wrapped < 0 ? Wrapped + Length : Wrapped;
+		}
+
+		case EBitmapBorderMode::Mirror:
+		{
+			// Reflect around the edge pixels without repeating them: -1 reads 1, Length reads Length - 2
+			if (Length == 1)
+			{
+				return 0;
+			}
+			const int32 Period = 2 * (Length - 1);
+			int32 Reflected = Index % Period;
+			Reflected = Reflected < 0 ? Reflected + Period : Reflected;
+			return Reflected < Length ? Reflected : Period - Reflected;
+		}
+
+		default:
+			return INDEX_NONE;
+		}
+	}
+
+	/* Reads a pixel at any coordinate, following the border mode outside the bitmap. Meant for edges only, interiors should index directly. */
+	FORCEINLINE FColor ReadPixel(const FConstBitmapView& Src, int32 X, int32 Y, EBitmapBorderMode BorderMode, FColor BorderColour)
+	{
+		const int32 ResolvedX = ResolveIndex(X, Src.Width, BorderMode);
+		const int32 ResolvedY = ResolveIndex(Y, Src.Height, BorderMode);
+		return ResolvedX == INDEX_NONE || ResolvedY == INDEX_NONE ? BorderColour : Src.GetRow(ResolvedY)[ResolvedX];
+	}
+}
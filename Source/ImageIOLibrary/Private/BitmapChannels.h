@@ -0,0 +1,59 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Colour channel handling shared by the filters.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+
+namespace BitmapChannels
+{
+	/* Whether a filter working on these channels filters alpha too. */
+	FORCEINLINE bool FiltersAlpha(EFilterColourChannel ColourChannel)
+	{
+		return ColourChannel == EFilterColourChannel::RGBA || ColourChannel == EFilterColourChannel::A;
+	}
+
+	/* Turns a pixel whose 4 channels were all filtered into the filter's output for the selected channels (same rules as ApplyBitmapFilter). */
+	FORCEINLINE FColor FinishFilteredPixel(FColor Pixel, EFilterColourChannel ColourChannel)
+	{
+		if (!FiltersAlpha(ColourChannel))
+		{
+			Pixel.A = 255;
+		}
+		return UImageIOLibraryBPLibrary::SetPixelColourChannel(Pixel, ColourChannel);
+	}
+
+	/* Bits of the packed pixel (FColor::DWColor(), ARGB on every platform) a channel keeps, and the bits it forces on. A and Greyscale
+	move values between channels so they can't be expressed this way, TChannelSelect::bIsMask is false for them.
+	*/
+	template<EFilterColourChannel ColourChannel>
+	struct TChannelSelect
+	{
+		static const bool bIsMask = ColourChannel != EFilterColourChannel::A && ColourChannel != EFilterColourChannel::Greyscale;
+
+		static const uint32 KeepMask =
+			ColourChannel == EFilterColourChannel::RGBA ? 0xFFFFFFFF :
+			ColourChannel == EFilterColourChannel::RGB ? 0x00FFFFFF :
+			ColourChannel == EFilterColourChannel::R ? 0x00FF0000 :
+			ColourChannel == EFilterColourChannel::G ? 0x0000FF00 :
+			ColourChannel == EFilterColourChannel::B ? 0x000000FF : 0;
+
+		// Every channel but RGBA returns an opaque pixel
+		static const uint32 SetMask = ColourChannel == EFilterColourChannel::RGBA ? 0 : 0xFF000000;
+	};
+
+	/* FinishFilteredPixel for a channel known at compile time: a constant AND and OR instead of the switch for all but A and Greyscale. */
+	template<EFilterColourChannel ColourChannel>
+	FORCEINLINE FColor FinishFilteredPixel(FColor Pixel)
+	{
+		typedef TChannelSelect<ColourChannel> FSelect;
+		if (FSelect::bIsMask)
+		{
+			Pixel.DWColor() = (Pixel.DWColor() & FSelect::KeepMask) | FSelect::SetMask;
+			return Pixel;
+		}
+		return FinishFilteredPixel(Pixel, ColourChannel);
+	}
+}
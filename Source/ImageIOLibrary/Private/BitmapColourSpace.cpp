@@ -0,0 +1,54 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapColourSpace.h"
+
+namespace
+{
+	/* IEC 61966-2-1 transfer functions, on values from 0 to 1. */
+	double DecodeSRGB(double Value)
+	{
+		return Value <= 0.04045 ? Value / 12.92 : FMath::Pow((Value + 0.055) / 1.055, 2.4);
+	}
+
+	double EncodeSRGB(double Value)
+	{
+		return Value <= 0.0031308 ? Value * 12.92 : 1.055 * FMath::Pow(Value, 1.0 / 2.4) - 0.055;
+	}
+
+	struct FSRGBTables
+	{
+		float SRGBToLinear[256];
+		uint8 LinearToSRGB[BitmapColourSpace::LinearToSRGBTableSize];
+
+		FSRGBTables()
+		{
+			for (int32 Value = 0; Value < 256; Value++)
+			{
+				SRGBToLinear[Value] = (float)DecodeSRGB(Value / 255.0);
+			}
+
+			for (int32 Index = 0; Index < BitmapColourSpace::LinearToSRGBTableSize; Index++)
+			{
+				const double Encoded = EncodeSRGB((double)Index / (BitmapColourSpace::LinearToSRGBTableSize - 1));
+				LinearToSRGB[Index] = (uint8)FMath::Clamp((int32)(Encoded * 255.0 + 0.5), 0, 255);
+			}
+		}
+	};
+
+	const FSRGBTables& GetSRGBTables()
+	{
+		// Function local static, so the first caller builds it and the others wait for it
+		static const FSRGBTables Tables;
+		return Tables;
+	}
+}
+
+const float* BitmapColourSpace::GetSRGBToLinearTable()
+{
+	return GetSRGBTables().SRGBToLinear;
+}
+
+const uint8* BitmapColourSpace::GetLinearToSRGBTable()
+{
+	return GetSRGBTables().LinearToSRGB;
+}
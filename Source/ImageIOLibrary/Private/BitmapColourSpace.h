@@ -0,0 +1,26 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// sRGB <-> linear light conversions through lookup tables, for the operations that mix pixels in linear light.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace BitmapColourSpace
+{
+	// Entries of the linear to sRGB table. Fine enough that only values right next to black can come out one level off
+	const int32 LinearToSRGBTableSize = 16384;
+
+	/* Linear light value (0 to 1) of each 8 bit sRGB value. Built the first time it's asked for, safe to call from any thread. */
+	const float* GetSRGBToLinearTable();
+
+	/* 8 bit sRGB value of LinearToSRGBTableSize evenly spaced linear values from 0 to 1. Built the first time it's asked for, safe to call from any thread. */
+	const uint8* GetLinearToSRGBTable();
+
+	/* 8 bit sRGB value of a linear light value, clamped to [0, 1]. Table comes from GetLinearToSRGBTable(), fetched once outside the pixel loops. */
+	FORCEINLINE uint8 LinearToSRGB(const uint8* Table, float Linear)
+	{
+		const float Clamped = FMath::Clamp(Linear, 0.0f, 1.0f);
+		return Table[(int32)(Clamped * (LinearToSRGBTableSize - 1) + 0.5f)];
+	}
+}
@@ -0,0 +1,236 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapCompositing.h"
+#include "BitmapParallel.h"
+#include "BitmapSimd.h"
+
+namespace
+{
+	// Pixels per parallel batch, compositing is cheap so batches need to be big to be worth a task
+	const int32 CompositeMinBatch = 16384;
+
+	/* Porter-Duff blend factor, "Other" being the alpha of the other operand. Out = Fa * Source + Fb * Destination. */
+	enum class EPorterDuffFactor : uint8
+	{
+		Zero,
+		One,
+		OtherAlpha,
+		InvOtherAlpha
+	};
+
+	FORCEINLINE uint32 ScalarFactor(EPorterDuffFactor Factor, uint32 OtherAlpha)
+	{
+		switch (Factor)
+		{
+		case EPorterDuffFactor::Zero:			return 0;
+		case EPorterDuffFactor::One:			return 255;
+		case EPorterDuffFactor::OtherAlpha:		return OtherAlpha;
+		default:								return 255 - OtherAlpha;
+		}
+	}
+
+#if IMAGEIO_WITH_SSE2
+	FORCEINLINE __m128i VectorFactor(EPorterDuffFactor Factor, __m128i OtherPixels)
+	{
+		switch (Factor)
+		{
+		case EPorterDuffFactor::Zero:			return _mm_setzero_si128();
+		case EPorterDuffFactor::One:			return _mm_set1_epi16(255);
+		case EPorterDuffFactor::OtherAlpha:		return BitmapSimd::BroadcastAlpha_Epi16(OtherPixels);
+		default:								return _mm_sub_epi16(_mm_set1_epi16(255), BitmapSimd::BroadcastAlpha_Epi16(OtherPixels));
+		}
+	}
+
+	/* Composites two pixels held in 16 bit lanes. */
+	template<EPorterDuffFactor Fa, EPorterDuffFactor Fb>
+	FORCEINLINE __m128i CompositeTwoPixels(__m128i Source, __m128i Destination)
+	{
+		const __m128i SourceTerm = BitmapSimd::Mul255_Epi16(Source, VectorFactor(Fa, Destination));
+		const __m128i DestinationTerm = BitmapSimd::Mul255_Epi16(Destination, VectorFactor(Fb, Source));
+		return _mm_add_epi16(SourceTerm, DestinationTerm);
+	}
+#endif
+
+	/* The factors are template arguments so each operator compiles down to its own branch-free loop. */
+	template<EPorterDuffFactor Fa, EPorterDuffFactor Fb>
+	void CompositeRange(const FColor* Source, const FColor* Destination, FColor* Out, int32 NumPixels)
+	{
+		int32 Index = 0;
+
+#if IMAGEIO_WITH_SSE2
+		const __m128i Zero = _mm_setzero_si128();
+		for (; Index + 4 <= NumPixels; Index += 4)
+		{
+			const __m128i Src = _mm_loadu_si128((const __m128i*)(Source + Index));
+			const __m128i Dst = _mm_loadu_si128((const __m128i*)(Destination + Index));
+
+			const __m128i Low = CompositeTwoPixels<Fa, Fb>(_mm_unpacklo_epi8(Src, Zero), _mm_unpacklo_epi8(Dst, Zero));
+			const __m128i High = CompositeTwoPixels<Fa, Fb>(_mm_unpackhi_epi8(Src, Zero), _mm_unpackhi_epi8(Dst, Zero));
+
+			// Saturating pack, only Plus can actually go over 255
+			_mm_storeu_si128((__m128i*)(Out + Index), _mm_packus_epi16(Low, High));
+		}
+#endif
+
+		for (; Index < NumPixels; Index++)
+		{
+			const FColor Src = Source[Index];
+			const FColor Dst = Destination[Index];
+			const uint32 SourceFactor = ScalarFactor(Fa, Dst.A);
+			const uint32 DestinationFactor = ScalarFactor(Fb, Src.A);
+
+			FColor Result;
+			Result.R = (uint8)FMath::Min<uint32>(BitmapSimd::Mul255(Src.R, SourceFactor) + BitmapSimd::Mul255(Dst.R, DestinationFactor), 255);
+			Result.G = (uint8)FMath::Min<uint32>(BitmapSimd::Mul255(Src.G, SourceFactor) + BitmapSimd::Mul255(Dst.G, DestinationFactor), 255);
+			Result.B = (uint8)FMath::Min<uint32>(BitmapSimd::Mul255(Src.B, SourceFactor) + BitmapSimd::Mul255(Dst.B, DestinationFactor), 255);
+			Result.A = (uint8)FMath::Min<uint32>(BitmapSimd::Mul255(Src.A, SourceFactor) + BitmapSimd::Mul255(Dst.A, DestinationFactor), 255);
+			Out[Index] = Result;
+		}
+	}
+
+	typedef void(*FCompositeRangeFunction)(const FColor*, const FColor*, FColor*, int32);
+
+	FCompositeRangeFunction GetCompositeRangeFunction(EBitmapCompositeOperation Operation)
+	{
+		typedef EPorterDuffFactor F;
+
+		switch (Operation)
+		{
+		case EBitmapCompositeOperation::Clear:				return &CompositeRange<F::Zero, F::Zero>;
+		case EBitmapCompositeOperation::Source:				return &CompositeRange<F::One, F::Zero>;
+		case EBitmapCompositeOperation::Destination:		return &CompositeRange<F::Zero, F::One>;
+		case EBitmapCompositeOperation::SourceOver:			return &CompositeRange<F::One, F::InvOtherAlpha>;
+		case EBitmapCompositeOperation::DestinationOver:	return &CompositeRange<F::InvOtherAlpha, F::One>;
+		case EBitmapCompositeOperation::SourceIn:			return &CompositeRange<F::OtherAlpha, F::Zero>;
+		case EBitmapCompositeOperation::DestinationIn:		return &CompositeRange<F::Zero, F::OtherAlpha>;
+		case EBitmapCompositeOperation::SourceOut:			return &CompositeRange<F::InvOtherAlpha, F::Zero>;
+		case EBitmapCompositeOperation::DestinationOut:		return &CompositeRange<F::Zero, F::InvOtherAlpha>;
+		case EBitmapCompositeOperation::SourceAtop:			return &CompositeRange<F::OtherAlpha, F::InvOtherAlpha>;
+		case EBitmapCompositeOperation::DestinationAtop:	return &CompositeRange<F::InvOtherAlpha, F::OtherAlpha>;
+		case EBitmapCompositeOperation::Xor:				return &CompositeRange<F::InvOtherAlpha, F::InvOtherAlpha>;
+		case EBitmapCompositeOperation::Plus:				return &CompositeRange<F::One, F::One>;
+		}
+
+		return &CompositeRange<F::One, F::InvOtherAlpha>;
+	}
+
+	void PremultiplyRange(const FColor* Src, FColor* Dst, int32 NumPixels)
+	{
+		int32 Index = 0;
+
+#if IMAGEIO_WITH_SSE2
+		const __m128i Zero = _mm_setzero_si128();
+
+		// Alpha gets multiplied by 255 which leaves it untouched
+		const __m128i AlphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+		for (; Index + 4 <= NumPixels; Index += 4)
+		{
+			const __m128i Pixels = _mm_loadu_si128((const __m128i*)(Src + Index));
+			const __m128i Low = _mm_unpacklo_epi8(Pixels, Zero);
+			const __m128i High = _mm_unpackhi_epi8(Pixels, Zero);
+
+			const __m128i LowResult = BitmapSimd::Mul255_Epi16(Low, _mm_or_si128(BitmapSimd::BroadcastAlpha_Epi16(Low), AlphaLanes));
+			const __m128i HighResult = BitmapSimd::Mul255_Epi16(High, _mm_or_si128(BitmapSimd::BroadcastAlpha_Epi16(High), AlphaLanes));
+
+			_mm_storeu_si128((__m128i*)(Dst + Index), _mm_packus_epi16(LowResult, HighResult));
+		}
+#endif
+
+		for (; Index < NumPixels; Index++)
+		{
+			const FColor Pixel = Src[Index];
+			Dst[Index] = FColor(BitmapSimd::Mul255(Pixel.R, Pixel.A), BitmapSimd::Mul255(Pixel.G, Pixel.A), BitmapSimd::Mul255(Pixel.B, Pixel.A), Pixel.A);
+		}
+	}
+
+	/* 16.16 fixed point 255/Alpha, so unpremultiplying is a multiply and a shift. */
+	struct FUnpremultiplyTable
+	{
+		uint32 Reciprocal[256];
+
+		FUnpremultiplyTable()
+		{
+			Reciprocal[0] = 0;
+			for (uint32 Alpha = 1; Alpha < 256; Alpha++)
+			{
+				Reciprocal[Alpha] = ((255u << 16) + Alpha / 2) / Alpha;
+			}
+		}
+	};
+
+	void UnpremultiplyRange(const FColor* Src, FColor* Dst, int32 NumPixels)
+	{
+		static const FUnpremultiplyTable Table;
+
+		for (int32 Index = 0; Index < NumPixels; Index++)
+		{
+			const FColor Pixel = Src[Index];
+			if (Pixel.A == 255)
+			{
+				Dst[Index] = Pixel;
+				continue;
+			}
+
+			const uint32 Reciprocal = Table.Reciprocal[Pixel.A];
+			Dst[Index] = FColor(
+				(uint8)FMath::Min<uint32>((Pixel.R * Reciprocal + 32768) >> 16, 255),
+				(uint8)FMath::Min<uint32>((Pixel.G * Reciprocal + 32768) >> 16, 255),
+				(uint8)FMath::Min<uint32>((Pixel.B * Reciprocal + 32768) >> 16, 255),
+				Pixel.A);
+		}
+	}
+}
+
+void FBitmapCompositing::Premultiply(const FColor* Src, FColor* Dst, int32 NumPixels)
+{
+	FBitmapParallel::ForRange(NumPixels, CompositeMinBatch, [&](int32 Start, int32 End)
+	{
+		PremultiplyRange(Src + Start, Dst + Start, End - Start);
+	});
+}
+
+void FBitmapCompositing::Unpremultiply(const FColor* Src, FColor* Dst, int32 NumPixels)
+{
+	FBitmapParallel::ForRange(NumPixels, CompositeMinBatch, [&](int32 Start, int32 End)
+	{
+		UnpremultiplyRange(Src + Start, Dst + Start, End - Start);
+	});
+}
+
+void FBitmapCompositing::Composite(EBitmapCompositeOperation Operation, const FColor* Source, const FColor* Destination, FColor* Out, int32 NumPixels)
+{
+	const FCompositeRangeFunction CompositeFunction = GetCompositeRangeFunction(Operation);
+
+	FBitmapParallel::ForRange(NumPixels, CompositeMinBatch, [&](int32 Start, int32 End)
+	{
+		CompositeFunction(Source + Start, Destination + Start, Out + Start, End - Start);
+	});
+}
+
+void FBitmapCompositing::CompositeStraight(EBitmapCompositeOperation Operation, FConstBitmapView Source, FBitmapView Destination)
+{
+	check(Source.Width == Destination.Width && Source.Height == Destination.Height);
+	if (Destination.Width <= 0)
+	{
+		return;
+	}
+
+	const FCompositeRangeFunction CompositeFunction = GetCompositeRangeFunction(Operation);
+	const int32 Width = Destination.Width;
+
+	FBitmapParallel::ForRange(Destination.Height, FMath::Max(CompositeMinBatch / Width, 1), [&](int32 StartRow, int32 EndRow)
+	{
+		TArray<FColor> SourceRow;
+		SourceRow.SetNumUninitialized(Width);
+
+		for (int32 Y = StartRow; Y < EndRow; Y++)
+		{
+			FColor* DestinationRow = Destination.GetRow(Y);
+			PremultiplyRange(Source.GetRow(Y), SourceRow.GetData(), Width);
+			PremultiplyRange(DestinationRow, DestinationRow, Width);
+			CompositeFunction(SourceRow.GetData(), DestinationRow, DestinationRow, Width);
+			UnpremultiplyRange(DestinationRow, DestinationRow, Width);
+		}
+	});
+}
@@ -0,0 +1,928 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapConvolution.h"
+#include "BitmapParallel.h"
+#include "BitmapChannels.h"
+#include "BitmapBorder.h"
+#include "BitmapSimd.h"
+#include "BitmapFFT.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/Crc.h"
+
+namespace
+{
+	// Lines filtered together by one iteration of a separable pass. Writing the transposed output for a band of lines at once
+	// means each output write is a contiguous run of BandSize values instead of a lone value.
+	const int32 SeparableBandSize = 8;
+
+	// Relative tolerance when checking a kernel is the product of a column and a row
+	const float SeparableTolerance = 1e-4f;
+
+	// Output tiles of the direct convolution. 64x64 pixels plus their apron stay in L2 along with the kernel.
+	const int32 ConvolutionTileSize = 64;
+
+	// Biggest sum of absolute integer taps the fixed point path takes: 255 times it has to fit in an int32 accumulator
+	const int32 MaxFixedPointWeightSum = MAX_int32 / 255;
+
+	// Smallest FFT block side. Blocks grow with the kernel so the overlap between tiles stays under a quarter of each block.
+	const int32 MinFFTBlockSize = 64;
+
+	// Kernel spectra kept around for filters applied to many bitmaps in a row
+	const int32 KernelSpectrumCacheSize = 8;
+
+	// Cost model, in multiply-adds of the float direct path per output pixel. Measured on x64, only the ratios matter. The separable
+	// passes run their taps along one padded line that stays in L1, so rank 1 kernels from 3x3 up are cheaper split than even through
+	// the fixed point path.
+	const float FixedPointTapCost = 0.3f;
+	const float SeparableTapCost = 0.4f;
+	const float FFTButterflyCost = 4.0f;
+
+	/* Copies a line into Padded with Before/After samples of border on each side. */
+	template<typename LoadSampleType>
+	FORCEINLINE void PadLine(VectorRegister* Padded, int32 Length, int32 Before, int32 After, EBitmapBorderMode BorderMode, VectorRegister BorderValue, const LoadSampleType& LoadSample)
+	{
+		for (int32 Index = -Before; Index < Length + After; Index++)
+		{
+			const int32 Resolved = BitmapBorder::ResolveIndex(Index, Length, BorderMode);
+			Padded[Index + Before] = Resolved == INDEX_NONE ? BorderValue : LoadSample(Resolved);
+		}
+	}
+
+	FORCEINLINE VectorRegister FilterSample(const VectorRegister* Padded, const float* Taps, int32 NumTaps)
+	{
+		VectorRegister Sum = VectorZero();
+		for (int32 Tap = 0; Tap < NumTaps; Tap++)
+		{
+			Sum = VectorMultiplyAdd(Padded[Tap], VectorLoadFloat1(&Taps[Tap]), Sum);
+		}
+		return Sum;
+	}
+
+	/* Horizontal pass: filters rows of Src and writes them as columns of Transposed (Transposed[X * Height + Y]). */
+	void FilterRowsTransposed(FConstBitmapView Src, const TArray<float>& Row, EBitmapBorderMode BorderMode, VectorRegister BorderValue, VectorRegister* Transposed)
+	{
+		const int32 Width = Src.Width;
+		const int32 Height = Src.Height;
+		const int32 NumTaps = Row.Num();
+		const int32 Before = NumTaps / 2;
+		const int32 After = NumTaps - 1 - Before;
+		const int32 NumBands = FMath::DivideAndRoundUp(Height, SeparableBandSize);
+
+		FBitmapParallel::ForRange(NumBands, 1, [&](int32 StartBand, int32 EndBand)
+		{
+			TArray<VectorRegister> Padded;
+			Padded.SetNumUninitialized((Width + NumTaps - 1) * SeparableBandSize);
+			const int32 PaddedLength = Width + NumTaps - 1;
+
+			for (int32 Band = StartBand; Band < EndBand; Band++)
+			{
+				const int32 FirstY = Band * SeparableBandSize;
+				const int32 NumLines = FMath::Min(SeparableBandSize, Height - FirstY);
+
+				for (int32 Line = 0; Line < NumLines; Line++)
+				{
+					const FColor* SrcRow = Src.GetRow(FirstY + Line);
+					PadLine(Padded.GetData() + Line * PaddedLength, Width, Before, After, BorderMode, BorderValue, [SrcRow](int32 X)
+					{
+						return VectorLoadByte4(&SrcRow[X]);
+					});
+				}
+
+				for (int32 X = 0; X < Width; X++)
+				{
+					VectorRegister* Out = Transposed + (int64)X * Height + FirstY;
+					for (int32 Line = 0; Line < NumLines; Line++)
+					{
+						Out[Line] = FilterSample(Padded.GetData() + Line * PaddedLength + X, Row.GetData(), NumTaps);
+					}
+				}
+			}
+		});
+	}
+
+	/* Vertical pass: filters rows of Transposed (columns of the image) and writes the finished pixels back in row order. */
+	void FilterColumnsToPixels(const VectorRegister* Transposed, const TArray<float>& Column, float Bias, EFilterColourChannel ColourChannel, EBitmapBorderMode BorderMode, VectorRegister BorderValue, FBitmapView Dst)
+	{
+		const int32 Width = Dst.Width;
+		const int32 Height = Dst.Height;
+		const int32 NumTaps = Column.Num();
+		const int32 Before = NumTaps / 2;
+		const int32 After = NumTaps - 1 - Before;
+		const int32 NumBands = FMath::DivideAndRoundUp(Width, SeparableBandSize);
+
+		// Bias is added once per pixel, plus a half for rounding when the float gets truncated back to a byte
+		const VectorRegister BiasAndRounding = VectorSetFloat1(Bias + 0.5f);
+
+		FBitmapParallel::ForRange(NumBands, 1, [&](int32 StartBand, int32 EndBand)
+		{
+			TArray<VectorRegister> Padded;
+			Padded.SetNumUninitialized((Height + NumTaps - 1) * SeparableBandSize);
+			const int32 PaddedLength = Height + NumTaps - 1;
+
+			for (int32 Band = StartBand; Band < EndBand; Band++)
+			{
+				const int32 FirstX = Band * SeparableBandSize;
+				const int32 NumLines = FMath::Min(SeparableBandSize, Width - FirstX);
+
+				for (int32 Line = 0; Line < NumLines; Line++)
+				{
+					const VectorRegister* SrcLine = Transposed + (int64)(FirstX + Line) * Height;
+					PadLine(Padded.GetData() + Line * PaddedLength, Height, Before, After, BorderMode, BorderValue, [SrcLine](int32 Y)
+					{
+						return SrcLine[Y];
+					});
+				}
+
+				for (int32 Y = 0; Y < Height; Y++)
+				{
+					FColor* Out = Dst.GetRow(Y) + FirstX;
+					for (int32 Line = 0; Line < NumLines; Line++)
+					{
+						const VectorRegister Sum = FilterSample(Padded.GetData() + Line * PaddedLength + Y, Column.GetData(), NumTaps);
+
+						FColor Pixel;
+						VectorStoreByte4(VectorAdd(Sum, BiasAndRounding), &Pixel);
+						Out[Line] = BitmapChannels::FinishFilteredPixel(Pixel, ColourChannel);
+					}
+				}
+			}
+		});
+	}
+
+	/* Everything the tile kernels need to know about the filter, prepared once per call. */
+	struct FConvolutionKernel
+	{
+		int32 Width;
+		int32 Height;
+		float Factor;
+		float Bias;
+
+		// Float path: one splatted weight per tap with the factor folded in
+		const VectorRegister* Weights;
+		VectorRegister BiasAndRounding;
+
+#if IMAGEIO_WITH_SSE2
+		// Fixed point path: int16 taps paired up for _mm_madd_epi16
+		const __m128i* TapPairs;
+#endif
+	};
+
+	typedef void (*FConvolveTileFunction)(const FColor* Src, int32 SrcPitch, FColor* Dst, int32 DstPitch, int32 TileWidth, int32 TileHeight, const FConvolutionKernel& Kernel);
+
+	/* Filters a tile of TileWidth x TileHeight pixels. Src points at the top left tap of the tile's first pixel and every tap
+	it reads is valid memory, so this loop has no border checks at all. FixedWidth and FixedHeight are the kernel size when
+	it's known at compile time so the tap loops unroll, 0 to read it from Kernel.
+	*/
+	template<int32 FixedWidth, int32 FixedHeight, EFilterColourChannel ColourChannel>
+	void ConvolveTile(const FColor* Src, int32 SrcPitch, FColor* Dst, int32 DstPitch, int32 TileWidth, int32 TileHeight, const FConvolutionKernel& Kernel)
+	{
+		const int32 KernelWidth = FixedWidth > 0 ? FixedWidth : Kernel.Width;
+		const int32 KernelHeight = FixedHeight > 0 ? FixedHeight : Kernel.Height;
+
+		for (int32 Y = 0; Y < TileHeight; Y++)
+		{
+			for (int32 X = 0; X < TileWidth; X++)
+			{
+				const FColor* Taps = Src + (int64)Y * SrcPitch + X;
+				const VectorRegister* Weight = Kernel.Weights;
+
+				VectorRegister Sum = Kernel.BiasAndRounding;
+				for (int32 KernelY = 0; KernelY < KernelHeight; KernelY++)
+				{
+					const FColor* TapRow = Taps + (int64)KernelY * SrcPitch;
+					for (int32 KernelX = 0; KernelX < KernelWidth; KernelX++)
+					{
+						Sum = VectorMultiplyAdd(VectorLoadByte4(&TapRow[KernelX]), *Weight++, Sum);
+					}
+				}
+
+				FColor Pixel;
+				VectorStoreByte4(Sum, &Pixel);
+				Dst[(int64)Y * DstPitch + X] = BitmapChannels::FinishFilteredPixel<ColourChannel>(Pixel);
+			}
+		}
+	}
+
+#if IMAGEIO_WITH_SSE2
+	/* Converts a kernel made of whole numbers (the usual sharpen, edge detection, emboss...) to the pairs of int16 taps
+	_mm_madd_epi16 takes: each register holds (Tap[X], Tap[X + 1]) 4 times, rows with an odd width end with (Tap, 0).
+	Returns false if any tap isn't a whole number or the sums could overflow.
+	*/
+	bool MakeFixedPointWeights(const FBitmapFilter& Filter, TArray<__m128i>& OutTapPairs)
+	{
+		const int32 KernelWidth = Filter.Size.X;
+		const int32 KernelHeight = Filter.Size.Y;
+
+		int64 WeightSum = 0;
+		for (float Tap : Filter.Filter)
+		{
+			if (Tap != FMath::RoundToFloat(Tap) || FMath::Abs(Tap) > MAX_int16)
+			{
+				return false;
+			}
+			WeightSum += FMath::Abs((int32)Tap);
+		}
+		if (WeightSum > MaxFixedPointWeightSum)
+		{
+			return false;
+		}
+
+		const int32 NumPairs = FMath::DivideAndRoundUp(KernelWidth, 2);
+		OutTapPairs.SetNumUninitialized(NumPairs * KernelHeight);
+		for (int32 KernelY = 0; KernelY < KernelHeight; KernelY++)
+		{
+			for (int32 Pair = 0; Pair < NumPairs; Pair++)
+			{
+				const int32 KernelX = Pair * 2;
+				const int16 First = (int16)Filter.Filter[KernelY * KernelWidth + KernelX];
+				const int16 Second = KernelX + 1 < KernelWidth ? (int16)Filter.Filter[KernelY * KernelWidth + KernelX + 1] : 0;
+				OutTapPairs[KernelY * NumPairs + Pair] = _mm_set1_epi32((int32)((uint32)(uint16)First | ((uint32)(uint16)Second << 16)));
+			}
+		}
+		return true;
+	}
+
+	/* Adds Tap * First + Next * Second to the B, G, R, A int32 lanes of Sum for one pixel (First and Second live in TapPair). */
+	FORCEINLINE __m128i AccumulateTapPair(__m128i Sum, __m128i Tap, __m128i Next, __m128i TapPair)
+	{
+		// B0 B1 G0 G1 R0 R1 A0 A1 as 16 bit lanes, which madd multiplies by the pair and sums two by two
+		const __m128i Interleaved = _mm_unpacklo_epi8(_mm_unpacklo_epi8(Tap, Next), _mm_setzero_si128());
+		return _mm_add_epi32(Sum, _mm_madd_epi16(Interleaved, TapPair));
+	}
+
+	/* Scales integer sums back to the filter's range, rounds and saturates them into the B, G, R, A bytes of 4 pixels. */
+	FORCEINLINE __m128i FinishFixedPointSums(__m128i Sum0, __m128i Sum1, __m128i Sum2, __m128i Sum3, __m128 Factor, __m128 BiasAndRounding)
+	{
+		// Clamping in float first keeps huge sums from turning into INT_MIN on conversion
+		const __m128 Max = _mm_set1_ps(255.0f);
+		const __m128i Pixel0 = _mm_cvttps_epi32(_mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(Sum0), Factor), BiasAndRounding), Max));
+		const __m128i Pixel1 = _mm_cvttps_epi32(_mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(Sum1), Factor), BiasAndRounding), Max));
+		const __m128i Pixel2 = _mm_cvttps_epi32(_mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(Sum2), Factor), BiasAndRounding), Max));
+		const __m128i Pixel3 = _mm_cvttps_epi32(_mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(Sum3), Factor), BiasAndRounding), Max));
+		return _mm_packus_epi16(_mm_packs_epi32(Pixel0, Pixel1), _mm_packs_epi32(Pixel2, Pixel3));
+	}
+
+	/* Fixed point version of ConvolveTile for integer kernels. Taps are exact int16 * uint8 products summed in int32, Factor and
+	Bias are applied once per pixel at the end. Four neighbouring output pixels are filtered together: the same two loads feed
+	a pair of taps to all four of them.
+	*/
+	template<int32 FixedWidth, int32 FixedHeight, EFilterColourChannel ColourChannel>
+	void ConvolveTileFixedPoint(const FColor* Src, int32 SrcPitch, FColor* Dst, int32 DstPitch, int32 TileWidth, int32 TileHeight, const FConvolutionKernel& Kernel)
+	{
+		typedef BitmapChannels::TChannelSelect<ColourChannel> FSelect;
+
+		const int32 KernelWidth = FixedWidth > 0 ? FixedWidth : Kernel.Width;
+		const int32 KernelHeight = FixedHeight > 0 ? FixedHeight : Kernel.Height;
+		const int32 LastPairX = KernelWidth & ~1;
+		const bool bOddWidth = (KernelWidth & 1) != 0;
+
+		const __m128 FactorVector = _mm_set1_ps(Kernel.Factor);
+		const __m128 BiasAndRounding = _mm_set1_ps(Kernel.Bias + 0.5f);
+		const __m128i KeepMask = _mm_set1_epi32((int32)FSelect::KeepMask);
+		const __m128i SetMask = _mm_set1_epi32((int32)FSelect::SetMask);
+		const __m128i Zero = _mm_setzero_si128();
+
+		for (int32 Y = 0; Y < TileHeight; Y++)
+		{
+			FColor* DstRow = Dst + (int64)Y * DstPitch;
+
+			int32 X = 0;
+			for (; X + 4 <= TileWidth; X += 4)
+			{
+				__m128i Sum0 = Zero;
+				__m128i Sum1 = Zero;
+				__m128i Sum2 = Zero;
+				__m128i Sum3 = Zero;
+				const __m128i* TapPair = Kernel.TapPairs;
+
+				for (int32 KernelY = 0; KernelY < KernelHeight; KernelY++)
+				{
+					const FColor* TapRow = Src + (int64)(Y + KernelY) * SrcPitch + X;
+					for (int32 KernelX = 0; KernelX < LastPairX; KernelX += 2)
+					{
+						// Taps KernelX and KernelX + 1 of the 4 output pixels
+						const __m128i Taps = _mm_loadu_si128((const __m128i*)(TapRow + KernelX));
+						const __m128i Next = _mm_loadu_si128((const __m128i*)(TapRow + KernelX + 1));
+						const __m128i Low = _mm_unpacklo_epi8(Taps, Next);
+						const __m128i High = _mm_unpackhi_epi8(Taps, Next);
+
+						Sum0 = _mm_add_epi32(Sum0, _mm_madd_epi16(_mm_unpacklo_epi8(Low, Zero), *TapPair));
+						Sum1 = _mm_add_epi32(Sum1, _mm_madd_epi16(_mm_unpackhi_epi8(Low, Zero), *TapPair));
+						Sum2 = _mm_add_epi32(Sum2, _mm_madd_epi16(_mm_unpacklo_epi8(High, Zero), *TapPair));
+						Sum3 = _mm_add_epi32(Sum3, _mm_madd_epi16(_mm_unpackhi_epi8(High, Zero), *TapPair));
+						TapPair++;
+					}
+					if (bOddWidth)
+					{
+						// The last tap is paired with zeros rather than reading a pixel that may be past the end of the source
+						const __m128i Taps = _mm_loadu_si128((const __m128i*)(TapRow + LastPairX));
+						const __m128i Low = _mm_unpacklo_epi8(Taps, Zero);
+						const __m128i High = _mm_unpackhi_epi8(Taps, Zero);
+
+						Sum0 = _mm_add_epi32(Sum0, _mm_madd_epi16(_mm_unpacklo_epi8(Low, Zero), *TapPair));
+						Sum1 = _mm_add_epi32(Sum1, _mm_madd_epi16(_mm_unpackhi_epi8(Low, Zero), *TapPair));
+						Sum2 = _mm_add_epi32(Sum2, _mm_madd_epi16(_mm_unpacklo_epi8(High, Zero), *TapPair));
+						Sum3 = _mm_add_epi32(Sum3, _mm_madd_epi16(_mm_unpackhi_epi8(High, Zero), *TapPair));
+						TapPair++;
+					}
+				}
+
+				const __m128i Pixels = FinishFixedPointSums(Sum0, Sum1, Sum2, Sum3, FactorVector, BiasAndRounding);
+				if (FSelect::bIsMask)
+				{
+					_mm_storeu_si128((__m128i*)(DstRow + X), _mm_or_si128(_mm_and_si128(Pixels, KeepMask), SetMask));
+				}
+				else
+				{
+					_mm_storeu_si128((__m128i*)(DstRow + X), Pixels);
+					for (int32 Index = X; Index < X + 4; Index++)
+					{
+						DstRow[Index] = BitmapChannels::FinishFilteredPixel<ColourChannel>(DstRow[Index]);
+					}
+				}
+			}
+
+			// Last few pixels of the row, one at a time
+			for (; X < TileWidth; X++)
+			{
+				__m128i Sum = Zero;
+				const __m128i* TapPair = Kernel.TapPairs;
+
+				for (int32 KernelY = 0; KernelY < KernelHeight; KernelY++)
+				{
+					const FColor* TapRow = Src + (int64)(Y + KernelY) * SrcPitch + X;
+					for (int32 KernelX = 0; KernelX < LastPairX; KernelX += 2)
+					{
+						Sum = AccumulateTapPair(Sum, _mm_cvtsi32_si128((int32)TapRow[KernelX].DWColor()), _mm_cvtsi32_si128((int32)TapRow[KernelX + 1].DWColor()), *TapPair++);
+					}
+					if (bOddWidth)
+					{
+						Sum = AccumulateTapPair(Sum, _mm_cvtsi32_si128((int32)TapRow[LastPairX].DWColor()), Zero, *TapPair++);
+					}
+				}
+
+				FColor Pixel;
+				Pixel.DWColor() = (uint32)_mm_cvtsi128_si32(FinishFixedPointSums(Sum, Zero, Zero, Zero, FactorVector, BiasAndRounding));
+				DstRow[X] = BitmapChannels::FinishFilteredPixel<ColourChannel>(Pixel);
+			}
+		}
+	}
+#endif
+
+	/* Picks the tile kernel for a filter: the common 3x3, 5x5 and 7x7 sizes get fully unrolled versions, the rest share a
+	runtime sized one. Every version is specialised on the colour channel.
+	*/
+	template<EFilterColourChannel ColourChannel>
+	FConvolveTileFunction SelectConvolveTileForChannel(int32 KernelWidth, int32 KernelHeight, bool bFixedPoint)
+	{
+#if IMAGEIO_WITH_SSE2
+		if (bFixedPoint)
+		{
+			switch (KernelWidth == KernelHeight ? KernelWidth : 0)
+			{
+			case 3:		return &ConvolveTileFixedPoint<3, 3, ColourChannel>;
+			case 5:		return &ConvolveTileFixedPoint<5, 5, ColourChannel>;
+			case 7:		return &ConvolveTileFixedPoint<7, 7, ColourChannel>;
+			default:	return &ConvolveTileFixedPoint<0, 0, ColourChannel>;
+			}
+		}
+#endif
+		switch (KernelWidth == KernelHeight ? KernelWidth : 0)
+		{
+		case 3:		return &ConvolveTile<3, 3, ColourChannel>;
+		case 5:		return &ConvolveTile<5, 5, ColourChannel>;
+		case 7:		return &ConvolveTile<7, 7, ColourChannel>;
+		default:	return &ConvolveTile<0, 0, ColourChannel>;
+		}
+	}
+
+	FConvolveTileFunction SelectConvolveTile(int32 KernelWidth, int32 KernelHeight, EFilterColourChannel ColourChannel, bool bFixedPoint)
+	{
+		switch (ColourChannel)
+		{
+		case EFilterColourChannel::RGB:			return SelectConvolveTileForChannel<EFilterColourChannel::RGB>(KernelWidth, KernelHeight, bFixedPoint);
+		case EFilterColourChannel::R:			return SelectConvolveTileForChannel<EFilterColourChannel::R>(KernelWidth, KernelHeight, bFixedPoint);
+		case EFilterColourChannel::G:			return SelectConvolveTileForChannel<EFilterColourChannel::G>(KernelWidth, KernelHeight, bFixedPoint);
+		case EFilterColourChannel::B:			return SelectConvolveTileForChannel<EFilterColourChannel::B>(KernelWidth, KernelHeight, bFixedPoint);
+		case EFilterColourChannel::A:			return SelectConvolveTileForChannel<EFilterColourChannel::A>(KernelWidth, KernelHeight, bFixedPoint);
+		case EFilterColourChannel::Greyscale:	return SelectConvolveTileForChannel<EFilterColourChannel::Greyscale>(KernelWidth, KernelHeight, bFixedPoint);
+		default:								return SelectConvolveTileForChannel<EFilterColourChannel::RGBA>(KernelWidth, KernelHeight, bFixedPoint);
+		}
+	}
+
+	/* FFT side covering a kernel of KernelLength taps: big enough that most of each block is output, no bigger than the whole line. */
+	int32 GetFFTBlockSize(int32 KernelLength, int32 ImageLength)
+	{
+		const int32 Preferred = FMath::RoundUpToPowerOfTwo(FMath::Max(MinFFTBlockSize, 4 * (KernelLength - 1)));
+		const int32 WholeLine = FMath::RoundUpToPowerOfTwo(ImageLength + KernelLength - 1);
+		return FMath::Min(Preferred, WholeLine);
+	}
+
+	/* Spectrum of a kernel laid out for one FFT block size, with the factor and the inverse transform's 1 / N folded in. */
+	struct FKernelSpectrum
+	{
+		uint32 KernelHash;
+		TArray<float> Kernel;
+		FImageSize KernelSize;
+		float Factor;
+		int32 BlockWidth;
+		int32 BlockHeight;
+		TArray<float> Spectrum;
+	};
+
+	typedef TSharedPtr<const FKernelSpectrum, ESPMode::ThreadSafe> FKernelSpectrumPtr;
+
+	// Most recently used first
+	FCriticalSection KernelSpectrumCacheLock;
+	TArray<FKernelSpectrumPtr> KernelSpectrumCache;
+
+	FKernelSpectrumPtr MakeKernelSpectrum(const FBitmapFilter& Filter, uint32 KernelHash, int32 BlockWidth, int32 BlockHeight)
+	{
+		TSharedPtr<FKernelSpectrum, ESPMode::ThreadSafe> Result = MakeShared<FKernelSpectrum, ESPMode::ThreadSafe>();
+		Result->KernelHash = KernelHash;
+		Result->Kernel = Filter.Filter;
+		Result->KernelSize = Filter.Size;
+		Result->Factor = Filter.Factor;
+		Result->BlockWidth = BlockWidth;
+		Result->BlockHeight = BlockHeight;
+
+		// ApplyBitmapFilter correlates, i.e. convolves with the mirrored kernel: tap (X, Y) goes to (-X, -Y) wrapped around the block.
+		// Each output pixel then sums the block pixels at its own position and the KernelSize - 1 after it.
+		const float Scale = Filter.Factor / ((float)BlockWidth * BlockHeight);
+		TArray<float>& Spectrum = Result->Spectrum;
+		Spectrum.SetNumZeroed(2 * BlockWidth * BlockHeight);
+		for (int32 KernelY = 0; KernelY < Filter.Size.Y; KernelY++)
+		{
+			for (int32 KernelX = 0; KernelX < Filter.Size.X; KernelX++)
+			{
+				const int32 X = (BlockWidth - KernelX) % BlockWidth;
+				const int32 Y = (BlockHeight - KernelY) % BlockHeight;
+				Spectrum[2 * (Y * BlockWidth + X)] = Filter.Filter[KernelY * Filter.Size.X + KernelX] * Scale;
+			}
+		}
+
+		const FBitmapFFT& RowFFT = FBitmapFFT::Get(BlockWidth);
+		const FBitmapFFT& ColumnFFT = FBitmapFFT::Get(BlockHeight);
+		TArray<float> Scratch;
+		Scratch.SetNumUninitialized(2 * BlockHeight * FBitmapFFT::ColumnBatch);
+		for (int32 Y = 0; Y < BlockHeight; Y++)
+		{
+			RowFFT.Forward(Spectrum.GetData() + 2 * Y * BlockWidth);
+		}
+		ColumnFFT.TransformColumns(Spectrum.GetData(), BlockWidth, BlockWidth, false, Scratch.GetData());
+
+		return Result;
+	}
+
+	/* Spectrum of the filter for this block size, from the cache when the same filter was used recently. */
+	FKernelSpectrumPtr FindOrMakeKernelSpectrum(const FBitmapFilter& Filter, int32 BlockWidth, int32 BlockHeight)
+	{
+		const uint32 KernelHash = FCrc::MemCrc32(Filter.Filter.GetData(), Filter.Filter.Num() * sizeof(float));
+		{
+			FScopeLock Lock(&KernelSpectrumCacheLock);
+			for (int32 Index = 0; Index < KernelSpectrumCache.Num(); Index++)
+			{
+				const FKernelSpectrum& Cached = *KernelSpectrumCache[Index];
+				if (Cached.KernelHash == KernelHash && Cached.BlockWidth == BlockWidth && Cached.BlockHeight == BlockHeight && Cached.Factor == Filter.Factor
+					&& Cached.KernelSize.X == Filter.Size.X && Cached.KernelSize.Y == Filter.Size.Y && Cached.Kernel == Filter.Filter)
+				{
+					FKernelSpectrumPtr Found = KernelSpectrumCache[Index];
+					KernelSpectrumCache.RemoveAt(Index, 1, false);
+					KernelSpectrumCache.Insert(Found, 0);
+					return Found;
+				}
+			}
+		}
+
+		// Built outside the lock, two threads racing on the same new filter just both build it
+		FKernelSpectrumPtr Spectrum = MakeKernelSpectrum(Filter, KernelHash, BlockWidth, BlockHeight);
+
+		FScopeLock Lock(&KernelSpectrumCacheLock);
+		KernelSpectrumCache.Insert(Spectrum, 0);
+		if (KernelSpectrumCache.Num() > KernelSpectrumCacheSize)
+		{
+			KernelSpectrumCache.SetNum(KernelSpectrumCacheSize);
+		}
+		return Spectrum;
+	}
+
+	/* Direct, separable and FFT costs per output pixel, in float multiply-adds. */
+	float EstimateDirectCost(const FBitmapFilter& Filter)
+	{
+		float TapCost = 1.0f;
+#if IMAGEIO_WITH_SSE2
+		TArray<__m128i> TapPairs;
+		if (MakeFixedPointWeights(Filter, TapPairs))
+		{
+			TapCost = FixedPointTapCost;
+		}
+#endif
+		return Filter.Size.X * Filter.Size.Y * TapCost;
+	}
+
+	float EstimateSeparableCost(const FBitmapFilter& Filter)
+	{
+		return (Filter.Size.X + Filter.Size.Y) * SeparableTapCost;
+	}
+
+	float EstimateFFTCost(FImageSize Size, const FBitmapFilter& Filter)
+	{
+		const int32 BlockWidth = GetFFTBlockSize(Filter.Size.X, Size.X);
+		const int32 BlockHeight = GetFFTBlockSize(Filter.Size.Y, Size.Y);
+		if (BlockWidth > FBitmapFFT::MaxSize || BlockHeight > FBitmapFFT::MaxSize)
+		{
+			return MAX_flt;
+		}
+
+		const int32 TileWidth = FMath::Min(BlockWidth - Filter.Size.X + 1, Size.X);
+		const int32 TileHeight = FMath::Min(BlockHeight - Filter.Size.Y + 1, Size.Y);
+
+		// Two complex blocks (B + iG, R + iA), each transformed forward and back along both axes
+		const float Butterflies = 2.0f * 2.0f * BlockWidth * BlockHeight * 0.5f * (FMath::FloorLog2(BlockWidth) + FMath::FloorLog2(BlockHeight));
+		return Butterflies * FFTButterflyCost / ((float)TileWidth * TileHeight);
+	}
+}
+
+EBitmapConvolutionMethod FBitmapConvolution::ChooseMethod(FImageSize Size, const FBitmapFilter& Filter, bool bSeparable)
+{
+	const float DirectCost = EstimateDirectCost(Filter);
+	const float SeparableCost = bSeparable ? EstimateSeparableCost(Filter) : MAX_flt;
+	const float FFTCost = EstimateFFTCost(Size, Filter);
+
+	if (SeparableCost <= DirectCost && SeparableCost <= FFTCost)
+	{
+		return EBitmapConvolutionMethod::Separable;
+	}
+	return FFTCost < DirectCost ? EBitmapConvolutionMethod::FFT : EBitmapConvolutionMethod::Direct;
+}
+
+void FBitmapConvolution::Apply(FConstBitmapView Src, const FBitmapFilter& Filter, FBitmapView Dst)
+{
+	// Rank 1 kernels (box blur, gaussians) can run as a horizontal then a vertical pass, big ones are cheaper through FFTs
+	TArray<float> RowFilter;
+	TArray<float> ColumnFilter;
+	const bool bSeparable = FindSeparableFactors(Filter, RowFilter, ColumnFilter);
+
+	switch (ChooseMethod(Src.GetSize(), Filter, bSeparable))
+	{
+	case EBitmapConvolutionMethod::Separable:
+	{
+		FSeparableBitmapFilter SeparableFilter(RowFilter, ColumnFilter, Filter.Factor, Filter.Bias, Filter.ColourChannel);
+		SeparableFilter.BorderMode = Filter.BorderMode;
+		SeparableFilter.BorderColour = Filter.BorderColour;
+
+		ConvolveSeparable(Src, SeparableFilter, Dst);
+		break;
+	}
+
+	case EBitmapConvolutionMethod::FFT:
+		ConvolveFFT(Src, Filter, Dst);
+		break;
+
+	default:
+		Convolve(Src, Filter, Dst);
+		break;
+	}
+
+	// Every method filters all four channels for RGBA, put the source alpha back unless the filter asks for it
+	if (Filter.ColourChannel == EFilterColourChannel::RGBA && !Filter.FilterAlpha)
+	{
+		for (int32 Y = 0; Y < Src.Height; Y++)
+		{
+			const FColor* SrcRow = Src.GetRow(Y);
+			FColor* DstRow = Dst.GetRow(Y);
+			for (int32 X = 0; X < Src.Width; X++)
+			{
+				DstRow[X].A = SrcRow[X].A;
+			}
+		}
+	}
+}
+
+void FBitmapConvolution::Convolve(FConstBitmapView Src, const FBitmapFilter& Filter, FBitmapView Dst)
+{
+	const int32 Width = Src.Width;
+	const int32 Height = Src.Height;
+	const int32 KernelWidth = Filter.Size.X;
+	const int32 KernelHeight = Filter.Size.Y;
+
+	if (Width <= 0 || Height <= 0 || KernelWidth <= 0 || KernelHeight <= 0 || Filter.Filter.Num() != KernelWidth * KernelHeight)
+	{
+		return;
+	}
+
+	// Integer kernels accumulate exactly in int32, anything else in float with the factor folded into the weights. Either way the
+	// bias is added once per pixel, plus a half for rounding (both end by truncating and saturating to bytes).
+	FConvolutionKernel Kernel;
+	Kernel.Width = KernelWidth;
+	Kernel.Height = KernelHeight;
+	Kernel.Factor = Filter.Factor;
+	Kernel.Bias = Filter.Bias;
+	Kernel.BiasAndRounding = VectorSetFloat1(Filter.Bias + 0.5f);
+
+	TArray<VectorRegister> Weights;
+#if IMAGEIO_WITH_SSE2
+	TArray<__m128i> TapPairs;
+	const bool bFixedPoint = MakeFixedPointWeights(Filter, TapPairs);
+	Kernel.TapPairs = TapPairs.GetData();
+#else
+	const bool bFixedPoint = false;
+#endif
+
+	if (!bFixedPoint)
+	{
+		Weights.SetNumUninitialized(Filter.Filter.Num());
+		for (int32 Index = 0; Index < Filter.Filter.Num(); Index++)
+		{
+			Weights[Index] = VectorSetFloat1(Filter.Filter[Index] * Filter.Factor);
+		}
+	}
+	Kernel.Weights = Weights.GetData();
+
+	const FConvolveTileFunction ConvolveTileFunction = SelectConvolveTile(KernelWidth, KernelHeight, Filter.ColourChannel, bFixedPoint);
+
+	// Taps before and after the pixel being filtered
+	const int32 BeforeX = KernelWidth / 2;
+	const int32 BeforeY = KernelHeight / 2;
+	const int32 AfterX = KernelWidth - 1 - BeforeX;
+	const int32 AfterY = KernelHeight - 1 - BeforeY;
+
+	const int32 NumTilesX = FMath::DivideAndRoundUp(Width, ConvolutionTileSize);
+	const int32 NumTilesY = FMath::DivideAndRoundUp(Height, ConvolutionTileSize);
+
+	FBitmapParallel::ForRange(NumTilesX * NumTilesY, 1, [&](int32 StartTile, int32 EndTile)
+	{
+		// Edge tiles are copied here with their apron, borders resolved, then filtered with the same branch-free loop
+		const int32 PaddedPitch = ConvolutionTileSize + KernelWidth - 1;
+		TArray<FColor> PaddedTile;
+		TArray<int32> SourceColumns;
+
+		for (int32 Tile = StartTile; Tile < EndTile; Tile++)
+		{
+			const int32 TileX = (Tile % NumTilesX) * ConvolutionTileSize;
+			const int32 TileY = (Tile / NumTilesX) * ConvolutionTileSize;
+			const int32 TileWidth = FMath::Min(ConvolutionTileSize, Width - TileX);
+			const int32 TileHeight = FMath::Min(ConvolutionTileSize, Height - TileY);
+			FColor* TileDst = Dst.GetRow(TileY) + TileX;
+
+			const bool bInterior = TileX - BeforeX >= 0 && TileY - BeforeY >= 0 && TileX + TileWidth - 1 + AfterX < Width && TileY + TileHeight - 1 + AfterY < Height;
+			if (bInterior)
+			{
+				const FColor* TileSrc = Src.GetRow(TileY - BeforeY) + (TileX - BeforeX);
+				ConvolveTileFunction(TileSrc, Src.Pitch, TileDst, Dst.Pitch, TileWidth, TileHeight, Kernel);
+				continue;
+			}
+
+			const int32 PaddedWidth = TileWidth + KernelWidth - 1;
+			const int32 PaddedHeight = TileHeight + KernelHeight - 1;
+			PaddedTile.SetNumUninitialized(PaddedPitch * (ConvolutionTileSize + KernelHeight - 1), false);
+			SourceColumns.SetNumUninitialized(PaddedWidth, false);
+
+			for (int32 PaddedX = 0; PaddedX < PaddedWidth; PaddedX++)
+			{
+				SourceColumns[PaddedX] = BitmapBorder::ResolveIndex(TileX - BeforeX + PaddedX, Width, Filter.BorderMode);
+			}
+
+			for (int32 PaddedY = 0; PaddedY < PaddedHeight; PaddedY++)
+			{
+				FColor* PaddedRow = PaddedTile.GetData() + PaddedY * PaddedPitch;
+				const int32 SourceY = BitmapBorder::ResolveIndex(TileY - BeforeY + PaddedY, Height, Filter.BorderMode);
+				if (SourceY == INDEX_NONE)
+				{
+					for (int32 PaddedX = 0; PaddedX < PaddedWidth; PaddedX++)
+					{
+						PaddedRow[PaddedX] = Filter.BorderColour;
+					}
+					continue;
+				}
+
+				const FColor* SourceRow = Src.GetRow(SourceY);
+				for (int32 PaddedX = 0; PaddedX < PaddedWidth; PaddedX++)
+				{
+					PaddedRow[PaddedX] = SourceColumns[PaddedX] == INDEX_NONE ? Filter.BorderColour : SourceRow[SourceColumns[PaddedX]];
+				}
+			}
+
+			ConvolveTileFunction(PaddedTile.GetData(), PaddedPitch, TileDst, Dst.Pitch, TileWidth, TileHeight, Kernel);
+		}
+	});
+}
+
+void FBitmapConvolution::ConvolveFFT(FConstBitmapView Src, const FBitmapFilter& Filter, FBitmapView Dst)
+{
+	const int32 Width = Src.Width;
+	const int32 Height = Src.Height;
+	const int32 KernelWidth = Filter.Size.X;
+	const int32 KernelHeight = Filter.Size.Y;
+
+	if (Width <= 0 || Height <= 0 || KernelWidth <= 0 || KernelHeight <= 0 || Filter.Filter.Num() != KernelWidth * KernelHeight)
+	{
+		return;
+	}
+
+	// Each tile of output is computed from one block of input: the tile plus its apron. Tiles are independent (an overlap-save
+	// scheme), so they spread across threads like the direct path's tiles and the border mode is applied while gathering blocks.
+	const int32 BlockWidth = GetFFTBlockSize(KernelWidth, Width);
+	const int32 BlockHeight = GetFFTBlockSize(KernelHeight, Height);
+	if (BlockWidth > FBitmapFFT::MaxSize || BlockHeight > FBitmapFFT::MaxSize)
+	{
+		// Kernels over a quarter of the biggest FFT on a side, on bitmaps as big: there is no plan for such blocks
+		Convolve(Src, Filter, Dst);
+		return;
+	}
+
+	const int32 TileWidth = BlockWidth - KernelWidth + 1;
+	const int32 TileHeight = BlockHeight - KernelHeight + 1;
+	const int32 BeforeX = KernelWidth / 2;
+	const int32 BeforeY = KernelHeight / 2;
+
+	const FKernelSpectrumPtr KernelSpectrum = FindOrMakeKernelSpectrum(Filter, BlockWidth, BlockHeight);
+	const float* Spectrum = KernelSpectrum->Spectrum.GetData();
+	const FBitmapFFT& RowFFT = FBitmapFFT::Get(BlockWidth);
+	const FBitmapFFT& ColumnFFT = FBitmapFFT::Get(BlockHeight);
+
+	const int32 NumTilesX = FMath::DivideAndRoundUp(Width, TileWidth);
+	const int32 NumTilesY = FMath::DivideAndRoundUp(Height, TileHeight);
+	const int32 BlockFloats = 2 * BlockWidth * BlockHeight;
+	const float BiasAndRounding = Filter.Bias + 0.5f;
+
+	FBitmapParallel::ForRange(NumTilesX * NumTilesY, 1, [&](int32 StartTile, int32 EndTile)
+	{
+		// The kernel is real, so two channels go through each complex transform: B + iG and R + iA
+		TArray<float> Blocks;
+		TArray<float> Scratch;
+		TArray<int32> SourceColumns;
+		Blocks.SetNumUninitialized(2 * BlockFloats);
+		Scratch.SetNumUninitialized(2 * BlockHeight * FBitmapFFT::ColumnBatch);
+		SourceColumns.SetNumUninitialized(BlockWidth);
+		float* BlueGreen = Blocks.GetData();
+		float* RedAlpha = Blocks.GetData() + BlockFloats;
+
+		for (int32 Tile = StartTile; Tile < EndTile; Tile++)
+		{
+			const int32 TileX = (Tile % NumTilesX) * TileWidth;
+			const int32 TileY = (Tile / NumTilesX) * TileHeight;
+			const int32 OutWidth = FMath::Min(TileWidth, Width - TileX);
+			const int32 OutHeight = FMath::Min(TileHeight, Height - TileY);
+
+			for (int32 X = 0; X < BlockWidth; X++)
+			{
+				SourceColumns[X] = BitmapBorder::ResolveIndex(TileX - BeforeX + X, Width, Filter.BorderMode);
+			}
+
+			for (int32 Y = 0; Y < BlockHeight; Y++)
+			{
+				const int32 SourceY = BitmapBorder::ResolveIndex(TileY - BeforeY + Y, Height, Filter.BorderMode);
+				const FColor* SourceRow = SourceY == INDEX_NONE ? nullptr : Src.GetRow(SourceY);
+				float* BlueGreenRow = BlueGreen + 2 * Y * BlockWidth;
+				float* RedAlphaRow = RedAlpha + 2 * Y * BlockWidth;
+
+				for (int32 X = 0; X < BlockWidth; X++)
+				{
+					const FColor Pixel = SourceY == INDEX_NONE || SourceColumns[X] == INDEX_NONE ? Filter.BorderColour : SourceRow[SourceColumns[X]];
+					BlueGreenRow[2 * X] = Pixel.B;
+					BlueGreenRow[2 * X + 1] = Pixel.G;
+					RedAlphaRow[2 * X] = Pixel.R;
+					RedAlphaRow[2 * X + 1] = Pixel.A;
+				}
+
+				RowFFT.Forward(BlueGreenRow);
+				RowFFT.Forward(RedAlphaRow);
+			}
+
+			ColumnFFT.TransformColumns(BlueGreen, BlockWidth, BlockWidth, false, Scratch.GetData());
+			ColumnFFT.TransformColumns(RedAlpha, BlockWidth, BlockWidth, false, Scratch.GetData());
+
+			for (int32 Index = 0; Index < BlockFloats; Index += 2)
+			{
+				const float KernelRe = Spectrum[Index];
+				const float KernelIm = Spectrum[Index + 1];
+
+				const float BlueGreenRe = BlueGreen[Index];
+				BlueGreen[Index] = BlueGreenRe * KernelRe - BlueGreen[Index + 1] * KernelIm;
+				BlueGreen[Index + 1] = BlueGreenRe * KernelIm + BlueGreen[Index + 1] * KernelRe;
+
+				const float RedAlphaRe = RedAlpha[Index];
+				RedAlpha[Index] = RedAlphaRe * KernelRe - RedAlpha[Index + 1] * KernelIm;
+				RedAlpha[Index + 1] = RedAlphaRe * KernelIm + RedAlpha[Index + 1] * KernelRe;
+			}
+
+			ColumnFFT.TransformColumns(BlueGreen, BlockWidth, BlockWidth, true, Scratch.GetData());
+			ColumnFFT.TransformColumns(RedAlpha, BlockWidth, BlockWidth, true, Scratch.GetData());
+
+			// Only the rows holding output need the last inverse pass
+			for (int32 Y = 0; Y < OutHeight; Y++)
+			{
+				float* BlueGreenRow = BlueGreen + 2 * Y * BlockWidth;
+				float* RedAlphaRow = RedAlpha + 2 * Y * BlockWidth;
+				RowFFT.Inverse(BlueGreenRow);
+				RowFFT.Inverse(RedAlphaRow);
+
+				FColor* DstRow = Dst.GetRow(TileY + Y) + TileX;
+				for (int32 X = 0; X < OutWidth; X++)
+				{
+					FColor Pixel;
+					Pixel.B = (uint8)FMath::Clamp(FMath::FloorToInt(BlueGreenRow[2 * X] + BiasAndRounding), 0, 255);
+					Pixel.G = (uint8)FMath::Clamp(FMath::FloorToInt(BlueGreenRow[2 * X + 1] + BiasAndRounding), 0, 255);
+					Pixel.R = (uint8)FMath::Clamp(FMath::FloorToInt(RedAlphaRow[2 * X] + BiasAndRounding), 0, 255);
+					Pixel.A = (uint8)FMath::Clamp(FMath::FloorToInt(RedAlphaRow[2 * X + 1] + BiasAndRounding), 0, 255);
+					DstRow[X] = BitmapChannels::FinishFilteredPixel(Pixel, Filter.ColourChannel);
+				}
+			}
+		}
+	});
+}
+
+bool FBitmapConvolution::FindSeparableFactors(const FBitmapFilter& Filter, TArray<float>& OutRow, TArray<float>& OutColumn)
+{
+	const int32 Width = Filter.Size.X;
+	const int32 Height = Filter.Size.Y;
+	const TArray<float>& Kernel = Filter.Filter;
+
+	// A single row or column is already 1D, there's nothing to gain
+	if (Width < 2 || Height < 2 || Kernel.Num() != Width * Height)
+	{
+		return false;
+	}
+
+	// Use the biggest value as the pivot, it's the most stable one to divide by
+	int32 PivotIndex = 0;
+	for (int32 Index = 1; Index < Kernel.Num(); Index++)
+	{
+		if (FMath::Abs(Kernel[Index]) > FMath::Abs(Kernel[PivotIndex]))
+		{
+			PivotIndex = Index;
+		}
+	}
+
+	const float Pivot = Kernel[PivotIndex];
+	if (Pivot == 0.0f)
+	{
+		return false;
+	}
+
+	const int32 PivotX = PivotIndex % Width;
+	const int32 PivotY = PivotIndex / Width;
+
+	// If the kernel is rank 1, every row is a multiple of the pivot's row and the pivot's column holds the multiples
+	TArray<float> Row;
+	TArray<float> Column;
+	Row.SetNumUninitialized(Width);
+	Column.SetNumUninitialized(Height);
+
+	for (int32 X = 0; X < Width; X++)
+	{
+		Row[X] = Kernel[PivotY * Width + X];
+	}
+	for (int32 Y = 0; Y < Height; Y++)
+	{
+		Column[Y] = Kernel[Y * Width + PivotX] / Pivot;
+	}
+
+	const float Tolerance = FMath::Abs(Pivot) * SeparableTolerance;
+	for (int32 Y = 0; Y < Height; Y++)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			if (FMath::Abs(Column[Y] * Row[X] - Kernel[Y * Width + X]) > Tolerance)
+			{
+				return false;
+			}
+		}
+	}
+
+	OutRow = MoveTemp(Row);
+	OutColumn = MoveTemp(Column);
+	return true;
+}
+
+void FBitmapConvolution::ConvolveSeparable(FConstBitmapView Src, const FSeparableBitmapFilter& Filter, FBitmapView Dst)
+{
+	if (Src.Width <= 0 || Src.Height <= 0 || Filter.RowFilter.Num() == 0 || Filter.ColumnFilter.Num() == 0)
+	{
+		return;
+	}
+
+	// Fold the factor into the vertical taps so it costs nothing per pixel
+	TArray<float> ScaledColumn = Filter.ColumnFilter;
+	float RowSum = 0.0f;
+	for (float& Tap : ScaledColumn)
+	{
+		Tap *= Filter.Factor;
+	}
+	for (float Tap : Filter.RowFilter)
+	{
+		RowSum += Tap;
+	}
+
+	// Past the top and bottom edges, the vertical pass reads the constant border as the horizontal pass would have filtered it
+	const VectorRegister BorderValue = VectorLoadByte4(&Filter.BorderColour);
+	const VectorRegister FilteredBorderValue = VectorMultiply(BorderValue, VectorSetFloat1(RowSum));
+
+	TArray<VectorRegister> Transposed;
+	Transposed.SetNumUninitialized(Src.Width * Src.Height);
+
+	FilterRowsTransposed(Src, Filter.RowFilter, Filter.BorderMode, BorderValue, Transposed.GetData());
+	FilterColumnsToPixels(Transposed.GetData(), ScaledColumn, Filter.Bias, Filter.ColourChannel, Filter.BorderMode, FilteredBorderValue, Dst);
+}
@@ -0,0 +1,357 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapDecodeBudget.h"
+#include "BitmapJobContext.h"
+#include "BitmapJobScheduler.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Event.h"
+
+static TAutoConsoleVariable<int32> CVarImageIODecodeMemoryBudget(
+	TEXT("ImageIO.DecodeMemoryBudget"),
+	1024,
+	TEXT("Megabytes the ImageIOLibrary image decodes running at the same time may hold. Decode jobs stay queued past it, 0 disables the cap."),
+	ECVF_Default);
+
+namespace
+{
+	FCriticalSection DecodeBudgetLock;
+	int64 DecodeBudgetUsedBytes = 0;
+	int64 DecodeBudgetPeakBytes = 0;
+	int32 DecodeBudgetNumReserved = 0;
+	int32 DecodeBudgetNumWaiting = 0;
+
+	// One event per thread waiting in Reserve, triggered by the next release. Added under the lock the thread checked the budget with, so
+	// no release between the check and the wait goes unnoticed.
+	TArray<FEvent*> DecodeBudgetWaiters;
+
+	/* Whether Bytes more fit in the budget. Call with DecodeBudgetLock held. */
+	bool DecodeBytesFit(int64 Bytes)
+	{
+		const int64 BudgetBytes = (int64)FMath::Max(CVarImageIODecodeMemoryBudget.GetValueOnAnyThread(), 0) * 1024 * 1024;
+		return BudgetBytes == 0 || DecodeBudgetUsedBytes == 0 || DecodeBudgetUsedBytes + Bytes <= BudgetBytes;
+	}
+
+	/* Call with DecodeBudgetLock held. */
+	void AddDecodeBytes(int64 Bytes)
+	{
+		DecodeBudgetUsedBytes += Bytes;
+		DecodeBudgetPeakBytes = FMath::Max(DecodeBudgetPeakBytes, DecodeBudgetUsedBytes);
+		DecodeBudgetNumReserved++;
+	}
+
+	/* Reads Num bytes at Offset, false past the end of the file. */
+	bool ReadHeaderBytes(FArchive& Reader, int64 Offset, uint8* Dst, int32 Num)
+	{
+		if (Offset < 0 || Offset + Num > Reader.TotalSize())
+		{
+			return false;
+		}
+		Reader.Seek(Offset);
+		Reader.Serialize(Dst, Num);
+		return !Reader.IsError();
+	}
+
+	uint32 ReadBigEndian32(const uint8* Bytes)
+	{
+		return ((uint32)Bytes[0] << 24) | ((uint32)Bytes[1] << 16) | ((uint32)Bytes[2] << 8) | Bytes[3];
+	}
+
+	int32 ReadLittleEndian32(const uint8* Bytes)
+	{
+		return (int32)(((uint32)Bytes[3] << 24) | ((uint32)Bytes[2] << 16) | ((uint32)Bytes[1] << 8) | Bytes[0]);
+	}
+
+	/* Walks the segments of a JPEG file up to its frame header, which holds the size. */
+	bool ProbeJpeg(FArchive& Reader, FImageSize& OutSize)
+	{
+		// Past that many segments the file is more likely broken than full of metadata
+		const int32 MaxSegments = 1024;
+
+		int64 Offset = 2;
+		uint8 Segment[4];
+		for (int32 SegmentIndex = 0; SegmentIndex < MaxSegments && ReadHeaderBytes(Reader, Offset, Segment, 4); SegmentIndex++)
+		{
+			if (Segment[0] != 0xFF)
+			{
+				return false;
+			}
+
+			const uint8 Marker = Segment[1];
+			if (Marker == 0xFF)
+			{
+				// Fill byte before a marker
+				Offset++;
+				continue;
+			}
+			if (Marker == 0x01 || Marker == 0xD8 || (Marker >= 0xD0 && Marker <= 0xD7))
+			{
+				// Markers without a segment
+				Offset += 2;
+				continue;
+			}
+			if (Marker == 0xD9 || Marker == 0xDA)
+			{
+				// End of image or start of the compressed data: no frame header before it
+				return false;
+			}
+
+			const int32 Length = (Segment[2] << 8) | Segment[3];
+			if (Length < 2)
+			{
+				return false;
+			}
+
+			// SOF0 to SOF15, except DHT, JPG and DAC which share the range
+			if (Marker >= 0xC0 && Marker <= 0xCF && Marker != 0xC4 && Marker != 0xC8 && Marker != 0xCC)
+			{
+				uint8 Frame[5];
+				if (!ReadHeaderBytes(Reader, Offset + 4, Frame, 5))
+				{
+					return false;
+				}
+				OutSize = FImageSize((Frame[3] << 8) | Frame[4], (Frame[1] << 8) | Frame[2]);
+				return OutSize.X > 0 && OutSize.Y > 0;
+			}
+
+			Offset += 2 + Length;
+		}
+		return false;
+	}
+}
+
+bool FBitmapDecodeBudget::ProbeImageFile(const FString& PathToImage, FImageSize& OutSize)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*PathToImage, FILEREAD_Silent));
+	if (!Reader)
+	{
+		return false;
+	}
+
+	uint8 Header[26];
+	if (!ReadHeaderBytes(*Reader, 0, Header, sizeof(Header)))
+	{
+		return false;
+	}
+
+	// PNG: the signature, then the IHDR chunk
+	static const uint8 PngSignature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+	if (FMemory::Memcmp(Header, PngSignature, sizeof(PngSignature)) == 0)
+	{
+		if (FMemory::Memcmp(Header + 12, "IHDR", 4) != 0)
+		{
+			return false;
+		}
+		OutSize = FImageSize((int32)ReadBigEndian32(Header + 16), (int32)ReadBigEndian32(Header + 20));
+		return OutSize.X > 0 && OutSize.Y > 0;
+	}
+
+	if (Header[0] == 0xFF && Header[1] == 0xD8)
+	{
+		return ProbeJpeg(*Reader, OutSize);
+	}
+
+	// BMP: the file header, then the DIB header whose own size tells its layout. Bottom up bitmaps have a negative height.
+	if (Header[0] == 'B' && Header[1] == 'M')
+	{
+		if (ReadLittleEndian32(Header + 14) == 12)
+		{
+			OutSize = FImageSize(Header[18] | (Header[19] << 8), Header[20] | (Header[21] << 8));
+		}
+		else
+		{
+			OutSize = FImageSize(ReadLittleEndian32(Header + 18), FMath::Abs(ReadLittleEndian32(Header + 22)));
+		}
+		return OutSize.X > 0 && OutSize.Y > 0;
+	}
+
+	return false;
+}
+
+int64 FBitmapDecodeBudget::EstimateDecodeBytes(const FString& PathToImage, bool bCreateTexture, bool bGenerateMips, bool bKeepBitmap)
+{
+	const int64 FileBytes = IFileManager::Get().FileSize(*PathToImage);
+	if (FileBytes <= 0)
+	{
+		return 0;
+	}
+
+	FImageSize Size;
+	const int64 PixelBytes = ProbeImageFile(PathToImage, Size) ? (int64)Size.X * Size.Y * sizeof(FColor) : FileBytes * 4;
+
+	// The file and the decoder's copy of it are freed once the pixels are out of the decoder
+	const int64 DecodeBytes = FileBytes * 2 + PixelBytes * 2;
+	if (!bCreateTexture)
+	{
+		return DecodeBytes;
+	}
+
+	// Then the pixels are copied to the texture's mips
+	const int64 TextureBytes = PixelBytes * (bKeepBitmap ? 2 : 1) + (bGenerateMips ? PixelBytes * 4 / 3 : PixelBytes);
+	return FMath::Max(DecodeBytes, TextureBytes);
+}
+
+bool FBitmapDecodeBudget::TryReserve(int64 Bytes)
+{
+	FScopeLock Lock(&DecodeBudgetLock);
+	if (!DecodeBytesFit(Bytes))
+	{
+		return false;
+	}
+	AddDecodeBytes(Bytes);
+	return true;
+}
+
+bool FBitmapDecodeBudget::Fits(int64 Bytes)
+{
+	FScopeLock Lock(&DecodeBudgetLock);
+	return DecodeBytesFit(Bytes);
+}
+
+void FBitmapDecodeBudget::Reserve(int64 Bytes)
+{
+	const bool bCanWait = !IsInGameThread() && FBitmapJobContext::GetCurrent() == nullptr;
+
+	FEvent* Released = nullptr;
+	while (true)
+	{
+		{
+			FScopeLock Lock(&DecodeBudgetLock);
+			if (!bCanWait || DecodeBytesFit(Bytes))
+			{
+				if (Released)
+				{
+					DecodeBudgetNumWaiting--;
+					FPlatformProcess::ReturnSynchEventToPool(Released);
+				}
+				AddDecodeBytes(Bytes);
+				return;
+			}
+
+			if (!Released)
+			{
+				Released = FPlatformProcess::GetSynchEventFromPool(false);
+				DecodeBudgetNumWaiting++;
+			}
+			DecodeBudgetWaiters.Add(Released);
+		}
+
+		Released->Wait();
+	}
+}
+
+void FBitmapDecodeBudget::Release(int64 Bytes)
+{
+	{
+		FScopeLock Lock(&DecodeBudgetLock);
+		DecodeBudgetUsedBytes -= Bytes;
+		DecodeBudgetNumReserved--;
+
+		for (FEvent* Waiter : DecodeBudgetWaiters)
+		{
+			Waiter->Trigger();
+		}
+		DecodeBudgetWaiters.Reset();
+	}
+
+	// Outside the budget's lock: the scheduler takes it while holding its own
+	FBitmapJobScheduler::Get().OnDecodeMemoryReleased();
+}
+
+FDecodeMemoryStats FBitmapDecodeBudget::GetStats()
+{
+	// Before taking the budget's lock, the scheduler takes them the other way around
+	const int32 NumQueuedDecodes = FBitmapJobScheduler::Get().GetNumQueuedDecodes();
+
+	FScopeLock Lock(&DecodeBudgetLock);
+
+	FDecodeMemoryStats Stats;
+	Stats.UsedMegabytes = (float)(DecodeBudgetUsedBytes / (1024.0 * 1024.0));
+	Stats.PeakMegabytes = (float)(DecodeBudgetPeakBytes / (1024.0 * 1024.0));
+	Stats.BudgetMegabytes = (float)FMath::Max(CVarImageIODecodeMemoryBudget.GetValueOnAnyThread(), 0);
+	Stats.Decodes = DecodeBudgetNumReserved;
+	Stats.WaitingDecodes = DecodeBudgetNumWaiting + NumQueuedDecodes;
+	return Stats;
+}
+
+void FBitmapDecodeBudget::ResetPeak()
+{
+	FScopeLock Lock(&DecodeBudgetLock);
+	DecodeBudgetPeakBytes = DecodeBudgetUsedBytes;
+}
+
+FBitmapDecodeReservation::FBitmapDecodeReservation()
+	: Bytes(0)
+	, bReserved(false)
+{
+}
+
+FBitmapDecodeReservation::FBitmapDecodeReservation(int64 InBytes)
+	: Bytes(InBytes)
+	, bReserved(true)
+{
+	FBitmapDecodeBudget::Reserve(InBytes);
+}
+
+FBitmapDecodeReservation FBitmapDecodeReservation::TryReserve(int64 InBytes)
+{
+	FBitmapDecodeReservation Reservation;
+	if (FBitmapDecodeBudget::TryReserve(InBytes))
+	{
+		Reservation.Bytes = InBytes;
+		Reservation.bReserved = true;
+	}
+	return Reservation;
+}
+
+FBitmapDecodeReservation::FBitmapDecodeReservation(FBitmapDecodeReservation&& Other)
+	: Bytes(Other.Bytes)
+	, bReserved(Other.bReserved)
+{
+	Other.bReserved = false;
+}
+
+FBitmapDecodeReservation& FBitmapDecodeReservation::operator=(FBitmapDecodeReservation&& Other)
+{
+	if (this != &Other)
+	{
+		Release();
+		Bytes = Other.Bytes;
+		bReserved = Other.bReserved;
+		Other.bReserved = false;
+	}
+	return *this;
+}
+
+FBitmapDecodeReservation::~FBitmapDecodeReservation()
+{
+	Release();
+}
+
+void FBitmapDecodeReservation::Release()
+{
+	if (bReserved)
+	{
+		FBitmapDecodeBudget::Release(Bytes);
+		bReserved = false;
+	}
+}
+
+static void PrintDecodeMemory(const TArray<FString>& Args)
+{
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		FBitmapDecodeBudget::ResetPeak();
+	}
+
+	const FDecodeMemoryStats Stats = FBitmapDecodeBudget::GetStats();
+	UE_LOG(LogTemp, Display, TEXT("ImageIO decode memory: %.1f MB used, %.1f MB peak, %.0f MB budget, %d decode(s) running, %d waiting"),
+		Stats.UsedMegabytes, Stats.PeakMegabytes, Stats.BudgetMegabytes, Stats.Decodes, Stats.WaitingDecodes);
+}
+
+static FAutoConsoleCommand DecodeMemoryCommand(
+	TEXT("ImageIO.DecodeMemory"),
+	TEXT("Prints the memory held by the image decodes running now and at most so far, against ImageIO.DecodeMemoryBudget. Arguments: [reset]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&PrintDecodeMemory));
@@ -0,0 +1,123 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapFFT.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	// Plans by log2 of their size, 2^0 to 2^(MaxFFTLog2Size - 1)
+	const int32 MaxFFTLog2Size = 16;
+	static_assert(1 << (MaxFFTLog2Size - 1) == FBitmapFFT::MaxSize, "FBitmapFFT::MaxSize must be the biggest plan");
+
+	FCriticalSection FFTPlansLock;
+	TUniquePtr<FBitmapFFT> FFTPlans[MaxFFTLog2Size];
+}
+
+const FBitmapFFT& FBitmapFFT::Get(int32 Size)
+{
+	check(FMath::IsPowerOfTwo(Size));
+	const int32 Log2Size = FMath::FloorLog2(Size);
+	check(Log2Size < MaxFFTLog2Size);
+
+	FScopeLock Lock(&FFTPlansLock);
+	if (!FFTPlans[Log2Size].IsValid())
+	{
+		FFTPlans[Log2Size] = MakeUnique<FBitmapFFT>(Size);
+	}
+	return *FFTPlans[Log2Size];
+}
+
+FBitmapFFT::FBitmapFFT(int32 InSize)
+	: Size(InSize)
+{
+	const int32 Log2Size = FMath::FloorLog2(Size);
+	for (int32 Index = 0; Index < Size; Index++)
+	{
+		int32 Reversed = 0;
+		for (int32 Bit = 0; Bit < Log2Size; Bit++)
+		{
+			Reversed |= ((Index >> Bit) & 1) << (Log2Size - 1 - Bit);
+		}
+		if (Index < Reversed)
+		{
+			BitReversalSwaps.Add(TPair<int32, int32>(Index, Reversed));
+		}
+	}
+
+	Twiddles.SetNumUninitialized(FMath::Max(Size, 2));
+	for (int32 K = 0; K < Size / 2; K++)
+	{
+		const double Angle = 2.0 * PI * K / Size;
+		Twiddles[2 * K] = (float)FMath::Cos(Angle);
+		Twiddles[2 * K + 1] = (float)FMath::Sin(Angle);
+	}
+}
+
+void FBitmapFFT::Transform(float* Data, bool bInverse) const
+{
+	for (const TPair<int32, int32>& Indices : BitReversalSwaps)
+	{
+		Swap(Data[2 * Indices.Key], Data[2 * Indices.Value]);
+		Swap(Data[2 * Indices.Key + 1], Data[2 * Indices.Value + 1]);
+	}
+
+	// The forward transform uses exp(-i * Angle), the inverse exp(i * Angle)
+	const float SinSign = bInverse ? 1.0f : -1.0f;
+
+	for (int32 Half = 1; Half < Size; Half *= 2)
+	{
+		const int32 TwiddleStep = Size / (2 * Half);
+		for (int32 K = 0; K < Half; K++)
+		{
+			const float TwiddleRe = Twiddles[2 * K * TwiddleStep];
+			const float TwiddleIm = SinSign * Twiddles[2 * K * TwiddleStep + 1];
+
+			for (int32 Start = K; Start < Size; Start += 2 * Half)
+			{
+				float* A = Data + 2 * Start;
+				float* B = Data + 2 * (Start + Half);
+
+				const float BRe = B[0] * TwiddleRe - B[1] * TwiddleIm;
+				const float BIm = B[0] * TwiddleIm + B[1] * TwiddleRe;
+				B[0] = A[0] - BRe;
+				B[1] = A[1] - BIm;
+				A[0] += BRe;
+				A[1] += BIm;
+			}
+		}
+	}
+}
+
+void FBitmapFFT::TransformColumns(float* Data, int32 Count, int32 Stride, bool bInverse, float* Scratch) const
+{
+	for (int32 FirstColumn = 0; FirstColumn < Count; FirstColumn += ColumnBatch)
+	{
+		const int32 NumColumns = FMath::Min(ColumnBatch, Count - FirstColumn);
+
+		for (int32 Row = 0; Row < Size; Row++)
+		{
+			const float* Source = Data + 2 * ((int64)Row * Stride + FirstColumn);
+			for (int32 Column = 0; Column < NumColumns; Column++)
+			{
+				Scratch[2 * (Column * Size + Row)] = Source[2 * Column];
+				Scratch[2 * (Column * Size + Row) + 1] = Source[2 * Column + 1];
+			}
+		}
+
+		for (int32 Column = 0; Column < NumColumns; Column++)
+		{
+			Transform(Scratch + 2 * Column * Size, bInverse);
+		}
+
+		for (int32 Row = 0; Row < Size; Row++)
+		{
+			float* Target = Data + 2 * ((int64)Row * Stride + FirstColumn);
+			for (int32 Column = 0; Column < NumColumns; Column++)
+			{
+				Target[2 * Column] = Scratch[2 * (Column * Size + Row)];
+				Target[2 * Column + 1] = Scratch[2 * (Column * Size + Row) + 1];
+			}
+		}
+	}
+}
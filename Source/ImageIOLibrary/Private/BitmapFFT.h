@@ -0,0 +1,50 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Radix-2 complex FFT used by the FFT convolution path.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* Complex values are interleaved floats: Data[2 * I] is the real part of value I, Data[2 * I + 1] its imaginary part. */
+class FBitmapFFT
+{
+public:
+
+	/* Plan for a power of two size, built the first time it's asked for and shared afterwards. Safe to call from any thread. */
+	static const FBitmapFFT& Get(int32 Size);
+
+	int32 GetSize() const { return Size; }
+
+	/* In place forward transform of Size complex values. */
+	void Forward(float* Data) const { Transform(Data, false); }
+
+	/* In place inverse transform of Size complex values. Not scaled by 1 / Size, callers fold that into something they already multiply by. */
+	void Inverse(float* Data) const { Transform(Data, true); }
+
+	/* Transforms Count lines of Size values spaced Stride complex values apart, e.g. the columns of a 2D block (Stride being its width).
+	Lines are gathered a few at a time into Scratch, which must hold Size * ColumnBatch complex values.
+	*/
+	void TransformColumns(float* Data, int32 Count, int32 Stride, bool bInverse, float* Scratch) const;
+
+	// Biggest size Get() has plans for
+	static const int32 MaxSize = 1 << 15;
+
+	// Columns gathered together by TransformColumns, so each row of the block is read as a contiguous run
+	static const int32 ColumnBatch = 8;
+
+	/* Use Get() rather than building plans directly. */
+	explicit FBitmapFFT(int32 InSize);
+
+private:
+
+	void Transform(float* Data, bool bInverse) const;
+
+	int32 Size;
+
+	// Index pairs swapped by the bit reversal permutation
+	TArray<TPair<int32, int32>> BitReversalSwaps;
+
+	// cos(2 * PI * K / Size), sin(2 * PI * K / Size) for K < Size / 2
+	TArray<float> Twiddles;
+};
@@ -0,0 +1,280 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapGuidedFilter.h"
+#include "BitmapParallel.h"
+#include "BitmapChannels.h"
+
+namespace
+{
+	/* Window sums of a pixel's 4 channels and of their squares, channels in memory order (B, G, R, A). */
+	struct FGuidedMoments
+	{
+		int32 Sum[4];
+		int32 SumSquares[4];
+	};
+
+	/* Window sums of the per window fits Value * A + B, one lane per channel in memory order. */
+	struct FGuidedCoefficients
+	{
+		VectorRegister A;
+		VectorRegister B;
+	};
+
+	FORCEINLINE void AddGuidedRow(FGuidedMoments& Total, const FGuidedMoments& Row)
+	{
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			Total.Sum[Channel] += Row.Sum[Channel];
+			Total.SumSquares[Channel] += Row.SumSquares[Channel];
+		}
+	}
+
+	FORCEINLINE void SubtractGuidedRow(FGuidedMoments& Total, const FGuidedMoments& Row)
+	{
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			Total.Sum[Channel] -= Row.Sum[Channel];
+			Total.SumSquares[Channel] -= Row.SumSquares[Channel];
+		}
+	}
+
+	FORCEINLINE void AddGuidedRow(FGuidedCoefficients& Total, const FGuidedCoefficients& Row)
+	{
+		Total.A = VectorAdd(Total.A, Row.A);
+		Total.B = VectorAdd(Total.B, Row.B);
+	}
+
+	FORCEINLINE void SubtractGuidedRow(FGuidedCoefficients& Total, const FGuidedCoefficients& Row)
+	{
+		Total.A = VectorSubtract(Total.A, Row.A);
+		Total.B = VectorSubtract(Total.B, Row.B);
+	}
+
+	/* Sliding window sums of the channels and their squares along one line, clamp-to-edge borders. */
+	void BoxMomentsLine(const FColor* In, FGuidedMoments* Out, int32 Length, int32 Radius)
+	{
+		FGuidedMoments Window;
+		FMemory::Memzero(Window);
+
+		auto AddPixel = [&Window](const FColor& Pixel, int32 Sign)
+		{
+			const uint8* Channels = (const uint8*)&Pixel;
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				const int32 Value = Channels[Channel];
+				Window.Sum[Channel] += Sign * Value;
+				Window.SumSquares[Channel] += Sign * Value * Value;
+			}
+		};
+
+		for (int32 Index = -Radius; Index <= Radius; Index++)
+		{
+			AddPixel(In[FMath::Clamp(Index, 0, Length - 1)], 1);
+		}
+
+		for (int32 Index = 0; Index < Length; Index++)
+		{
+			Out[Index] = Window;
+			AddPixel(In[FMath::Min(Index + Radius + 1, Length - 1)], 1);
+			AddPixel(In[FMath::Max(Index - Radius, 0)], -1);
+		}
+	}
+
+	/* Same sliding window along a line of fits. */
+	void BoxCoefficientsLine(const FGuidedCoefficients* In, FGuidedCoefficients* Out, int32 Length, int32 Radius)
+	{
+		FGuidedCoefficients Window = { VectorZero(), VectorZero() };
+		for (int32 Index = -Radius; Index <= Radius; Index++)
+		{
+			AddGuidedRow(Window, In[FMath::Clamp(Index, 0, Length - 1)]);
+		}
+
+		for (int32 Index = 0; Index < Length; Index++)
+		{
+			Out[Index] = Window;
+			AddGuidedRow(Window, In[FMath::Min(Index + Radius + 1, Length - 1)]);
+			SubtractGuidedRow(Window, In[FMath::Max(Index - Radius, 0)]);
+		}
+	}
+
+	/* Fits each window of a line of moments: A = Variance / (Variance + Regulariser), B = Mean * (1 - A). */
+	void FitCoefficientsLine(const FGuidedMoments* Moments, FGuidedCoefficients* Out, int32 Length, int32 WindowArea, float Regulariser)
+	{
+		const double InvArea = 1.0 / WindowArea;
+		const double InvAreaSquared = InvArea * InvArea;
+
+		for (int32 Index = 0; Index < Length; Index++)
+		{
+			float A[4];
+			float B[4];
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				// Area * SumSquares - Sum² is exact in 64 bits, so flat windows get a variance of exactly 0
+				const int64 Sum = Moments[Index].Sum[Channel];
+				const int64 ScaledVariance = (int64)WindowArea * Moments[Index].SumSquares[Channel] - Sum * Sum;
+
+				const float Variance = (float)(ScaledVariance * InvAreaSquared);
+				const float Mean = (float)(Sum * InvArea);
+				A[Channel] = Variance / (Variance + Regulariser);
+				B[Channel] = Mean * (1.0f - A[Channel]);
+			}
+
+			Out[Index].A = MakeVectorRegister(A[0], A[1], A[2], A[3]);
+			Out[Index].B = MakeVectorRegister(B[0], B[1], B[2], B[3]);
+		}
+	}
+
+	/* Vertical sliding window over rows that are produced on demand, top to bottom, by ProduceRow(Row, Out).
+	Only the rows the window still has to subtract are kept, in a ring of 2 * Radius + 2 rows.
+	*/
+	template<typename RowType, typename ProduceRowType>
+	class TGuidedColumnWindow
+	{
+	public:
+
+		TGuidedColumnWindow(int32 InWidth, int32 InHeight, int32 InRadius, const ProduceRowType& InProduceRow)
+			: Width(InWidth)
+			, Height(InHeight)
+			, Radius(InRadius)
+			, RingRows(2 * InRadius + 2)
+			, ProduceRow(InProduceRow)
+			, CurrentRow(INDEX_NONE)
+			, LastProducedRow(INDEX_NONE)
+		{
+			Ring.SetNumUninitialized(RingRows * Width);
+			Sum.SetNumUninitialized(Width);
+		}
+
+		/* Sums of the rows Row - Radius to Row + Radius (repeating the edge rows). Row can't go back up between calls. */
+		const RowType* GetSumAt(int32 Row)
+		{
+			if (CurrentRow == INDEX_NONE)
+			{
+				LastProducedRow = ClampRow(Row - Radius) - 1;
+				FMemory::Memzero(Sum.GetData(), Sum.Num() * sizeof(RowType));
+				for (int32 WindowRow = Row - Radius; WindowRow <= Row + Radius; WindowRow++)
+				{
+					AddRow(GetRow(ClampRow(WindowRow)));
+				}
+				CurrentRow = Row;
+			}
+
+			for (; CurrentRow < Row; CurrentRow++)
+			{
+				AddRow(GetRow(ClampRow(CurrentRow + Radius + 1)));
+				SubtractRow(GetRow(ClampRow(CurrentRow - Radius)));
+			}
+			return Sum.GetData();
+		}
+
+	private:
+
+		int32 ClampRow(int32 Row) const
+		{
+			return FMath::Clamp(Row, 0, Height - 1);
+		}
+
+		const RowType* GetRow(int32 Row)
+		{
+			while (LastProducedRow < Row)
+			{
+				LastProducedRow++;
+				ProduceRow(LastProducedRow, Ring.GetData() + (LastProducedRow % RingRows) * Width);
+			}
+			return Ring.GetData() + (Row % RingRows) * Width;
+		}
+
+		void AddRow(const RowType* Row)
+		{
+			for (int32 Index = 0; Index < Width; Index++)
+			{
+				AddGuidedRow(Sum[Index], Row[Index]);
+			}
+		}
+
+		void SubtractRow(const RowType* Row)
+		{
+			for (int32 Index = 0; Index < Width; Index++)
+			{
+				SubtractGuidedRow(Sum[Index], Row[Index]);
+			}
+		}
+
+		int32 Width;
+		int32 Height;
+		int32 Radius;
+		int32 RingRows;
+		ProduceRowType ProduceRow;
+
+		// Row the sums are currently for, and the last row written to the ring
+		int32 CurrentRow;
+		int32 LastProducedRow;
+
+		TArray<RowType> Ring;
+		TArray<RowType> Sum;
+	};
+
+	template<typename RowType, typename ProduceRowType>
+	TGuidedColumnWindow<RowType, ProduceRowType> MakeGuidedColumnWindow(FImageSize Size, int32 Radius, const ProduceRowType& ProduceRow)
+	{
+		return TGuidedColumnWindow<RowType, ProduceRowType>(Size.X, Size.Y, Radius, ProduceRow);
+	}
+}
+
+void FBitmapGuidedFilter::Filter(FConstBitmapView Src, int32 Radius, float Smoothness, EFilterColourChannel ColourChannel, FBitmapView Dst)
+{
+	const FImageSize Size = Src.GetSize();
+	if (Size.X <= 0 || Size.Y <= 0)
+	{
+		return;
+	}
+
+	Radius = FMath::Clamp(Radius, 0, (int32)MaxRadius);
+	const int32 WindowArea = (2 * Radius + 1) * (2 * Radius + 1);
+
+	// Smoothness is a contrast on a 0 to 1 scale, the fits work on 0 to 255 values
+	const float Regulariser = FMath::Max(FMath::Square(Smoothness * 255.0f), 1e-4f);
+
+	// Each band recomputes 2 * Radius rows of fits and moments above and below it, so bands shouldn't be much thinner than that
+	const int32 MinBandRows = FMath::Max(32, 4 * Radius);
+
+	FBitmapParallel::ForRange(Size.Y, MinBandRows, [&](int32 StartRow, int32 EndRow)
+	{
+		TArray<FGuidedCoefficients> FittedLine;
+		FittedLine.SetNumUninitialized(Size.X);
+
+		auto Moments = MakeGuidedColumnWindow<FGuidedMoments>(Size, Radius, [&](int32 Row, FGuidedMoments* Out)
+		{
+			BoxMomentsLine(Src.GetRow(Row), Out, Size.X, Radius);
+		});
+
+		auto Coefficients = MakeGuidedColumnWindow<FGuidedCoefficients>(Size, Radius, [&](int32 Row, FGuidedCoefficients* Out)
+		{
+			FitCoefficientsLine(Moments.GetSumAt(Row), FittedLine.GetData(), Size.X, WindowArea, Regulariser);
+			BoxCoefficientsLine(FittedLine.GetData(), Out, Size.X, Radius);
+		});
+
+		const VectorRegister InvArea = VectorSetFloat1(1.0f / WindowArea);
+
+		// Half added for rounding, VectorStoreByte4 truncates (and saturates)
+		const VectorRegister Rounding = VectorSetFloat1(0.5f);
+
+		for (int32 Row = StartRow; Row < EndRow; Row++)
+		{
+			const FGuidedCoefficients* Sums = Coefficients.GetSumAt(Row);
+			const FColor* SrcRow = Src.GetRow(Row);
+			FColor* DstRow = Dst.GetRow(Row);
+
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				// Average of the fits of every window covering the pixel
+				const VectorRegister A = VectorMultiply(Sums[X].A, InvArea);
+				const VectorRegister B = VectorMultiplyAdd(Sums[X].B, InvArea, Rounding);
+
+				FColor Pixel;
+				VectorStoreByte4(VectorMultiplyAdd(A, VectorLoadByte4(&SrcRow[X]), B), &Pixel);
+				DstRow[X] = BitmapChannels::FinishFilteredPixel(Pixel, ColourChannel);
+			}
+		}
+	});
+}
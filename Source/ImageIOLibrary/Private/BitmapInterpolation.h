@@ -0,0 +1,191 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Reading a bitmap between pixel centres, shared by the operations that sample at arbitrary coordinates (sampling, warps).
+// Coordinates are in texel space: pixel X has its centre at X, so continuous pixel coordinates have 0.5 taken off first.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapBorder.h"
+#include "BitmapSimd.h"
+
+namespace BitmapInterpolation
+{
+	/* Keeps coordinates far outside the bitmap (or NaN) from overflowing when they're turned into pixel indices. */
+	FORCEINLINE float ClampCoordinate(float Coordinate)
+	{
+		return Coordinate > -1e8f ? FMath::Min(Coordinate, 1e8f) : -1e8f;
+	}
+
+	/* Blends 4 texels with weights out of 256 that add up to 256, so every sum fits in 16 bits. */
+	FORCEINLINE FColor BlendBilinear(FColor TopLeft, FColor TopRight, FColor BottomLeft, FColor BottomRight, int32 WeightX, int32 WeightY)
+	{
+		const int32 WeightBottomRight = (WeightX * WeightY + 128) >> 8;
+		const int32 WeightTopRight = WeightX - WeightBottomRight;
+		const int32 WeightBottomLeft = WeightY - WeightBottomRight;
+		const int32 WeightTopLeft = 256 - WeightX - WeightY + WeightBottomRight;
+
+#if IMAGEIO_WITH_SSE2
+		const __m128i Zero = _mm_setzero_si128();
+		const __m128i Top = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int32)TopLeft.DWColor()), _mm_cvtsi32_si128((int32)TopRight.DWColor())), Zero);
+		const __m128i Bottom = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int32)BottomLeft.DWColor()), _mm_cvtsi32_si128((int32)BottomRight.DWColor())), Zero);
+		const __m128i TopWeights = _mm_unpacklo_epi64(_mm_set1_epi16((int16)WeightTopLeft), _mm_set1_epi16((int16)WeightTopRight));
+		const __m128i BottomWeights = _mm_unpacklo_epi64(_mm_set1_epi16((int16)WeightBottomLeft), _mm_set1_epi16((int16)WeightBottomRight));
+
+		// Left texels in the low half, right texels in the high half: folding the halves together finishes the sum
+		__m128i Sum = _mm_add_epi16(_mm_mullo_epi16(Top, TopWeights), _mm_mullo_epi16(Bottom, BottomWeights));
+		Sum = _mm_add_epi16(Sum, _mm_srli_si128(Sum, 8));
+		Sum = _mm_srli_epi16(_mm_add_epi16(Sum, _mm_set1_epi16(128)), 8);
+
+		FColor Result;
+		Result.DWColor() = (uint32)_mm_cvtsi128_si32(_mm_packus_epi16(Sum, Zero));
+		return Result;
+#else
+		const uint8* Texels[4] = { (const uint8*)&TopLeft, (const uint8*)&TopRight, (const uint8*)&BottomLeft, (const uint8*)&BottomRight };
+		const int32 Weights[4] = { WeightTopLeft, WeightTopRight, WeightBottomLeft, WeightBottomRight };
+		FColor Result;
+		uint8* Out = (uint8*)&Result;
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			int32 Sum = 128;
+			for (int32 Texel = 0; Texel < 4; Texel++)
+			{
+				Sum += Texels[Texel][Channel] * Weights[Texel];
+			}
+			Out[Channel] = (uint8)(Sum >> 8);
+		}
+		return Result;
+#endif
+	}
+
+	/* Catmull-Rom weights of the 4 texels around a sample T (0 to 1) past the second one. Same cubic as EBitmapResampleFilter::Bicubic. */
+	FORCEINLINE void GetCubicWeights(float T, float* Weights)
+	{
+		Weights[0] = ((-0.5f * T + 1.0f) * T - 0.5f) * T;
+		Weights[1] = (1.5f * T - 2.5f) * T * T + 1.0f;
+		Weights[2] = ((-1.5f * T + 2.0f) * T + 0.5f) * T;
+		Weights[3] = (0.5f * T - 0.5f) * T * T;
+	}
+
+	/* Blends 4x4 texels (rows Pitch pixels apart) with WeightsX along the rows and WeightsY across them. The negative lobes can overshoot,
+	channels are clamped to [0, 255].
+	*/
+	FORCEINLINE FColor BlendBicubic(const FColor* Texels, int32 Pitch, const float* WeightsX, const float* WeightsY)
+	{
+#if IMAGEIO_WITH_SSE2
+		const __m128i Zero = _mm_setzero_si128();
+		__m128 Sum = _mm_setzero_ps();
+		for (int32 Row = 0; Row < 4; Row++)
+		{
+			// The 4 texels of the row, one per float vector
+			const __m128i Pixels = _mm_loadu_si128((const __m128i*)(Texels + Row * Pitch));
+			const __m128i Low = _mm_unpacklo_epi8(Pixels, Zero);
+			const __m128i High = _mm_unpackhi_epi8(Pixels, Zero);
+			__m128 RowSum = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Low, Zero)), _mm_set1_ps(WeightsX[0]));
+			RowSum = _mm_add_ps(RowSum, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Low, Zero)), _mm_set1_ps(WeightsX[1])));
+			RowSum = _mm_add_ps(RowSum, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(High, Zero)), _mm_set1_ps(WeightsX[2])));
+			RowSum = _mm_add_ps(RowSum, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(High, Zero)), _mm_set1_ps(WeightsX[3])));
+			Sum = _mm_add_ps(Sum, _mm_mul_ps(RowSum, _mm_set1_ps(WeightsY[Row])));
+		}
+
+		// Rounded, then clamped by the saturating packs
+		const __m128i Rounded = _mm_cvtps_epi32(Sum);
+		const __m128i Packed = _mm_packus_epi16(_mm_packs_epi32(Rounded, Zero), Zero);
+		FColor Result;
+		Result.DWColor() = (uint32)_mm_cvtsi128_si32(Packed);
+		return Result;
+#else
+		float Sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int32 Row = 0; Row < 4; Row++)
+		{
+			for (int32 Column = 0; Column < 4; Column++)
+			{
+				const uint8* Texel = (const uint8*)(Texels + Row * Pitch + Column);
+				const float Weight = WeightsX[Column] * WeightsY[Row];
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					Sums[Channel] += Texel[Channel] * Weight;
+				}
+			}
+		}
+		FColor Result;
+		uint8* Out = (uint8*)&Result;
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			Out[Channel] = (uint8)FMath::Clamp(FMath::RoundToInt(Sums[Channel]), 0, 255);
+		}
+		return Result;
+#endif
+	}
+
+	/* The pixel whose centre is the closest to (X, Y). */
+	FORCEINLINE FColor SampleNearest(const FConstBitmapView& Src, float X, float Y, EBitmapBorderMode BorderMode, FColor BorderColour)
+	{
+		return BitmapBorder::ReadPixel(Src, FMath::FloorToInt(ClampCoordinate(X) + 0.5f), FMath::FloorToInt(ClampCoordinate(Y) + 0.5f), BorderMode, BorderColour);
+	}
+
+	/* Blend of the 4 texels around (X, Y). Only samples touching the edges go through the border mode. */
+	FORCEINLINE FColor SampleBilinear(const FConstBitmapView& Src, float X, float Y, EBitmapBorderMode BorderMode, FColor BorderColour)
+	{
+		X = ClampCoordinate(X);
+		Y = ClampCoordinate(Y);
+		const int32 Left = FMath::FloorToInt(X);
+		const int32 Top = FMath::FloorToInt(Y);
+		const int32 WeightX = (int32)((X - Left) * 256.0f + 0.5f);
+		const int32 WeightY = (int32)((Y - Top) * 256.0f + 0.5f);
+
+		if (Left >= 0 && Top >= 0 && Left + 1 < Src.Width && Top + 1 < Src.Height)
+		{
+			const FColor* Texels = Src.GetRow(Top) + Left;
+			return BlendBilinear(Texels[0], Texels[1], Texels[Src.Pitch], Texels[Src.Pitch + 1], WeightX, WeightY);
+		}
+		return BlendBilinear(
+			BitmapBorder::ReadPixel(Src, Left, Top, BorderMode, BorderColour),
+			BitmapBorder::ReadPixel(Src, Left + 1, Top, BorderMode, BorderColour),
+			BitmapBorder::ReadPixel(Src, Left, Top + 1, BorderMode, BorderColour),
+			BitmapBorder::ReadPixel(Src, Left + 1, Top + 1, BorderMode, BorderColour),
+			WeightX, WeightY);
+	}
+
+	/* Catmull-Rom blend of the 4x4 texels around (X, Y). Only samples touching the edges go through the border mode. */
+	FORCEINLINE FColor SampleBicubic(const FConstBitmapView& Src, float X, float Y, EBitmapBorderMode BorderMode, FColor BorderColour)
+	{
+		X = ClampCoordinate(X);
+		Y = ClampCoordinate(Y);
+		const int32 Left = FMath::FloorToInt(X);
+		const int32 Top = FMath::FloorToInt(Y);
+		float WeightsX[4];
+		float WeightsY[4];
+		GetCubicWeights(X - Left, WeightsX);
+		GetCubicWeights(Y - Top, WeightsY);
+
+		if (Left >= 1 && Top >= 1 && Left + 2 < Src.Width && Top + 2 < Src.Height)
+		{
+			return BlendBicubic(Src.GetRow(Top - 1) + Left - 1, Src.Pitch, WeightsX, WeightsY);
+		}
+
+		FColor Texels[16];
+		for (int32 Row = 0; Row < 4; Row++)
+		{
+			for (int32 Column = 0; Column < 4; Column++)
+			{
+				Texels[Row * 4 + Column] = BitmapBorder::ReadPixel(Src, Left - 1 + Column, Top - 1 + Row, BorderMode, BorderColour);
+			}
+		}
+		return BlendBicubic(Texels, 4, WeightsX, WeightsY);
+	}
+
+	FORCEINLINE FColor Sample(const FConstBitmapView& Src, float X, float Y, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode, FColor BorderColour)
+	{
+		switch (Filter)
+		{
+		case EBitmapSampleFilter::Nearest:
+			return SampleNearest(Src, X, Y, BorderMode, BorderColour);
+		case EBitmapSampleFilter::Bilinear:
+			return SampleBilinear(Src, X, Y, BorderMode, BorderColour);
+		default:
+			return SampleBicubic(Src, X, Y, BorderMode, BorderColour);
+		}
+	}
+}
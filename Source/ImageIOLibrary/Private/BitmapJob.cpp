@@ -0,0 +1,153 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapJob.h"
+#include "BitmapJobScheduler.h"
+#include "BitmapTexture.h"
+#include "BitmapSimd.h"
+
+#include "Async/Async.h"
+#include "Engine/Texture2D.h"
+
+UBitmapJob::UBitmapJob()
+	: Texture(nullptr)
+	, Context(MakeShared<FBitmapJobContext, ESPMode::ThreadSafe>())
+	, State(EBitmapJobState::Running)
+{
+}
+
+UBitmapJob* UBitmapJob::Launch(TUniqueFunction<bool(FBitmapJobContext&, FBitmapJobResult&)>&& Work, TFunction<void(UBitmapJob*)>&& OnCompleted,
+	EBitmapJobPriority Priority, int64 DecodeBytes)
+{
+	check(IsInGameThread());
+
+	// Rooted until it completes: the worker and the callbacks only hold raw pointers to it
+	UBitmapJob* Job = NewObject<UBitmapJob>();
+	Job->AddToRoot();
+	Job->OnCompleted = MoveTemp(OnCompleted);
+
+	TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe> Context = Job->Context;
+	Context->SetPriority(Priority);
+	TWeakObjectPtr<UBitmapJob> WeakJob(Job);
+	Context->OnProgressStep = [WeakJob](float Progress)
+	{
+		AsyncTask(ENamedThreads::GameThread, [WeakJob, Progress]()
+		{
+			if (UBitmapJob* ProgressJob = WeakJob.Get())
+			{
+				ProgressJob->OnProgress.Broadcast(ProgressJob, Progress);
+			}
+		});
+	};
+
+	FBitmapJobScheduler::Get().Schedule(Context, [Job, Context, Work = MoveTemp(Work)](FBitmapDecodeReservation& Reservation) mutable
+	{
+		FBitmapJobResult Result;
+		Result.Reservation = MoveTemp(Reservation);
+
+		// Cancelled between being taken from the queue and running
+		bool bSucceeded = false;
+		if (!Context->IsCancelled())
+		{
+			FBitmapJobContext::FScope Scope(*Context);
+			bSucceeded = Work(*Context, Result) && !Context->IsCancelled();
+		}
+
+		if (bSucceeded && Result.bCreateTexture)
+		{
+			Result.TexturePixels.SetNumUninitialized(Result.Bitmap.Num());
+			BitmapSimd::SwapRedBlue(Result.Bitmap.GetData(), Result.TexturePixels.GetData(), Result.Bitmap.Num());
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [Job, bSucceeded, Result = MoveTemp(Result)]() mutable
+		{
+			Job->Complete(bSucceeded, Result);
+		});
+	}, DecodeBytes);
+
+	return Job;
+}
+
+void UBitmapJob::Complete(bool bSucceeded, FBitmapJobResult& Result)
+{
+	if (Context->IsCancelled())
+	{
+		State = EBitmapJobState::Cancelled;
+	}
+	else if (!bSucceeded)
+	{
+		State = EBitmapJobState::Failed;
+	}
+	else
+	{
+		if (Result.bCreateTexture)
+		{
+			Texture = FBitmapTexture::CreateTransient(Result.TexturePixels.GetData(), Result.Size, false, EBitmapTextureCompression::None);
+		}
+
+		if (Result.bCreateTexture && !Texture)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to create the Texture2D of a bitmap job."));
+			State = EBitmapJobState::Failed;
+		}
+		else
+		{
+			Bitmap = MoveTemp(Result.Bitmap);
+			Size = Result.Size;
+			State = EBitmapJobState::Succeeded;
+		}
+	}
+
+	// The texture holds its own copy of the pixels now, the decode is over
+	Result.TexturePixels.Empty();
+	Result.Reservation.Release();
+
+	RemoveFromRoot();
+	const TFunction<void(UBitmapJob*)> Callback = MoveTemp(OnCompleted);
+	if (Callback)
+	{
+		Callback(this);
+	}
+}
+
+void UBitmapJob::Cancel()
+{
+	Context->Cancel();
+
+	// Dropped from the queue, the work never runs: the job completes on the next tick, as it would have
+	if (State == EBitmapJobState::Running && FBitmapJobScheduler::Get().Remove(*Context))
+	{
+		AsyncTask(ENamedThreads::GameThread, [this]()
+		{
+			FBitmapJobResult Result;
+			Complete(false, Result);
+		});
+	}
+}
+
+float UBitmapJob::GetProgress() const
+{
+	return State == EBitmapJobState::Succeeded ? 1.0f : Context->GetProgress();
+}
+
+EBitmapJobState UBitmapJob::GetState() const
+{
+	return State == EBitmapJobState::Running && !Context->IsStarted() ? EBitmapJobState::Queued : State;
+}
+
+void UBitmapJob::SetPriority(EBitmapJobPriority Priority)
+{
+	if (State == EBitmapJobState::Running)
+	{
+		FBitmapJobScheduler::Get().SetPriority(*Context, Priority);
+	}
+}
+
+EBitmapJobPriority UBitmapJob::GetPriority() const
+{
+	return Context->GetPriority();
+}
+
+bool UBitmapJob::IsDone() const
+{
+	return State != EBitmapJobState::Running;
+}
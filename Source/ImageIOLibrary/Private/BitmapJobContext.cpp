@@ -0,0 +1,145 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapJobContext.h"
+#include "BitmapJobScheduler.h"
+
+namespace
+{
+	const int32 ProgressScale = 1 << 20;
+
+	thread_local FBitmapJobContext* CurrentJobContext = nullptr;
+}
+
+FBitmapJobContext::FScope::FScope(FBitmapJobContext& Context)
+	: Previous(CurrentJobContext)
+{
+	CurrentJobContext = &Context;
+}
+
+FBitmapJobContext::FScope::~FScope()
+{
+	CurrentJobContext = Previous;
+}
+
+FBitmapJobContext::FBitmapJobContext()
+	: bCancelled(0)
+	, bStarted(0)
+	, Priority((int32)EBitmapJobPriority::Visible)
+	, InheritedPriority((int32)EBitmapJobPriority::Background)
+	, Progress(0)
+	, StageBegin(0.0f)
+	, StageEnd(1.0f)
+{
+}
+
+FBitmapJobContext* FBitmapJobContext::GetCurrent()
+{
+	return CurrentJobContext;
+}
+
+void FBitmapJobContext::Cancel()
+{
+	FPlatformAtomics::InterlockedExchange(&bCancelled, 1);
+}
+
+bool FBitmapJobContext::IsCancelled() const
+{
+	return FPlatformAtomics::AtomicRead(&bCancelled) != 0;
+}
+
+EBitmapJobPriority FBitmapJobContext::GetPriority() const
+{
+	return (EBitmapJobPriority)FPlatformAtomics::AtomicRead(&Priority);
+}
+
+void FBitmapJobContext::SetPriority(EBitmapJobPriority NewPriority)
+{
+	FPlatformAtomics::InterlockedExchange(&Priority, (int32)NewPriority);
+}
+
+EBitmapJobPriority FBitmapJobContext::GetEffectivePriority() const
+{
+	return (EBitmapJobPriority)FMath::Min(FPlatformAtomics::AtomicRead(&Priority), FPlatformAtomics::AtomicRead(&InheritedPriority));
+}
+
+void FBitmapJobContext::InheritPriority(EBitmapJobPriority Inherited)
+{
+	int32 OldPriority = FPlatformAtomics::AtomicRead(&InheritedPriority);
+	while ((int32)Inherited < OldPriority)
+	{
+		const int32 Seen = FPlatformAtomics::InterlockedCompareExchange(&InheritedPriority, (int32)Inherited, OldPriority);
+		if (Seen == OldPriority)
+		{
+			return;
+		}
+		OldPriority = Seen;
+	}
+}
+
+bool FBitmapJobContext::IsStarted() const
+{
+	return FPlatformAtomics::AtomicRead(&bStarted) != 0;
+}
+
+void FBitmapJobContext::MarkStarted()
+{
+	FPlatformAtomics::InterlockedExchange(&bStarted, 1);
+}
+
+bool FBitmapJobContext::HasHigherPriorityQueued() const
+{
+	return FBitmapJobScheduler::Get().HasQueuedAbove(GetEffectivePriority());
+}
+
+bool FBitmapJobContext::YieldToHigherPriority() const
+{
+	FBitmapJobScheduler& Scheduler = FBitmapJobScheduler::Get();
+	return Scheduler.HasQueuedAbove(GetEffectivePriority()) && Scheduler.RunQueuedAbove(*this);
+}
+
+void FBitmapJobContext::SetStage(float Begin, float End)
+{
+	StageBegin = FMath::Clamp(Begin, 0.0f, 1.0f);
+	StageEnd = FMath::Clamp(End, StageBegin, 1.0f);
+	RaiseProgress(StageBegin);
+}
+
+void FBitmapJobContext::ReportProgress(float StageProgress)
+{
+	RaiseProgress(FMath::Lerp(StageBegin, StageEnd, FMath::Clamp(StageProgress, 0.0f, 1.0f)));
+}
+
+float FBitmapJobContext::BeginPass() const
+{
+	return FMath::Max(GetProgress(), StageBegin);
+}
+
+void FBitmapJobContext::ReportPassProgress(float PassStart, float PassProgress)
+{
+	RaiseProgress(PassStart + (StageEnd - PassStart) * 0.5f * FMath::Clamp(PassProgress, 0.0f, 1.0f));
+}
+
+float FBitmapJobContext::GetProgress() const
+{
+	return (float)FPlatformAtomics::AtomicRead(&Progress) / ProgressScale;
+}
+
+void FBitmapJobContext::RaiseProgress(float Value)
+{
+	const int32 NewProgress = FMath::Clamp((int32)(Value * ProgressScale), 0, ProgressScale);
+	int32 OldProgress = FPlatformAtomics::AtomicRead(&Progress);
+	while (NewProgress > OldProgress)
+	{
+		const int32 Seen = FPlatformAtomics::InterlockedCompareExchange(&Progress, NewProgress, OldProgress);
+		if (Seen == OldProgress)
+		{
+			// Only the thread that moved the progress past a percent reports it
+			if (OnProgressStep && (int64)NewProgress * 100 / ProgressScale > (int64)OldProgress * 100 / ProgressScale)
+			{
+				OnProgressStep((float)NewProgress / ProgressScale);
+			}
+			return;
+		}
+		OldProgress = Seen;
+	}
+}
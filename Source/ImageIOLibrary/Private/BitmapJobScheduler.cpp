@@ -0,0 +1,242 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapJobScheduler.h"
+#include "BitmapParallel.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/Async.h"
+
+static TAutoConsoleVariable<int32> CVarImageIOMaxJobs(
+	TEXT("ImageIO.MaxJobs"),
+	0,
+	TEXT("Maximum number of ImageIOLibrary bitmap jobs running at once. 0 allows one per thread the bitmap operations may use (see ImageIO.MaxThreads)."),
+	ECVF_Default);
+
+FBitmapJobScheduler& FBitmapJobScheduler::Get()
+{
+	static FBitmapJobScheduler Scheduler;
+	return Scheduler;
+}
+
+FBitmapJobScheduler::FBitmapJobScheduler()
+	: NumRunning(0)
+	, MostUrgentQueued(NumPriorities)
+{
+}
+
+void FBitmapJobScheduler::Schedule(const TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe>& Context, TUniqueFunction<void(FBitmapDecodeReservation&)>&& Task,
+	int64 DecodeBytes)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FQueuedJob& Job = Queues[(int32)Context->GetPriority()].AddDefaulted_GetRef();
+	Job.Context = Context;
+	Job.Task = MoveTemp(Task);
+	Job.DecodeBytes = DecodeBytes;
+
+	UpdateMostUrgentQueued();
+	Dispatch();
+	InheritIfHeldBack(*Context, DecodeBytes);
+}
+
+void FBitmapJobScheduler::SetPriority(FBitmapJobContext& Context, EBitmapJobPriority Priority)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	const EBitmapJobPriority OldPriority = Context.GetPriority();
+	if (OldPriority == Priority)
+	{
+		return;
+	}
+	Context.SetPriority(Priority);
+
+	TArray<FQueuedJob>& OldQueue = Queues[(int32)OldPriority];
+	for (int32 Index = 0; Index < OldQueue.Num(); Index++)
+	{
+		if (OldQueue[Index].Context.Get() == &Context)
+		{
+			const int64 DecodeBytes = OldQueue[Index].DecodeBytes;
+			Queues[(int32)Priority].Add(MoveTemp(OldQueue[Index]));
+			OldQueue.RemoveAt(Index);
+
+			// Raised to Visible or more, it may take the slot prefetches leave free
+			UpdateMostUrgentQueued();
+			Dispatch();
+			InheritIfHeldBack(Context, DecodeBytes);
+			return;
+		}
+	}
+}
+
+bool FBitmapJobScheduler::Remove(FBitmapJobContext& Context)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	TArray<FQueuedJob>& Queue = Queues[(int32)Context.GetPriority()];
+	for (int32 Index = 0; Index < Queue.Num(); Index++)
+	{
+		if (Queue[Index].Context.Get() == &Context)
+		{
+			Queue.RemoveAt(Index);
+			UpdateMostUrgentQueued();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FBitmapJobScheduler::HasQueuedAbove(EBitmapJobPriority Priority) const
+{
+	return FPlatformAtomics::AtomicRead(&MostUrgentQueued) < (int32)Priority;
+}
+
+bool FBitmapJobScheduler::RunQueuedAbove(const FBitmapJobContext& Yielding)
+{
+	bool bRanAny = false;
+	while (true)
+	{
+		FQueuedJob Job;
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (!Pop((int32)Yielding.GetEffectivePriority(), Job, &Yielding))
+			{
+				return bRanAny;
+			}
+		}
+
+		// Runs as the thread's current job until done, then the preempted one carries on
+		Run(Job);
+		bRanAny = true;
+	}
+}
+
+void FBitmapJobScheduler::OnDecodeMemoryReleased()
+{
+	FScopeLock ScopeLock(&Lock);
+	Dispatch();
+}
+
+int32 FBitmapJobScheduler::GetNumQueuedDecodes()
+{
+	FScopeLock ScopeLock(&Lock);
+
+	int32 NumDecodes = 0;
+	for (const TArray<FQueuedJob>& Queue : Queues)
+	{
+		for (const FQueuedJob& Job : Queue)
+		{
+			NumDecodes += Job.DecodeBytes > 0 ? 1 : 0;
+		}
+	}
+	return NumDecodes;
+}
+
+bool FBitmapJobScheduler::Pop(int32 Priority, FQueuedJob& OutJob, const FBitmapJobContext* Yielding)
+{
+	bool bDecodesHeldBack = false;
+	for (int32 QueuePriority = 0; QueuePriority < Priority; QueuePriority++)
+	{
+		TArray<FQueuedJob>& Queue = Queues[QueuePriority];
+		for (int32 Index = 0; Index < Queue.Num(); Index++)
+		{
+			FQueuedJob& Job = Queue[Index];
+			if (Job.DecodeBytes > 0)
+			{
+				if (bDecodesHeldBack)
+				{
+					continue;
+				}
+
+				// Reserved now rather than by the task, so no thread ever sleeps waiting for it
+				Job.Reservation = FBitmapDecodeReservation::TryReserve(Job.DecodeBytes);
+				if (!Job.Reservation.IsReserved())
+				{
+					// The most urgent decode held back: the running ones it waits on shouldn't give way to less urgent jobs meanwhile,
+					// starting with the rest of this search when it's for one of them
+					PassPriorityToRunningDecodes((EBitmapJobPriority)QueuePriority);
+					if (Yielding)
+					{
+						Priority = FMath::Min(Priority, (int32)Yielding->GetEffectivePriority());
+					}
+					bDecodesHeldBack = true;
+					continue;
+				}
+				RunningDecodes.Add(Job.Context);
+			}
+
+			OutJob = MoveTemp(Job);
+			Queue.RemoveAt(Index);
+			OutJob.Context->MarkStarted();
+			UpdateMostUrgentQueued();
+			return true;
+		}
+	}
+	return false;
+}
+
+void FBitmapJobScheduler::InheritIfHeldBack(const FBitmapJobContext& Context, int64 DecodeBytes)
+{
+	if (DecodeBytes > 0 && !Context.IsStarted() && !FBitmapDecodeBudget::Fits(DecodeBytes))
+	{
+		PassPriorityToRunningDecodes(Context.GetPriority());
+	}
+}
+
+void FBitmapJobScheduler::PassPriorityToRunningDecodes(EBitmapJobPriority Priority)
+{
+	for (const TSharedPtr<FBitmapJobContext, ESPMode::ThreadSafe>& Running : RunningDecodes)
+	{
+		Running->InheritPriority(Priority);
+	}
+}
+
+void FBitmapJobScheduler::Dispatch()
+{
+	const int32 MaxJobsSetting = CVarImageIOMaxJobs.GetValueOnAnyThread();
+	const int32 MaxJobs = MaxJobsSetting > 0 ? MaxJobsSetting : FBitmapParallel::GetNumWorkers();
+
+	// With a single slot there is nothing to keep free: prefetches would never run
+	const int32 NumReserved = MaxJobs > 1 ? 1 : 0;
+
+	while (NumRunning < MaxJobs)
+	{
+		const int32 Priority = NumRunning < MaxJobs - NumReserved ? NumPriorities : (int32)EBitmapJobPriority::Prefetch;
+
+		FQueuedJob Job;
+		if (!Pop(Priority, Job))
+		{
+			return;
+		}
+
+		NumRunning++;
+		Async(EAsyncExecution::ThreadPool, [this, Job = MoveTemp(Job)]() mutable
+		{
+			Run(Job);
+
+			FScopeLock ScopeLock(&Lock);
+			NumRunning--;
+			Dispatch();
+		});
+	}
+}
+
+void FBitmapJobScheduler::Run(FQueuedJob& Job)
+{
+	Job.Task(Job.Reservation);
+
+	if (Job.DecodeBytes > 0)
+	{
+		FScopeLock ScopeLock(&Lock);
+		RunningDecodes.RemoveSingleSwap(Job.Context);
+	}
+	Job = FQueuedJob();
+}
+
+void FBitmapJobScheduler::UpdateMostUrgentQueued()
+{
+	int32 Priority = 0;
+	while (Priority < NumPriorities && Queues[Priority].Num() == 0)
+	{
+		Priority++;
+	}
+	FPlatformAtomics::InterlockedExchange(&MostUrgentQueued, Priority);
+}
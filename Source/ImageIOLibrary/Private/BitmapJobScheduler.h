@@ -0,0 +1,105 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Decides when bitmap jobs run. Jobs wait in one queue per priority and are started on the thread pool, most urgent first, while fewer than
+// ImageIO.MaxJobs run. Prefetch and Background jobs leave the last slot free, so a bulk export never holds every thread when something on
+// screen needs one. A job queued while lower priority jobs hold every slot doesn't wait for them either: they run it on their own thread
+// between two batches of their rows or tiles (see FBitmapJobContext::YieldToHigherPriority), and resume once it's done.
+// Jobs that decode image files are only started once their decode memory fits in the budget (see FBitmapDecodeBudget), which they then hold
+// from the start. The oldest that doesn't fit holds back the decodes queued after it, so a stream of small files can't starve a big one, while
+// jobs that don't decode run past it. What it waits for can be held by running jobs of a lower priority: those inherit its priority until
+// they're done, so they stop giving their threads to jobs less urgent than the one waiting on them.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "BitmapJobContext.h"
+#include "BitmapDecodeBudget.h"
+
+class FBitmapJobScheduler
+{
+public:
+
+	static FBitmapJobScheduler& Get();
+
+	/* Queues Task, to be run on the thread pool when its turn comes. Context holds the priority and is marked started once Task is taken.
+	@param DecodeBytes	Decode memory the job needs, see FBitmapDecodeBudget::EstimateDecodeBytes. The job isn't started before it fits, and
+						Task is handed the reservation. 0 for jobs that don't decode.
+	*/
+	void Schedule(const TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe>& Context, TUniqueFunction<void(FBitmapDecodeReservation&)>&& Task, int64 DecodeBytes = 0);
+
+	/* Changes the priority of a job. A queued job moves to the back of its new queue, a running one can be preempted by what it no longer
+	outranks and stops preempting what it no longer outranks.
+	*/
+	void SetPriority(FBitmapJobContext& Context, EBitmapJobPriority Priority);
+
+	/* Takes a job out of its queue. Returns false when a thread already took it: the task runs, and has to be cancelled instead. */
+	bool Remove(FBitmapJobContext& Context);
+
+	/* Whether a job more urgent than Priority waits. Lock free. */
+	bool HasQueuedAbove(EBitmapJobPriority Priority) const;
+
+	/* Runs the queued jobs more urgent than Yielding, the job the calling thread works for, on that thread until there are none left that fit
+	in the decode memory. Yielding's effective priority is read again before each job, as the decodes held back meanwhile can raise it.
+	Returns whether any ran.
+	*/
+	bool RunQueuedAbove(const FBitmapJobContext& Yielding);
+
+	/* Starts the queued jobs that were held back for decode memory, now that some was given back. */
+	void OnDecodeMemoryReleased();
+
+	/* Jobs that decode and haven't been started yet, for want of a slot or of decode memory. */
+	int32 GetNumQueuedDecodes();
+
+private:
+
+	struct FQueuedJob
+	{
+		TSharedPtr<FBitmapJobContext, ESPMode::ThreadSafe> Context;
+		TUniqueFunction<void(FBitmapDecodeReservation&)> Task;
+		int64 DecodeBytes = 0;
+
+		// Made when the job is taken out of its queue
+		FBitmapDecodeReservation Reservation;
+	};
+
+	static const int32 NumPriorities = (int32)EBitmapJobPriority::Background + 1;
+
+	FBitmapJobScheduler();
+
+	/* Takes the oldest of the most urgent jobs more urgent than Priority (NumPriorities for any) out of the queues, skipping the decodes the
+	decode memory can't take now. The running decodes take on the priority of the most urgent of those, and when Yielding is one of them,
+	jobs less urgent than its new priority are no longer taken. Call with Lock held.
+	*/
+	bool Pop(int32 Priority, FQueuedJob& OutJob, const FBitmapJobContext* Yielding = nullptr);
+
+	/* Passes the priority of a queued decode that can't fit next to the running ones to them. Pop does it when a slot is free, this covers
+	the decodes queued or raised while none is, which Pop won't see before one frees up. Call with Lock held.
+	*/
+	void InheritIfHeldBack(const FBitmapJobContext& Context, int64 DecodeBytes);
+
+	/* Raises the running decodes to Priority until they're done. Call with Lock held. */
+	void PassPriorityToRunningDecodes(EBitmapJobPriority Priority);
+
+	/* Runs a job taken by Pop and forgets it as a running decode. Call without Lock. */
+	void Run(FQueuedJob& Job);
+
+	/* Starts queued jobs on the thread pool while there are free slots. Call with Lock held. */
+	void Dispatch();
+
+	/* Call with Lock held, after any change to the queues. */
+	void UpdateMostUrgentQueued();
+
+	FCriticalSection Lock;
+
+	TArray<FQueuedJob> Queues[NumPriorities];
+
+	// Jobs started by Dispatch and not done yet. Jobs run by RunQueuedAbove borrow the slot of the job they preempt.
+	int32 NumRunning;
+
+	// Running jobs that hold decode memory, which held back decodes pass their priority to
+	TArray<TSharedPtr<FBitmapJobContext, ESPMode::ThreadSafe>> RunningDecodes;
+
+	// Priority of the most urgent queued job, NumPriorities when none. Written with Lock held, read without.
+	volatile int32 MostUrgentQueued;
+};
@@ -0,0 +1,66 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Runs a 1D filter over every line of an image and writes the result transposed. Running it twice filters rows then columns
+// while both passes only ever read contiguous memory, which is what makes the vertical pass of big images cheap.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BitmapParallel.h"
+#include "BitmapView.h"
+
+struct FBitmapLinePass
+{
+	// Lines filtered before they get transposed together, so each transposed write is a contiguous run of BandSize values
+	static const int32 BandSize = 8;
+
+	/* Filters each row of Src (Src.Height lines of Src.Width values) into Dst.Height values and writes the results transposed: value I of
+	line L ends up at Dst.GetRow(I)[L], so Dst is Src.Height wide. Either view may be a rectangle of a bigger buffer.
+	MakeLineFilter() is called once per thread and returns the line filter, a callable (const InType* Line, ScratchType* Result) that can keep its own scratch buffers.
+	Convert(const ScratchType&) turns the filtered values into the output type while they are transposed.
+	*/
+	template<typename InType, typename ScratchType, typename OutType, typename MakeLineFilterType, typename ConvertType>
+	static void Run(TBitmapView<const InType> Src, TBitmapView<OutType> Dst, const MakeLineFilterType& MakeLineFilter, const ConvertType& Convert)
+	{
+		check(Dst.Width == Src.Height);
+
+		const int32 NumLines = Src.Height;
+		const int32 OutLength = Dst.Height;
+		const int32 NumBands = FMath::DivideAndRoundUp(NumLines, BandSize);
+
+		FBitmapParallel::ForRange(NumBands, 1, [&](int32 StartBand, int32 EndBand)
+		{
+			auto LineFilter = MakeLineFilter();
+
+			TArray<ScratchType> Scratch;
+			Scratch.SetNumUninitialized(OutLength * BandSize);
+
+			for (int32 Band = StartBand; Band < EndBand; Band++)
+			{
+				const int32 FirstLine = Band * BandSize;
+				const int32 NumBandLines = FMath::Min(BandSize, NumLines - FirstLine);
+
+				for (int32 Line = 0; Line < NumBandLines; Line++)
+				{
+					LineFilter(Src.GetRow(FirstLine + Line), Scratch.GetData() + Line * OutLength);
+				}
+
+				for (int32 Index = 0; Index < OutLength; Index++)
+				{
+					OutType* Out = Dst.GetRow(Index) + FirstLine;
+					for (int32 Line = 0; Line < NumBandLines; Line++)
+					{
+						Out[Line] = Convert(Scratch[Line * OutLength + Index]);
+					}
+				}
+			}
+		});
+	}
+
+	/* Same as above when the line filter already produces the output type. */
+	template<typename InType, typename OutType, typename MakeLineFilterType>
+	static void Run(TBitmapView<const InType> Src, TBitmapView<OutType> Dst, const MakeLineFilterType& MakeLineFilter)
+	{
+		Run<InType, OutType, OutType>(Src, Dst, MakeLineFilter, [](const OutType& Value) { return Value; });
+	}
+};
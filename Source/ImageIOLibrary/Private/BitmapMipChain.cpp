@@ -0,0 +1,197 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapMipChain.h"
+#include "BitmapColourSpace.h"
+#include "BitmapParallel.h"
+#include "BitmapSimd.h"
+
+namespace
+{
+	// Channels of a pixel, alpha last
+	const int32 MipChannels = 4;
+
+	/* Source rows and columns averaged into an output row or column: 2 of them, 3 for the last one when the input length is odd, 1 when it's already 1. */
+	FORCEINLINE int32 GetMipFootprint(int32 OutIndex, int32 OutLength, int32 InLength)
+	{
+		if (InLength == 1)
+		{
+			return 1;
+		}
+		return OutIndex == OutLength - 1 && (InLength & 1) ? 3 : 2;
+	}
+
+	/* Averages NumRows rows of InWidth 16 bit pixels into OutWidth pixels. */
+	void DownsampleMipRow(const uint16* const* Rows, int32 NumRows, int32 InWidth, uint16* Out, int32 OutWidth)
+	{
+		int32 X = 0;
+
+#if IMAGEIO_WITH_SSE2
+		// Plain 2x2 blocks, 2 output pixels (4 input pixels of each row) at a time
+		if (NumRows == 2 && InWidth > 1)
+		{
+			const int32 NumPlain = (InWidth & 1) ? OutWidth - 1 : OutWidth;
+			const uint16* Top = Rows[0];
+			const uint16* Bottom = Rows[1];
+			for (; X + 2 <= NumPlain; X += 2)
+			{
+				const int32 In = X * 2 * MipChannels;
+				const __m128i Left = _mm_avg_epu16(_mm_loadu_si128((const __m128i*)(Top + In)), _mm_loadu_si128((const __m128i*)(Bottom + In)));
+				const __m128i Right = _mm_avg_epu16(_mm_loadu_si128((const __m128i*)(Top + In + 8)), _mm_loadu_si128((const __m128i*)(Bottom + In + 8)));
+				const __m128i Even = _mm_unpacklo_epi64(Left, Right);
+				const __m128i Odd = _mm_unpackhi_epi64(Left, Right);
+				_mm_storeu_si128((__m128i*)(Out + X * MipChannels), _mm_avg_epu16(Even, Odd));
+			}
+		}
+#endif
+
+		for (; X < OutWidth; X++)
+		{
+			const int32 NumColumns = GetMipFootprint(X, OutWidth, InWidth);
+			const int32 Count = NumColumns * NumRows;
+			for (int32 Channel = 0; Channel < MipChannels; Channel++)
+			{
+				uint32 Sum = 0;
+				for (int32 Row = 0; Row < NumRows; Row++)
+				{
+					const uint16* Source = Rows[Row] + X * 2 * MipChannels + Channel;
+					for (int32 Column = 0; Column < NumColumns; Column++)
+					{
+						Sum += Source[Column * MipChannels];
+					}
+				}
+				Out[X * MipChannels + Channel] = (uint16)((Sum + Count / 2) / Count);
+			}
+		}
+	}
+
+	/* Turns the 16 bit values of a level back into 8 bit pixels. */
+	struct FMipEncoding
+	{
+		// Null when the colours aren't sRGB
+		const uint8* LinearToSRGB;
+
+		void EncodeRow(const uint16* In, uint8* Out, int32 Width) const
+		{
+			for (int32 Index = 0; Index < Width * MipChannels; Index += MipChannels)
+			{
+				for (int32 Channel = 0; Channel < MipChannels - 1; Channel++)
+				{
+					Out[Index + Channel] = LinearToSRGB ? BitmapColourSpace::LinearToSRGB(LinearToSRGB, In[Index + Channel] * (1.0f / 65535.0f)) : (uint8)((In[Index + Channel] + 128) / 257);
+				}
+				Out[Index + 3] = (uint8)((In[Index + 3] + 128) / 257);
+			}
+		}
+	};
+
+	/* Builds one level from the level above, which GetRow(Y, Scratch) hands out one row at a time. Rows are written to Out16 (unless null) and,
+	encoded, to Out8.
+	*/
+	template<typename GetRowType>
+	void DownsampleMipLevel(FImageSize InSize, FImageSize OutSize, const GetRowType& GetRow, uint16* Out16, FColor* Out8, const FMipEncoding& Encoding)
+	{
+		// Small levels aren't worth spreading across threads
+		const int32 MinBatch = FMath::Max(1, 16384 / OutSize.X);
+
+		FBitmapParallel::ForRange(OutSize.Y, MinBatch, [&](int32 Start, int32 End)
+		{
+			TArray<uint16> Scratch;
+			Scratch.SetNumUninitialized(3 * InSize.X * MipChannels);
+			TArray<uint16> Row;
+			Row.SetNumUninitialized(OutSize.X * MipChannels);
+
+			for (int32 Y = Start; Y < End; Y++)
+			{
+				const int32 NumRows = GetMipFootprint(Y, OutSize.Y, InSize.Y);
+				const uint16* Rows[3];
+				for (int32 Index = 0; Index < NumRows; Index++)
+				{
+					Rows[Index] = GetRow(Y * 2 + Index, Scratch.GetData() + Index * InSize.X * MipChannels);
+				}
+
+				uint16* Out = Out16 ? Out16 + (int64)Y * OutSize.X * MipChannels : Row.GetData();
+				DownsampleMipRow(Rows, NumRows, InSize.X, Out, OutSize.X);
+				Encoding.EncodeRow(Out, (uint8*)(Out8 + (int64)Y * OutSize.X), OutSize.X);
+			}
+		});
+	}
+}
+
+int32 FBitmapMipChain::GetNumMips(FImageSize Size)
+{
+	return FMath::FloorLog2((uint32)FMath::Max(FMath::Max(Size.X, Size.Y), 1)) + 1;
+}
+
+FImageSize FBitmapMipChain::GetMipSize(FImageSize Size, int32 MipIndex)
+{
+	FImageSize MipSize;
+	MipSize.X = FMath::Max(Size.X >> MipIndex, 1);
+	MipSize.Y = FMath::Max(Size.Y >> MipIndex, 1);
+	return MipSize;
+}
+
+void FBitmapMipChain::Generate(FConstBitmapView Pixels, bool bSRGB, const TArray<FColor*>& Mips)
+{
+	const FImageSize Size = Pixels.GetSize();
+	if (Size.X <= 0 || Size.Y <= 0)
+	{
+		return;
+	}
+
+	const int32 NumLevels = FMath::Min(Mips.Num(), GetNumMips(Size) - 1);
+	if (NumLevels <= 0)
+	{
+		return;
+	}
+
+	// Level 0 is decoded to 16 bits a row at a time as it's read
+	uint16 Decode[256];
+	const float* SRGBToLinear = bSRGB ? BitmapColourSpace::GetSRGBToLinearTable() : nullptr;
+	for (int32 Value = 0; Value < 256; Value++)
+	{
+		Decode[Value] = SRGBToLinear ? (uint16)(SRGBToLinear[Value] * 65535.0f + 0.5f) : (uint16)(Value * 257);
+	}
+
+	FMipEncoding Encoding;
+	Encoding.LinearToSRGB = bSRGB ? BitmapColourSpace::GetLinearToSRGBTable() : nullptr;
+
+	// Every level but the last is also kept in 16 bits for the next one, in two buffers taking turns
+	TArray<uint16> Levels[2];
+	FImageSize InSize = Size;
+
+	for (int32 Level = 0; Level < NumLevels; Level++)
+	{
+		const FImageSize OutSize = GetMipSize(Size, Level + 1);
+		TArray<uint16>& Out16 = Levels[Level & 1];
+		if (Level + 1 < NumLevels)
+		{
+			Out16.SetNumUninitialized(OutSize.X * OutSize.Y * MipChannels);
+		}
+		uint16* Out16Data = Level + 1 < NumLevels ? Out16.GetData() : nullptr;
+
+		if (Level == 0)
+		{
+			DownsampleMipLevel(InSize, OutSize, [&](int32 Y, uint16* Scratch) -> const uint16*
+			{
+				const uint8* Row = (const uint8*)Pixels.GetRow(Y);
+				for (int32 Index = 0; Index < InSize.X * MipChannels; Index += MipChannels)
+				{
+					Scratch[Index] = Decode[Row[Index]];
+					Scratch[Index + 1] = Decode[Row[Index + 1]];
+					Scratch[Index + 2] = Decode[Row[Index + 2]];
+					Scratch[Index + 3] = (uint16)(Row[Index + 3] * 257);
+				}
+				return Scratch;
+			}, Out16Data, Mips[Level], Encoding);
+		}
+		else
+		{
+			const uint16* In16 = Levels[(Level - 1) & 1].GetData();
+			DownsampleMipLevel(InSize, OutSize, [&](int32 Y, uint16* Scratch) -> const uint16*
+			{
+				return In16 + (int64)Y * InSize.X * MipChannels;
+			}, Out16Data, Mips[Level], Encoding);
+		}
+
+		InSize = OutSize;
+	}
+}
@@ -0,0 +1,502 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapMorphology.h"
+#include "BitmapParallel.h"
+#include "BitmapChannels.h"
+#include "BitmapSimd.h"
+
+namespace
+{
+	// Bytes of each row a thread filters at once. The rows of a block stay in cache while the block's prefix and suffix are built
+	const int32 MorphologyStripBytes = 256;
+
+	// Rows and columns transposed together
+	const int32 MorphologyTransposeTile = 32;
+
+	struct FMorphologyMin
+	{
+		static const uint8 Identity = 255;
+
+		static FORCEINLINE uint8 Apply(uint8 A, uint8 B) { return FMath::Min(A, B); }
+
+#if IMAGEIO_WITH_SSE2
+		static FORCEINLINE __m128i Apply(__m128i A, __m128i B) { return _mm_min_epu8(A, B); }
+#endif
+	};
+
+	struct FMorphologyMax
+	{
+		static const uint8 Identity = 0;
+
+		static FORCEINLINE uint8 Apply(uint8 A, uint8 B) { return FMath::Max(A, B); }
+
+#if IMAGEIO_WITH_SSE2
+		static FORCEINLINE __m128i Apply(__m128i A, __m128i B) { return _mm_max_epu8(A, B); }
+#endif
+	};
+
+	/* Dst = Op(A, B) byte by byte, Dst may be A or B. */
+	template<typename OpType>
+	FORCEINLINE void CombineMorphologyRows(uint8* Dst, const uint8* A, const uint8* B, int32 NumBytes)
+	{
+		int32 Index = 0;
+#if IMAGEIO_WITH_SSE2
+		for (; Index + 16 <= NumBytes; Index += 16)
+		{
+			const __m128i ValuesA = _mm_loadu_si128((const __m128i*)(A + Index));
+			const __m128i ValuesB = _mm_loadu_si128((const __m128i*)(B + Index));
+			_mm_storeu_si128((__m128i*)(Dst + Index), OpType::Apply(ValuesA, ValuesB));
+		}
+#endif
+		for (; Index < NumBytes; Index++)
+		{
+			Dst[Index] = OpType::Apply(A[Index], B[Index]);
+		}
+	}
+
+	/* Van Herk / Gil-Werman along the columns of Height rows of RowBytes bytes: each output byte is Op over the 2 * Radius + 1 bytes around it in its column.
+	The column is cut in blocks of 2 * Radius + 1 rows, so every window is the end of one block (a suffix) followed by the start of the next (a prefix).
+	Building both and combining them costs 3 Op per byte whatever the radius. Src rows are SrcStride bytes apart, Dst rows RowBytes. Src and Dst can't alias.
+	*/
+	template<typename OpType>
+	void MorphologyColumns(const uint8* Src, int64 SrcStride, int32 RowBytes, int32 Height, int32 Radius, uint8* Dst)
+	{
+		const int32 BlockRows = 2 * Radius + 1;
+		const int32 NumStrips = FMath::DivideAndRoundUp(RowBytes, MorphologyStripBytes);
+
+		FBitmapParallel::ForRange(NumStrips, 1, [&](int32 StartStrip, int32 EndStrip)
+		{
+			// Stands in for the rows past the edges, so they never win
+			TArray<uint8> IdentityRow;
+			IdentityRow.Init((uint8)OpType::Identity, MorphologyStripBytes);
+
+			TArray<uint8> Suffixes;
+			Suffixes.SetNumUninitialized(BlockRows * MorphologyStripBytes);
+			TArray<uint8> Prefix;
+			Prefix.SetNumUninitialized(MorphologyStripBytes);
+
+			for (int32 Strip = StartStrip; Strip < EndStrip; Strip++)
+			{
+				const int32 FirstByte = Strip * MorphologyStripBytes;
+				const int32 NumBytes = FMath::Min(MorphologyStripBytes, RowBytes - FirstByte);
+
+				// Row of the image padded with Radius rows of identity above and below it
+				auto PaddedRow = [&](int32 Row) -> const uint8*
+				{
+					const int32 ImageRow = Row - Radius;
+					return ImageRow >= 0 && ImageRow < Height ? Src + ImageRow * SrcStride + FirstByte : IdentityRow.GetData();
+				};
+
+				for (int32 BlockStart = 0; BlockStart < Height; BlockStart += BlockRows)
+				{
+					// Suffix J is Op over rows BlockStart + J to the end of the block
+					uint8* Suffix = Suffixes.GetData();
+					FMemory::Memcpy(Suffix + (BlockRows - 1) * MorphologyStripBytes, PaddedRow(BlockStart + BlockRows - 1), NumBytes);
+					for (int32 J = BlockRows - 2; J >= 0; J--)
+					{
+						CombineMorphologyRows<OpType>(Suffix + J * MorphologyStripBytes, PaddedRow(BlockStart + J), Suffix + (J + 1) * MorphologyStripBytes, NumBytes);
+					}
+
+					// Output row BlockStart + J covers padded rows BlockStart + J to BlockStart + J + 2 * Radius: suffix J and the next block's first J rows
+					const int32 NumOutputs = FMath::Min(BlockRows, Height - BlockStart);
+					FMemory::Memcpy(Dst + (int64)BlockStart * RowBytes + FirstByte, Suffix, NumBytes);
+					for (int32 J = 1; J < NumOutputs; J++)
+					{
+						const uint8* NextRow = PaddedRow(BlockStart + BlockRows + J - 1);
+						if (J == 1)
+						{
+							FMemory::Memcpy(Prefix.GetData(), NextRow, NumBytes);
+						}
+						else
+						{
+							CombineMorphologyRows<OpType>(Prefix.GetData(), Prefix.GetData(), NextRow, NumBytes);
+						}
+						CombineMorphologyRows<OpType>(Dst + (int64)(BlockStart + J) * RowBytes + FirstByte, Suffix + J * MorphologyStripBytes, Prefix.GetData(), NumBytes);
+					}
+				}
+			}
+		});
+	}
+
+	/* Square blocks transposed in registers: 16x16 bytes for single channel planes, 4x4 pixels otherwise. */
+	template<typename ElementType>
+	struct TMorphologyTransposeBlock;
+
+	template<>
+	struct TMorphologyTransposeBlock<uint8>
+	{
+		static const int32 Size = 16;
+
+		static void Transpose(const uint8* Src, int32 SrcStride, uint8* Dst, int32 DstStride)
+		{
+#if IMAGEIO_WITH_SSE2
+			__m128i Rows[16];
+			for (int32 Row = 0; Row < 16; Row++)
+			{
+				Rows[Row] = _mm_loadu_si128((const __m128i*)(Src + (int64)Row * SrcStride));
+			}
+
+			// Each step doubles the run of consecutive rows every column holds: 2 rows of 8 columns per register, then 4 rows, 8 rows and 16 rows
+			__m128i Pairs[16];
+			for (int32 Index = 0; Index < 8; Index++)
+			{
+				Pairs[Index] = _mm_unpacklo_epi8(Rows[2 * Index], Rows[2 * Index + 1]);
+				Pairs[Index + 8] = _mm_unpackhi_epi8(Rows[2 * Index], Rows[2 * Index + 1]);
+			}
+
+			__m128i Quads[16];
+			for (int32 Half = 0; Half < 2; Half++)
+			{
+				for (int32 Index = 0; Index < 4; Index++)
+				{
+					Quads[Half * 8 + Index] = _mm_unpacklo_epi16(Pairs[Half * 8 + 2 * Index], Pairs[Half * 8 + 2 * Index + 1]);
+					Quads[Half * 8 + Index + 4] = _mm_unpackhi_epi16(Pairs[Half * 8 + 2 * Index], Pairs[Half * 8 + 2 * Index + 1]);
+				}
+			}
+
+			// Quads[4 * Group + I] holds rows 4 * I to 4 * I + 3 of columns 4 * Group to 4 * Group + 3
+			for (int32 Group = 0; Group < 4; Group++)
+			{
+				const __m128i* Quad = Quads + 4 * Group;
+				const __m128i Low01 = _mm_unpacklo_epi32(Quad[0], Quad[1]);
+				const __m128i High01 = _mm_unpackhi_epi32(Quad[0], Quad[1]);
+				const __m128i Low23 = _mm_unpacklo_epi32(Quad[2], Quad[3]);
+				const __m128i High23 = _mm_unpackhi_epi32(Quad[2], Quad[3]);
+
+				uint8* Column = Dst + (int64)(4 * Group) * DstStride;
+				_mm_storeu_si128((__m128i*)Column, _mm_unpacklo_epi64(Low01, Low23));
+				_mm_storeu_si128((__m128i*)(Column + DstStride), _mm_unpackhi_epi64(Low01, Low23));
+				_mm_storeu_si128((__m128i*)(Column + 2 * DstStride), _mm_unpacklo_epi64(High01, High23));
+				_mm_storeu_si128((__m128i*)(Column + 3 * DstStride), _mm_unpackhi_epi64(High01, High23));
+			}
+#else
+			for (int32 X = 0; X < Size; X++)
+			{
+				for (int32 Y = 0; Y < Size; Y++)
+				{
+					Dst[(int64)X * DstStride + Y] = Src[(int64)Y * SrcStride + X];
+				}
+			}
+#endif
+		}
+	};
+
+	template<>
+	struct TMorphologyTransposeBlock<FColor>
+	{
+		static const int32 Size = 4;
+
+		static void Transpose(const FColor* Src, int32 SrcStride, FColor* Dst, int32 DstStride)
+		{
+#if IMAGEIO_WITH_SSE2
+			const __m128i Row0 = _mm_loadu_si128((const __m128i*)Src);
+			const __m128i Row1 = _mm_loadu_si128((const __m128i*)(Src + SrcStride));
+			const __m128i Row2 = _mm_loadu_si128((const __m128i*)(Src + 2 * SrcStride));
+			const __m128i Row3 = _mm_loadu_si128((const __m128i*)(Src + 3 * SrcStride));
+
+			const __m128i Low01 = _mm_unpacklo_epi32(Row0, Row1);
+			const __m128i High01 = _mm_unpackhi_epi32(Row0, Row1);
+			const __m128i Low23 = _mm_unpacklo_epi32(Row2, Row3);
+			const __m128i High23 = _mm_unpackhi_epi32(Row2, Row3);
+
+			_mm_storeu_si128((__m128i*)Dst, _mm_unpacklo_epi64(Low01, Low23));
+			_mm_storeu_si128((__m128i*)(Dst + DstStride), _mm_unpackhi_epi64(Low01, Low23));
+			_mm_storeu_si128((__m128i*)(Dst + 2 * DstStride), _mm_unpacklo_epi64(High01, High23));
+			_mm_storeu_si128((__m128i*)(Dst + 3 * DstStride), _mm_unpackhi_epi64(High01, High23));
+#else
+			for (int32 X = 0; X < Size; X++)
+			{
+				for (int32 Y = 0; Y < Size; Y++)
+				{
+					Dst[(int64)X * DstStride + Y] = Src[(int64)Y * SrcStride + X];
+				}
+			}
+#endif
+		}
+	};
+
+	/* Dst[X * Height + Y] = Src[Y * SrcPitch + X], a tile at a time so both sides stay in cache. */
+	template<typename ElementType>
+	void TransposeMorphologyPlane(const ElementType* Src, int32 SrcPitch, int32 Width, int32 Height, ElementType* Dst)
+	{
+		typedef TMorphologyTransposeBlock<ElementType> FBlock;
+		const int32 NumTileRows = FMath::DivideAndRoundUp(Height, MorphologyTransposeTile);
+
+		FBitmapParallel::ForRange(NumTileRows, 1, [&](int32 StartTileRow, int32 EndTileRow)
+		{
+			for (int32 TileRow = StartTileRow; TileRow < EndTileRow; TileRow++)
+			{
+				const int32 FirstY = TileRow * MorphologyTransposeTile;
+				const int32 LastY = FMath::Min(FirstY + MorphologyTransposeTile, Height);
+
+				for (int32 FirstX = 0; FirstX < Width; FirstX += MorphologyTransposeTile)
+				{
+					const int32 LastX = FMath::Min(FirstX + MorphologyTransposeTile, Width);
+
+					for (int32 BlockY = FirstY; BlockY < LastY; BlockY += FBlock::Size)
+					{
+						for (int32 BlockX = FirstX; BlockX < LastX; BlockX += FBlock::Size)
+						{
+							if (BlockX + FBlock::Size <= LastX && BlockY + FBlock::Size <= LastY)
+							{
+								FBlock::Transpose(Src + (int64)BlockY * SrcPitch + BlockX, SrcPitch, Dst + (int64)BlockX * Height + BlockY, Height);
+								continue;
+							}
+
+							// Partial blocks along the right and bottom edges
+							for (int32 X = BlockX; X < FMath::Min(BlockX + FBlock::Size, LastX); X++)
+							{
+								for (int32 Y = BlockY; Y < FMath::Min(BlockY + FBlock::Size, LastY); Y++)
+								{
+									Dst[(int64)X * Height + Y] = Src[(int64)Y * SrcPitch + X];
+								}
+							}
+						}
+					}
+				}
+			}
+		});
+	}
+
+	/* Erosion (FMorphologyMin) or dilation (FMorphologyMax) of a Width x Height plane: columns first, then rows as the columns of the transposed plane.
+	Src rows are SrcPitch elements apart, Dst is contiguous. Src may be Dst when SrcPitch is Width.
+	*/
+	template<typename OpType, typename ElementType>
+	void ErodeOrDilate(const ElementType* Src, int32 SrcPitch, int32 Width, int32 Height, int32 RadiusX, int32 RadiusY, ElementType* Dst)
+	{
+		const int64 NumElements = (int64)Width * Height;
+		const int64 SrcStride = (int64)SrcPitch * sizeof(ElementType);
+
+		if (RadiusX == 0 && RadiusY == 0)
+		{
+			if (Src != Dst)
+			{
+				for (int32 Y = 0; Y < Height; Y++)
+				{
+					FMemory::Memcpy(Dst + (int64)Y * Width, Src + (int64)Y * SrcPitch, Width * sizeof(ElementType));
+				}
+			}
+			return;
+		}
+
+		TArray<ElementType> Filtered;
+		Filtered.SetNumUninitialized(NumElements);
+
+		if (RadiusX == 0)
+		{
+			MorphologyColumns<OpType>((const uint8*)Src, SrcStride, Width * sizeof(ElementType), Height, RadiusY, (uint8*)Filtered.GetData());
+			FMemory::Memcpy(Dst, Filtered.GetData(), NumElements * sizeof(ElementType));
+			return;
+		}
+
+		TArray<ElementType> Transposed;
+		Transposed.SetNumUninitialized(NumElements);
+
+		if (RadiusY == 0)
+		{
+			TransposeMorphologyPlane(Src, SrcPitch, Width, Height, Transposed.GetData());
+		}
+		else
+		{
+			MorphologyColumns<OpType>((const uint8*)Src, SrcStride, Width * sizeof(ElementType), Height, RadiusY, (uint8*)Filtered.GetData());
+			TransposeMorphologyPlane(Filtered.GetData(), Width, Width, Height, Transposed.GetData());
+		}
+
+		MorphologyColumns<OpType>((const uint8*)Transposed.GetData(), Height * sizeof(ElementType), Height * sizeof(ElementType), Width, RadiusX, (uint8*)Filtered.GetData());
+		TransposeMorphologyPlane(Filtered.GetData(), Height, Height, Width, Dst);
+	}
+
+	/* Dst = Dst - Subtrahend byte by byte, saturating at 0. */
+	void SubtractMorphologyPlane(uint8* Dst, const uint8* Subtrahend, int64 NumBytes)
+	{
+		const int32 BatchBytes = 64 * 1024;
+		const int32 NumBatches = (int32)((NumBytes + BatchBytes - 1) / BatchBytes);
+
+		FBitmapParallel::ForRange(NumBatches, 1, [&](int32 StartBatch, int32 EndBatch)
+		{
+			const int64 First = (int64)StartBatch * BatchBytes;
+			const int64 Last = FMath::Min<int64>((int64)EndBatch * BatchBytes, NumBytes);
+
+			int64 Index = First;
+#if IMAGEIO_WITH_SSE2
+			for (; Index + 16 <= Last; Index += 16)
+			{
+				const __m128i Values = _mm_loadu_si128((const __m128i*)(Dst + Index));
+				const __m128i Subtracted = _mm_loadu_si128((const __m128i*)(Subtrahend + Index));
+				_mm_storeu_si128((__m128i*)(Dst + Index), _mm_subs_epu8(Values, Subtracted));
+			}
+#endif
+			for (; Index < Last; Index++)
+			{
+				Dst[Index] = (uint8)FMath::Max((int32)Dst[Index] - Subtrahend[Index], 0);
+			}
+		});
+	}
+
+	/* Src rows are SrcPitch elements apart, Dst is a contiguous Width x Height plane. Src may be Dst when SrcPitch is Width. */
+	template<typename ElementType>
+	void ApplyMorphologyToPlane(const ElementType* Src, int32 SrcPitch, int32 Width, int32 Height, EBitmapMorphologyOperation Operation, int32 RadiusX, int32 RadiusY, ElementType* Dst)
+	{
+		switch (Operation)
+		{
+		case EBitmapMorphologyOperation::Erode:
+			ErodeOrDilate<FMorphologyMin>(Src, SrcPitch, Width, Height, RadiusX, RadiusY, Dst);
+			break;
+
+		case EBitmapMorphologyOperation::Dilate:
+			ErodeOrDilate<FMorphologyMax>(Src, SrcPitch, Width, Height, RadiusX, RadiusY, Dst);
+			break;
+
+		case EBitmapMorphologyOperation::Open:
+			ErodeOrDilate<FMorphologyMin>(Src, SrcPitch, Width, Height, RadiusX, RadiusY, Dst);
+			ErodeOrDilate<FMorphologyMax>(Dst, Width, Width, Height, RadiusX, RadiusY, Dst);
+			break;
+
+		case EBitmapMorphologyOperation::Close:
+			ErodeOrDilate<FMorphologyMax>(Src, SrcPitch, Width, Height, RadiusX, RadiusY, Dst);
+			ErodeOrDilate<FMorphologyMin>(Dst, Width, Width, Height, RadiusX, RadiusY, Dst);
+			break;
+
+		case EBitmapMorphologyOperation::Gradient:
+		{
+			TArray<ElementType> Eroded;
+			Eroded.SetNumUninitialized((int64)Width * Height);
+			ErodeOrDilate<FMorphologyMin>(Src, SrcPitch, Width, Height, RadiusX, RadiusY, Eroded.GetData());
+			ErodeOrDilate<FMorphologyMax>(Src, SrcPitch, Width, Height, RadiusX, RadiusY, Dst);
+			SubtractMorphologyPlane((uint8*)Dst, (const uint8*)Eroded.GetData(), (int64)Width * Height * sizeof(ElementType));
+			break;
+		}
+		}
+	}
+
+	/* Turns the filtered pixels into the output for a channel selection known at compile time (see BitmapChannels::TChannelSelect). */
+	template<EFilterColourChannel ColourChannel>
+	void FinishMorphologyPixels(const FColor* Filtered, FBitmapView Dst)
+	{
+		FBitmapParallel::ForRange(Dst.Height, 16, [&](int32 StartY, int32 EndY)
+		{
+			for (int32 Y = StartY; Y < EndY; Y++)
+			{
+				const FColor* FilteredRow = Filtered + (int64)Y * Dst.Width;
+				FColor* DstRow = Dst.GetRow(Y);
+				for (int32 X = 0; X < Dst.Width; X++)
+				{
+					DstRow[X] = BitmapChannels::FinishFilteredPixel<ColourChannel>(FilteredRow[X]);
+				}
+			}
+		});
+	}
+
+	/* Packs a filtered single channel plane into output pixels: SetPixelColourChannel puts R, G or B back in place on an opaque pixel, and A in the three colour channels. */
+	void FinishMorphologyPlane(const uint8* Plane, EFilterColourChannel ColourChannel, FBitmapView Dst)
+	{
+		uint32 Multiplier = 0;
+		uint32 SetMask = 0xFF000000;
+		switch (ColourChannel)
+		{
+		case EFilterColourChannel::R:
+			Multiplier = 0x00010000;
+			break;
+		case EFilterColourChannel::G:
+			Multiplier = 0x00000100;
+			break;
+		case EFilterColourChannel::B:
+			Multiplier = 0x00000001;
+			break;
+		default:
+			Multiplier = 0x00010101;
+			SetMask = 0;
+			break;
+		}
+
+		FBitmapParallel::ForRange(Dst.Height, 16, [&](int32 StartY, int32 EndY)
+		{
+			for (int32 Y = StartY; Y < EndY; Y++)
+			{
+				const uint8* PlaneRow = Plane + (int64)Y * Dst.Width;
+				FColor* DstRow = Dst.GetRow(Y);
+				for (int32 X = 0; X < Dst.Width; X++)
+				{
+					DstRow[X].DWColor() = PlaneRow[X] * Multiplier | SetMask;
+				}
+			}
+		});
+	}
+
+	/* Byte offset of a single channel within an FColor, or INDEX_NONE for the selections that use several channels. */
+	int32 GetMorphologyChannelOffset(EFilterColourChannel ColourChannel)
+	{
+		switch (ColourChannel)
+		{
+		case EFilterColourChannel::R:
+			return STRUCT_OFFSET(FColor, R);
+		case EFilterColourChannel::G:
+			return STRUCT_OFFSET(FColor, G);
+		case EFilterColourChannel::B:
+			return STRUCT_OFFSET(FColor, B);
+		case EFilterColourChannel::A:
+			return STRUCT_OFFSET(FColor, A);
+		default:
+			return INDEX_NONE;
+		}
+	}
+}
+
+void FBitmapMorphology::Apply(FConstBitmapView Src, EBitmapMorphologyOperation Operation, int32 RadiusX, int32 RadiusY, EFilterColourChannel ColourChannel, FBitmapView Dst)
+{
+	const int32 Width = Src.Width;
+	const int32 Height = Src.Height;
+	if (Width <= 0 || Height <= 0)
+	{
+		return;
+	}
+
+	RadiusX = FMath::Clamp(RadiusX, 0, (int32)MaxRadius);
+	RadiusY = FMath::Clamp(RadiusY, 0, (int32)MaxRadius);
+	const int32 NumPixels = Width * Height;
+	const int32 ChannelOffset = GetMorphologyChannelOffset(ColourChannel);
+
+	if (ChannelOffset != INDEX_NONE)
+	{
+		// One byte per pixel, so each SSE2 min or max handles 16 pixels
+		TArray<uint8> Plane;
+		Plane.SetNumUninitialized(NumPixels);
+		FBitmapParallel::ForRange(Height, 16, [&](int32 StartY, int32 EndY)
+		{
+			for (int32 Y = StartY; Y < EndY; Y++)
+			{
+				const FColor* SrcRow = Src.GetRow(Y);
+				uint8* PlaneRow = Plane.GetData() + (int64)Y * Width;
+				for (int32 X = 0; X < Width; X++)
+				{
+					PlaneRow[X] = ((const uint8*)&SrcRow[X])[ChannelOffset];
+				}
+			}
+		});
+
+		ApplyMorphologyToPlane(Plane.GetData(), Width, Width, Height, Operation, RadiusX, RadiusY, Plane.GetData());
+		FinishMorphologyPlane(Plane.GetData(), ColourChannel, Dst);
+		return;
+	}
+
+	// The 4 channels are independent bytes, so the byte wise min and max filter them all at once. The first pass reads Src through its pitch.
+	TArray<FColor> Filtered;
+	Filtered.SetNumUninitialized(NumPixels);
+	ApplyMorphologyToPlane(Src.Data, Src.Pitch, Width, Height, Operation, RadiusX, RadiusY, Filtered.GetData());
+
+	switch (ColourChannel)
+	{
+	case EFilterColourChannel::RGB:
+		FinishMorphologyPixels<EFilterColourChannel::RGB>(Filtered.GetData(), Dst);
+		break;
+	case EFilterColourChannel::RGBA:
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			FMemory::Memcpy(Dst.GetRow(Y), Filtered.GetData() + (int64)Y * Width, Width * sizeof(FColor));
+		}
+		break;
+	default:
+		FinishMorphologyPixels<EFilterColourChannel::Greyscale>(Filtered.GetData(), Dst);
+		break;
+	}
+}
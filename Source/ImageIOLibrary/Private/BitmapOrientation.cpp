@@ -0,0 +1,430 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapOrientation.h"
+#include "BitmapParallel.h"
+#include "BitmapSimd.h"
+
+namespace
+{
+	// Side of the tiles operations that swap the axes work through: a 32x32 tile reads 32 source rows and writes 32 output rows
+	// of 128 bytes each, which all fit in L1
+	const int32 OrientationTileSize = 32;
+
+	/* Rows handed to each thread by the row by row operations, which are bound by memory bandwidth. */
+	FORCEINLINE int32 GetOrientationMinBatch(int32 Width)
+	{
+		return FMath::Max(1, 65536 / FMath::Max(Width, 1));
+	}
+
+	/* Which source axes run backwards. Operations that keep the axes read Dst(X, Y) = Src(FlipX ? W - 1 - X : X, FlipY ? H - 1 - Y : Y),
+	those that swap them read Dst(X, Y) = Src(FlipX ? W - 1 - Y : Y, FlipY ? H - 1 - X : X).
+	*/
+	void GetOrientationFlips(EBitmapOrientation Orientation, bool& bOutFlipX, bool& bOutFlipY)
+	{
+		switch (Orientation)
+		{
+		case EBitmapOrientation::Rotate90:
+			bOutFlipX = false;
+			bOutFlipY = true;
+			break;
+		case EBitmapOrientation::Rotate270:
+			bOutFlipX = true;
+			bOutFlipY = false;
+			break;
+		case EBitmapOrientation::Transverse:
+		case EBitmapOrientation::Rotate180:
+			bOutFlipX = true;
+			bOutFlipY = true;
+			break;
+		case EBitmapOrientation::FlipHorizontal:
+			bOutFlipX = true;
+			bOutFlipY = false;
+			break;
+		case EBitmapOrientation::FlipVertical:
+			bOutFlipX = false;
+			bOutFlipY = true;
+			break;
+		default:
+			bOutFlipX = false;
+			bOutFlipY = false;
+			break;
+		}
+	}
+
+#if IMAGEIO_WITH_SSE2
+	FORCEINLINE __m128i ReversePixels(__m128i Pixels)
+	{
+		return _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(0, 1, 2, 3));
+	}
+#endif
+
+	/* Transposes a 4x4 block: row J of Dst (rows DstPitch pixels apart) gets pixel J of each of the 4 Rows, or pixel 3 - J when bReverse. */
+	FORCEINLINE void TransposeBlock(const FColor* const* Rows, bool bReverse, FColor* Dst, int32 DstPitch)
+	{
+#if IMAGEIO_WITH_SSE2
+		__m128i Row0 = _mm_loadu_si128((const __m128i*)Rows[0]);
+		__m128i Row1 = _mm_loadu_si128((const __m128i*)Rows[1]);
+		__m128i Row2 = _mm_loadu_si128((const __m128i*)Rows[2]);
+		__m128i Row3 = _mm_loadu_si128((const __m128i*)Rows[3]);
+		if (bReverse)
+		{
+			Row0 = ReversePixels(Row0);
+			Row1 = ReversePixels(Row1);
+			Row2 = ReversePixels(Row2);
+			Row3 = ReversePixels(Row3);
+		}
+
+		const __m128i Low01 = _mm_unpacklo_epi32(Row0, Row1);
+		const __m128i Low23 = _mm_unpacklo_epi32(Row2, Row3);
+		const __m128i High01 = _mm_unpackhi_epi32(Row0, Row1);
+		const __m128i High23 = _mm_unpackhi_epi32(Row2, Row3);
+		_mm_storeu_si128((__m128i*)Dst, _mm_unpacklo_epi64(Low01, Low23));
+		_mm_storeu_si128((__m128i*)(Dst + DstPitch), _mm_unpackhi_epi64(Low01, Low23));
+		_mm_storeu_si128((__m128i*)(Dst + 2 * DstPitch), _mm_unpacklo_epi64(High01, High23));
+		_mm_storeu_si128((__m128i*)(Dst + 3 * DstPitch), _mm_unpackhi_epi64(High01, High23));
+#else
+		for (int32 J = 0; J < 4; J++)
+		{
+			for (int32 I = 0; I < 4; I++)
+			{
+				Dst[J * DstPitch + I] = Rows[I][bReverse ? 3 - J : J];
+			}
+		}
+#endif
+	}
+
+	/* Dst[X] = Src[Width - 1 - X]. */
+	void ReverseRow(const FColor* Src, FColor* Dst, int32 Width)
+	{
+		int32 X = 0;
+#if IMAGEIO_WITH_SSE2
+		for (; X + 4 <= Width; X += 4)
+		{
+			_mm_storeu_si128((__m128i*)(Dst + X), ReversePixels(_mm_loadu_si128((const __m128i*)(Src + Width - 4 - X))));
+		}
+#endif
+		for (; X < Width; X++)
+		{
+			Dst[X] = Src[Width - 1 - X];
+		}
+	}
+
+	/* Swaps A[X] with B[Width - 1 - X] for every X. A and B are different rows. */
+	void SwapReversedRows(FColor* A, FColor* B, int32 Width)
+	{
+		int32 X = 0;
+#if IMAGEIO_WITH_SSE2
+		for (; X + 4 <= Width; X += 4)
+		{
+			const __m128i PixelsA = _mm_loadu_si128((const __m128i*)(A + X));
+			const __m128i PixelsB = _mm_loadu_si128((const __m128i*)(B + Width - 4 - X));
+			_mm_storeu_si128((__m128i*)(A + X), ReversePixels(PixelsB));
+			_mm_storeu_si128((__m128i*)(B + Width - 4 - X), ReversePixels(PixelsA));
+		}
+#endif
+		for (; X < Width; X++)
+		{
+			Swap(A[X], B[Width - 1 - X]);
+		}
+	}
+
+	/* Reverses a row where it is, swapping 4 pixels from each end at a time. */
+	void ReverseRowInPlace(FColor* Row, int32 Width)
+	{
+		int32 Left = 0;
+		int32 Right = Width;
+#if IMAGEIO_WITH_SSE2
+		for (; Right - Left >= 8; Left += 4, Right -= 4)
+		{
+			const __m128i PixelsLeft = _mm_loadu_si128((const __m128i*)(Row + Left));
+			const __m128i PixelsRight = _mm_loadu_si128((const __m128i*)(Row + Right - 4));
+			_mm_storeu_si128((__m128i*)(Row + Left), ReversePixels(PixelsRight));
+			_mm_storeu_si128((__m128i*)(Row + Right - 4), ReversePixels(PixelsLeft));
+		}
+#endif
+		for (; Right - Left >= 2; Left++, Right--)
+		{
+			Swap(Row[Left], Row[Right - 1]);
+		}
+	}
+
+	/* Operations that swap the axes, out of place: Dst is Src.Height x Src.Width. */
+	void ReorientSwapped(FConstBitmapView Src, bool bFlipX, bool bFlipY, FBitmapView Dst)
+	{
+		const int32 Width = Src.Width;
+		const int32 Height = Src.Height;
+		const int32 DstWidth = Height;
+		const int32 DstHeight = Width;
+		const int32 NumTilesX = FMath::DivideAndRoundUp(DstWidth, OrientationTileSize);
+		const int32 NumTilesY = FMath::DivideAndRoundUp(DstHeight, OrientationTileSize);
+
+		auto GetSourceRow = [&](int32 X) { return bFlipY ? Height - 1 - X : X; };
+		auto GetSourceColumn = [&](int32 Y) { return bFlipX ? Width - 1 - Y : Y; };
+
+		FBitmapParallel::ForRange(NumTilesY, 1, [&](int32 StartTile, int32 EndTile)
+		{
+			for (int32 TileY = StartTile; TileY < EndTile; TileY++)
+			{
+				const int32 FirstY = TileY * OrientationTileSize;
+				const int32 LastY = FMath::Min(FirstY + OrientationTileSize, DstHeight);
+
+				for (int32 TileX = 0; TileX < NumTilesX; TileX++)
+				{
+					const int32 FirstX = TileX * OrientationTileSize;
+					const int32 LastX = FMath::Min(FirstX + OrientationTileSize, DstWidth);
+
+					for (int32 Y = FirstY; Y < LastY; Y += 4)
+					{
+						for (int32 X = FirstX; X < LastX; X += 4)
+						{
+							if (Y + 4 <= LastY && X + 4 <= LastX)
+							{
+								// Output columns X to X + 3 are 4 source rows, output rows Y to Y + 3 are 4 neighbouring pixels of each
+								const int32 SourceColumn = bFlipX ? Width - 4 - Y : Y;
+								const FColor* Rows[4];
+								for (int32 Index = 0; Index < 4; Index++)
+								{
+									Rows[Index] = Src.GetRow(GetSourceRow(X + Index)) + SourceColumn;
+								}
+								TransposeBlock(Rows, bFlipX, Dst.GetRow(Y) + X, Dst.Pitch);
+								continue;
+							}
+
+							// Partial blocks along the right and bottom edges
+							for (int32 BlockY = Y; BlockY < FMath::Min(Y + 4, LastY); BlockY++)
+							{
+								for (int32 BlockX = X; BlockX < FMath::Min(X + 4, LastX); BlockX++)
+								{
+									Dst.GetRow(BlockY)[BlockX] = Src.GetRow(GetSourceRow(BlockX))[GetSourceColumn(BlockY)];
+								}
+							}
+						}
+					}
+				}
+			}
+		});
+	}
+
+	/* Transposes a square bitmap where it is: each pair of 4x4 blocks mirrored across the diagonal is transposed and swapped, a pair of
+	tiles at a time so both stay in cache.
+	*/
+	void TransposeSquareInPlace(FBitmapView Pixels)
+	{
+		const int32 Size = Pixels.Width;
+		const int32 BlockedSize = Size & ~3;
+		const int32 NumTiles = FMath::DivideAndRoundUp(BlockedSize, OrientationTileSize);
+
+		auto GetBlockRows = [Pixels](int32 Y, int32 X, const FColor** Rows)
+		{
+			for (int32 Index = 0; Index < 4; Index++)
+			{
+				Rows[Index] = Pixels.GetRow(Y + Index) + X;
+			}
+		};
+		auto StoreBlock = [Pixels](const FColor* Block, int32 Y, int32 X)
+		{
+			for (int32 Index = 0; Index < 4; Index++)
+			{
+				FMemory::Memcpy(Pixels.GetRow(Y + Index) + X, Block + Index * 4, 4 * sizeof(FColor));
+			}
+		};
+
+		// Tile pairs are disjoint, each is handled by the thread of the tile row above the diagonal
+		FBitmapParallel::ForRange(NumTiles, 1, [&](int32 StartTile, int32 EndTile)
+		{
+			FColor BlockA[16];
+			FColor BlockB[16];
+			const FColor* Rows[4];
+
+			for (int32 TileY = StartTile; TileY < EndTile; TileY++)
+			{
+				const int32 FirstY = TileY * OrientationTileSize;
+				const int32 LastY = FMath::Min(FirstY + OrientationTileSize, BlockedSize);
+
+				for (int32 TileX = TileY; TileX < NumTiles; TileX++)
+				{
+					const int32 FirstX = TileX * OrientationTileSize;
+					const int32 LastX = FMath::Min(FirstX + OrientationTileSize, BlockedSize);
+
+					for (int32 Y = FirstY; Y < LastY; Y += 4)
+					{
+						for (int32 X = TileX == TileY ? Y : FirstX; X < LastX; X += 4)
+						{
+							GetBlockRows(Y, X, Rows);
+							TransposeBlock(Rows, false, BlockA, 4);
+							if (X == Y)
+							{
+								StoreBlock(BlockA, Y, X);
+								continue;
+							}
+
+							GetBlockRows(X, Y, Rows);
+							TransposeBlock(Rows, false, BlockB, 4);
+							StoreBlock(BlockA, X, Y);
+							StoreBlock(BlockB, Y, X);
+						}
+					}
+				}
+			}
+		});
+
+		// The last rows and columns when the size isn't a multiple of 4
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = FMath::Max(BlockedSize, Y + 1); X < Size; X++)
+			{
+				Swap(Pixels.GetRow(Y)[X], Pixels.GetRow(X)[Y]);
+			}
+		}
+	}
+}
+
+bool FBitmapOrientation::SwapsAxes(EBitmapOrientation Orientation)
+{
+	return Orientation == EBitmapOrientation::Rotate90 || Orientation == EBitmapOrientation::Rotate270
+		|| Orientation == EBitmapOrientation::Transpose || Orientation == EBitmapOrientation::Transverse;
+}
+
+FImageSize FBitmapOrientation::GetOrientedSize(FImageSize Size, EBitmapOrientation Orientation)
+{
+	return SwapsAxes(Orientation) ? FImageSize(Size.Y, Size.X) : Size;
+}
+
+void FBitmapOrientation::Reorient(FConstBitmapView Src, EBitmapOrientation Orientation, FBitmapView Dst)
+{
+	const FImageSize Size = Src.GetSize();
+	if (Size.X <= 0 || Size.Y <= 0)
+	{
+		return;
+	}
+
+	bool bFlipX;
+	bool bFlipY;
+	GetOrientationFlips(Orientation, bFlipX, bFlipY);
+
+	if (SwapsAxes(Orientation))
+	{
+		ReorientSwapped(Src, bFlipX, bFlipY, Dst);
+		return;
+	}
+
+	FBitmapParallel::ForRange(Size.Y, GetOrientationMinBatch(Size.X), [&](int32 Start, int32 End)
+	{
+		for (int32 Y = Start; Y < End; Y++)
+		{
+			const FColor* SourceRow = Src.GetRow(bFlipY ? Size.Y - 1 - Y : Y);
+			FColor* Row = Dst.GetRow(Y);
+			if (bFlipX)
+			{
+				ReverseRow(SourceRow, Row, Size.X);
+			}
+			else
+			{
+				FMemory::Memcpy(Row, SourceRow, Size.X * sizeof(FColor));
+			}
+		}
+	});
+}
+
+bool FBitmapOrientation::ReorientInPlace(FBitmapView Pixels, EBitmapOrientation Orientation)
+{
+	const FImageSize Size = Pixels.GetSize();
+	if (Size.X <= 0 || Size.Y <= 0)
+	{
+		return true;
+	}
+
+	if (SwapsAxes(Orientation))
+	{
+		if (Size.X != Size.Y)
+		{
+			return false;
+		}
+
+		// Square: a transpose, then the flip that turns it into the operation asked for
+		TransposeSquareInPlace(Pixels);
+		switch (Orientation)
+		{
+		case EBitmapOrientation::Rotate90:
+			return ReorientInPlace(Pixels, EBitmapOrientation::FlipHorizontal);
+		case EBitmapOrientation::Rotate270:
+			return ReorientInPlace(Pixels, EBitmapOrientation::FlipVertical);
+		case EBitmapOrientation::Transverse:
+			return ReorientInPlace(Pixels, EBitmapOrientation::Rotate180);
+		default:
+			return true;
+		}
+	}
+
+	const int32 Width = Size.X;
+	const int32 Height = Size.Y;
+	auto GetRow = [Pixels](int32 Y) { return Pixels.GetRow(Y); };
+
+	switch (Orientation)
+	{
+	case EBitmapOrientation::FlipHorizontal:
+		FBitmapParallel::ForRange(Height, GetOrientationMinBatch(Width), [&](int32 Start, int32 End)
+		{
+			for (int32 Y = Start; Y < End; Y++)
+			{
+				ReverseRowInPlace(GetRow(Y), Width);
+			}
+		});
+		break;
+
+	case EBitmapOrientation::FlipVertical:
+		FBitmapParallel::ForRange(Height / 2, GetOrientationMinBatch(Width), [&](int32 Start, int32 End)
+		{
+			for (int32 Y = Start; Y < End; Y++)
+			{
+				FMemory::Memswap(GetRow(Y), GetRow(Height - 1 - Y), Width * sizeof(FColor));
+			}
+		});
+		break;
+
+	default:
+		FBitmapParallel::ForRange(Height / 2, GetOrientationMinBatch(Width), [&](int32 Start, int32 End)
+		{
+			for (int32 Y = Start; Y < End; Y++)
+			{
+				SwapReversedRows(GetRow(Y), GetRow(Height - 1 - Y), Width);
+			}
+		});
+		if (Height & 1)
+		{
+			ReverseRowInPlace(GetRow(Height / 2), Width);
+		}
+		break;
+	}
+	return true;
+}
+
+bool FBitmapOrientation::FromExifOrientation(int32 ExifOrientation, EBitmapOrientation& OutOrientation)
+{
+	switch (ExifOrientation)
+	{
+	case 2:
+		OutOrientation = EBitmapOrientation::FlipHorizontal;
+		return true;
+	case 3:
+		OutOrientation = EBitmapOrientation::Rotate180;
+		return true;
+	case 4:
+		OutOrientation = EBitmapOrientation::FlipVertical;
+		return true;
+	case 5:
+		OutOrientation = EBitmapOrientation::Transpose;
+		return true;
+	case 6:
+		OutOrientation = EBitmapOrientation::Rotate90;
+		return true;
+	case 7:
+		OutOrientation = EBitmapOrientation::Transverse;
+		return true;
+	case 8:
+		OutOrientation = EBitmapOrientation::Rotate270;
+		return true;
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,39 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapParallel.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/App.h"
+
+static TAutoConsoleVariable<int32> CVarImageIOMaxThreads(
+	TEXT("ImageIO.MaxThreads"),
+	0,
+	TEXT("Maximum number of threads used by the ImageIOLibrary bitmap operations. 0 uses every task graph worker, 1 runs single threaded."),
+	ECVF_Default);
+
+int32 FBitmapParallel::GetNumWorkers()
+{
+	const int32 MaxThreads = CVarImageIOMaxThreads.GetValueOnAnyThread();
+	if (MaxThreads > 0)
+	{
+		return MaxThreads;
+	}
+
+	// The calling thread takes part in ParallelFor too
+	return FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+}
+
+int32 FBitmapParallel::GetNumChunks(int32 Num, int32 MinBatch)
+{
+	const int32 MaxChunks = FMath::Max(1, Num / FMath::Max(1, MinBatch));
+	const int32 NumWorkers = GetNumWorkers();
+
+	if (NumWorkers <= 1 || !FApp::ShouldUseThreadingForPerformance())
+	{
+		return 1;
+	}
+
+	// A few chunks per worker keeps the threads busy when the rows don't all cost the same, and gives more urgent jobs more points to
+	// take over at. ForRange never runs them on more than NumWorkers threads.
+	return FMath::Min(MaxChunks, NumWorkers * 4);
+}
@@ -0,0 +1,93 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Work splitting shared by every bitmap operation that runs across rows or tiles. It is also where jobs get their progress and cancellation.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "BitmapJobContext.h"
+
+struct FBitmapParallel
+{
+	/* Number of threads the bitmap operations are allowed to run on (see the ImageIO.MaxThreads console variable). */
+	static int32 GetNumWorkers();
+
+	/* How many chunks Num items should be split into, given that a chunk shouldn't hold less than MinBatch items. */
+	static int32 GetNumChunks(int32 Num, int32 MinBatch);
+
+	/* Splits [0, Num) into contiguous ranges of at least MinBatch items and calls Body(Start, End) for each range, in parallel when worth it.
+	Inside a job (see FBitmapJobContext) every range done is reported as progress, and the ranges left are skipped once the job is cancelled:
+	the output is then incomplete, and thrown away by the job. Queued jobs of a higher priority take over between ranges: every thread stops
+	taking ranges, the more urgent jobs run on the job's own thread, then the pass carries on across as many threads as before. They never run
+	on the task graph threads helping the pass, which other work shares. Work that doesn't go through here (e.g. decoding a file) can't be
+	preempted, and neither can a single range.
+	*/
+	template<typename BodyType>
+	static void ForRange(int32 Num, int32 MinBatch, const BodyType& Body)
+	{
+		FBitmapJobContext* Job = FBitmapJobContext::GetCurrent();
+		if (Num <= 0 || (Job && Job->IsCancelled()))
+		{
+			return;
+		}
+
+		if (Job)
+		{
+			Job->YieldToHigherPriority();
+		}
+
+		const float PassStart = Job ? Job->BeginPass() : 0.0f;
+		const int32 NumChunks = GetNumChunks(Num, MinBatch);
+		if (NumChunks <= 1)
+		{
+			Body(0, Num);
+			if (Job)
+			{
+				Job->ReportPassProgress(PassStart, 1.0f);
+			}
+			return;
+		}
+
+		// Ranges are handed out in order as threads free up rather than by ParallelFor index, so the pass can stop and resume anywhere
+		FThreadSafeCounter NextChunk;
+		FThreadSafeCounter NumChunksDone;
+		bool bPreemptible = Job != nullptr;
+		while (true)
+		{
+			const int32 NumThreads = FMath::Min(NumChunks - NextChunk.GetValue(), GetNumWorkers());
+			ParallelFor(NumThreads, [&](int32 ThreadIndex)
+			{
+				while (!Job || !(Job->IsCancelled() || (bPreemptible && Job->HasHigherPriorityQueued())))
+				{
+					const int32 ChunkIndex = NextChunk.Increment() - 1;
+					if (ChunkIndex >= NumChunks)
+					{
+						return;
+					}
+
+					const int32 Start = (int32)((int64)Num * ChunkIndex / NumChunks);
+					const int32 End = (int32)((int64)Num * (ChunkIndex + 1) / NumChunks);
+					if (Start < End)
+					{
+						Body(Start, End);
+					}
+					if (Job)
+					{
+						Job->ReportPassProgress(PassStart, (float)NumChunksDone.Increment() / NumChunks);
+					}
+				}
+			});
+
+			if (NextChunk.GetValue() >= NumChunks || Job->IsCancelled())
+			{
+				return;
+			}
+
+			// Stopped for a more urgent job. One that can't start yet (its decode memory isn't free) isn't waited for: the pass then finishes
+			// without looking again.
+			bPreemptible = Job->YieldToHigherPriority();
+		}
+	}
+};
@@ -0,0 +1,285 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapPyramid.h"
+#include "BitmapParallel.h"
+
+namespace
+{
+	// Rows of a level processed per thread at least, counted in pixels so small levels stay on one thread
+	const int32 PyramidMinBatchPixels = 16384;
+
+	/* Mirrors indices up to 2 pixels past either edge back inside, without repeating the edge pixel. */
+	FORCEINLINE int32 ReflectPyramidIndex(int32 Index, int32 Length)
+	{
+		Index = FMath::Abs(Index);
+		if (Index >= Length)
+		{
+			Index = 2 * Length - 2 - Index;
+		}
+		return FMath::Clamp(Index, 0, Length - 1);
+	}
+
+	/* [1 4 6 4 1] / 16 over 5 pixels. */
+	FORCEINLINE VectorRegister FilterPyramidTaps(const VectorRegister& Tap0, const VectorRegister& Tap1, const VectorRegister& Tap2, const VectorRegister& Tap3, const VectorRegister& Tap4)
+	{
+		const VectorRegister Outer = VectorAdd(Tap0, Tap4);
+		const VectorRegister Inner = VectorAdd(Tap1, Tap3);
+		VectorRegister Sum = VectorMultiply(Tap2, VectorSetFloat1(6.0f / 16.0f));
+		Sum = VectorMultiplyAdd(Inner, VectorSetFloat1(4.0f / 16.0f), Sum);
+		return VectorMultiplyAdd(Outer, VectorSetFloat1(1.0f / 16.0f), Sum);
+	}
+
+	/* Filters In and keeps every other pixel of every other row. Each output row blends 5 input rows into a padded scratch row first, which
+	is then filtered and decimated along X with no edge checks.
+	*/
+	void ReducePyramidLevel(const VectorRegister* In, FImageSize InSize, VectorRegister* Out, FImageSize OutSize)
+	{
+		FBitmapParallel::ForRange(OutSize.Y, FMath::Max(1, PyramidMinBatchPixels / InSize.X), [&](int32 Start, int32 End)
+		{
+			TArray<VectorRegister> Scratch;
+			Scratch.SetNumUninitialized(InSize.X + 4);
+			VectorRegister* Row = Scratch.GetData() + 2;
+
+			for (int32 Y = Start; Y < End; Y++)
+			{
+				const VectorRegister* Rows[5];
+				for (int32 Tap = 0; Tap < 5; Tap++)
+				{
+					Rows[Tap] = In + (int64)ReflectPyramidIndex(Y * 2 + Tap - 2, InSize.Y) * InSize.X;
+				}
+				for (int32 X = 0; X < InSize.X; X++)
+				{
+					Row[X] = FilterPyramidTaps(Rows[0][X], Rows[1][X], Rows[2][X], Rows[3][X], Rows[4][X]);
+				}
+				for (int32 Pad = 1; Pad <= 2; Pad++)
+				{
+					Row[-Pad] = Row[ReflectPyramidIndex(-Pad, InSize.X)];
+					Row[InSize.X - 1 + Pad] = Row[ReflectPyramidIndex(InSize.X - 1 + Pad, InSize.X)];
+				}
+
+				VectorRegister* OutRow = Out + (int64)Y * OutSize.X;
+				for (int32 X = 0; X < OutSize.X; X++)
+				{
+					const VectorRegister* Taps = Row + X * 2;
+					OutRow[X] = FilterPyramidTaps(Taps[-2], Taps[-1], Taps[0], Taps[1], Taps[2]);
+				}
+			}
+		});
+	}
+
+	/* Upsamples Small to the size of Big with the same kernel (doubled, as only every other tap lands on a pixel) and adds it, times Sign, to Big.
+	Even outputs sit on a small pixel and weigh [1 6 1] / 8, odd ones fall between two and weigh [1 1] / 2.
+	*/
+	void ExpandPyramidLevel(const VectorRegister* Small, FImageSize SmallSize, VectorRegister* Big, FImageSize BigSize, float Sign)
+	{
+		FBitmapParallel::ForRange(BigSize.Y, FMath::Max(1, PyramidMinBatchPixels / BigSize.X), [&](int32 Start, int32 End)
+		{
+			TArray<VectorRegister> Scratch;
+			Scratch.SetNumUninitialized(SmallSize.X + 2);
+			VectorRegister* Row = Scratch.GetData() + 1;
+
+			const VectorRegister Centre = VectorSetFloat1(6.0f / 8.0f);
+			const VectorRegister Side = VectorSetFloat1(1.0f / 8.0f);
+			const VectorRegister Half = VectorSetFloat1(0.5f);
+
+			for (int32 Y = Start; Y < End; Y++)
+			{
+				// Sign folded into the vertical weights
+				const int32 SmallY = Y / 2;
+				const VectorRegister* Here = Small + (int64)SmallY * SmallSize.X;
+				const VectorRegister* Below = Small + (int64)ReflectPyramidIndex(SmallY + 1, SmallSize.Y) * SmallSize.X;
+				if (Y & 1)
+				{
+					const VectorRegister Weight = VectorSetFloat1(0.5f * Sign);
+					for (int32 X = 0; X < SmallSize.X; X++)
+					{
+						Row[X] = VectorMultiply(VectorAdd(Here[X], Below[X]), Weight);
+					}
+				}
+				else
+				{
+					const VectorRegister* Above = Small + (int64)ReflectPyramidIndex(SmallY - 1, SmallSize.Y) * SmallSize.X;
+					const VectorRegister CentreWeight = VectorSetFloat1(6.0f / 8.0f * Sign);
+					const VectorRegister SideWeight = VectorSetFloat1(1.0f / 8.0f * Sign);
+					for (int32 X = 0; X < SmallSize.X; X++)
+					{
+						Row[X] = VectorMultiplyAdd(VectorAdd(Above[X], Below[X]), SideWeight, VectorMultiply(Here[X], CentreWeight));
+					}
+				}
+				Row[-1] = Row[ReflectPyramidIndex(-1, SmallSize.X)];
+				Row[SmallSize.X] = Row[ReflectPyramidIndex(SmallSize.X, SmallSize.X)];
+
+				VectorRegister* BigRow = Big + (int64)Y * BigSize.X;
+				for (int32 X = 0; X < SmallSize.X; X++)
+				{
+					BigRow[X * 2] = VectorAdd(BigRow[X * 2], VectorMultiplyAdd(VectorAdd(Row[X - 1], Row[X + 1]), Side, VectorMultiply(Row[X], Centre)));
+					if (X * 2 + 1 < BigSize.X)
+					{
+						BigRow[X * 2 + 1] = VectorMultiplyAdd(VectorAdd(Row[X], Row[X + 1]), Half, BigRow[X * 2 + 1]);
+					}
+				}
+			}
+		});
+	}
+
+	/* Fills level 0 of Pyramid from Pixels, which has its size, one pixel at a time through Decode. */
+	template<typename DecodeType>
+	void FillPyramidBase(FBitmapPyramid& Pyramid, FConstBitmapView Pixels, const DecodeType& Decode)
+	{
+		const FImageSize Size = Pyramid.GetLevelSize(0);
+		VectorRegister* Level = Pyramid.GetLevel(0);
+		FBitmapParallel::ForRange(Size.Y, FMath::Max(1, PyramidMinBatchPixels / Size.X), [&](int32 Start, int32 End)
+		{
+			for (int32 Y = Start; Y < End; Y++)
+			{
+				const FColor* Row = Pixels.GetRow(Y);
+				VectorRegister* LevelRow = Level + (int64)Y * Size.X;
+				for (int32 X = 0; X < Size.X; X++)
+				{
+					LevelRow[X] = Decode(Row[X]);
+				}
+			}
+		});
+	}
+
+	FORCEINLINE VectorRegister DecodePyramidPixel(const FColor& Pixel)
+	{
+		return MakeVectorRegister(Pixel.B * (1.0f / 255.0f), Pixel.G * (1.0f / 255.0f), Pixel.R * (1.0f / 255.0f), Pixel.A * (1.0f / 255.0f));
+	}
+
+	FORCEINLINE uint8 EncodePyramidChannel(float Value)
+	{
+		return (uint8)(FMath::Clamp(Value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+int32 FBitmapPyramid::GetMaxLevels(FImageSize Size)
+{
+	return (int32)FMath::CeilLogTwo((uint32)FMath::Max(FMath::Max(Size.X, Size.Y), 1)) + 1;
+}
+
+FImageSize FBitmapPyramid::GetLevelSize(FImageSize Size, int32 Level)
+{
+	FImageSize LevelSize = Size;
+	for (int32 Index = 0; Index < Level; Index++)
+	{
+		LevelSize.X = (LevelSize.X + 1) / 2;
+		LevelSize.Y = (LevelSize.Y + 1) / 2;
+	}
+	return LevelSize;
+}
+
+void FBitmapPyramid::Init(FImageSize Size, int32 NumLevels)
+{
+	const int32 MaxLevels = GetMaxLevels(Size);
+	NumLevels = NumLevels <= 0 ? MaxLevels : FMath::Min(NumLevels, MaxLevels);
+
+	LevelSizes.SetNumUninitialized(NumLevels);
+	LevelOffsets.SetNumUninitialized(NumLevels);
+	int64 NumPixels = 0;
+	for (int32 Level = 0; Level < NumLevels; Level++)
+	{
+		LevelSizes[Level] = GetLevelSize(Size, Level);
+		LevelOffsets[Level] = NumPixels;
+		NumPixels += (int64)LevelSizes[Level].X * LevelSizes[Level].Y;
+	}
+	Pixels.SetNumUninitialized((int32)NumPixels);
+}
+
+void FBitmapPyramid::BuildGaussian(FConstBitmapView Src, int32 NumLevels)
+{
+	Init(Src.GetSize(), NumLevels);
+	FillPyramidBase(*this, Src, [](const FColor& Pixel) { return DecodePyramidPixel(Pixel); });
+	Reduce();
+}
+
+void FBitmapPyramid::BuildLaplacian(FConstBitmapView Src, int32 NumLevels)
+{
+	BuildGaussian(Src, NumLevels);
+	ToLaplacian();
+}
+
+void FBitmapPyramid::Reduce()
+{
+	for (int32 Level = 1; Level < GetNumLevels(); Level++)
+	{
+		ReducePyramidLevel(GetLevel(Level - 1), LevelSizes[Level - 1], GetLevel(Level), LevelSizes[Level]);
+	}
+}
+
+void FBitmapPyramid::ToLaplacian()
+{
+	// From the top down, so the level below is still Gaussian when it's expanded
+	for (int32 Level = 0; Level + 1 < GetNumLevels(); Level++)
+	{
+		ExpandPyramidLevel(GetLevel(Level + 1), LevelSizes[Level + 1], GetLevel(Level), LevelSizes[Level], -1.0f);
+	}
+}
+
+void FBitmapPyramid::Collapse()
+{
+	for (int32 Level = GetNumLevels() - 2; Level >= 0; Level--)
+	{
+		ExpandPyramidLevel(GetLevel(Level + 1), LevelSizes[Level + 1], GetLevel(Level), LevelSizes[Level], 1.0f);
+	}
+}
+
+void FBitmapPyramid::GetPixels(int32 Level, FBitmapView Dst) const
+{
+	const FImageSize Size = LevelSizes[Level];
+	const VectorRegister* Values = GetLevel(Level);
+	FBitmapParallel::ForRange(Size.Y, FMath::Max(1, PyramidMinBatchPixels / Size.X), [&](int32 Start, int32 End)
+	{
+		for (int32 Y = Start; Y < End; Y++)
+		{
+			const VectorRegister* Row = Values + (int64)Y * Size.X;
+			FColor* DstRow = Dst.GetRow(Y);
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				float Channels[4];
+				VectorStore(Row[X], Channels);
+				DstRow[X] = FColor(EncodePyramidChannel(Channels[2]), EncodePyramidChannel(Channels[1]), EncodePyramidChannel(Channels[0]), EncodePyramidChannel(Channels[3]));
+			}
+		}
+	});
+}
+
+void FBitmapPyramid::BlendMultiband(FConstBitmapView A, FConstBitmapView B, FConstBitmapView Mask, int32 NumLevels, FBitmapView Dst)
+{
+	const FImageSize Size = A.GetSize();
+	if (Size.X <= 0 || Size.Y <= 0)
+	{
+		return;
+	}
+
+	if (NumLevels <= 0)
+	{
+		NumLevels = FMath::Max(1, (int32)FMath::FloorLog2((uint32)FMath::Min(Size.X, Size.Y)) - 2);
+	}
+
+	FBitmapPyramid PyramidA;
+	FBitmapPyramid PyramidB;
+	FBitmapPyramid PyramidMask;
+	PyramidA.BuildLaplacian(A, NumLevels);
+	PyramidB.BuildLaplacian(B, NumLevels);
+
+	// The mask weighs every channel the same
+	PyramidMask.Init(Size, NumLevels);
+	FillPyramidBase(PyramidMask, Mask, [](const FColor& Pixel) { return VectorSetFloat1(Pixel.R * (1.0f / 255.0f)); });
+	PyramidMask.Reduce();
+
+	// All three pyramids share the same layout, so every level is mixed in one pass over the whole allocation
+	VectorRegister* ValuesA = PyramidA.Pixels.GetData();
+	const VectorRegister* ValuesB = PyramidB.Pixels.GetData();
+	const VectorRegister* Weights = PyramidMask.Pixels.GetData();
+	FBitmapParallel::ForRange(PyramidA.Pixels.Num(), PyramidMinBatchPixels, [&](int32 Start, int32 End)
+	{
+		for (int32 Index = Start; Index < End; Index++)
+		{
+			ValuesA[Index] = VectorMultiplyAdd(Weights[Index], VectorSubtract(ValuesA[Index], ValuesB[Index]), ValuesB[Index]);
+		}
+	});
+
+	PyramidA.Collapse();
+	PyramidA.GetPixels(0, Dst);
+}
@@ -0,0 +1,423 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapRankFilter.h"
+#include "BitmapParallel.h"
+#include "BitmapChannels.h"
+#include "BitmapSimd.h"
+
+namespace
+{
+	// Columns per strip. Strips are what gets spread across threads, and each keeps a histogram per column (plus the radius on each side).
+	const int32 RankStripWidth = 64;
+
+	// Histograms are split in 16 coarse bins of 16 fine bins each
+	const int32 NumCoarseBins = 16;
+	const int32 FineBinsPerCoarseBin = 16;
+
+	/* Histogram of one column (or of the whole square) for one channel. Counts fit in 16 bits, the square holds at most 31² samples. */
+	struct FRankHistogram
+	{
+		uint16 Coarse[NumCoarseBins];
+		uint16 Fine[NumCoarseBins * FineBinsPerCoarseBin];
+	};
+
+	/* Byte offsets within FColor of the channels that need filtering for ColourChannel. Returns how many there are. */
+	int32 GetRankChannelOffsets(EFilterColourChannel ColourChannel, int32 OutOffsets[4])
+	{
+		switch (ColourChannel)
+		{
+		case EFilterColourChannel::R:
+			OutOffsets[0] = STRUCT_OFFSET(FColor, R);
+			return 1;
+
+		case EFilterColourChannel::G:
+			OutOffsets[0] = STRUCT_OFFSET(FColor, G);
+			return 1;
+
+		case EFilterColourChannel::B:
+			OutOffsets[0] = STRUCT_OFFSET(FColor, B);
+			return 1;
+
+		case EFilterColourChannel::A:
+			OutOffsets[0] = STRUCT_OFFSET(FColor, A);
+			return 1;
+
+		case EFilterColourChannel::RGB:
+		case EFilterColourChannel::Greyscale:
+			OutOffsets[0] = STRUCT_OFFSET(FColor, R);
+			OutOffsets[1] = STRUCT_OFFSET(FColor, G);
+			OutOffsets[2] = STRUCT_OFFSET(FColor, B);
+			return 3;
+
+		default:
+			OutOffsets[0] = STRUCT_OFFSET(FColor, R);
+			OutOffsets[1] = STRUCT_OFFSET(FColor, G);
+			OutOffsets[2] = STRUCT_OFFSET(FColor, B);
+			OutOffsets[3] = STRUCT_OFFSET(FColor, A);
+			return 4;
+		}
+	}
+
+	FORCEINLINE uint8 GetChannel(const FColor& Pixel, int32 Offset)
+	{
+		return reinterpret_cast<const uint8*>(&Pixel)[Offset];
+	}
+
+	FORCEINLINE void AddToHistogram(FRankHistogram& Histogram, uint8 Value)
+	{
+		Histogram.Coarse[Value / FineBinsPerCoarseBin]++;
+		Histogram.Fine[Value]++;
+	}
+
+	FORCEINLINE void RemoveFromHistogram(FRankHistogram& Histogram, uint8 Value)
+	{
+		Histogram.Coarse[Value / FineBinsPerCoarseBin]--;
+		Histogram.Fine[Value]--;
+	}
+
+	/* Bins += Added - Removed, for 16 bins (a coarse histogram, or the fine bins under one coarse bin). */
+	FORCEINLINE void SlideBins(uint16* Bins, const uint16* Added, const uint16* Removed)
+	{
+#if IMAGEIO_WITH_SSE2
+		const __m128i Low = _mm_sub_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i*)Bins), _mm_loadu_si128((const __m128i*)Added)), _mm_loadu_si128((const __m128i*)Removed));
+		const __m128i High = _mm_sub_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i*)(Bins + 8)), _mm_loadu_si128((const __m128i*)(Added + 8))), _mm_loadu_si128((const __m128i*)(Removed + 8)));
+		_mm_storeu_si128((__m128i*)Bins, Low);
+		_mm_storeu_si128((__m128i*)(Bins + 8), High);
+#else
+		for (int32 Bin = 0; Bin < 16; Bin++)
+		{
+			Bins[Bin] += Added[Bin] - Removed[Bin];
+		}
+#endif
+	}
+
+	/* Finds which of 16 bins holds the sample of rank InOutRank, and turns InOutRank into its rank within that bin.
+	Branch free on SSE2: a walk through the bins mispredicts about once per pixel, which costs more than the rest of the filter.
+	*/
+	FORCEINLINE int32 FindRankBin(const uint16* Bins, int32& InOutRank)
+	{
+#if IMAGEIO_WITH_SSE2
+		// Running totals of the bins, 8 lanes at a time then carried into the high half
+		__m128i Low = _mm_loadu_si128((const __m128i*)Bins);
+		__m128i High = _mm_loadu_si128((const __m128i*)(Bins + 8));
+		Low = _mm_add_epi16(Low, _mm_slli_si128(Low, 2));
+		High = _mm_add_epi16(High, _mm_slli_si128(High, 2));
+		Low = _mm_add_epi16(Low, _mm_slli_si128(Low, 4));
+		High = _mm_add_epi16(High, _mm_slli_si128(High, 4));
+		Low = _mm_add_epi16(Low, _mm_slli_si128(Low, 8));
+		High = _mm_add_epi16(High, _mm_slli_si128(High, 8));
+		const __m128i LowTotal = _mm_shufflehi_epi16(Low, _MM_SHUFFLE(3, 3, 3, 3));
+		High = _mm_add_epi16(High, _mm_unpackhi_epi64(LowTotal, LowTotal));
+
+		// The bin is the number of running totals that don't go past the rank
+		const __m128i RankPlusOne = _mm_set1_epi16((int16)(InOutRank + 1));
+		const uint32 BelowMask = (uint32)_mm_movemask_epi8(_mm_cmpgt_epi16(RankPlusOne, Low)) | ((uint32)_mm_movemask_epi8(_mm_cmpgt_epi16(RankPlusOne, High)) << 16);
+		const int32 Bin = (int32)FPlatformMath::CountBits(BelowMask) / 2;
+
+		uint16 Totals[16];
+		_mm_storeu_si128((__m128i*)Totals, Low);
+		_mm_storeu_si128((__m128i*)(Totals + 8), High);
+		InOutRank -= Bin > 0 ? Totals[Bin - 1] : 0;
+		return Bin;
+#else
+		int32 Bin = 0;
+		while (InOutRank >= Bins[Bin])
+		{
+			InOutRank -= Bins[Bin];
+			Bin++;
+		}
+		return Bin;
+#endif
+	}
+
+	/* Perreault-Hébert filter over the columns [StartX, EndX) of every row.
+	Each column keeps a histogram of its 2 * Radius + 1 pixels around the current row, updated with one add and one remove per row.
+	The square's coarse histogram slides along the row the same way. Its fine bins are only brought up to date for the coarse bin
+	that holds the wanted rank, which usually stays the same from one pixel to the next.
+	*/
+	void RankFilterStripHistogram(FConstBitmapView Src, int32 StartX, int32 EndX, int32 Radius, int32 Rank, EFilterColourChannel ColourChannel,
+		FBitmapView Dst)
+	{
+		const int32 Width = Src.Width;
+		const int32 Height = Src.Height;
+		int32 Offsets[4];
+		const int32 NumChannels = GetRankChannelOffsets(ColourChannel, Offsets);
+		const int32 Diameter = 2 * Radius + 1;
+
+		// Columns read by this strip, the ones past the edges of the bitmap are clamped to it
+		const int32 FirstColumn = FMath::Max(0, StartX - Radius);
+		const int32 LastColumn = FMath::Min(Width - 1, EndX - 1 + Radius);
+		const int32 NumColumns = LastColumn - FirstColumn + 1;
+
+		TArray<FRankHistogram> ColumnHistograms;
+		ColumnHistograms.SetNumZeroed(NumColumns * NumChannels);
+		auto GetColumn = [&](int32 X, int32 Channel) -> const FRankHistogram&
+		{
+			return ColumnHistograms[(FMath::Clamp(X, 0, Width - 1) - FirstColumn) * NumChannels + Channel];
+		};
+
+		for (int32 Row = -Radius; Row <= Radius; Row++)
+		{
+			const FColor* SrcRow = Src.GetRow(FMath::Clamp(Row, 0, Height - 1));
+			for (int32 Column = 0; Column < NumColumns; Column++)
+			{
+				for (int32 Channel = 0; Channel < NumChannels; Channel++)
+				{
+					AddToHistogram(ColumnHistograms[Column * NumChannels + Channel], GetChannel(SrcRow[FirstColumn + Column], Offsets[Channel]));
+				}
+			}
+		}
+
+		FRankHistogram Square[4];
+		int32 FineUpToDateX[4][NumCoarseBins];
+
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			if (Y > 0)
+			{
+				const FColor* RemovedRow = Src.GetRow(FMath::Clamp(Y - Radius - 1, 0, Height - 1));
+				const FColor* AddedRow = Src.GetRow(FMath::Clamp(Y + Radius, 0, Height - 1));
+				for (int32 Column = 0; Column < NumColumns; Column++)
+				{
+					for (int32 Channel = 0; Channel < NumChannels; Channel++)
+					{
+						FRankHistogram& Histogram = ColumnHistograms[Column * NumChannels + Channel];
+						RemoveFromHistogram(Histogram, GetChannel(RemovedRow[FirstColumn + Column], Offsets[Channel]));
+						AddToHistogram(Histogram, GetChannel(AddedRow[FirstColumn + Column], Offsets[Channel]));
+					}
+				}
+			}
+
+			// Restart the square at the beginning of the strip. Fine bins are rebuilt when first needed.
+			for (int32 Channel = 0; Channel < NumChannels; Channel++)
+			{
+				FMemory::Memzero(Square[Channel].Coarse);
+				for (int32 Offset = -Radius; Offset <= Radius; Offset++)
+				{
+					const FRankHistogram& Column = GetColumn(StartX + Offset, Channel);
+					for (int32 Bin = 0; Bin < NumCoarseBins; Bin++)
+					{
+						Square[Channel].Coarse[Bin] += Column.Coarse[Bin];
+					}
+				}
+				for (int32 Bin = 0; Bin < NumCoarseBins; Bin++)
+				{
+					FineUpToDateX[Channel][Bin] = INDEX_NONE;
+				}
+			}
+
+			const FColor* SrcRow = Src.GetRow(Y);
+			FColor* DstRow = Dst.GetRow(Y);
+
+			for (int32 X = StartX; X < EndX; X++)
+			{
+				FColor Pixel = SrcRow[X];
+
+				for (int32 Channel = 0; Channel < NumChannels; Channel++)
+				{
+					FRankHistogram& Histogram = Square[Channel];
+
+					if (X > StartX)
+					{
+						const FRankHistogram& Added = GetColumn(X + Radius, Channel);
+						const FRankHistogram& Removed = GetColumn(X - Radius - 1, Channel);
+						SlideBins(Histogram.Coarse, Added.Coarse, Removed.Coarse);
+					}
+
+					// Coarse bin holding the rank
+					int32 Remaining = Rank;
+					const int32 CoarseBin = FindRankBin(Histogram.Coarse, Remaining);
+
+					// Bring its fine bins up to X: replay the columns that moved in and out, or rebuild when that's more work
+					uint16* Fine = Histogram.Fine + CoarseBin * FineBinsPerCoarseBin;
+					int32& UpToDateX = FineUpToDateX[Channel][CoarseBin];
+					if (UpToDateX == INDEX_NONE || 2 * (X - UpToDateX) > Diameter)
+					{
+						FMemory::Memzero(Fine, FineBinsPerCoarseBin * sizeof(uint16));
+						for (int32 Offset = -Radius; Offset <= Radius; Offset++)
+						{
+							const uint16* ColumnFine = GetColumn(X + Offset, Channel).Fine + CoarseBin * FineBinsPerCoarseBin;
+							for (int32 Bin = 0; Bin < FineBinsPerCoarseBin; Bin++)
+							{
+								Fine[Bin] += ColumnFine[Bin];
+							}
+						}
+					}
+					else
+					{
+						for (int32 StepX = UpToDateX + 1; StepX <= X; StepX++)
+						{
+							const uint16* AddedFine = GetColumn(StepX + Radius, Channel).Fine + CoarseBin * FineBinsPerCoarseBin;
+							const uint16* RemovedFine = GetColumn(StepX - Radius - 1, Channel).Fine + CoarseBin * FineBinsPerCoarseBin;
+							SlideBins(Fine, AddedFine, RemovedFine);
+						}
+					}
+					UpToDateX = X;
+
+					const int32 FineBin = FindRankBin(Fine, Remaining);
+
+					reinterpret_cast<uint8*>(&Pixel)[Offsets[Channel]] = (uint8)(CoarseBin * FineBinsPerCoarseBin + FineBin);
+				}
+
+				DstRow[X] = BitmapChannels::FinishFilteredPixel(Pixel, ColourChannel);
+			}
+		}
+	}
+
+	FORCEINLINE void SortPair(uint8& A, uint8& B)
+	{
+		const uint8 Low = FMath::Min(A, B);
+		B = FMath::Max(A, B);
+		A = Low;
+	}
+
+#if IMAGEIO_WITH_SSE2
+	FORCEINLINE void SortPair(__m128i& A, __m128i& B)
+	{
+		const __m128i Low = _mm_min_epu8(A, B);
+		B = _mm_max_epu8(A, B);
+		A = Low;
+	}
+#endif
+
+	/* Sorts 9 values with 25 compare-exchanges (Floyd's network). On registers, each byte lane gets sorted independently. */
+	template<typename ValueType>
+	FORCEINLINE void SortNine(ValueType* V)
+	{
+		SortPair(V[0], V[1]); SortPair(V[3], V[4]); SortPair(V[6], V[7]);
+		SortPair(V[1], V[2]); SortPair(V[4], V[5]); SortPair(V[7], V[8]);
+		SortPair(V[0], V[1]); SortPair(V[3], V[4]); SortPair(V[6], V[7]);
+		SortPair(V[0], V[3]); SortPair(V[3], V[6]); SortPair(V[0], V[3]);
+		SortPair(V[1], V[4]); SortPair(V[4], V[7]); SortPair(V[1], V[4]);
+		SortPair(V[2], V[5]); SortPair(V[5], V[8]); SortPair(V[2], V[5]);
+		SortPair(V[1], V[3]); SortPair(V[5], V[7]); SortPair(V[2], V[6]);
+		SortPair(V[4], V[6]); SortPair(V[2], V[4]); SortPair(V[2], V[3]);
+		SortPair(V[5], V[6]);
+	}
+
+	/* 3x3 rank filter over the columns [StartX, EndX) of every row, with a sorting network. Away from the edges 4 pixels are done at
+	once: the 9 registers hold the 3x3 neighbourhoods of 4 pixels, all 4 channels of each, and every byte lane is sorted on its own.
+	*/
+	void RankFilterStripNetwork(FConstBitmapView Src, int32 StartX, int32 EndX, int32 Rank, EFilterColourChannel ColourChannel, FBitmapView Dst)
+	{
+		const int32 Width = Src.Width;
+		const int32 Height = Src.Height;
+
+		// Edges and leftovers, one pixel at a time with clamped reads
+		auto FilterPixel = [&](int32 X, int32 Y)
+		{
+			FColor Neighbours[9];
+			for (int32 Tap = 0; Tap < 9; Tap++)
+			{
+				const int32 TapX = FMath::Clamp(X + Tap % 3 - 1, 0, Width - 1);
+				const int32 TapY = FMath::Clamp(Y + Tap / 3 - 1, 0, Height - 1);
+				Neighbours[Tap] = Src.GetRow(TapY)[TapX];
+			}
+
+			FColor Pixel;
+			for (int32 Offset = 0; Offset < 4; Offset++)
+			{
+				uint8 Values[9];
+				for (int32 Tap = 0; Tap < 9; Tap++)
+				{
+					Values[Tap] = GetChannel(Neighbours[Tap], Offset);
+				}
+				SortNine(Values);
+				reinterpret_cast<uint8*>(&Pixel)[Offset] = Values[Rank];
+			}
+			Dst.GetRow(Y)[X] = BitmapChannels::FinishFilteredPixel(Pixel, ColourChannel);
+		};
+
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			int32 X = StartX;
+
+#if IMAGEIO_WITH_SSE2
+			if (Y > 0 && Y < Height - 1)
+			{
+				if (X == 0)
+				{
+					FilterPixel(X++, Y);
+				}
+
+				FColor* DstRow = Dst.GetRow(Y);
+				for (; X + 4 <= EndX && X + 4 < Width; X += 4)
+				{
+					__m128i Values[9];
+					for (int32 Tap = 0; Tap < 9; Tap++)
+					{
+						Values[Tap] = _mm_loadu_si128((const __m128i*)(Src.GetRow(Y + Tap / 3 - 1) + X + Tap % 3 - 1));
+					}
+					SortNine(Values);
+					_mm_storeu_si128((__m128i*)(DstRow + X), Values[Rank]);
+
+					if (ColourChannel != EFilterColourChannel::RGBA)
+					{
+						for (int32 Index = X; Index < X + 4; Index++)
+						{
+							DstRow[Index] = BitmapChannels::FinishFilteredPixel(DstRow[Index], ColourChannel);
+						}
+					}
+				}
+			}
+#endif
+
+			for (; X < EndX; X++)
+			{
+				FilterPixel(X, Y);
+			}
+		}
+	}
+}
+
+int32 FBitmapRankFilter::GetRank(int32 Radius, float Percentile)
+{
+	const int32 NumSamples = FMath::Square(2 * Radius + 1);
+	return FMath::Clamp(FMath::RoundToInt(FMath::Clamp(Percentile, 0.0f, 100.0f) / 100.0f * (NumSamples - 1)), 0, NumSamples - 1);
+}
+
+void FBitmapRankFilter::Filter(FConstBitmapView Src, int32 Radius, float Percentile, EFilterColourChannel ColourChannel, FBitmapView Dst)
+{
+	const int32 Width = Src.Width;
+	const int32 Height = Src.Height;
+	if (Width <= 0 || Height <= 0)
+	{
+		return;
+	}
+
+	Radius = FMath::Clamp(Radius, 0, (int32)MaxRadius);
+	if (Radius == 0)
+	{
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			const FColor* SrcRow = Src.GetRow(Y);
+			FColor* DstRow = Dst.GetRow(Y);
+			for (int32 X = 0; X < Width; X++)
+			{
+				DstRow[X] = BitmapChannels::FinishFilteredPixel(SrcRow[X], ColourChannel);
+			}
+		}
+		return;
+	}
+
+	const int32 Rank = GetRank(Radius, Percentile);
+	const int32 NumStrips = FMath::DivideAndRoundUp(Width, RankStripWidth);
+
+	FBitmapParallel::ForRange(NumStrips, 1, [&](int32 StartStrip, int32 EndStrip)
+	{
+		for (int32 Strip = StartStrip; Strip < EndStrip; Strip++)
+		{
+			const int32 StartX = Strip * RankStripWidth;
+			const int32 EndX = FMath::Min(StartX + RankStripWidth, Width);
+
+			if (Radius == 1)
+			{
+				RankFilterStripNetwork(Src, StartX, EndX, Rank, ColourChannel, Dst);
+			}
+			else
+			{
+				RankFilterStripHistogram(Src, StartX, EndX, Radius, Rank, ColourChannel, Dst);
+			}
+		}
+	});
+}
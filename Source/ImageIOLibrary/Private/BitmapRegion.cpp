@@ -0,0 +1,164 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapRegion.h"
+#include "BitmapBorder.h"
+#include "BitmapParallel.h"
+
+namespace
+{
+	/* Rows handed to each thread: copies are bound by memory bandwidth, so only big regions are split. */
+	FORCEINLINE int32 GetRegionMinBatch(int32 Width)
+	{
+		return FMath::Max(1, 65536 / FMath::Max(Width, 1));
+	}
+
+	/* Whether two views share any pixel's memory, e.g. two rectangles of the same bitmap. */
+	bool RegionViewsOverlap(FConstBitmapView A, FConstBitmapView B)
+	{
+		const FColor* AEnd = A.GetRow(A.Height - 1) + A.Width;
+		const FColor* BEnd = B.GetRow(B.Height - 1) + B.Width;
+		return A.Data < BEnd && B.Data < AEnd;
+	}
+
+	FORCEINLINE void FillPixels(FColor* Dst, int32 Num, FColor Colour)
+	{
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			Dst[Index] = Colour;
+		}
+	}
+
+	/* Writes the Width pixels of a row starting at column First, which may be outside the Length pixels of SrcRow. Columns inside the row and
+	wrapped runs are copied in one go, clamped edges are filled and only mirrored columns go pixel by pixel.
+	*/
+	void CopyRowSpan(const FColor* SrcRow, int32 Length, int32 First, int32 Width, EBitmapBorderMode BorderMode, FColor BorderColour, FColor* Dst)
+	{
+		int32 X = 0;
+		while (X < Width)
+		{
+			const int32 Column = First + X;
+			int32 Run;
+
+			if (Column >= 0 && Column < Length)
+			{
+				Run = FMath::Min(Width - X, Length - Column);
+				FMemory::Memcpy(Dst + X, SrcRow + Column, Run * sizeof(FColor));
+			}
+			else if (BorderMode == EBitmapBorderMode::Wrap)
+			{
+				const int32 Resolved = BitmapBorder::ResolveIndex(Column, Length, BorderMode);
+				Run = FMath::Min(Width - X, Length - Resolved);
+				FMemory::Memcpy(Dst + X, SrcRow + Resolved, Run * sizeof(FColor));
+			}
+			else if (BorderMode == EBitmapBorderMode::Mirror)
+			{
+				Run = 1;
+				Dst[X] = SrcRow[BitmapBorder::ResolveIndex(Column, Length, BorderMode)];
+			}
+			else
+			{
+				// Everything up to the left edge, or to the end of the span past the right edge, is the same colour
+				Run = Column < 0 ? FMath::Min(Width - X, -Column) : Width - X;
+				const FColor Colour = BorderMode == EBitmapBorderMode::Clamp ? SrcRow[Column < 0 ? 0 : Length - 1] : BorderColour;
+				FillPixels(Dst + X, Run, Colour);
+			}
+			X += Run;
+		}
+	}
+}
+
+void FBitmapRegion::Copy(FConstBitmapView Src, FBitmapView Dst)
+{
+	check(Src.Width == Dst.Width && Src.Height == Dst.Height);
+	if (Src.Width <= 0 || Src.Height <= 0 || (Src.Data == Dst.Data && Src.Pitch == Dst.Pitch))
+	{
+		return;
+	}
+
+	// Overlapping rows would be read after being overwritten, and rows copied by other threads in any order: the source goes aside first
+	if (RegionViewsOverlap(Src, Dst))
+	{
+		TArray<FColor> Copied;
+		Copied.SetNumUninitialized(Src.Width * Src.Height);
+		Copy(Src, FBitmapView(Copied.GetData(), Src.GetSize()));
+		Copy(FConstBitmapView(Copied.GetData(), Src.GetSize()), Dst);
+		return;
+	}
+
+	// Both contiguous: one copy for the lot
+	if (Src.IsContiguous() && Dst.IsContiguous())
+	{
+		FMemory::Memcpy(Dst.Data, Src.Data, (int64)Src.Width * Src.Height * sizeof(FColor));
+		return;
+	}
+
+	FBitmapParallel::ForRange(Src.Height, GetRegionMinBatch(Src.Width), [&](int32 Start, int32 End)
+	{
+		for (int32 Y = Start; Y < End; Y++)
+		{
+			FMemory::Memcpy(Dst.GetRow(Y), Src.GetRow(Y), Src.Width * sizeof(FColor));
+		}
+	});
+}
+
+bool FBitmapRegion::Paste(FConstBitmapView Src, FBitmapView Dst, int32 X, int32 Y)
+{
+	const FBitmapView Target = Dst.GetSubView(FImageRect(X, Y, Src.Width, Src.Height));
+	if (Target.Width <= 0 || Target.Height <= 0)
+	{
+		return false;
+	}
+
+	// The part of Src that lands on Target
+	const FImageRect Visible(FMath::Max(-X, 0), FMath::Max(-Y, 0), Target.Width, Target.Height);
+	Copy(Src.GetSubView(Visible), Target);
+	return true;
+}
+
+void FBitmapRegion::Crop(FConstBitmapView Src, FImageRect Rect, EBitmapBorderMode BorderMode, FColor BorderColour, FBitmapView Dst)
+{
+	check(Rect.Width == Dst.Width && Rect.Height == Dst.Height);
+	if (Dst.Width <= 0 || Dst.Height <= 0)
+	{
+		return;
+	}
+
+	// Nothing to read from, every mode falls back to the border colour
+	if (Src.Width <= 0 || Src.Height <= 0)
+	{
+		BorderMode = EBitmapBorderMode::Constant;
+	}
+
+	// Entirely inside: a plain copy
+	if (Rect.X >= 0 && Rect.Y >= 0 && (int64)Rect.X + Rect.Width <= Src.Width && (int64)Rect.Y + Rect.Height <= Src.Height)
+	{
+		Copy(Src.GetSubView(Rect), Dst);
+		return;
+	}
+
+	FBitmapParallel::ForRange(Dst.Height, GetRegionMinBatch(Dst.Width), [&](int32 Start, int32 End)
+	{
+		for (int32 Y = Start; Y < End; Y++)
+		{
+			const int32 SrcY = BitmapBorder::ResolveIndex(Rect.Y + Y, Src.Height, BorderMode);
+			if (SrcY == INDEX_NONE)
+			{
+				FillPixels(Dst.GetRow(Y), Dst.Width, BorderColour);
+			}
+			else
+			{
+				CopyRowSpan(Src.GetRow(SrcY), Src.Width, Rect.X, Dst.Width, BorderMode, BorderColour, Dst.GetRow(Y));
+			}
+		}
+	});
+}
+
+void FBitmapRegion::Pad(FConstBitmapView Src, int32 Left, int32 Top, int32 Right, int32 Bottom, EBitmapBorderMode BorderMode, FColor BorderColour, FBitmapView Dst)
+{
+	Crop(Src, FImageRect(-Left, -Top, Src.Width + Left + Right, Src.Height + Top + Bottom), BorderMode, BorderColour, Dst);
+}
+
+void FBitmapRegion::Tile(FConstBitmapView Src, FBitmapView Dst)
+{
+	Crop(Src, FImageRect(0, 0, Dst.Width, Dst.Height), EBitmapBorderMode::Wrap, FColor(0, 0, 0, 0), Dst);
+}
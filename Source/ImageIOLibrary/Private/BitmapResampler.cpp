@@ -0,0 +1,304 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapResampler.h"
+#include "BitmapLinePass.h"
+#include "BitmapColourSpace.h"
+
+namespace
+{
+	/* Source pixels and weights of each output pixel of a line. Every output reads NumTaps consecutive pixels from its start, unused taps weigh 0,
+	so the inner loop has no bounds to check.
+	*/
+	struct FResampleTaps
+	{
+		int32 NumTaps;
+		TArray<int32> Starts;
+		TArray<float> Weights;
+	};
+
+	FResampleTaps MakeResampleTaps(int32 InLength, int32 OutLength, EBitmapResampleFilter Filter)
+	{
+		FResampleTaps Taps;
+		Taps.Starts.SetNumUninitialized(OutLength);
+
+		// Same size: every filter would be (or, for Mitchell, should be) a copy
+		if (InLength == OutLength)
+		{
+			Taps.NumTaps = 1;
+			Taps.Weights.Init(1.0f, OutLength);
+			for (int32 Index = 0; Index < OutLength; Index++)
+			{
+				Taps.Starts[Index] = Index;
+			}
+			return Taps;
+		}
+
+		// When shrinking, the filter stretches over Scale source pixels
+		const double Scale = (double)InLength / OutLength;
+		const double FilterScale = FMath::Max(Scale, 1.0);
+		const double Support = FBitmapResampler::GetFilterSupport(Filter) * FilterScale;
+
+		auto GetCentre = [Scale](int32 Index) { return (Index + 0.5) * Scale - 0.5; };
+		auto GetFirst = [&](int32 Index) { return FMath::Max(FMath::CeilToInt((float)(GetCentre(Index) - Support)), 0); };
+		auto GetLast = [&](int32 Index) { return FMath::Min(FMath::FloorToInt((float)(GetCentre(Index) + Support)), InLength - 1); };
+
+		Taps.NumTaps = 1;
+		for (int32 Index = 0; Index < OutLength; Index++)
+		{
+			Taps.NumTaps = FMath::Max(Taps.NumTaps, GetLast(Index) - GetFirst(Index) + 1);
+		}
+		Taps.NumTaps = FMath::Min(Taps.NumTaps, InLength);
+		Taps.Weights.SetNumZeroed(OutLength * Taps.NumTaps);
+
+		TArray<double> Folded;
+		Folded.SetNumUninitialized(Taps.NumTaps);
+
+		for (int32 Index = 0; Index < OutLength; Index++)
+		{
+			const double Centre = GetCentre(Index);
+			const int32 Start = FMath::Clamp(GetFirst(Index), 0, InLength - Taps.NumTaps);
+			Taps.Starts[Index] = Start;
+
+			// Taps past the edges are folded onto the edge pixels, which is the same as repeating them
+			for (double& Weight : Folded)
+			{
+				Weight = 0.0;
+			}
+			double Sum = 0.0;
+			for (int32 Source = FMath::CeilToInt((float)(Centre - Support)); Source <= FMath::FloorToInt((float)(Centre + Support)); Source++)
+			{
+				const double Weight = FBitmapResampler::EvaluateFilter(Filter, (float)((Source - Centre) / FilterScale));
+				Folded[FMath::Clamp(Source, 0, InLength - 1) - Start] += Weight;
+				Sum += Weight;
+			}
+
+			// Normalised so flat areas stay flat whatever the phase of the output pixel
+			float* Weights = Taps.Weights.GetData() + Index * Taps.NumTaps;
+			if (FMath::Abs(Sum) < 1e-8)
+			{
+				Weights[FMath::Clamp(FMath::RoundToInt((float)Centre), 0, InLength - 1) - Start] = 1.0f;
+				continue;
+			}
+			for (int32 Tap = 0; Tap < Taps.NumTaps; Tap++)
+			{
+				Weights[Tap] = (float)(Folded[Tap] / Sum);
+			}
+		}
+		return Taps;
+	}
+
+	/* Weighted sums of the taps of every output pixel, 4 channels at once. */
+	void ResampleLine(const VectorRegister* In, VectorRegister* Out, int32 OutLength, const FResampleTaps& Taps)
+	{
+		const int32 NumTaps = Taps.NumTaps;
+		const float* Weights = Taps.Weights.GetData();
+
+		for (int32 Index = 0; Index < OutLength; Index++)
+		{
+			const VectorRegister* Source = In + Taps.Starts[Index];
+			VectorRegister Sum = VectorMultiply(VectorLoadFloat1(Weights), Source[0]);
+			for (int32 Tap = 1; Tap < NumTaps; Tap++)
+			{
+				Sum = VectorMultiplyAdd(VectorLoadFloat1(Weights + Tap), Source[Tap], Sum);
+			}
+			Out[Index] = Sum;
+			Weights += NumTaps;
+		}
+	}
+
+	/* How pixels are turned into the values that get filtered, and back. */
+	struct FResampleEncoding
+	{
+		// Null when filtering the sRGB values as they are
+		const float* SRGBToLinear;
+		const uint8* LinearToSRGB;
+		bool bPremultipliedAlpha;
+
+		/* Channels from 0 to 1 in memory order (B, G, R, A), decoded to linear light and premultiplied as asked. */
+		FORCEINLINE VectorRegister Decode(const FColor& Pixel) const
+		{
+			const float Alpha = Pixel.A * (1.0f / 255.0f);
+			float Red;
+			float Green;
+			float Blue;
+			if (SRGBToLinear)
+			{
+				Red = SRGBToLinear[Pixel.R];
+				Green = SRGBToLinear[Pixel.G];
+				Blue = SRGBToLinear[Pixel.B];
+			}
+			else
+			{
+				Red = Pixel.R * (1.0f / 255.0f);
+				Green = Pixel.G * (1.0f / 255.0f);
+				Blue = Pixel.B * (1.0f / 255.0f);
+			}
+
+			if (bPremultipliedAlpha)
+			{
+				Red *= Alpha;
+				Green *= Alpha;
+				Blue *= Alpha;
+			}
+			return MakeVectorRegister(Blue, Green, Red, Alpha);
+		}
+
+		FORCEINLINE uint8 EncodeChannel(float Value) const
+		{
+			return LinearToSRGB ? BitmapColourSpace::LinearToSRGB(LinearToSRGB, Value) : (uint8)(FMath::Clamp(Value, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+
+		/* Back to a straight alpha sRGB pixel. Filters with negative lobes overshoot, everything gets clamped. */
+		FORCEINLINE FColor Encode(const VectorRegister& Value) const
+		{
+			float Channels[4];
+			VectorStore(Value, Channels);
+
+			const float Alpha = FMath::Clamp(Channels[3], 0.0f, 1.0f);
+			const uint8 Alpha8 = (uint8)(Alpha * 255.0f + 0.5f);
+
+			if (bPremultipliedAlpha)
+			{
+				// Fully transparent pixels come back as transparent black
+				if (Alpha8 == 0)
+				{
+					return FColor(0, 0, 0, 0);
+				}
+
+				const float InvAlpha = 1.0f / Alpha;
+				Channels[0] *= InvAlpha;
+				Channels[1] *= InvAlpha;
+				Channels[2] *= InvAlpha;
+			}
+			return FColor(EncodeChannel(Channels[2]), EncodeChannel(Channels[1]), EncodeChannel(Channels[0]), Alpha8);
+		}
+	};
+}
+
+void FBitmapResampler::Resize(FConstBitmapView Src, EBitmapResampleFilter Filter, bool bLinearLight, bool bPremultipliedAlpha, FBitmapView Dst)
+{
+	const FImageSize Size = Src.GetSize();
+	const FImageSize NewSize = Dst.GetSize();
+	if (Size.X <= 0 || Size.Y <= 0 || NewSize.X <= 0 || NewSize.Y <= 0)
+	{
+		return;
+	}
+
+	const FResampleTaps RowTaps = MakeResampleTaps(Size.X, NewSize.X, Filter);
+	const FResampleTaps ColumnTaps = MakeResampleTaps(Size.Y, NewSize.Y, Filter);
+
+	FResampleEncoding Encoding;
+	Encoding.SRGBToLinear = bLinearLight ? BitmapColourSpace::GetSRGBToLinearTable() : nullptr;
+	Encoding.LinearToSRGB = bLinearLight ? BitmapColourSpace::GetLinearToSRGBTable() : nullptr;
+	Encoding.bPremultipliedAlpha = bPremultipliedAlpha;
+
+	// Rows to the new width, written transposed: NewSize.X lines of Size.Y values
+	TArray<VectorRegister> Transposed;
+	Transposed.SetNumUninitialized(NewSize.X * Size.Y);
+	const TBitmapView<VectorRegister> TransposedView(Transposed.GetData(), Size.Y, NewSize.X, Size.Y);
+
+	FBitmapLinePass::Run<FColor, VectorRegister, VectorRegister>(Src, TransposedView, [&]()
+	{
+		TArray<VectorRegister> Decoded;
+		Decoded.SetNumUninitialized(Size.X);
+		return [&RowTaps, &Encoding, &NewSize, Decoded](const FColor* In, VectorRegister* Out) mutable
+		{
+			for (int32 Index = 0; Index < Decoded.Num(); Index++)
+			{
+				Decoded[Index] = Encoding.Decode(In[Index]);
+			}
+			ResampleLine(Decoded.GetData(), Out, NewSize.X, RowTaps);
+		};
+	},
+	[](const VectorRegister& Value) { return Value; });
+
+	// Columns to the new height, transposed back into place
+	FBitmapLinePass::Run<VectorRegister, VectorRegister, FColor>(TransposedView, Dst, [&]()
+	{
+		return [&ColumnTaps, &NewSize](const VectorRegister* In, VectorRegister* Out)
+		{
+			ResampleLine(In, Out, NewSize.Y, ColumnTaps);
+		};
+	},
+	[&Encoding](const VectorRegister& Value)
+	{
+		return Encoding.Encode(Value);
+	});
+}
+
+float FBitmapResampler::GetFilterSupport(EBitmapResampleFilter Filter)
+{
+	switch (Filter)
+	{
+	case EBitmapResampleFilter::Box:
+		return 0.5f;
+	case EBitmapResampleFilter::Bilinear:
+		return 1.0f;
+	case EBitmapResampleFilter::Bicubic:
+	case EBitmapResampleFilter::Mitchell:
+		return 2.0f;
+	default:
+		return 3.0f;
+	}
+}
+
+float FBitmapResampler::EvaluateFilter(EBitmapResampleFilter Filter, float X)
+{
+	const float Distance = FMath::Abs(X);
+
+	switch (Filter)
+	{
+	case EBitmapResampleFilter::Box:
+		// Half open so a pixel exactly between two outputs only counts once
+		return X >= -0.5f && X < 0.5f ? 1.0f : 0.0f;
+
+	case EBitmapResampleFilter::Bilinear:
+		return FMath::Max(1.0f - Distance, 0.0f);
+
+	case EBitmapResampleFilter::Bicubic:
+	{
+		// Keys cubic with a = -0.5 (Catmull-Rom)
+		const float A = -0.5f;
+		if (Distance < 1.0f)
+		{
+			return ((A + 2.0f) * Distance - (A + 3.0f)) * Distance * Distance + 1.0f;
+		}
+		if (Distance < 2.0f)
+		{
+			return ((A * Distance - 5.0f * A) * Distance + 8.0f * A) * Distance - 4.0f * A;
+		}
+		return 0.0f;
+	}
+
+	case EBitmapResampleFilter::Mitchell:
+	{
+		// Mitchell-Netravali with B = C = 1/3
+		const float B = 1.0f / 3.0f;
+		const float C = 1.0f / 3.0f;
+		if (Distance < 1.0f)
+		{
+			return ((12.0f - 9.0f * B - 6.0f * C) * Distance * Distance * Distance + (-18.0f + 12.0f * B + 6.0f * C) * Distance * Distance + (6.0f - 2.0f * B)) / 6.0f;
+		}
+		if (Distance < 2.0f)
+		{
+			return ((-B - 6.0f * C) * Distance * Distance * Distance + (6.0f * B + 30.0f * C) * Distance * Distance + (-12.0f * B - 48.0f * C) * Distance + (8.0f * B + 24.0f * C)) / 6.0f;
+		}
+		return 0.0f;
+	}
+
+	default:
+	{
+		// Lanczos with 3 lobes: sinc(X) * sinc(X / 3)
+		if (Distance < 1e-6f)
+		{
+			return 1.0f;
+		}
+		if (Distance >= 3.0f)
+		{
+			return 0.0f;
+		}
+		const float PiX = PI * X;
+		return 3.0f * FMath::Sin(PiX) * FMath::Sin(PiX / 3.0f) / (PiX * PiX);
+	}
+	}
+}
@@ -0,0 +1,38 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapSampler.h"
+#include "BitmapBorder.h"
+#include "BitmapInterpolation.h"
+#include "BitmapParallel.h"
+
+namespace
+{
+	// Samples are cheap, a batch has to be big before threads pay off
+	const int32 SamplerMinBatch = 4096;
+}
+
+void FBitmapSampler::SamplePixels(FConstBitmapView Src, const FIntPoint* Points, int32 Num, EBitmapBorderMode BorderMode, FColor BorderColour, FColor* Dst)
+{
+	FBitmapParallel::ForRange(Num, SamplerMinBatch, [&](int32 Start, int32 End)
+	{
+		for (int32 Index = Start; Index < End; Index++)
+		{
+			Dst[Index] = BitmapBorder::ReadPixel(Src, Points[Index].X, Points[Index].Y, BorderMode, BorderColour);
+		}
+	});
+}
+
+void FBitmapSampler::SampleUVs(FConstBitmapView Src, const FVector2D* UVs, int32 Num, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode, FColor BorderColour,
+	FColor* Dst)
+{
+	FBitmapParallel::ForRange(Num, SamplerMinBatch, [&](int32 Start, int32 End)
+	{
+		for (int32 Index = Start; Index < End; Index++)
+		{
+			// To texel space, where pixel centres are whole numbers
+			const float X = UVs[Index].X * Src.Width - 0.5f;
+			const float Y = UVs[Index].Y * Src.Height - 0.5f;
+			Dst[Index] = BitmapInterpolation::Sample(Src, X, Y, Filter, BorderMode, BorderColour);
+		}
+	});
+}
@@ -0,0 +1,67 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// SSE2 helpers for the 8 bit bitmap kernels. SSE2 is part of every x64 CPU we ship on (Win64 and Mac),
+// other targets compile the scalar fallbacks instead.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+	#define IMAGEIO_WITH_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define IMAGEIO_WITH_SSE2 0
+#endif
+
+namespace BitmapSimd
+{
+	/* Rounded A * B / 255 for A and B in [0, 255], exact for every input pair. */
+	FORCEINLINE uint32 Mul255(uint32 A, uint32 B)
+	{
+		const uint32 T = A * B + 128;
+		return (T + (T >> 8)) >> 8;
+	}
+
+	/* Copies NumPixels 4 byte pixels swapping their first and third bytes, which turns BGRA (FColor) into RGBA and back. Src and Dst may be the same buffer. */
+	FORCEINLINE void SwapRedBlue(const void* Src, void* Dst, int64 NumPixels)
+	{
+		const uint32* Source = (const uint32*)Src;
+		uint32* Destination = (uint32*)Dst;
+		int64 Index = 0;
+
+#if IMAGEIO_WITH_SSE2
+		const __m128i KeepMask = _mm_set1_epi32(0xFF00FF00);
+		const __m128i LowMask = _mm_set1_epi32(0x000000FF);
+		for (; Index + 4 <= NumPixels; Index += 4)
+		{
+			const __m128i Pixels = _mm_loadu_si128((const __m128i*)(Source + Index));
+			const __m128i Kept = _mm_and_si128(Pixels, KeepMask);
+			const __m128i Down = _mm_and_si128(_mm_srli_epi32(Pixels, 16), LowMask);
+			const __m128i Up = _mm_slli_epi32(_mm_and_si128(Pixels, LowMask), 16);
+			_mm_storeu_si128((__m128i*)(Destination + Index), _mm_or_si128(Kept, _mm_or_si128(Down, Up)));
+		}
+#endif
+
+		for (; Index < NumPixels; Index++)
+		{
+			const uint32 Pixel = Source[Index];
+			Destination[Index] = (Pixel & 0xFF00FF00) | ((Pixel >> 16) & 0xFF) | ((Pixel & 0xFF) << 16);
+		}
+	}
+
+#if IMAGEIO_WITH_SSE2
+	/* Lane-wise rounded A * B / 255 on 16 bit lanes holding values in [0, 255]. */
+	FORCEINLINE __m128i Mul255_Epi16(__m128i A, __m128i B)
+	{
+		const __m128i T = _mm_add_epi16(_mm_mullo_epi16(A, B), _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(T, _mm_srli_epi16(T, 8)), 8);
+	}
+
+	/* Copies the alpha lane of each pixel (lanes 3 and 7 of an unpacked B G R A B G R A register) into its colour lanes. */
+	FORCEINLINE __m128i BroadcastAlpha_Epi16(__m128i Pixels)
+	{
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(Pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+#endif
+}
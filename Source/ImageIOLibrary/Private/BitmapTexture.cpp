@@ -0,0 +1,332 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapTexture.h"
+#include "BitmapMipChain.h"
+#include "BitmapBlockCompression.h"
+#include "BitmapSimd.h"
+#include "BitmapParallel.h"
+
+#include "Engine/Texture2D.h"
+
+namespace
+{
+	/* Uploads Rects of the texture's first mip, row Row of rect RectIndex being read from GetSourceRow(RectIndex, Row). */
+	void UploadTextureRects(UTexture2D* Texture, const TArray<FImageRect>& Rects, TFunctionRef<const FColor*(int32, int32)> GetSourceRow)
+	{
+		if (Rects.Num() == 0)
+		{
+			return;
+		}
+
+		const int32 Width = Texture->GetSizeX();
+		const bool bSwapRedBlue = Texture->GetPixelFormat(0) == PF_R8G8B8A8;
+
+		// The rects are packed one above the other, in a buffer that belongs to the render thread until it has uploaded them
+		int32 PackedWidth = 0;
+		int32 PackedHeight = 0;
+		for (const FImageRect& Rect : Rects)
+		{
+			PackedWidth = FMath::Max(PackedWidth, Rect.Width);
+			PackedHeight += Rect.Height;
+		}
+		uint8* Packed = (uint8*)FMemory::Malloc((SIZE_T)PackedWidth * PackedHeight * sizeof(FColor));
+		FUpdateTextureRegion2D* Regions = new FUpdateTextureRegion2D[Rects.Num()];
+
+		// Textures that dropped their CPU copy (cooked assets) only get the GPU update
+		FByteBulkData& BulkData = Texture->PlatformData->Mips[0].BulkData;
+		const bool bUpdateBulkData = BulkData.IsBulkDataLoaded() && BulkData.GetBulkDataSize() == (int64)Width * Texture->GetSizeY() * sizeof(FColor);
+		uint8* Mip = bUpdateBulkData ? (uint8*)BulkData.Lock(LOCK_READ_WRITE) : nullptr;
+
+		int32 PackedY = 0;
+		for (int32 RectIndex = 0; RectIndex < Rects.Num(); RectIndex++)
+		{
+			const FImageRect& Rect = Rects[RectIndex];
+			Regions[RectIndex] = FUpdateTextureRegion2D(Rect.X, Rect.Y, 0, PackedY, Rect.Width, Rect.Height);
+
+			for (int32 Row = 0; Row < Rect.Height; Row++)
+			{
+				const FColor* Source = GetSourceRow(RectIndex, Row);
+				uint8* Out = Packed + (int64)(PackedY + Row) * PackedWidth * sizeof(FColor);
+				if (bSwapRedBlue)
+				{
+					BitmapSimd::SwapRedBlue(Source, Out, Rect.Width);
+				}
+				else
+				{
+					FMemory::Memcpy(Out, Source, Rect.Width * sizeof(FColor));
+				}
+
+				if (Mip)
+				{
+					FMemory::Memcpy(Mip + ((int64)(Rect.Y + Row) * Width + Rect.X) * sizeof(FColor), Out, Rect.Width * sizeof(FColor));
+				}
+			}
+			PackedY += Rect.Height;
+		}
+
+		if (Mip)
+		{
+			BulkData.Unlock();
+		}
+
+		Texture->UpdateTextureRegions(0, Rects.Num(), Regions, PackedWidth * sizeof(FColor), sizeof(FColor), Packed, [](uint8* SrcData, const FUpdateTextureRegion2D* InRegions)
+		{
+			FMemory::Free(SrcData);
+			delete[] InRegions;
+		});
+	}
+}
+
+UTexture2D* FBitmapTexture::CreateTransient(const void* Pixels, FImageSize Size, bool bGenerateMips, EBitmapTextureCompression Compression)
+{
+	// Only the first mip needs whole blocks, smaller mips are padded to a block by the format itself
+	if (Compression != EBitmapTextureCompression::None && (Size.X % 4 != 0 || Size.Y % 4 != 0))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Block compressed textures need a width and height that are multiples of 4, the %dx%d texture is created uncompressed."), Size.X, Size.Y);
+		Compression = EBitmapTextureCompression::None;
+	}
+
+	UTexture2D* Texture = UTexture2D::CreateTransient(Size.X, Size.Y, FBitmapBlockCompression::GetPixelFormat(Compression));
+	if (!Texture)
+	{
+		return nullptr;
+	}
+
+	// CreateTransient only makes the first mip, the others are added to the platform data before the resource is created
+	FTexturePlatformData* PlatformData = Texture->PlatformData;
+	const int32 NumMips = bGenerateMips ? FBitmapMipChain::GetNumMips(Size) : 1;
+	for (int32 MipIndex = 1; MipIndex < NumMips; MipIndex++)
+	{
+		const FImageSize MipSize = FBitmapMipChain::GetMipSize(Size, MipIndex);
+		FTexture2DMipMap* Mip = new FTexture2DMipMap();
+		Mip->SizeX = MipSize.X;
+		Mip->SizeY = MipSize.Y;
+		PlatformData->Mips.Add(Mip);
+	}
+
+	TArray<void*> MipData;
+	MipData.Add(PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE));
+	for (int32 MipIndex = 1; MipIndex < NumMips; MipIndex++)
+	{
+		FTexture2DMipMap& Mip = PlatformData->Mips[MipIndex];
+		Mip.BulkData.Lock(LOCK_READ_WRITE);
+		MipData.Add(Mip.BulkData.Realloc(FBitmapBlockCompression::GetCompressedSize(FImageSize(Mip.SizeX, Mip.SizeY), Compression)));
+	}
+
+	// Uncompressed levels are built straight into the bulk data, compressed ones go through a copy first
+	TArray<TArray<FColor>> Levels;
+	TArray<FColor*> LevelPixels;
+	for (int32 MipIndex = 1; MipIndex < NumMips; MipIndex++)
+	{
+		if (Compression == EBitmapTextureCompression::None)
+		{
+			LevelPixels.Add((FColor*)MipData[MipIndex]);
+		}
+		else
+		{
+			const FImageSize MipSize = FBitmapMipChain::GetMipSize(Size, MipIndex);
+			TArray<FColor>& Level = Levels.AddDefaulted_GetRef();
+			Level.SetNumUninitialized(MipSize.X * MipSize.Y);
+			LevelPixels.Add(Level.GetData());
+		}
+	}
+	FBitmapMipChain::Generate(FConstBitmapView((const FColor*)Pixels, Size), Texture->SRGB, LevelPixels);
+
+	if (Compression == EBitmapTextureCompression::None)
+	{
+		FMemory::Memcpy(MipData[0], Pixels, (int64)Size.X * Size.Y * sizeof(FColor));
+	}
+	else
+	{
+		FBitmapBlockCompression::Compress(FConstBitmapView((const FColor*)Pixels, Size), Compression, MipData[0]);
+		for (int32 MipIndex = 1; MipIndex < NumMips; MipIndex++)
+		{
+			FBitmapBlockCompression::Compress(FConstBitmapView(LevelPixels[MipIndex - 1], FBitmapMipChain::GetMipSize(Size, MipIndex)), Compression, MipData[MipIndex]);
+		}
+	}
+
+	for (int32 MipIndex = 0; MipIndex < NumMips; MipIndex++)
+	{
+		PlatformData->Mips[MipIndex].BulkData.Unlock();
+	}
+	Texture->UpdateResource();
+	return Texture;
+}
+
+void FBitmapTexture::UpdateRegions(UTexture2D* Texture, const FColor* Bitmap, const TArray<FImageRect>& Rects)
+{
+	const int32 Width = Texture->GetSizeX();
+	UploadTextureRects(Texture, Rects, [&](int32 RectIndex, int32 Row)
+	{
+		return Bitmap + (int64)(Rects[RectIndex].Y + Row) * Width + Rects[RectIndex].X;
+	});
+}
+
+void FBitmapTexture::UploadBitmaps(UTexture2D* Texture, const TArray<FConstBitmapView>& Sources, const TArray<FIntPoint>& Positions)
+{
+	check(Sources.Num() == Positions.Num());
+
+	TArray<FImageRect> Rects;
+	Rects.Reserve(Sources.Num());
+	for (int32 Index = 0; Index < Sources.Num(); Index++)
+	{
+		Rects.Add(FImageRect(Positions[Index].X, Positions[Index].Y, Sources[Index].Width, Sources[Index].Height));
+	}
+
+	UploadTextureRects(Texture, Rects, [&](int32 RectIndex, int32 Row)
+	{
+		return Sources[RectIndex].GetRow(Row);
+	});
+}
+
+void FBitmapTexture::UpdateMips(UTexture2D* Texture)
+{
+	FTexturePlatformData* PlatformData = Texture->PlatformData;
+	const int32 NumMips = PlatformData->Mips.Num();
+	if (NumMips <= 1 || !PlatformData->Mips[0].BulkData.IsBulkDataLoaded())
+	{
+		return;
+	}
+
+	const FImageSize Size(Texture->GetSizeX(), Texture->GetSizeY());
+	const FColor* FirstMip = (const FColor*)PlatformData->Mips[0].BulkData.Lock(LOCK_READ_ONLY);
+	TArray<FColor*> Mips;
+	for (int32 MipIndex = 1; MipIndex < NumMips; MipIndex++)
+	{
+		Mips.Add((FColor*)PlatformData->Mips[MipIndex].BulkData.Lock(LOCK_READ_WRITE));
+	}
+
+	// Channel order doesn't matter to the mip chain, only alpha being last does
+	FBitmapMipChain::Generate(FConstBitmapView(FirstMip, Size), Texture->SRGB, Mips);
+
+	for (int32 MipIndex = 1; MipIndex < NumMips; MipIndex++)
+	{
+		const FImageSize MipSize = FBitmapMipChain::GetMipSize(Size, MipIndex);
+		const SIZE_T MipBytes = (SIZE_T)MipSize.X * MipSize.Y * sizeof(FColor);
+		uint8* Pixels = (uint8*)FMemory::Malloc(MipBytes);
+		FMemory::Memcpy(Pixels, Mips[MipIndex - 1], MipBytes);
+		PlatformData->Mips[MipIndex].BulkData.Unlock();
+
+		FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, 0, 0, 0, MipSize.X, MipSize.Y);
+		Texture->UpdateTextureRegions(MipIndex, 1, Region, MipSize.X * sizeof(FColor), sizeof(FColor), Pixels, [](uint8* SrcData, const FUpdateTextureRegion2D* InRegions)
+		{
+			FMemory::Free(SrcData);
+			delete InRegions;
+		});
+	}
+	PlatformData->Mips[0].BulkData.Unlock();
+}
+
+bool FBitmapTexture::ReadPixels(UTexture2D* Texture, FColor* Dst)
+{
+	bool bSwapRedBlue;
+	const FColor* Pixels = LockPixels(Texture, bSwapRedBlue);
+	if (!Pixels)
+	{
+#if WITH_EDITORONLY_DATA
+		// Imported assets are usually compressed, the editor still has the pixels they were imported from
+		return ReadSourcePixels(Texture, Dst);
+#else
+		return false;
+#endif
+	}
+
+	// Bound by memory bandwidth, a few threads still help on big textures
+	const int32 Width = Texture->GetSizeX();
+	FBitmapParallel::ForRange(Texture->GetSizeY(), FMath::Max(1, 65536 / Width), [&](int32 Start, int32 End)
+	{
+		const int64 First = (int64)Start * Width;
+		const int64 Num = (int64)(End - Start) * Width;
+		if (bSwapRedBlue)
+		{
+			BitmapSimd::SwapRedBlue(Pixels + First, Dst + First, Num);
+		}
+		else
+		{
+			FMemory::Memcpy(Dst + First, Pixels + First, Num * sizeof(FColor));
+		}
+	});
+
+	UnlockPixels(Texture);
+	return true;
+}
+
+const FColor* FBitmapTexture::LockPixels(UTexture2D* Texture, bool& bOutSwapRedBlue)
+{
+	const EPixelFormat Format = Texture->GetPixelFormat(0);
+	if (!Texture->PlatformData || (Format != PF_R8G8B8A8 && Format != PF_B8G8R8A8))
+	{
+		return nullptr;
+	}
+
+	FByteBulkData& BulkData = Texture->PlatformData->Mips[0].BulkData;
+	if (!BulkData.IsBulkDataLoaded() || BulkData.GetBulkDataSize() != (int64)Texture->GetSizeX() * Texture->GetSizeY() * sizeof(FColor))
+	{
+		return nullptr;
+	}
+
+	bOutSwapRedBlue = Format == PF_R8G8B8A8;
+	return (const FColor*)BulkData.LockReadOnly();
+}
+
+void FBitmapTexture::UnlockPixels(UTexture2D* Texture)
+{
+	Texture->PlatformData->Mips[0].BulkData.Unlock();
+}
+
+#if WITH_EDITORONLY_DATA
+bool FBitmapTexture::ReadSourcePixels(UTexture2D* Texture, FColor* Dst)
+{
+	FTextureSource& Source = Texture->Source;
+	if (!Source.IsValid() || Source.GetSizeX() != Texture->GetSizeX() || Source.GetSizeY() != Texture->GetSizeY())
+	{
+		return false;
+	}
+
+	const ETextureSourceFormat Format = Source.GetFormat();
+	if (Format != TSF_BGRA8 && Format != TSF_G8 && Format != TSF_RGBA16)
+	{
+		return false;
+	}
+
+	TArray64<uint8> MipData;
+	if (!Source.GetMipData(MipData, 0))
+	{
+		return false;
+	}
+
+	const int64 NumPixels = (int64)Texture->GetSizeX() * Texture->GetSizeY();
+	if (MipData.Num() != NumPixels * Source.GetBytesPerPixel())
+	{
+		return false;
+	}
+
+	switch (Format)
+	{
+	case TSF_BGRA8:
+		FMemory::Memcpy(Dst, MipData.GetData(), NumPixels * sizeof(FColor));
+		break;
+
+	case TSF_G8:
+		for (int64 Index = 0; Index < NumPixels; Index++)
+		{
+			const uint8 Value = MipData[Index];
+			Dst[Index] = FColor(Value, Value, Value, 255);
+		}
+		break;
+
+	default:
+	{
+		// RGBA, 16 bits per channel: the top byte of each
+		const uint16* Channels = (const uint16*)MipData.GetData();
+		for (int64 Index = 0; Index < NumPixels; Index++)
+		{
+			const uint16* Pixel = Channels + Index * 4;
+			Dst[Index] = FColor(Pixel[0] >> 8, Pixel[1] >> 8, Pixel[2] >> 8, Pixel[3] >> 8);
+		}
+		break;
+	}
+	}
+	return true;
+}
+#endif
@@ -0,0 +1,138 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapTexturePool.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/Texture2D.h"
+
+static TAutoConsoleVariable<int32> CVarImageIOTexturePoolBudget(
+	TEXT("ImageIO.TexturePoolBudget"),
+	256,
+	TEXT("Megabytes of released textures the ImageIOLibrary texture pool keeps for reuse. The oldest ones are dropped past it, 0 disables pooling."),
+	ECVF_Default);
+
+namespace
+{
+	TUniquePtr<FBitmapTexturePool> GBitmapTexturePool;
+
+	/* Memory taken by every mip of a texture. */
+	int64 GetTextureBytes(FImageSize Size, EPixelFormat Format, int32 NumMips)
+	{
+		const FPixelFormatInfo& Info = GPixelFormats[Format];
+		int64 Bytes = 0;
+		for (int32 MipIndex = 0; MipIndex < NumMips; MipIndex++)
+		{
+			const int32 Width = FMath::Max(Size.X >> MipIndex, 1);
+			const int32 Height = FMath::Max(Size.Y >> MipIndex, 1);
+			Bytes += (int64)FMath::DivideAndRoundUp(Width, Info.BlockSizeX) * FMath::DivideAndRoundUp(Height, Info.BlockSizeY) * Info.BlockBytes;
+		}
+		return Bytes;
+	}
+}
+
+FBitmapTexturePool& FBitmapTexturePool::Get()
+{
+	if (!GBitmapTexturePool)
+	{
+		GBitmapTexturePool.Reset(new FBitmapTexturePool());
+	}
+	return *GBitmapTexturePool;
+}
+
+void FBitmapTexturePool::Shutdown()
+{
+	GBitmapTexturePool.Reset();
+}
+
+FBitmapTexturePool::FBitmapTexturePool()
+	: FreeBytes(0)
+	, NumCreated(0)
+	, NumReused(0)
+{
+}
+
+UTexture2D* FBitmapTexturePool::Acquire(FImageSize Size, EPixelFormat Format, int32 NumMips)
+{
+	// Most recently released first, its resource is the most likely to still be warm
+	for (int32 Index = FreeTextures.Num() - 1; Index >= 0; Index--)
+	{
+		const FPooledTexture& Pooled = FreeTextures[Index];
+		if (Pooled.Size.X == Size.X && Pooled.Size.Y == Size.Y && Pooled.Format == Format && Pooled.NumMips == NumMips && Pooled.Texture)
+		{
+			UTexture2D* Texture = Pooled.Texture;
+			FreeBytes -= Pooled.Bytes;
+			FreeTextures.RemoveAt(Index);
+			NumReused++;
+			return Texture;
+		}
+	}
+
+	return nullptr;
+}
+
+bool FBitmapTexturePool::Release(UTexture2D* Texture)
+{
+	if (!Texture || Texture->GetOuter() != GetTransientPackage() || !Texture->PlatformData || Texture->GetPixelFormat(0) != PF_R8G8B8A8
+		|| !Texture->PlatformData->Mips[0].BulkData.IsBulkDataLoaded())
+	{
+		return false;
+	}
+	for (const FPooledTexture& Pooled : FreeTextures)
+	{
+		if (Pooled.Texture == Texture)
+		{
+			return false;
+		}
+	}
+
+	FPooledTexture Pooled;
+	Pooled.Texture = Texture;
+	Pooled.Size = FImageSize(Texture->GetSizeX(), Texture->GetSizeY());
+	Pooled.Format = Texture->GetPixelFormat(0);
+	Pooled.NumMips = Texture->GetNumMips();
+	Pooled.Bytes = GetTextureBytes(Pooled.Size, Pooled.Format, Pooled.NumMips);
+	FreeTextures.Add(Pooled);
+	FreeBytes += Pooled.Bytes;
+
+	Trim((int64)FMath::Max(CVarImageIOTexturePoolBudget.GetValueOnGameThread(), 0) * 1024 * 1024);
+	return true;
+}
+
+void FBitmapTexturePool::Empty()
+{
+	Trim(0);
+}
+
+FTexturePoolStats FBitmapTexturePool::GetStats() const
+{
+	FTexturePoolStats Stats;
+	Stats.FreeTextures = FreeTextures.Num();
+	Stats.FreeMegabytes = (float)(FreeBytes / (1024.0 * 1024.0));
+	Stats.CreatedTextures = NumCreated;
+	Stats.ReusedTextures = NumReused;
+	Stats.ReuseRate = NumCreated + NumReused > 0 ? (float)NumReused / (NumCreated + NumReused) : 0.0f;
+	return Stats;
+}
+
+void FBitmapTexturePool::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (FPooledTexture& Pooled : FreeTextures)
+	{
+		Collector.AddReferencedObject(Pooled.Texture);
+	}
+}
+
+FString FBitmapTexturePool::GetReferencerName() const
+{
+	return TEXT("FBitmapTexturePool");
+}
+
+void FBitmapTexturePool::Trim(int64 MaxBytes)
+{
+	int32 NumDropped = 0;
+	while (NumDropped < FreeTextures.Num() && FreeBytes > MaxBytes)
+	{
+		FreeBytes -= FreeTextures[NumDropped].Bytes;
+		NumDropped++;
+	}
+	FreeTextures.RemoveAt(0, NumDropped);
+}
@@ -0,0 +1,233 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "BitmapWarp.h"
+#include "BitmapInterpolation.h"
+#include "BitmapParallel.h"
+
+namespace
+{
+	// Output tiles: 64x64 pixels read a source footprint that stays in L2 for any sane zoom
+	const int32 WarpTileSize = 64;
+
+	// Smallest homogeneous W still treated as in front of the viewer
+	const double MinWarpW = 1e-9;
+
+	/* Warps the output pixels of one tile. Both template arguments are known at compile time so the inner loop has no filter switch. */
+	template<EBitmapSampleFilter Filter, bool bAffine>
+	void WarpTile(const FConstBitmapView& Src, const FBitmapHomography& Matrix, EBitmapBorderMode BorderMode, FColor BorderColour,
+		int32 FirstX, int32 LastX, int32 FirstY, int32 LastY, const FBitmapView& Dst)
+	{
+		const double (&M)[3][3] = Matrix.M;
+
+		for (int32 Y = FirstY; Y < LastY; Y++)
+		{
+			// Centre of the first pixel of the row, then one pixel to the right at a time
+			const double CentreX = FirstX + 0.5;
+			const double CentreY = Y + 0.5;
+			double U = M[0][0] * CentreX + M[0][1] * CentreY + M[0][2];
+			double V = M[1][0] * CentreX + M[1][1] * CentreY + M[1][2];
+			double W = M[2][0] * CentreX + M[2][1] * CentreY + M[2][2];
+
+			FColor* Out = Dst.GetRow(Y);
+			for (int32 X = FirstX; X < LastX; X++, U += M[0][0], V += M[1][0], W += M[2][0])
+			{
+				float SourceX;
+				float SourceY;
+				if (bAffine)
+				{
+					SourceX = (float)U;
+					SourceY = (float)V;
+				}
+				else
+				{
+					if (W < MinWarpW)
+					{
+						Out[X] = BorderColour;
+						continue;
+					}
+					const double InvW = 1.0 / W;
+					SourceX = (float)(U * InvW);
+					SourceY = (float)(V * InvW);
+				}
+
+				// To texel space, where pixel centres are whole numbers
+				Out[X] = BitmapInterpolation::Sample(Src, SourceX - 0.5f, SourceY - 0.5f, Filter, BorderMode, BorderColour);
+			}
+		}
+	}
+
+	template<EBitmapSampleFilter Filter>
+	void WarpTiles(const FConstBitmapView& Src, const FBitmapHomography& Matrix, EBitmapBorderMode BorderMode, FColor BorderColour, const FBitmapView& Dst)
+	{
+		const int32 NumTilesX = FMath::DivideAndRoundUp(Dst.Width, WarpTileSize);
+		const int32 NumTilesY = FMath::DivideAndRoundUp(Dst.Height, WarpTileSize);
+		const bool bAffine = Matrix.IsAffine();
+
+		FBitmapParallel::ForRange(NumTilesX * NumTilesY, 1, [&](int32 Start, int32 End)
+		{
+			for (int32 Tile = Start; Tile < End; Tile++)
+			{
+				const int32 FirstX = (Tile % NumTilesX) * WarpTileSize;
+				const int32 FirstY = (Tile / NumTilesX) * WarpTileSize;
+				const int32 LastX = FMath::Min(FirstX + WarpTileSize, Dst.Width);
+				const int32 LastY = FMath::Min(FirstY + WarpTileSize, Dst.Height);
+
+				if (bAffine)
+				{
+					WarpTile<Filter, true>(Src, Matrix, BorderMode, BorderColour, FirstX, LastX, FirstY, LastY, Dst);
+				}
+				else
+				{
+					WarpTile<Filter, false>(Src, Matrix, BorderMode, BorderColour, FirstX, LastX, FirstY, LastY, Dst);
+				}
+			}
+		});
+	}
+}
+
+FBitmapHomography::FBitmapHomography()
+{
+	for (int32 Row = 0; Row < 3; Row++)
+	{
+		for (int32 Column = 0; Column < 3; Column++)
+		{
+			M[Row][Column] = Row == Column ? 1.0 : 0.0;
+		}
+	}
+}
+
+FBitmapHomography FBitmapHomography::FromRowMajor(const float* Values)
+{
+	FBitmapHomography Homography;
+	for (int32 Index = 0; Index < 9; Index++)
+	{
+		Homography.M[Index / 3][Index % 3] = Values[Index];
+	}
+	return Homography;
+}
+
+FBitmapHomography FBitmapHomography::MakeScale(double ScaleX, double ScaleY)
+{
+	FBitmapHomography Homography;
+	Homography.M[0][0] = ScaleX;
+	Homography.M[1][1] = ScaleY;
+	return Homography;
+}
+
+bool FBitmapHomography::MakeUnitSquareToQuad(const FVector2D* Corners, FBitmapHomography& OutHomography)
+{
+	const double X0 = Corners[0].X, Y0 = Corners[0].Y;
+	const double X1 = Corners[1].X, Y1 = Corners[1].Y;
+	const double X2 = Corners[2].X, Y2 = Corners[2].Y;
+	const double X3 = Corners[3].X, Y3 = Corners[3].Y;
+
+	// Heckbert's square to quadrilateral mapping: a parallelogram is affine, anything else needs the perspective terms G and H
+	const double SumX = X0 - X1 + X2 - X3;
+	const double SumY = Y0 - Y1 + Y2 - Y3;
+	double G = 0.0;
+	double H = 0.0;
+	if (FMath::Abs(SumX) > 1e-12 || FMath::Abs(SumY) > 1e-12)
+	{
+		const double DeltaX1 = X1 - X2;
+		const double DeltaX2 = X3 - X2;
+		const double DeltaY1 = Y1 - Y2;
+		const double DeltaY2 = Y3 - Y2;
+		const double Denominator = DeltaX1 * DeltaY2 - DeltaX2 * DeltaY1;
+		if (FMath::Abs(Denominator) < 1e-12)
+		{
+			return false;
+		}
+		G = (SumX * DeltaY2 - DeltaX2 * SumY) / Denominator;
+		H = (DeltaX1 * SumY - SumX * DeltaY1) / Denominator;
+	}
+
+	FBitmapHomography& Out = OutHomography;
+	Out.M[0][0] = X1 - X0 + G * X1;
+	Out.M[0][1] = X3 - X0 + H * X3;
+	Out.M[0][2] = X0;
+	Out.M[1][0] = Y1 - Y0 + G * Y1;
+	Out.M[1][1] = Y3 - Y0 + H * Y3;
+	Out.M[1][2] = Y0;
+	Out.M[2][0] = G;
+	Out.M[2][1] = H;
+	Out.M[2][2] = 1.0;
+
+	FBitmapHomography Unused;
+	return Out.Inverse(Unused);
+}
+
+FBitmapHomography FBitmapHomography::operator*(const FBitmapHomography& Other) const
+{
+	FBitmapHomography Product;
+	for (int32 Row = 0; Row < 3; Row++)
+	{
+		for (int32 Column = 0; Column < 3; Column++)
+		{
+			Product.M[Row][Column] = M[Row][0] * Other.M[0][Column] + M[Row][1] * Other.M[1][Column] + M[Row][2] * Other.M[2][Column];
+		}
+	}
+	return Product;
+}
+
+bool FBitmapHomography::Inverse(FBitmapHomography& OutInverse) const
+{
+	// Adjugate over determinant
+	const double Cofactor00 = M[1][1] * M[2][2] - M[1][2] * M[2][1];
+	const double Cofactor01 = M[1][2] * M[2][0] - M[1][0] * M[2][2];
+	const double Cofactor02 = M[1][0] * M[2][1] - M[1][1] * M[2][0];
+	const double Determinant = M[0][0] * Cofactor00 + M[0][1] * Cofactor01 + M[0][2] * Cofactor02;
+
+	// Relative to the size of the entries, so pixel sized and unit sized matrices are judged alike
+	double Scale = 0.0;
+	for (int32 Row = 0; Row < 3; Row++)
+	{
+		for (int32 Column = 0; Column < 3; Column++)
+		{
+			Scale = FMath::Max(Scale, FMath::Abs(M[Row][Column]));
+		}
+	}
+	if (Scale == 0.0 || FMath::Abs(Determinant) <= 1e-12 * Scale * Scale * Scale)
+	{
+		return false;
+	}
+
+	const double InvDeterminant = 1.0 / Determinant;
+	FBitmapHomography& Out = OutInverse;
+	Out.M[0][0] = Cofactor00 * InvDeterminant;
+	Out.M[1][0] = Cofactor01 * InvDeterminant;
+	Out.M[2][0] = Cofactor02 * InvDeterminant;
+	Out.M[0][1] = (M[0][2] * M[2][1] - M[0][1] * M[2][2]) * InvDeterminant;
+	Out.M[1][1] = (M[0][0] * M[2][2] - M[0][2] * M[2][0]) * InvDeterminant;
+	Out.M[2][1] = (M[0][1] * M[2][0] - M[0][0] * M[2][1]) * InvDeterminant;
+	Out.M[0][2] = (M[0][1] * M[1][2] - M[0][2] * M[1][1]) * InvDeterminant;
+	Out.M[1][2] = (M[0][2] * M[1][0] - M[0][0] * M[1][2]) * InvDeterminant;
+	Out.M[2][2] = (M[0][0] * M[1][1] - M[0][1] * M[1][0]) * InvDeterminant;
+	return true;
+}
+
+bool FBitmapHomography::IsAffine() const
+{
+	return M[2][0] == 0.0 && M[2][1] == 0.0 && M[2][2] == 1.0;
+}
+
+void FBitmapWarp::Warp(FConstBitmapView Src, const FBitmapHomography& OutputToSource, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode, FColor BorderColour,
+	FBitmapView Dst)
+{
+	if (Src.Width <= 0 || Src.Height <= 0 || Dst.Width <= 0 || Dst.Height <= 0)
+	{
+		return;
+	}
+
+	switch (Filter)
+	{
+	case EBitmapSampleFilter::Nearest:
+		WarpTiles<EBitmapSampleFilter::Nearest>(Src, OutputToSource, BorderMode, BorderColour, Dst);
+		break;
+	case EBitmapSampleFilter::Bilinear:
+		WarpTiles<EBitmapSampleFilter::Bilinear>(Src, OutputToSource, BorderMode, BorderColour, Dst);
+		break;
+	default:
+		WarpTiles<EBitmapSampleFilter::Bicubic>(Src, OutputToSource, BorderMode, BorderColour, Dst);
+		break;
+	}
+}
@@ -2,6 +2,7 @@
 // Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
 
 #include "ImageIOLibrary.h"
+#include "BitmapTexturePool.h"
 
 #define LOCTEXT_NAMESPACE "FImageIOLibraryModule"
 
@@ -15,7 +16,7 @@ void FImageIOLibraryModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
-	
+	FBitmapTexturePool::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
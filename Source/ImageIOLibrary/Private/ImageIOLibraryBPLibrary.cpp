@@ -3,6 +3,26 @@
 
 #include "ImageIOLibraryBPLibrary.h"
 #include "ImageIOLibrary.h"
+#include "BitmapCompositing.h"
+#include "BitmapConvolution.h"
+#include "BitmapBlur.h"
+#include "BitmapRankFilter.h"
+#include "BitmapGuidedFilter.h"
+#include "BitmapMorphology.h"
+#include "BitmapResampler.h"
+#include "BitmapTexture.h"
+#include "BitmapTexturePool.h"
+#include "BitmapMipChain.h"
+#include "BitmapSampler.h"
+#include "BitmapRegion.h"
+#include "BitmapAtlas.h"
+#include "BitmapOrientation.h"
+#include "BitmapWarp.h"
+#include "BitmapPyramid.h"
+#include "BitmapJob.h"
+#include "BitmapDecodeBudget.h"
+#include "BitmapParallel.h"
+#include "BitmapSimd.h"
 
 #include "Runtime/Core/Public/Async/Async.h"
 #include "Runtime/ImageWrapper/Public/IImageWrapper.h"
@@ -25,9 +45,79 @@ UImageIOLibraryBPLibrary::UImageIOLibraryBPLibrary(const FObjectInitializer& Obj
 
 }
 
+namespace
+{
+	/* Loads and decodes an image file to FColor pixels, without logging: callers decoding many files report the failures. */
+	bool DecodeImageFile(const FString& PathToImage, TArray<FColor>& OutBitmap, FImageSize& OutSize)
+	{
+		TArray<uint8> FileData;
+		if (!FFileHelper::LoadFileToArray(FileData, *PathToImage, FILEREAD_Silent))
+		{
+			return false;
+		}
+
+		IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+		const EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num());
+		if (ImageFormat == EImageFormat::Invalid)
+		{
+			return false;
+		}
+
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
+		TArray<uint8> Raw;
+		if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()) || !ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, Raw))
+		{
+			return false;
+		}
+
+		OutSize = FImageSize(ImageWrapper->GetWidth(), ImageWrapper->GetHeight());
+
+		// The decoder holds the pixels and its own copy of the file: both go before the pixels are copied once more
+		ImageWrapper.Reset();
+		FileData.Empty();
+		OutBitmap.SetNumUninitialized(OutSize.X * OutSize.Y);
+		FMemory::Memcpy(OutBitmap.GetData(), Raw.GetData(), FMath::Min((int64)Raw.Num(), (int64)OutBitmap.Num() * (int64)sizeof(FColor)));
+		return true;
+	}
+
+	/* Region clipped to a Size bitmap, empty when it misses the bitmap. */
+	FImageRect ClipRegion(FImageSize Size, FImageRect Region)
+	{
+		const int32 Left = FMath::Clamp(Region.X, 0, Size.X);
+		const int32 Top = FMath::Clamp(Region.Y, 0, Size.Y);
+		const int32 Right = FMath::Clamp((int32)FMath::Min((int64)Region.X + Region.Width, (int64)MAX_int32), Left, Size.X);
+		const int32 Bottom = FMath::Clamp((int32)FMath::Min((int64)Region.Y + Region.Height, (int64)MAX_int32), Top, Size.Y);
+		return FImageRect(Left, Top, Right - Left, Bottom - Top);
+	}
+
+	/* Filters Region (clipped) of Canvas in place, without a copy of what it reads: Filter(Src, Dst) gets Region grown by ApronX and ApronY
+	on each side as a view of Canvas, clipped to it, and only Region is written back from its result. With aprons as wide as the filter
+	reads, the edges of the view are either Canvas' edges or too far away to matter, and Region ends up as filtering all of Canvas would.
+	*/
+	template<typename FilterType>
+	void FilterRegionWithApron(FBitmapView Canvas, FImageRect Region, int32 ApronX, int32 ApronY, const FilterType& Filter)
+	{
+		ApronX = FMath::Clamp(ApronX, 0, Canvas.Width);
+		ApronY = FMath::Clamp(ApronY, 0, Canvas.Height);
+
+		const int32 SourceLeft = FMath::Max(Region.X - ApronX, 0);
+		const int32 SourceTop = FMath::Max(Region.Y - ApronY, 0);
+		const FConstBitmapView Source = FConstBitmapView(Canvas).GetSubView(FImageRect(SourceLeft, SourceTop, Region.X + Region.Width + ApronX - SourceLeft,
+			Region.Y + Region.Height + ApronY - SourceTop));
+
+		TArray<FColor> Filtered;
+		Filtered.SetNumUninitialized(Source.Width * Source.Height);
+		Filter(Source, FBitmapView(Filtered.GetData(), Source.GetSize()));
+
+		FBitmapRegion::Copy(FConstBitmapView(Filtered.GetData(), Source.GetSize()).GetSubView(FImageRect(Region.X - SourceLeft, Region.Y - SourceTop, Region.Width, Region.Height)),
+			Canvas.GetSubView(Region));
+	}
+}
+
+
 /***** Creating Texture 2D *****/
 
-bool UImageIOLibraryBPLibrary::CreateTexture2DFromImageFile(UTexture2D*& Texture2D, FImageSize &Size, FString PathToImage)
+bool UImageIOLibraryBPLibrary::CreateTexture2DFromImageFile(UTexture2D*& Texture2D, FImageSize &Size, FString PathToImage, bool GenerateMips, EBitmapTextureCompression Compression)
 {
 	UTexture2D* ReturnTexture2D = nullptr;
 
@@ -38,6 +128,9 @@ bool UImageIOLibraryBPLibrary::CreateTexture2DFromImageFile(UTexture2D*& Texture
 		return false;
 	}
 
+	// Counted in the decode memory, but never waits for it on the game thread
+	FBitmapDecodeReservation Reservation(FBitmapDecodeBudget::EstimateDecodeBytes(PathToImage, true, GenerateMips));
+
 	// Load the compressed byte data from the file
 	TArray<uint8> FileData;
 	if(!FFileHelper::LoadFileToArray(FileData, *PathToImage))
@@ -65,22 +158,19 @@ bool UImageIOLibraryBPLibrary::CreateTexture2DFromImageFile(UTexture2D*& Texture
 		TArray<uint8> UncompressedRGBA;
 		if(ImageWrapper->GetRaw(ERGBFormat::RGBA, 8, UncompressedRGBA))
 		{
-			// Create the Texture2D and makes sure it is valid
-			ReturnTexture2D = UTexture2D::CreateTransient(ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), PF_R8G8B8A8);
+			Size = FImageSize(ImageWrapper->GetWidth(), ImageWrapper->GetHeight());
+
+			// The decoder and the file aren't needed anymore, they'd only add to the memory the texture's mips take
+			ImageWrapper.Reset();
+			FileData.Empty();
+
+			// Create the Texture2D (compressed, with its mips if asked) and makes sure it is valid
+			ReturnTexture2D = FBitmapTexture::CreateTransient(UncompressedRGBA.GetData(), Size, GenerateMips, Compression);
 			if (!ReturnTexture2D)
 			{
 				UE_LOG(LogTemp, Error, TEXT("Failed to create Texture2D from file: %s"), *PathToImage);
 				return false;
 			}
-
-			// Saves the texture to memory ready to be used at runtime
-
-			void* TextureData = ReturnTexture2D->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-			FMemory::Memcpy(TextureData, UncompressedRGBA.GetData(), UncompressedRGBA.Num());
-			ReturnTexture2D->PlatformData->Mips[0].BulkData.Unlock();
-			ReturnTexture2D->UpdateResource();
-
-			Size = FImageSize(ImageWrapper->GetWidth(), ImageWrapper->GetHeight());
 		}
 	}
 
@@ -88,7 +178,7 @@ bool UImageIOLibraryBPLibrary::CreateTexture2DFromImageFile(UTexture2D*& Texture
 	return true;
 }
 
-bool UImageIOLibraryBPLibrary::CreateTexture2DFromBitmap(UTexture2D*& Texture2D, TArray<FColor> Bitmap, FImageSize Size)
+bool UImageIOLibraryBPLibrary::CreateTexture2DFromBitmap(UTexture2D*& Texture2D, TArray<FColor> Bitmap, FImageSize Size, bool GenerateMips, EBitmapTextureCompression Compression)
 {
 	if (Bitmap.Num() <= 0)
 	{
@@ -102,61 +192,14 @@ bool UImageIOLibraryBPLibrary::CreateTexture2DFromBitmap(UTexture2D*& Texture2D,
 		return false;
 	}
 
-	UTexture2D* ReturnTexture2D = nullptr;
-
-
-	//Create an ImageWrapperModule create the Texture2D
-	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-
-	//Convert ColorData to bytes
-	TArray<uint8> FileData;
-	FImageUtils::CompressImageArray(Size.X, Size.Y, Bitmap, FileData);
-
-	// Create an image format to ensure our ColorData is valid
-	EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num());
-	if (ImageFormat == EImageFormat::Invalid)
-	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to recognise image format."));
-		return false;
-	}
-
-	//Create Image wrapper to create the Texture2D
-	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
-	if (!ImageWrapper.IsValid())
-	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to create the image wrapper."));
-		return false;
-	}
-
-	if (ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()))
-	{
-		TArray<uint8> UncompressedRGBA;
-		if (ImageWrapper->GetRaw(ERGBFormat::RGBA, 8, UncompressedRGBA))
-		{
-			// Create the Texture2D and makes sure it is valid
-			ReturnTexture2D = UTexture2D::CreateTransient(ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), PF_R8G8B8A8);
-			if (!ReturnTexture2D)
-			{
-				UE_LOG(LogTemp, Error, TEXT("Failed to create Texture2D from ColorData"));
-				return false;
-			}
-
-			// Saves the texture to memory ready to be used at runtime
-			void* TextureData = ReturnTexture2D->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-			FMemory::Memcpy(TextureData, UncompressedRGBA.GetData(), UncompressedRGBA.Num());
-			ReturnTexture2D->PlatformData->Mips[0].BulkData.Unlock();
-			ReturnTexture2D->UpdateResource();
-		}
+	// Textures are created as RGBA while FColor is BGRA: swizzled in place, the array is already a copy
+	BitmapSimd::SwapRedBlue(Bitmap.GetData(), Bitmap.GetData(), Bitmap.Num());
 
-		else
-		{
-			UE_LOG(LogTemp, Error, TEXT("Failed to read the compressed image data."));
-			return false;
-		}
-	}
-	else
+	// Create the Texture2D (compressed, with its mips if asked) and makes sure it is valid
+	UTexture2D* ReturnTexture2D = FBitmapTexture::CreateTransient(Bitmap.GetData(), Size, GenerateMips, Compression);
+	if (!ReturnTexture2D)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to compress the image data."));
+		UE_LOG(LogTemp, Error, TEXT("Failed to create Texture2D from ColorData"));
 		return false;
 	}
 
@@ -229,6 +272,226 @@ bool UImageIOLibraryBPLibrary::SaveTexture2DAsPNG(UTexture2D* Texture2D, FString
 	return false;
 }
 
+bool UImageIOLibraryBPLibrary::UpdateTexture2DFromBitmap(UTexture2D* Texture2D, const TArray<FColor>& Bitmap, FImageSize Size, TArray<FImageRect> DirtyRects)
+{
+	if (!Texture2D->IsValidLowLevel() || !Texture2D->Resource)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Texture doesn't seem to be valid, can't update it. (Check UpdateTexture2DFromBitmap arguments)."));
+		return false;
+	}
+	if (Bitmap.Num() != Size.X * Size.Y || Size.X != Texture2D->GetSizeX() || Size.Y != Texture2D->GetSizeY())
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size or the texture size. (Check UpdateTexture2DFromBitmap arguments)."));
+		return false;
+	}
+	const EPixelFormat PixelFormat = Texture2D->GetPixelFormat(0);
+	if (PixelFormat != PF_R8G8B8A8 && PixelFormat != PF_B8G8R8A8)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Only uncompressed 8 bit RGBA textures can be updated from a bitmap. (Check UpdateTexture2DFromBitmap arguments)."));
+		return false;
+	}
+
+	// Brush strokes can go past the edges: the rects are clipped, and those left empty are dropped
+	TArray<FImageRect> Rects;
+	if (DirtyRects.Num() == 0)
+	{
+		Rects.Add(FImageRect(0, 0, Size.X, Size.Y));
+	}
+	for (const FImageRect& DirtyRect : DirtyRects)
+	{
+		const int32 MinX = FMath::Max(DirtyRect.X, 0);
+		const int32 MinY = FMath::Max(DirtyRect.Y, 0);
+		const int32 MaxX = FMath::Min(DirtyRect.X + DirtyRect.Width, Size.X);
+		const int32 MaxY = FMath::Min(DirtyRect.Y + DirtyRect.Height, Size.Y);
+		if (MinX < MaxX && MinY < MaxY)
+		{
+			Rects.Add(FImageRect(MinX, MinY, MaxX - MinX, MaxY - MinY));
+		}
+	}
+
+	FBitmapTexture::UpdateRegions(Texture2D, Bitmap.GetData(), Rects);
+	return true;
+}
+
+bool UImageIOLibraryBPLibrary::CreatePooledTexture2DFromBitmap(UTexture2D*& Texture2D, const TArray<FColor>& Bitmap, FImageSize Size, bool GenerateMips)
+{
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check CreatePooledTexture2DFromBitmap arguments)."));
+		return false;
+	}
+
+	const int32 NumMips = GenerateMips ? FBitmapMipChain::GetNumMips(Size) : 1;
+	UTexture2D* ReturnTexture2D = FBitmapTexturePool::Get().Acquire(Size, PF_R8G8B8A8, NumMips);
+	if (ReturnTexture2D)
+	{
+		// A recycled texture only needs its pixels uploaded
+		TArray<FImageRect> Rects;
+		Rects.Add(FImageRect(0, 0, Size.X, Size.Y));
+		FBitmapTexture::UpdateRegions(ReturnTexture2D, Bitmap.GetData(), Rects);
+		FBitmapTexture::UpdateMips(ReturnTexture2D);
+	}
+	else
+	{
+		TArray<FColor> RGBA;
+		RGBA.SetNumUninitialized(Bitmap.Num());
+		BitmapSimd::SwapRedBlue(Bitmap.GetData(), RGBA.GetData(), Bitmap.Num());
+
+		ReturnTexture2D = FBitmapTexture::CreateTransient(RGBA.GetData(), Size, GenerateMips, EBitmapTextureCompression::None);
+		if (!ReturnTexture2D)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to create Texture2D from ColorData"));
+			return false;
+		}
+		FBitmapTexturePool::Get().AddCreated();
+	}
+
+	Texture2D = ReturnTexture2D;
+	return true;
+}
+
+bool UImageIOLibraryBPLibrary::ReleasePooledTexture2D(UTexture2D* Texture2D)
+{
+	if (!Texture2D->IsValidLowLevel() || !FBitmapTexturePool::Get().Release(Texture2D))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Only uncompressed textures created by this library can be pooled, once. (Check ReleasePooledTexture2D arguments)."));
+		return false;
+	}
+	return true;
+}
+
+void UImageIOLibraryBPLibrary::EmptyTexturePool()
+{
+	FBitmapTexturePool::Get().Empty();
+}
+
+FTexturePoolStats UImageIOLibraryBPLibrary::GetTexturePoolStats()
+{
+	return FBitmapTexturePool::Get().GetStats();
+}
+
+
+UBitmapAtlas* UImageIOLibraryBPLibrary::CreateBitmapAtlas(int32 PageSize, int32 Padding)
+{
+	if (PageSize <= 0 || Padding < 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The page size has to be positive and the padding can't be negative. (Check CreateBitmapAtlas arguments)."));
+		return nullptr;
+	}
+
+	UBitmapAtlas* Atlas = NewObject<UBitmapAtlas>(GetTransientPackage());
+	Atlas->Init(PageSize, Padding);
+	return Atlas;
+}
+
+bool UImageIOLibraryBPLibrary::AddBitmapToAtlas(FBitmapAtlasEntry& Entry, UBitmapAtlas* Atlas, const TArray<FColor>& Bitmap, FImageSize Size)
+{
+	if (!Atlas->IsValidLowLevel())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Atlas doesn't seem to be valid. (Check AddBitmapToAtlas arguments)."));
+		return false;
+	}
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check AddBitmapToAtlas arguments)."));
+		return false;
+	}
+
+	TArray<FConstBitmapView> Bitmaps;
+	Bitmaps.Add(FConstBitmapView(Bitmap.GetData(), Size));
+	TArray<FBitmapAtlasEntry> Entries;
+	const bool bAdded = Atlas->Add(Bitmaps, Entries) == 1;
+	Entry = Entries[0];
+	return bAdded;
+}
+
+bool UImageIOLibraryBPLibrary::AddImageFilesToAtlas(TArray<FBitmapAtlasEntry>& Entries, UBitmapAtlas* Atlas, const TArray<FString>& PathsToImages)
+{
+	if (!Atlas->IsValidLowLevel())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Atlas doesn't seem to be valid. (Check AddImageFilesToAtlas arguments)."));
+		return false;
+	}
+
+	// The module has to be loaded on the game thread before the files are decoded on the workers
+	FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+	const int32 NumFiles = PathsToImages.Num();
+	TArray<TArray<FColor>> Bitmaps;
+	Bitmaps.SetNum(NumFiles);
+	TArray<FImageSize> Sizes;
+	Sizes.SetNum(NumFiles);
+
+	TArray<int64> DecodeBytes;
+	DecodeBytes.SetNumUninitialized(NumFiles);
+	FBitmapParallel::ForRange(NumFiles, 1, [&](int32 Start, int32 End)
+	{
+		for (int32 Index = Start; Index < End; Index++)
+		{
+			DecodeBytes[Index] = FBitmapDecodeBudget::EstimateDecodeBytes(PathsToImages[Index], false, false);
+		}
+	});
+
+	// Decoded in rounds: this thread reserves the memory of as many files as fit, the workers decode them, and the next round starts once
+	// they gave it back. The workers are task graph threads the rest of the engine shares, none of them ever waits for the budget.
+	TArray<FBitmapDecodeReservation> Reservations;
+	Reservations.SetNum(NumFiles);
+	int32 NextFile = 0;
+	while (NextFile < NumFiles)
+	{
+		// At least one file a round, waited for or only counted as FBitmapDecodeBudget::Reserve decides
+		const int32 FirstFile = NextFile;
+		Reservations[NextFile] = FBitmapDecodeReservation(DecodeBytes[NextFile]);
+		NextFile++;
+		while (NextFile < NumFiles && (Reservations[NextFile] = FBitmapDecodeReservation::TryReserve(DecodeBytes[NextFile])).IsReserved())
+		{
+			NextFile++;
+		}
+
+		FBitmapParallel::ForRange(NextFile - FirstFile, 1, [&](int32 Start, int32 End)
+		{
+			for (int32 Index = FirstFile + Start; Index < FirstFile + End; Index++)
+			{
+				if (!DecodeImageFile(PathsToImages[Index], Bitmaps[Index], Sizes[Index]))
+				{
+					Bitmaps[Index].Reset();
+				}
+				Reservations[Index].Release();
+			}
+		});
+	}
+
+	// Images that failed to load go in as empty bitmaps, which the atlas leaves out
+	TArray<FConstBitmapView> Views;
+	bool bAllLoaded = true;
+	for (int32 Index = 0; Index < PathsToImages.Num(); Index++)
+	{
+		if (Bitmaps[Index].Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to load image: %s"), *PathsToImages[Index]);
+			Views.Add(FConstBitmapView());
+			bAllLoaded = false;
+		}
+		else
+		{
+			Views.Add(FConstBitmapView(Bitmaps[Index].GetData(), Sizes[Index]));
+		}
+	}
+
+	const int32 NumAdded = Atlas->Add(Views, Entries);
+	return bAllLoaded && NumAdded == PathsToImages.Num();
+}
+
+TArray<UTexture2D*> UImageIOLibraryBPLibrary::GetAtlasTextures(UBitmapAtlas* Atlas)
+{
+	if (!Atlas->IsValidLowLevel())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Atlas doesn't seem to be valid. (Check GetAtlasTextures arguments)."));
+		return TArray<UTexture2D*>();
+	}
+	return Atlas->GetPages();
+}
+
 
 /***** Texture 2D *****/
 
@@ -269,49 +532,48 @@ bool UImageIOLibraryBPLibrary::GetTextureBitmap(TArray<FColor> &Bitmap, FImageSi
 		return false;
 	}
 
-	// Backup current texture settings
-	TextureCompressionSettings OldCompressionSettings = Texture2D->CompressionSettings;
-	//TextureMipGenSettings OldMipGenSettings = Texture2D->MipGenSettings;  //Editor only, doesn't compile in shipping
-	bool OldSRGB = Texture2D->SRGB;
-
-	// Set texture settings to make sure LockReadOnly returns its value properly and more efficiently.
-	Texture2D->CompressionSettings = TextureCompressionSettings::TC_VectorDisplacementmap;
-	//Texture2D->MipGenSettings = TextureMipGenSettings::TMGS_NoMipmaps;  //Editor only, doesn't compile in shipping
-	Texture2D->SRGB = false;
-	Texture2D->UpdateResource();
+	// Read straight from the CPU copy of the first mip, into the array the caller passed in when it's already the right size
+	Bitmap.SetNumUninitialized(Texture2D->GetSizeX() * Texture2D->GetSizeY(), false);
+	if (!FBitmapTexture::ReadPixels(Texture2D, Bitmap.GetData()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Only uncompressed 8 bit RGBA textures with their pixels on the CPU, or editor textures with their source pixels, can be read back. (Check GetTextureBitmap arguments)."));
+		Bitmap.Reset();
+		return false;
+	}
 
-	// Get a reference to the texture's color data array
-	// This is a pointer to an array of uint8 that is converted to FColor on the fly thanks to the cast.
-	FColor* FormatedImageData = (FColor*)Texture2D->PlatformData->Mips[0].BulkData.LockReadOnly();
+	Size = FImageSize(Texture2D->GetSizeX(), Texture2D->GetSizeY());
+	return true;
+}
 
-	//Read the color data
-	TArray<FColor> ReturnColorData;
-	for (int Y = 0; Y < Texture2D->GetSizeY(); Y++)
+bool UImageIOLibraryBPLibrary::GetTexturePixelColor(FColor &PixelColor, UTexture2D* Texture2D, int XIndex, int YIndex)
+{
+	if (!Texture2D->IsValidLowLevel())
 	{
-		for (int X = 0; X < Texture2D->GetSizeX(); X++)
-		{
-			//For some reason red and green gets swapped here so we have to swap them again
-			FColor tempPixel = FormatedImageData[Y * Texture2D->GetSizeX() + X];
-			tempPixel = FColor(tempPixel.B, tempPixel.G, tempPixel.R, tempPixel.A);
+		UE_LOG(LogTemp, Error, TEXT("Texture doesn't seem to be valid, can't return coloor data."));
+		return false;
+	}
+	if (XIndex < 0 || YIndex < 0 || XIndex >= Texture2D->GetSizeX() || YIndex >= Texture2D->GetSizeY())
+	{
+		UE_LOG(LogTemp, Error, TEXT("The pixel is outside the texture. (Check GetTexturePixelColor arguments)."));
+		return false;
+	}
 
-			ReturnColorData.Add(tempPixel);
-		}
+	bool bSwapRedBlue;
+	const FColor* Pixels = FBitmapTexture::LockPixels(Texture2D, bSwapRedBlue);
+	if (!Pixels)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Only uncompressed 8 bit RGBA textures with their pixels on the CPU can be read. (Check GetTexturePixelColor arguments)."));
+		return false;
 	}
 
-	// Reset the texture settings to what it was
-	Texture2D->PlatformData->Mips[0].BulkData.Unlock();
-	Texture2D->CompressionSettings = OldCompressionSettings;
-	//Texture2D->MipGenSettings = OldMipGenSettings; //Editor only, doesn't compile in shipping
-	Texture2D->SRGB = OldSRGB;
-	Texture2D->UpdateResource();
+	const FColor Pixel = Pixels[YIndex * Texture2D->GetSizeX() + XIndex];
+	FBitmapTexture::UnlockPixels(Texture2D);
 
-	//Returns the color data
-	Bitmap = ReturnColorData;
-	Size = FImageSize(Texture2D->GetSizeX(), Texture2D->GetSizeY());
+	PixelColor = bSwapRedBlue ? FColor(Pixel.B, Pixel.G, Pixel.R, Pixel.A) : Pixel;
 	return true;
 }
 
-bool UImageIOLibraryBPLibrary::GetTexturePixelColor(FColor &PixelColor, UTexture2D* Texture2D, int XIndex, int YIndex)
+bool UImageIOLibraryBPLibrary::SampleTexturePixels(TArray<FColor> &Colours, UTexture2D* Texture2D, const TArray<FIntPoint>& Pixels, EBitmapBorderMode BorderMode)
 {
 	if (!Texture2D->IsValidLowLevel())
 	{
@@ -319,20 +581,51 @@ bool UImageIOLibraryBPLibrary::GetTexturePixelColor(FColor &PixelColor, UTexture
 		return false;
 	}
 
-	FVector2D TextureSize = FVector2D(Texture2D->GetSizeX(), Texture2D->GetSizeY());
+	bool bSwapRedBlue;
+	const FColor* TexturePixels = FBitmapTexture::LockPixels(Texture2D, bSwapRedBlue);
+	if (!TexturePixels)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Only uncompressed 8 bit RGBA textures with their pixels on the CPU can be read. (Check SampleTexturePixels arguments)."));
+		return false;
+	}
+
+	// Sampled in the texture's channel order, swizzled once at the end
+	Colours.SetNumUninitialized(Pixels.Num(), false);
+	FBitmapSampler::SamplePixels(FConstBitmapView(TexturePixels, FImageSize(Texture2D->GetSizeX(), Texture2D->GetSizeY())), Pixels.GetData(), Pixels.Num(), BorderMode, FColor(0, 0, 0, 0), Colours.GetData());
+	FBitmapTexture::UnlockPixels(Texture2D);
+
+	if (bSwapRedBlue)
+	{
+		BitmapSimd::SwapRedBlue(Colours.GetData(), Colours.GetData(), Colours.Num());
+	}
+	return true;
+}
+
+bool UImageIOLibraryBPLibrary::SampleTextureUVs(TArray<FColor> &Colours, UTexture2D* Texture2D, const TArray<FVector2D>& UVs, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode)
+{
+	if (!Texture2D->IsValidLowLevel())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Texture doesn't seem to be valid, can't return coloor data."));
+		return false;
+	}
 
-	FTexture2DMipMap& Mip = Texture2D->PlatformData->Mips[0]; //A reference 
-	void* Data = Mip.BulkData.Lock(LOCK_READ_WRITE);
-	uint8* raw = NULL;
-	raw = (uint8*)Data;
+	bool bSwapRedBlue;
+	const FColor* TexturePixels = FBitmapTexture::LockPixels(Texture2D, bSwapRedBlue);
+	if (!TexturePixels)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Only uncompressed 8 bit RGBA textures with their pixels on the CPU can be read. (Check SampleTextureUVs arguments)."));
+		return false;
+	}
 
-	FColor returnPixelColor = FColor(0, 0, 0, 255);
-	returnPixelColor.B = raw[4 * (XIndex * (int)TextureSize.X + YIndex) + 0];
-	returnPixelColor.G = raw[4 * (XIndex * (int)TextureSize.X + YIndex) + 1];
-	returnPixelColor.R = raw[4 * (XIndex * (int)TextureSize.X + YIndex) + 2];
-	returnPixelColor.A = raw[4 * (XIndex * (int)TextureSize.X + YIndex) + 3];
+	// Sampled in the texture's channel order, swizzled once at the end
+	Colours.SetNumUninitialized(UVs.Num(), false);
+	FBitmapSampler::SampleUVs(FConstBitmapView(TexturePixels, FImageSize(Texture2D->GetSizeX(), Texture2D->GetSizeY())), UVs.GetData(), UVs.Num(), Filter, BorderMode, FColor(0, 0, 0, 0), Colours.GetData());
+	FBitmapTexture::UnlockPixels(Texture2D);
 
-	PixelColor = returnPixelColor;
+	if (bSwapRedBlue)
+	{
+		BitmapSimd::SwapRedBlue(Colours.GetData(), Colours.GetData(), Colours.Num());
+	}
 	return true;
 }
 
@@ -442,36 +735,311 @@ TArray<uint8> UImageIOLibraryBPLibrary::GetBitmapBytes(TArray<FColor> Bitmap, FI
 
 /***** Bitmap Operations *****/
 
-TArray<FColor> UImageIOLibraryBPLibrary::ResizeBitmap(TArray<FColor> Bitmap, FImageSize Size, FImageSize NewSize)
+TArray<FColor> UImageIOLibraryBPLibrary::SampleBitmapPixels(const TArray<FColor>& Bitmap, FImageSize Size, const TArray<FIntPoint>& Pixels, EBitmapBorderMode BorderMode)
 {
-	TArray<FColor> OutBitmap;
+	TArray<FColor> Colours;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check SampleBitmapPixels arguments)."));
+		return Colours;
+	}
+
+	Colours.SetNumUninitialized(Pixels.Num());
+	FBitmapSampler::SamplePixels(FConstBitmapView(Bitmap.GetData(), Size), Pixels.GetData(), Pixels.Num(), BorderMode, FColor(0, 0, 0, 0), Colours.GetData());
+	return Colours;
+}
 
-	if (Bitmap.Num() > 0 && Size.X != 0 && Size.Y != 0 && NewSize.X != 0 && NewSize.Y != 0)
+TArray<FColor> UImageIOLibraryBPLibrary::SampleBitmapUVs(const TArray<FColor>& Bitmap, FImageSize Size, const TArray<FVector2D>& UVs, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode)
+{
+	TArray<FColor> Colours;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
 	{
-		FImageUtils::ImageResize(Size.X, Size.Y, Bitmap, NewSize.X, NewSize.Y, OutBitmap, false);
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check SampleBitmapUVs arguments)."));
+		return Colours;
 	}
-	return OutBitmap;
+
+	Colours.SetNumUninitialized(UVs.Num());
+	FBitmapSampler::SampleUVs(FConstBitmapView(Bitmap.GetData(), Size), UVs.GetData(), UVs.Num(), Filter, BorderMode, FColor(0, 0, 0, 0), Colours.GetData());
+	return Colours;
 }
 
-TArray<FColor> UImageIOLibraryBPLibrary::SetBitmapHueSaturationLuminance(TArray<FColor> Bitmap, float Hue, float Saturation, float Luminance)
+TArray<FColor> UImageIOLibraryBPLibrary::CropBitmap(const TArray<FColor>& Bitmap, FImageSize Size, FImageRect Rect, EBitmapBorderMode BorderMode)
 {
-	float tempHueValue = FMath::Clamp(Hue, 0.0f, 360.0f);
-	float tempSaturationValue = Saturation; 
-	float tempLuminanceValue = Luminance;
 	TArray<FColor> OutBitmap;
-
-	for (FColor pixel : Bitmap)
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
 	{
-		FLinearColor HSV = FLinearColor::FromSRGBColor(pixel).LinearRGBToHSV();
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check CropBitmap arguments)."));
+		return OutBitmap;
+	}
+	if (Rect.Width <= 0 || Rect.Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The rectangle to crop is empty. (Check CropBitmap arguments)."));
+		return OutBitmap;
+	}
 
-		// Sets the hue and makes sure values <0 or >360 get looped. (If a pixel's hue = -1, it will become 359, if it is = 361 it will become 1)
-			float newHue = HSV.R + tempHueValue;
-			if (newHue >= 360.0f)
-			{
-				HSV.R = FMath::Clamp(newHue - 360.0f, 0.0f, 360.0f);
-			}
-			else if (newHue <= 0.0f)
-			{
+	OutBitmap.SetNumUninitialized(Rect.Width * Rect.Height);
+	FBitmapRegion::Crop(FConstBitmapView(Bitmap.GetData(), Size), Rect, BorderMode, FColor(0, 0, 0, 0), FBitmapView(OutBitmap.GetData(), Rect.Width, Rect.Height, Rect.Width));
+	return OutBitmap;
+}
+
+bool UImageIOLibraryBPLibrary::PasteBitmap(TArray<FColor>& Bitmap, FImageSize Size, const TArray<FColor>& Source, FImageSize SourceSize, int32 X, int32 Y)
+{
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check PasteBitmap arguments)."));
+		return false;
+	}
+	if (Source.Num() <= 0 || Source.Num() != SourceSize.X * SourceSize.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the Source bitmap doesn't match SourceSize. (Check PasteBitmap arguments)."));
+		return false;
+	}
+
+	return FBitmapRegion::Paste(FConstBitmapView(Source.GetData(), SourceSize), FBitmapView(Bitmap.GetData(), Size), X, Y);
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::PadBitmap(FImageSize& NewSize, const TArray<FColor>& Bitmap, FImageSize Size, int32 Left, int32 Top, int32 Right, int32 Bottom,
+	EBitmapBorderMode BorderMode)
+{
+	TArray<FColor> OutBitmap;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check PadBitmap arguments)."));
+		return OutBitmap;
+	}
+	if (Left < 0 || Top < 0 || Right < 0 || Bottom < 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Padding can't be negative, use CropBitmap to remove pixels. (Check PadBitmap arguments)."));
+		return OutBitmap;
+	}
+
+	NewSize = FImageSize(Size.X + Left + Right, Size.Y + Top + Bottom);
+	OutBitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+	FBitmapRegion::Pad(FConstBitmapView(Bitmap.GetData(), Size), Left, Top, Right, Bottom, BorderMode, FColor(0, 0, 0, 0), FBitmapView(OutBitmap.GetData(), NewSize));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::TileBitmap(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize)
+{
+	TArray<FColor> OutBitmap;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check TileBitmap arguments)."));
+		return OutBitmap;
+	}
+	if (NewSize.X <= 0 || NewSize.Y <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The new size can't be 0. (Check TileBitmap arguments)."));
+		return OutBitmap;
+	}
+
+	OutBitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+	FBitmapRegion::Tile(FConstBitmapView(Bitmap.GetData(), Size), FBitmapView(OutBitmap.GetData(), NewSize));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::ReorientBitmap(FImageSize& NewSize, const TArray<FColor>& Bitmap, FImageSize Size, EBitmapOrientation Orientation)
+{
+	TArray<FColor> OutBitmap;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ReorientBitmap arguments)."));
+		return OutBitmap;
+	}
+
+	NewSize = FBitmapOrientation::GetOrientedSize(Size, Orientation);
+	OutBitmap.SetNumUninitialized(Bitmap.Num());
+	FBitmapOrientation::Reorient(FConstBitmapView(Bitmap.GetData(), Size), Orientation, FBitmapView(OutBitmap.GetData(), NewSize));
+	return OutBitmap;
+}
+
+bool UImageIOLibraryBPLibrary::ReorientBitmapInPlace(TArray<FColor>& Bitmap, FImageSize& Size, EBitmapOrientation Orientation)
+{
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ReorientBitmapInPlace arguments)."));
+		return false;
+	}
+
+	// Quarter turns of rectangles move every pixel to a different row length, those go through a copy
+	if (!FBitmapOrientation::ReorientInPlace(FBitmapView(Bitmap.GetData(), Size), Orientation))
+	{
+		TArray<FColor> Reoriented;
+		Reoriented.SetNumUninitialized(Bitmap.Num());
+		FBitmapOrientation::Reorient(FConstBitmapView(Bitmap.GetData(), Size), Orientation, FBitmapView(Reoriented.GetData(), FBitmapOrientation::GetOrientedSize(Size, Orientation)));
+		Bitmap = MoveTemp(Reoriented);
+	}
+
+	Size = FBitmapOrientation::GetOrientedSize(Size, Orientation);
+	return true;
+}
+
+bool UImageIOLibraryBPLibrary::GetExifOrientationFix(EBitmapOrientation& Orientation, int32 ExifOrientation)
+{
+	return FBitmapOrientation::FromExifOrientation(ExifOrientation, Orientation);
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::WarpBitmap(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize, const TArray<float>& Matrix,
+	EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode)
+{
+	TArray<FColor> OutBitmap;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y || NewSize.X <= 0 || NewSize.Y <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size, or the new size is empty. (Check WarpBitmap arguments)."));
+		return OutBitmap;
+	}
+
+	FBitmapHomography OutputToSource;
+	if (Matrix.Num() != 9 || !FBitmapHomography::FromRowMajor(Matrix.GetData()).Inverse(OutputToSource))
+	{
+		UE_LOG(LogTemp, Error, TEXT("The matrix needs 9 values and must be invertible. (Check WarpBitmap arguments)."));
+		return OutBitmap;
+	}
+
+	OutBitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+	FBitmapWarp::Warp(FConstBitmapView(Bitmap.GetData(), Size), OutputToSource, Filter, BorderMode, FColor(0, 0, 0, 0), FBitmapView(OutBitmap.GetData(), NewSize));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::WarpBitmapRegion(const TArray<FColor>& Bitmap, FImageSize Size, FImageRect Region, FImageSize NewSize, const TArray<float>& Matrix,
+	EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode)
+{
+	TArray<FColor> OutBitmap;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y || NewSize.X <= 0 || NewSize.Y <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size, or the new size is empty. (Check WarpBitmapRegion arguments)."));
+		return OutBitmap;
+	}
+
+	const FConstBitmapView Source = FConstBitmapView(Bitmap.GetData(), Size).GetSubView(Region);
+	if (Source.Width <= 0 || Source.Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The region is outside the bitmap. (Check WarpBitmapRegion arguments)."));
+		return OutBitmap;
+	}
+
+	FBitmapHomography OutputToSource;
+	if (Matrix.Num() != 9 || !FBitmapHomography::FromRowMajor(Matrix.GetData()).Inverse(OutputToSource))
+	{
+		UE_LOG(LogTemp, Error, TEXT("The matrix needs 9 values and must be invertible. (Check WarpBitmapRegion arguments)."));
+		return OutBitmap;
+	}
+
+	OutBitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+	FBitmapWarp::Warp(Source, OutputToSource, Filter, BorderMode, FColor(0, 0, 0, 0), FBitmapView(OutBitmap.GetData(), NewSize));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::WarpBitmapFromQuad(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize, FVector2D TopLeft, FVector2D TopRight,
+	FVector2D BottomRight, FVector2D BottomLeft, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode)
+{
+	TArray<FColor> OutBitmap;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y || NewSize.X <= 0 || NewSize.Y <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size, or the new size is empty. (Check WarpBitmapFromQuad arguments)."));
+		return OutBitmap;
+	}
+
+	// Output pixels to the unit square, then the unit square to the quad
+	const FVector2D Corners[4] = { TopLeft, TopRight, BottomRight, BottomLeft };
+	FBitmapHomography SquareToQuad;
+	if (!FBitmapHomography::MakeUnitSquareToQuad(Corners, SquareToQuad))
+	{
+		UE_LOG(LogTemp, Error, TEXT("3 of the corners are on a line. (Check WarpBitmapFromQuad arguments)."));
+		return OutBitmap;
+	}
+	const FBitmapHomography OutputToSource = SquareToQuad * FBitmapHomography::MakeScale(1.0 / NewSize.X, 1.0 / NewSize.Y);
+
+	OutBitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+	FBitmapWarp::Warp(FConstBitmapView(Bitmap.GetData(), Size), OutputToSource, Filter, BorderMode, FColor(0, 0, 0, 0), FBitmapView(OutBitmap.GetData(), NewSize));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::WarpBitmapOntoQuad(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize, FVector2D TopLeft, FVector2D TopRight,
+	FVector2D BottomRight, FVector2D BottomLeft, EBitmapSampleFilter Filter)
+{
+	TArray<FColor> OutBitmap;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y || NewSize.X <= 0 || NewSize.Y <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size, or the new size is empty. (Check WarpBitmapOntoQuad arguments)."));
+		return OutBitmap;
+	}
+
+	// Source pixels to the unit square, then the unit square to the quad, inverted to look up the source from the output
+	const FVector2D Corners[4] = { TopLeft, TopRight, BottomRight, BottomLeft };
+	FBitmapHomography SquareToQuad;
+	FBitmapHomography OutputToSource;
+	if (!FBitmapHomography::MakeUnitSquareToQuad(Corners, SquareToQuad)
+		|| !(SquareToQuad * FBitmapHomography::MakeScale(1.0 / Size.X, 1.0 / Size.Y)).Inverse(OutputToSource))
+	{
+		UE_LOG(LogTemp, Error, TEXT("3 of the corners are on a line. (Check WarpBitmapOntoQuad arguments)."));
+		return OutBitmap;
+	}
+
+	OutBitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+	FBitmapWarp::Warp(FConstBitmapView(Bitmap.GetData(), Size), OutputToSource, Filter, EBitmapBorderMode::Constant, FColor(0, 0, 0, 0), FBitmapView(OutBitmap.GetData(), NewSize));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::ResizeBitmap(TArray<FColor> Bitmap, FImageSize Size, FImageSize NewSize, EBitmapResampleFilter Filter, bool LinearLight, bool PremultipliedAlpha)
+{
+	TArray<FColor> OutBitmap;
+
+	if (Bitmap.Num() > 0 && Size.X > 0 && Size.Y > 0 && NewSize.X > 0 && NewSize.Y > 0)
+	{
+		if (Bitmap.Num() != Size.X * Size.Y)
+		{
+			UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ResizeBitmap arguments)."));
+			return OutBitmap;
+		}
+
+		OutBitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+		FBitmapResampler::Resize(FConstBitmapView(Bitmap.GetData(), Size), Filter, LinearLight, PremultipliedAlpha, FBitmapView(OutBitmap.GetData(), NewSize));
+	}
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::ResizeBitmapRegion(const TArray<FColor>& Bitmap, FImageSize Size, FImageRect Region, FImageSize NewSize, EBitmapResampleFilter Filter,
+	bool LinearLight, bool PremultipliedAlpha)
+{
+	TArray<FColor> OutBitmap;
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y || NewSize.X <= 0 || NewSize.Y <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size, or the new size is empty. (Check ResizeBitmapRegion arguments)."));
+		return OutBitmap;
+	}
+
+	const FConstBitmapView Source = FConstBitmapView(Bitmap.GetData(), Size).GetSubView(Region);
+	if (Source.Width <= 0 || Source.Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The region is outside the bitmap. (Check ResizeBitmapRegion arguments)."));
+		return OutBitmap;
+	}
+
+	OutBitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+	FBitmapResampler::Resize(Source, Filter, LinearLight, PremultipliedAlpha, FBitmapView(OutBitmap.GetData(), NewSize));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::SetBitmapHueSaturationLuminance(TArray<FColor> Bitmap, float Hue, float Saturation, float Luminance)
+{
+	float tempHueValue = FMath::Clamp(Hue, 0.0f, 360.0f);
+	float tempSaturationValue = Saturation; 
+	float tempLuminanceValue = Luminance;
+	TArray<FColor> OutBitmap;
+
+	for (FColor pixel : Bitmap)
+	{
+		FLinearColor HSV = FLinearColor::FromSRGBColor(pixel).LinearRGBToHSV();
+
+		// Sets the hue and makes sure values <0 or >360 get looped. (If a pixel's hue = -1, it will become 359, if it is = 361 it will become 1)
+			float newHue = HSV.R + tempHueValue;
+			if (newHue >= 360.0f)
+			{
+				HSV.R = FMath::Clamp(newHue - 360.0f, 0.0f, 360.0f);
+			}
+			else if (newHue <= 0.0f)
+			{
 				HSV.R = FMath::Clamp(newHue + 360.0f, 0.0f, 360.0f);
 			}
 			else
@@ -675,54 +1243,231 @@ TArray<FColor> UImageIOLibraryBPLibrary::ApplyBitmapFilter(TArray<FColor> Bitmap
 {
 	TArray<FColor> OutBitmap;
 
-	// Parse the filter struct into individual variables
-	int filterWidth = Filter.Size.X;
-	int filterHeight = Filter.Size.Y;
-	TArray<float> filter = Filter.Filter;
-	float factor = Filter.Factor;
-	float bias = Filter.Bias;
+	if (Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ApplyBitmapFilter arguments)."));
+		return OutBitmap;
+	}
+	if (Filter.Filter.Num() != Filter.Size.X * Filter.Size.Y || Filter.Filter.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The filter's values don't match its size. (Check the filter passed to ApplyBitmapFilter)."));
+		return OutBitmap;
+	}
 
-	int offset = FMath::FloorToInt(filter.Num() / 2);
+	// Every output pixel gets written, no need to initialise them
+	OutBitmap.SetNumUninitialized(Bitmap.Num());
+	FBitmapConvolution::Apply(FConstBitmapView(Bitmap.GetData(), Size), Filter, FBitmapView(OutBitmap.GetData(), Size));
+	return OutBitmap;
+}
+
+bool UImageIOLibraryBPLibrary::ApplyBitmapFilterToRegion(TArray<FColor>& Bitmap, FImageSize Size, FBitmapFilter Filter, FImageRect Region)
+{
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ApplyBitmapFilterToRegion arguments)."));
+		return false;
+	}
+	if (Filter.Filter.Num() != Filter.Size.X * Filter.Size.Y || Filter.Filter.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The filter's values don't match its size. (Check the filter passed to ApplyBitmapFilterToRegion)."));
+		return false;
+	}
 
-	// For each pixel in the bitmap
-	for (int Y = 0; Y < Size.Y; Y++) {
-		for (int X = 0; X < Size.X; X++) {
+	const FBitmapView Canvas(Bitmap.GetData(), Size);
+	const FImageRect Target = ClipRegion(Size, Region);
+	if (Target.Width <= 0 || Target.Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The region is outside the bitmap. (Check ApplyBitmapFilterToRegion arguments)."));
+		return false;
+	}
 
-			// Working pixel's index in the bitmap
-			int pixelIndex = FMath::Clamp(Y * Size.X + X, 0, Bitmap.Num() - 1);
+	// A whole kernel on each side: every tap of the region's pixels then reads what it would have read in the whole bitmap
+	const int32 ApronX = Filter.Size.X;
+	const int32 ApronY = Filter.Size.Y;
 
-			//New working pixel's default values
-			uint8 tempRed = 0;
-			uint8 tempGreen = 0;
-			uint8 tempBlue = 0;
-			uint8 tempAlpha = Filter.ColourChannel == EFilterColourChannel::RGBA ? Bitmap[pixelIndex].A : (uint8)255;
+	if (Filter.BorderMode != EBitmapBorderMode::Wrap)
+	{
+		FilterRegionWithApron(Canvas, Target, ApronX, ApronY, [&Filter](FConstBitmapView Src, FBitmapView Dst)
+		{
+			FBitmapConvolution::Apply(Src, Filter, Dst);
+		});
+		return true;
+	}
 
-			// Calculate the new colour of the working pixel
-			for (int filterY = 0; filterY < filterHeight; filterY++) {
-				for (int filterX = 0; filterX < filterWidth; filterX++) {
+	// Wrapping reads the far side of the bitmap rather than of the view, that one goes through a copy of the region and its wrapped apron
+	const FImageSize ApronSize(Target.Width + 2 * ApronX, Target.Height + 2 * ApronY);
 
-					// Get the working pixel's neighbours' index in the bitmap
-					int nPixelX = (X + filterX - FMath::FloorToInt(filterWidth / 2));
-					int nPixelY = (Y + filterY - FMath::FloorToInt(filterHeight / 2));
-					int nPixelIndex = FMath::Clamp(nPixelY * Size.X + nPixelX, 0, Bitmap.Num() - 1);
+	TArray<FColor> Apron;
+	Apron.SetNumUninitialized(ApronSize.X * ApronSize.Y);
+	FBitmapRegion::Crop(Canvas, FImageRect(Target.X - ApronX, Target.Y - ApronY, ApronSize.X, ApronSize.Y), Filter.BorderMode, Filter.BorderColour,
+		FBitmapView(Apron.GetData(), ApronSize));
 
-					//Get the corresponding filter index to apply
-					int nFilterIndex = FMath::Clamp(filterY * filterWidth + filterX, 0, filter.Num() - 1);
+	TArray<FColor> Filtered;
+	Filtered.SetNumUninitialized(Apron.Num());
+	FBitmapConvolution::Apply(FConstBitmapView(Apron.GetData(), ApronSize), Filter, FBitmapView(Filtered.GetData(), ApronSize));
 
-					tempRed += Bitmap[nPixelIndex].R * (filter[nFilterIndex] * Filter.Factor) + Filter.Bias;
-					tempGreen += Bitmap[nPixelIndex].G * (filter[nFilterIndex] * Filter.Factor) + Filter.Bias;
-					tempBlue += Bitmap[nPixelIndex].B * (filter[nFilterIndex] * Filter.Factor) + Filter.Bias;
-				}
-			}
+	FBitmapRegion::Copy(FConstBitmapView(Filtered.GetData(), ApronSize).GetSubView(FImageRect(ApronX, ApronY, Target.Width, Target.Height)), Canvas.GetSubView(Target));
+	return true;
+}
 
- 			//OutBitmap.Add(SetPixelColourChannel(FColor(tempRed, tempGreen, tempBlue, tempAlpha), Filter.ColourChannel));
-			OutBitmap.EmplaceAt(pixelIndex, SetPixelColourChannel(FColor(tempRed, tempGreen, tempBlue, tempAlpha), Filter.ColourChannel));
+TArray<FColor> UImageIOLibraryBPLibrary::ApplySeparableBitmapFilter(TArray<FColor> Bitmap, FImageSize Size, FSeparableBitmapFilter Filter)
+{
+	TArray<FColor> OutBitmap;
 
-		}
+	if (Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ApplySeparableBitmapFilter arguments)."));
+		return OutBitmap;
+	}
+	if (Filter.RowFilter.Num() == 0 || Filter.ColumnFilter.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The separable filter needs at least one row and one column value."));
+		return OutBitmap;
 	}
+
+	OutBitmap.SetNumUninitialized(Bitmap.Num());
+	FBitmapConvolution::ConvolveSeparable(FConstBitmapView(Bitmap.GetData(), Size), Filter, FBitmapView(OutBitmap.GetData(), Size));
 	return OutBitmap;
 }
 
+TArray<FColor> UImageIOLibraryBPLibrary::BlurBitmap(TArray<FColor> Bitmap, FImageSize Size, float Radius, EBitmapBlurMethod Method, EFilterColourChannel ColourChannel)
+{
+	if (Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check BlurBitmap arguments)."));
+		return TArray<FColor>();
+	}
+
+	// The blurs can work in place
+	FBitmapBlur::Blur(FConstBitmapView(Bitmap.GetData(), Size), Radius, Method, ColourChannel, FBitmapView(Bitmap.GetData(), Size));
+	return Bitmap;
+}
+
+bool UImageIOLibraryBPLibrary::BlurBitmapRegion(TArray<FColor>& Bitmap, FImageSize Size, FImageRect Region, float Radius, EBitmapBlurMethod Method, EFilterColourChannel ColourChannel)
+{
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check BlurBitmapRegion arguments)."));
+		return false;
+	}
+
+	const FImageRect Target = ClipRegion(Size, Region);
+	if (Target.Width <= 0 || Target.Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The region is outside the bitmap. (Check BlurBitmapRegion arguments)."));
+		return false;
+	}
+
+	const int32 Reach = FBitmapBlur::GetReach(Radius, Method);
+	FilterRegionWithApron(FBitmapView(Bitmap.GetData(), Size), Target, Reach, Reach, [=](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapBlur::Blur(Src, Radius, Method, ColourChannel, Dst);
+	});
+	return true;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::MedianFilterBitmap(TArray<FColor> Bitmap, FImageSize Size, int32 Radius, EFilterColourChannel ColourChannel)
+{
+	return PercentileFilterBitmap(MoveTemp(Bitmap), Size, Radius, 50.0f, ColourChannel);
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::PercentileFilterBitmap(TArray<FColor> Bitmap, FImageSize Size, int32 Radius, float Percentile, EFilterColourChannel ColourChannel)
+{
+	if (Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check PercentileFilterBitmap arguments)."));
+		return TArray<FColor>();
+	}
+
+	if (Radius < 1 || Radius > FBitmapRankFilter::MaxRadius)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The radius must be between 1 and %d. (Check PercentileFilterBitmap arguments)."), FBitmapRankFilter::MaxRadius);
+		return TArray<FColor>();
+	}
+
+	TArray<FColor> OutBitmap;
+	OutBitmap.SetNumUninitialized(Bitmap.Num());
+	FBitmapRankFilter::Filter(FConstBitmapView(Bitmap.GetData(), Size), Radius, Percentile, ColourChannel, FBitmapView(OutBitmap.GetData(), Size));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::SmoothBitmap(TArray<FColor> Bitmap, FImageSize Size, int32 Radius, float Smoothness, EFilterColourChannel ColourChannel)
+{
+	if (Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check SmoothBitmap arguments)."));
+		return TArray<FColor>();
+	}
+
+	if (Radius < 1 || Radius > FBitmapGuidedFilter::MaxRadius)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The radius must be between 1 and %d. (Check SmoothBitmap arguments)."), FBitmapGuidedFilter::MaxRadius);
+		return TArray<FColor>();
+	}
+
+	if (Smoothness <= 0.0f)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The smoothness must be greater than 0. (Check SmoothBitmap arguments)."));
+		return TArray<FColor>();
+	}
+
+	TArray<FColor> OutBitmap;
+	OutBitmap.SetNumUninitialized(Bitmap.Num());
+	FBitmapGuidedFilter::Filter(FConstBitmapView(Bitmap.GetData(), Size), Radius, Smoothness, ColourChannel, FBitmapView(OutBitmap.GetData(), Size));
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::ApplyBitmapMorphology(TArray<FColor> Bitmap, FImageSize Size, EBitmapMorphologyOperation Operation, int32 RadiusX, int32 RadiusY, EFilterColourChannel ColourChannel)
+{
+	if (Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ApplyBitmapMorphology arguments)."));
+		return TArray<FColor>();
+	}
+
+	if (RadiusX < 0 || RadiusX > FBitmapMorphology::MaxRadius || RadiusY < 0 || RadiusY > FBitmapMorphology::MaxRadius)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The radii must be between 0 and %d. (Check ApplyBitmapMorphology arguments)."), FBitmapMorphology::MaxRadius);
+		return TArray<FColor>();
+	}
+
+	TArray<FColor> OutBitmap;
+	OutBitmap.SetNumUninitialized(Bitmap.Num());
+	FBitmapMorphology::Apply(FConstBitmapView(Bitmap.GetData(), Size), Operation, RadiusX, RadiusY, ColourChannel, FBitmapView(OutBitmap.GetData(), Size));
+	return OutBitmap;
+}
+
+bool UImageIOLibraryBPLibrary::ApplyBitmapMorphologyToRegion(TArray<FColor>& Bitmap, FImageSize Size, FImageRect Region, EBitmapMorphologyOperation Operation, int32 RadiusX, int32 RadiusY,
+	EFilterColourChannel ColourChannel)
+{
+	if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ApplyBitmapMorphologyToRegion arguments)."));
+		return false;
+	}
+
+	if (RadiusX < 0 || RadiusX > FBitmapMorphology::MaxRadius || RadiusY < 0 || RadiusY > FBitmapMorphology::MaxRadius)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The radii must be between 0 and %d. (Check ApplyBitmapMorphologyToRegion arguments)."), FBitmapMorphology::MaxRadius);
+		return false;
+	}
+
+	const FImageRect Target = ClipRegion(Size, Region);
+	if (Target.Width <= 0 || Target.Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The region is outside the bitmap. (Check ApplyBitmapMorphologyToRegion arguments)."));
+		return false;
+	}
+
+	// Open and close run two operators in a row, each reaching a radius further
+	const int32 NumPasses = (Operation == EBitmapMorphologyOperation::Open || Operation == EBitmapMorphologyOperation::Close) ? 2 : 1;
+	FilterRegionWithApron(FBitmapView(Bitmap.GetData(), Size), Target, RadiusX * NumPasses, RadiusY * NumPasses, [=](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapMorphology::Apply(Src, Operation, RadiusX, RadiusY, ColourChannel, Dst);
+	});
+	return true;
+}
+
 FBitmapFilter UImageIOLibraryBPLibrary::GetBitmapFilter(EBitmapFilterType BitmapFilter, bool OverrideColourChannel, EFilterColourChannel ColourChannelOverride)
 {
 	// See https://en.wikipedia.org/wiki/Kernel_(image_processing) or https://setosa.io/ev/image-kernels/
@@ -820,6 +1565,271 @@ FColor UImageIOLibraryBPLibrary::SetPixelColourChannel(FColor Pixel, EFilterColo
 	return OutPixel;
 }
 
+
+/***** Alpha Compositing *****/
+
+FPremultipliedBitmap UImageIOLibraryBPLibrary::PremultiplyBitmap(TArray<FColor> Bitmap, FImageSize Size)
+{
+	if (Bitmap.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check PremultiplyBitmap arguments)."));
+		return FPremultipliedBitmap();
+	}
+
+	FBitmapCompositing::Premultiply(Bitmap.GetData(), Bitmap.GetData(), Bitmap.Num());
+	return FPremultipliedBitmap(MoveTemp(Bitmap), Size);
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::UnpremultiplyBitmap(FPremultipliedBitmap PremultipliedBitmap)
+{
+	TArray<FColor> OutBitmap = MoveTemp(PremultipliedBitmap.Bitmap);
+	FBitmapCompositing::Unpremultiply(OutBitmap.GetData(), OutBitmap.GetData(), OutBitmap.Num());
+	return OutBitmap;
+}
+
+FPremultipliedBitmap UImageIOLibraryBPLibrary::CompositePremultipliedBitmaps(FPremultipliedBitmap Source, FPremultipliedBitmap Destination, EBitmapCompositeOperation Operation)
+{
+	if (Source.Bitmap.Num() != Destination.Bitmap.Num() || Source.Size.X != Destination.Size.X || Source.Size.Y != Destination.Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Both bitmaps need the same resolution to be composited. (Check CompositePremultipliedBitmaps arguments)."));
+		return FPremultipliedBitmap();
+	}
+
+	// The destination is consumed, the result is written over it
+	FPremultipliedBitmap OutBitmap = MoveTemp(Destination);
+	FBitmapCompositing::Composite(Operation, Source.Bitmap.GetData(), OutBitmap.Bitmap.GetData(), OutBitmap.Bitmap.GetData(), OutBitmap.Bitmap.Num());
+	return OutBitmap;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::CompositeBitmaps(TArray<FColor> Source, TArray<FColor> Destination, FImageSize Size, EBitmapCompositeOperation Operation)
+{
+	if (Source.Num() != Size.X * Size.Y || Destination.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmaps doesn't match the input size. (Check CompositeBitmaps arguments)."));
+		return TArray<FColor>();
+	}
+
+	FBitmapCompositing::CompositeStraight(Operation, FConstBitmapView(Source.GetData(), Size), FBitmapView(Destination.GetData(), Size));
+	return Destination;
+}
+
+bool UImageIOLibraryBPLibrary::CompositeBitmapsInRegion(const TArray<FColor>& Source, TArray<FColor>& Destination, FImageSize Size, FImageRect Region, EBitmapCompositeOperation Operation)
+{
+	if (Source.Num() <= 0 || Source.Num() != Size.X * Size.Y || Destination.Num() != Size.X * Size.Y)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmaps doesn't match the input size. (Check CompositeBitmapsInRegion arguments)."));
+		return false;
+	}
+
+	const FBitmapView Target = FBitmapView(Destination.GetData(), Size).GetSubView(Region);
+	if (Target.Width <= 0 || Target.Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The region is outside the bitmaps. (Check CompositeBitmapsInRegion arguments)."));
+		return false;
+	}
+
+	FBitmapCompositing::CompositeStraight(Operation, FConstBitmapView(Source.GetData(), Size).GetSubView(Region), Target);
+	return true;
+}
+
+TArray<FColor> UImageIOLibraryBPLibrary::BlendBitmapsMultiband(const TArray<FColor>& BitmapA, const TArray<FColor>& BitmapB, const TArray<FColor>& Mask, FImageSize Size, int32 NumLevels)
+{
+	TArray<FColor> OutBitmap;
+	if (BitmapA.Num() <= 0 || BitmapA.Num() != Size.X * Size.Y || BitmapB.Num() != BitmapA.Num() || Mask.Num() != BitmapA.Num())
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmaps or Mask doesn't match the input size. (Check BlendBitmapsMultiband arguments)."));
+		return OutBitmap;
+	}
+
+	OutBitmap.SetNumUninitialized(BitmapA.Num());
+	FBitmapPyramid::BlendMultiband(FConstBitmapView(BitmapA.GetData(), Size), FConstBitmapView(BitmapB.GetData(), Size), FConstBitmapView(Mask.GetData(), Size), NumLevels,
+		FBitmapView(OutBitmap.GetData(), Size));
+	return OutBitmap;
+}
+
+
+bool UImageIOLibraryBPLibrary::BlendBitmapsMultibandInRegion(const TArray<FColor>& BitmapA, TArray<FColor>& BitmapB, const TArray<FColor>& Mask, FImageSize Size, FImageRect Region,
+	int32 NumLevels)
+{
+	if (BitmapA.Num() <= 0 || BitmapA.Num() != Size.X * Size.Y || BitmapB.Num() != BitmapA.Num() || Mask.Num() != BitmapA.Num())
+	{
+		UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmaps or Mask doesn't match the input size. (Check BlendBitmapsMultibandInRegion arguments)."));
+		return false;
+	}
+
+	const FBitmapView Target = FBitmapView(BitmapB.GetData(), Size).GetSubView(Region);
+	if (Target.Width <= 0 || Target.Height <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("The region is outside the bitmaps. (Check BlendBitmapsMultibandInRegion arguments)."));
+		return false;
+	}
+
+	FBitmapPyramid::BlendMultiband(FConstBitmapView(BitmapA.GetData(), Size).GetSubView(Region), Target, FConstBitmapView(Mask.GetData(), Size).GetSubView(Region), NumLevels, Target);
+	return true;
+}
+
+/***** Async Jobs *****/
+
+UBitmapJob* UImageIOLibraryBPLibrary::LoadImageFileAsync(const FOnBitmapJobCompleted& OnCompleted, FString PathToImage, bool CreateTexture, EBitmapJobPriority Priority)
+{
+	// Loaded here, the workers can only look modules up
+	FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+	// Read from the file's header now, the job is only started once that much decode memory is free. It holds it until the game thread has
+	// made its texture too.
+	const int64 DecodeBytes = FBitmapDecodeBudget::EstimateDecodeBytes(PathToImage, CreateTexture, false, true);
+
+	return UBitmapJob::Launch([PathToImage, CreateTexture](FBitmapJobContext& Context, FBitmapJobResult& Result)
+	{
+		if (!DecodeImageFile(PathToImage, Result.Bitmap, Result.Size))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to load image: %s"), *PathToImage);
+			return false;
+		}
+		Result.bCreateTexture = CreateTexture;
+		return true;
+	},
+	[OnCompleted](UBitmapJob* Job) { OnCompleted.ExecuteIfBound(Job); }, Priority, DecodeBytes);
+}
+
+UBitmapJob* UImageIOLibraryBPLibrary::ResizeBitmapAsync(const FOnBitmapJobCompleted& OnCompleted, TArray<FColor> Bitmap, FImageSize Size, FImageSize NewSize,
+	EBitmapResampleFilter Filter, bool LinearLight, bool PremultipliedAlpha, EBitmapJobPriority Priority)
+{
+	return UBitmapJob::Launch([Bitmap = MoveTemp(Bitmap), Size, NewSize, Filter, LinearLight, PremultipliedAlpha](FBitmapJobContext& Context, FBitmapJobResult& Result)
+	{
+		if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y || NewSize.X <= 0 || NewSize.Y <= 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size, or the new size is empty. (Check ResizeBitmapAsync arguments)."));
+			return false;
+		}
+
+		Result.Size = NewSize;
+		Result.Bitmap.SetNumUninitialized(NewSize.X * NewSize.Y);
+		FBitmapResampler::Resize(FConstBitmapView(Bitmap.GetData(), Size), Filter, LinearLight, PremultipliedAlpha, FBitmapView(Result.Bitmap.GetData(), NewSize));
+		return true;
+	},
+	[OnCompleted](UBitmapJob* Job) { OnCompleted.ExecuteIfBound(Job); }, Priority);
+}
+
+UBitmapJob* UImageIOLibraryBPLibrary::ApplyBitmapFilterAsync(const FOnBitmapJobCompleted& OnCompleted, TArray<FColor> Bitmap, FImageSize Size, FBitmapFilter Filter, EBitmapJobPriority Priority)
+{
+	return UBitmapJob::Launch([Bitmap = MoveTemp(Bitmap), Size, Filter](FBitmapJobContext& Context, FBitmapJobResult& Result)
+	{
+		if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+		{
+			UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check ApplyBitmapFilterAsync arguments)."));
+			return false;
+		}
+		if (Filter.Filter.Num() != Filter.Size.X * Filter.Size.Y || Filter.Filter.Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("The filter's values don't match its size. (Check the filter passed to ApplyBitmapFilterAsync)."));
+			return false;
+		}
+
+		Result.Size = Size;
+		Result.Bitmap.SetNumUninitialized(Bitmap.Num());
+		FBitmapConvolution::Apply(FConstBitmapView(Bitmap.GetData(), Size), Filter, FBitmapView(Result.Bitmap.GetData(), Size));
+		return true;
+	},
+	[OnCompleted](UBitmapJob* Job) { OnCompleted.ExecuteIfBound(Job); }, Priority);
+}
+
+UBitmapJob* UImageIOLibraryBPLibrary::BlurBitmapAsync(const FOnBitmapBlurred& OnBitmapBlurComplete, TArray<FColor> Bitmap, FImageSize Size, float BlurStrength, int BlurRadius, EBitmapJobPriority Priority)
+{
+	return UBitmapJob::Launch([Bitmap = MoveTemp(Bitmap), Size, BlurStrength, BlurRadius](FBitmapJobContext& Context, FBitmapJobResult& Result)
+	{
+		if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+		{
+			UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check BlurBitmapAsync arguments)."));
+			return false;
+		}
+
+		// Blend between the original and a full gaussian blur of the requested radius
+		Context.SetStage(0.0f, 0.9f);
+		Result.Size = Size;
+		Result.Bitmap.SetNumUninitialized(Bitmap.Num());
+		FBitmapBlur::Blur(FConstBitmapView(Bitmap.GetData(), Size), (float)BlurRadius, EBitmapBlurMethod::FastGaussian, EFilterColourChannel::RGBA, FBitmapView(Result.Bitmap.GetData(), Size));
+
+		Context.SetStage(0.9f, 1.0f);
+		const int32 Strength = FMath::RoundToInt(FMath::Clamp(BlurStrength, 0.0f, 1.0f) * 256.0f);
+		if (Strength < 256)
+		{
+			FBitmapParallel::ForRange(Bitmap.Num(), 16384, [&](int32 Start, int32 End)
+			{
+				const uint8* Original = (const uint8*)(Bitmap.GetData() + Start);
+				uint8* Blurred = (uint8*)(Result.Bitmap.GetData() + Start);
+				for (int32 Index = 0; Index < (End - Start) * 4; Index++)
+				{
+					Blurred[Index] = (uint8)(Original[Index] + (((Blurred[Index] - Original[Index]) * Strength + 128) >> 8));
+				}
+			});
+		}
+
+		Result.bCreateTexture = true;
+		return true;
+	},
+	[OnBitmapBlurComplete](UBitmapJob* Job) { OnBitmapBlurComplete.ExecuteIfBound(Job->Texture); }, Priority);
+}
+
+UBitmapJob* UImageIOLibraryBPLibrary::BlendBitmapsMultibandAsync(const FOnBitmapJobCompleted& OnCompleted, TArray<FColor> BitmapA, TArray<FColor> BitmapB, TArray<FColor> Mask,
+	FImageSize Size, int32 NumLevels, EBitmapJobPriority Priority)
+{
+	return UBitmapJob::Launch([BitmapA = MoveTemp(BitmapA), BitmapB = MoveTemp(BitmapB), Mask = MoveTemp(Mask), Size, NumLevels](FBitmapJobContext& Context, FBitmapJobResult& Result)
+	{
+		if (BitmapA.Num() <= 0 || BitmapA.Num() != Size.X * Size.Y || BitmapB.Num() != BitmapA.Num() || Mask.Num() != BitmapA.Num())
+		{
+			UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmaps or Mask doesn't match the input size. (Check BlendBitmapsMultibandAsync arguments)."));
+			return false;
+		}
+
+		Result.Size = Size;
+		Result.Bitmap.SetNumUninitialized(BitmapA.Num());
+		FBitmapPyramid::BlendMultiband(FConstBitmapView(BitmapA.GetData(), Size), FConstBitmapView(BitmapB.GetData(), Size), FConstBitmapView(Mask.GetData(), Size), NumLevels,
+			FBitmapView(Result.Bitmap.GetData(), Size));
+		return true;
+	},
+	[OnCompleted](UBitmapJob* Job) { OnCompleted.ExecuteIfBound(Job); }, Priority);
+}
+
+UBitmapJob* UImageIOLibraryBPLibrary::SaveBitmapAsPNGAsync(const FOnBitmapJobCompleted& OnCompleted, FString FilePath, TArray<FColor> Bitmap, FImageSize Size, EBitmapJobPriority Priority)
+{
+	return UBitmapJob::Launch([FilePath, Bitmap = MoveTemp(Bitmap), Size](FBitmapJobContext& Context, FBitmapJobResult& Result)
+	{
+		if (Bitmap.Num() <= 0 || Bitmap.Num() != Size.X * Size.Y)
+		{
+			UE_LOG(LogTemp, Error, TEXT("The size of the input Bitmap doesn't match the input size. (Check SaveBitmapAsPNGAsync arguments)."));
+			return false;
+		}
+
+		TArray<uint8> FileData;
+		FImageUtils::CompressImageArray(Size.X, Size.Y, Bitmap, FileData);
+
+		// A cancelled save leaves the file alone
+		Context.ReportProgress(0.9f);
+		if (Context.IsCancelled())
+		{
+			return false;
+		}
+		if (!FFileHelper::SaveArrayToFile(FileData, *FilePath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to save image: %s"), *FilePath);
+			return false;
+		}
+		return true;
+	},
+	[OnCompleted](UBitmapJob* Job) { OnCompleted.ExecuteIfBound(Job); }, Priority);
+}
+
+FDecodeMemoryStats UImageIOLibraryBPLibrary::GetDecodeMemoryStats()
+{
+	return FBitmapDecodeBudget::GetStats();
+}
+
+void UImageIOLibraryBPLibrary::ResetDecodeMemoryPeak()
+{
+	FBitmapDecodeBudget::ResetPeak();
+}
+
 /***** Private *****/
 
 EImageIOFormat UImageIOLibraryBPLibrary::EImageFormatToEImageIOFormat(EImageFormat ImageFormat)
@@ -931,15 +1941,4 @@ bool UImageIOLibraryBPLibrary::SaveTexture2D(UTexture2D* Texture2D, EImageIOForm
 		UE_LOG(LogTemp, Error, TEXT("Failed compress the image data."));
 	}
 	return false;
-}
-
-void UImageIOLibraryBPLibrary::BlurBitmapAsync(const FOnBitmapBlurred& OnBitmapBlurComplete, TArray<FColor> Bitmap, FImageSize Size, float BlurStrength, int BlurRadius)
-{
-	Async(EAsyncExecution::TaskGraphMainThread, [&]()
-	{
-		TArray<FColor> Result = ApplyBitmapFilter(Bitmap, Size, FBitmapFilter());
-		UTexture2D* ResultTexture;
-		CreateTexture2DFromBitmap(ResultTexture, Result, Size);
-		OnBitmapBlurComplete.ExecuteIfBound(ResultTexture);
-	});
 }
\ No newline at end of file
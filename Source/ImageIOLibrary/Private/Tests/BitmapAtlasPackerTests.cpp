@@ -0,0 +1,93 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "BitmapAtlasPacker.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapAtlasPackerTests
+{
+	bool Overlap(const FImageRect& A, const FImageRect& B)
+	{
+		return A.X < B.X + B.Width && B.X < A.X + A.Width && A.Y < B.Y + B.Height && B.Y < A.Y + A.Height;
+	}
+
+	/* Inserts rectangles until one doesn't fit, checking that each lands inside the bin without overlapping the ones before it. */
+	void FillBin(FAutomationTestBase& Test, FImageSize BinSize, int32 MinSide, int32 MaxSide, int32 Seed)
+	{
+		FRandomStream Random(Seed);
+		FBitmapAtlasPacker Packer(BinSize);
+		TArray<FImageRect> Placed;
+		int64 UsedArea = 0;
+
+		while (true)
+		{
+			const FImageSize Size(Random.RandRange(MinSide, MaxSide), Random.RandRange(MinSide, MaxSide));
+			const float OccupancyBefore = Packer.GetOccupancy();
+			FIntPoint Position;
+			if (!Packer.Insert(Size, Position))
+			{
+				Test.TestEqual(TEXT("A rectangle that doesn't fit leaves the occupancy as it was"), Packer.GetOccupancy(), OccupancyBefore);
+				break;
+			}
+
+			const FImageRect Rect(Position.X, Position.Y, Size.X, Size.Y);
+			if (Rect.X < 0 || Rect.Y < 0 || Rect.X + Rect.Width > BinSize.X || Rect.Y + Rect.Height > BinSize.Y)
+			{
+				Test.AddError(FString::Printf(TEXT("A %dx%d rectangle was placed at %d, %d, past the edge of the %dx%d bin."), Size.X, Size.Y, Rect.X, Rect.Y, BinSize.X, BinSize.Y));
+				return;
+			}
+			for (const FImageRect& Other : Placed)
+			{
+				if (Overlap(Rect, Other))
+				{
+					Test.AddError(FString::Printf(TEXT("A %dx%d rectangle at %d, %d overlaps the %dx%d one at %d, %d."), Rect.Width, Rect.Height, Rect.X, Rect.Y, Other.Width, Other.Height, Other.X, Other.Y));
+					return;
+				}
+			}
+
+			Placed.Add(Rect);
+			UsedArea += (int64)Size.X * Size.Y;
+		}
+
+		const float ExpectedOccupancy = (float)((double)UsedArea / ((double)BinSize.X * BinSize.Y));
+		if (!FMath::IsNearlyEqual(Packer.GetOccupancy(), ExpectedOccupancy, 1e-4f))
+		{
+			Test.AddError(FString::Printf(TEXT("The occupancy is %f where the placed rectangles cover %f of the bin."), Packer.GetOccupancy(), ExpectedOccupancy));
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapAtlasPackerTest, "ImageIOLibrary.AtlasPacker", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapAtlasPackerTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapAtlasPackerTests;
+
+	// Small icons, mixed sizes and a few big ones, in square and long bins
+	FillBin(*this, FImageSize(256, 256), 4, 20, 1);
+	FillBin(*this, FImageSize(512, 512), 1, 100, 2);
+	FillBin(*this, FImageSize(1024, 128), 30, 120, 3);
+
+	// Tiles that divide the bin fill it completely
+	FBitmapAtlasPacker Packer(FImageSize(64, 64));
+	FIntPoint Position;
+	bool bAllFit = true;
+	for (int32 Index = 0; Index < 16; Index++)
+	{
+		bAllFit &= Packer.Insert(FImageSize(16, 16), Position);
+	}
+	TestTrue(TEXT("16 16x16 tiles fit in a 64x64 bin"), bAllFit);
+	TestEqual(TEXT("16 16x16 tiles fill a 64x64 bin"), Packer.GetOccupancy(), 1.0f);
+	TestFalse(TEXT("A full bin has no room for a single pixel"), Packer.Insert(FImageSize(1, 1), Position));
+
+	FBitmapAtlasPacker Empty(FImageSize(32, 16));
+	TestFalse(TEXT("Rectangles aren't rotated to fit"), Empty.Insert(FImageSize(16, 32), Position));
+	TestTrue(TEXT("A rectangle the size of the bin fits"), Empty.Insert(FImageSize(32, 16), Position) && Position == FIntPoint(0, 0));
+
+	return true;
+}
+
+#endif
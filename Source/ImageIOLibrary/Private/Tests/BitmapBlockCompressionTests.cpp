@@ -0,0 +1,149 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "BitmapBlockCompression.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapBlockCompressionTests
+{
+	/* Decodes a BC7 mode 6 block to 16 RGBA pixels, false when the block uses another mode. */
+	bool DecodeBC7Mode6(const uint8* Block, uint8 (&OutPixels)[16][4])
+	{
+		int32 Position = 0;
+		auto Read = [Block, &Position](int32 NumBits)
+		{
+			int32 Value = 0;
+			for (int32 Bit = 0; Bit < NumBits; Bit++, Position++)
+			{
+				Value |= ((Block[Position >> 3] >> (Position & 7)) & 1) << Bit;
+			}
+			return Value;
+		};
+
+		if (Read(7) != 1 << 6)
+		{
+			return false;
+		}
+
+		int32 Endpoints[2][4];
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			Endpoints[0][Channel] = Read(7);
+			Endpoints[1][Channel] = Read(7);
+		}
+		const int32 FirstBit = Read(1);
+		const int32 SecondBit = Read(1);
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			Endpoints[0][Channel] = Endpoints[0][Channel] << 1 | FirstBit;
+			Endpoints[1][Channel] = Endpoints[1][Channel] << 1 | SecondBit;
+		}
+
+		static const int32 Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		for (int32 Pixel = 0; Pixel < 16; Pixel++)
+		{
+			const int32 Index = Read(Pixel == 0 ? 3 : 4);
+			for (int32 Channel = 0; Channel < 4; Channel++)
+			{
+				OutPixels[Pixel][Channel] = (uint8)(((64 - Weights[Index]) * Endpoints[0][Channel] + Weights[Index] * Endpoints[1][Channel] + 32) >> 6);
+			}
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapBC7FlatTest, "ImageIOLibrary.BlockCompression.BC7FlatBlocks", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapBC7FlatTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapBlockCompressionTests;
+
+	// Mode 6 can't hit every flat colour exactly (each endpoint's 4 channels share their lowest bit), but it gets within 1 of all of them
+	for (int32 Alpha : { 0, 128, 255 })
+	{
+		for (int32 Value = 0; Value < 256; Value++)
+		{
+			uint8 Pixels[16][4];
+			for (uint8 (&Pixel)[4] : Pixels)
+			{
+				Pixel[0] = Pixel[1] = Pixel[2] = (uint8)Value;
+				Pixel[3] = (uint8)Alpha;
+			}
+
+			uint8 Block[16];
+			FBitmapBlockCompression::Compress(FConstBitmapView((const FColor*)Pixels, FImageSize(4, 4)), EBitmapTextureCompression::BC7, Block);
+
+			uint8 Decoded[16][4];
+			if (!DecodeBC7Mode6(Block, Decoded))
+			{
+				AddError(FString::Printf(TEXT("Grey %d, alpha %d isn't a mode 6 block."), Value, Alpha));
+				continue;
+			}
+
+			int32 Error = 0;
+			bool bOpaque = true;
+			for (int32 Pixel = 0; Pixel < 16; Pixel++)
+			{
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					Error = FMath::Max(Error, FMath::Abs((int32)Decoded[Pixel][Channel] - Pixels[Pixel][Channel]));
+				}
+				bOpaque &= Decoded[Pixel][3] == 255;
+			}
+			if (Error > 1)
+			{
+				AddError(FString::Printf(TEXT("Grey %d, alpha %d is off by up to %d."), Value, Alpha, Error));
+			}
+			if (Alpha == 255 && !bOpaque)
+			{
+				AddError(FString::Printf(TEXT("Opaque grey %d doesn't decode to alpha 255."), Value));
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapBC7OpaqueTest, "ImageIOLibrary.BlockCompression.BC7OpaqueBlocks", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapBC7OpaqueTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapBlockCompressionTests;
+
+	// Opaque blocks of random colours, where the endpoints come from the principal axis rather than a single colour
+	FRandomStream Random(2020);
+	for (int32 Test = 0; Test < 200; Test++)
+	{
+		uint8 Pixels[16][4];
+		for (uint8 (&Pixel)[4] : Pixels)
+		{
+			Pixel[0] = (uint8)Random.RandRange(0, 255);
+			Pixel[1] = (uint8)Random.RandRange(0, 255);
+			Pixel[2] = (uint8)Random.RandRange(0, 255);
+			Pixel[3] = 255;
+		}
+
+		uint8 Block[16];
+		uint8 Decoded[16][4];
+		FBitmapBlockCompression::Compress(FConstBitmapView((const FColor*)Pixels, FImageSize(4, 4)), EBitmapTextureCompression::BC7, Block);
+		if (!DecodeBC7Mode6(Block, Decoded))
+		{
+			AddError(FString::Printf(TEXT("Random opaque block %d isn't a mode 6 block."), Test));
+			continue;
+		}
+		for (int32 Pixel = 0; Pixel < 16; Pixel++)
+		{
+			if (Decoded[Pixel][3] != 255)
+			{
+				AddError(FString::Printf(TEXT("Random opaque block %d decodes to alpha %d."), Test, Decoded[Pixel][3]));
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+#endif
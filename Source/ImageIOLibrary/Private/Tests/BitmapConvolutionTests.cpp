@@ -0,0 +1,202 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapConvolution.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapConvolutionTests
+{
+	// Odd sizes, so edge tiles and leftover pixels get exercised
+	const FImageSize BitmapSize(157, 93);
+
+	/* Every stock filter, plus random whole (fixed point path) and fractional (float path) kernels of assorted shapes. */
+	TArray<FBitmapFilter> MakeTestFilters()
+	{
+		TArray<FBitmapFilter> Filters;
+		for (int32 FilterType = EBitmapFilterType::Identity; FilterType <= EBitmapFilterType::EdgeDetection; FilterType++)
+		{
+			Filters.Add(UImageIOLibraryBPLibrary::GetBitmapFilter((EBitmapFilterType)FilterType, false, EFilterColourChannel::RGBA));
+		}
+
+		FRandomStream Random(5678);
+		for (const FImageSize& KernelSize : { FImageSize(3, 3), FImageSize(4, 5), FImageSize(7, 2), FImageSize(9, 9), FImageSize(31, 17) })
+		{
+			Filters.Add(BitmapTestUtils::MakeRandomFilter(KernelSize, true, Random));
+			Filters.Add(BitmapTestUtils::MakeRandomFilter(KernelSize, false, Random));
+		}
+		return Filters;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapConvolutionApplyTest, "ImageIOLibrary.Convolution.ApplyBitmapFilter", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapConvolutionApplyTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapConvolutionTests;
+
+	const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(BitmapSize, 1234);
+
+	for (FBitmapFilter Filter : MakeTestFilters())
+	{
+		for (int32 BorderMode = (int32)EBitmapBorderMode::Clamp; BorderMode <= (int32)EBitmapBorderMode::Constant; BorderMode++)
+		{
+			for (int32 ColourChannel = (int32)EFilterColourChannel::RGB; ColourChannel <= (int32)EFilterColourChannel::Greyscale; ColourChannel++)
+			{
+				for (bool bFilterAlpha : { false, true })
+				{
+					Filter.BorderMode = (EBitmapBorderMode)BorderMode;
+					Filter.BorderColour = FColor(40, 120, 200, 255);
+					Filter.ColourChannel = (EFilterColourChannel)ColourChannel;
+					Filter.FilterAlpha = bFilterAlpha;
+
+					const TArray<FColor> Expected = BitmapTestUtils::ReferenceConvolution(Bitmap, BitmapSize, Filter);
+					const int32 Error = BitmapTestUtils::MaxChannelError(Expected, UImageIOLibraryBPLibrary::ApplyBitmapFilter(Bitmap, BitmapSize, Filter));
+					if (Error > BitmapTestUtils::RoundingTolerance)
+					{
+						AddError(FString::Printf(TEXT("%dx%d kernel, border mode %d, colour channel %d, alpha %s is off by up to %d."), Filter.Size.X, Filter.Size.Y, BorderMode, ColourChannel,
+							bFilterAlpha ? TEXT("filtered") : TEXT("kept"), Error));
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapConvolutionTileTest, "ImageIOLibrary.Convolution.SpecialisedTiles", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapConvolutionTileTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapConvolutionTests;
+
+	// Direct convolution only: ApplyBitmapFilter would send some of these kernels through the separable or FFT paths instead
+	const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(BitmapSize, 4321);
+
+	FRandomStream Random(8765);
+	for (int32 KernelSide : { 3, 5, 7 })
+	{
+		for (bool bWholeTaps : { true, false })
+		{
+			FBitmapFilter Filter = BitmapTestUtils::MakeRandomFilter(FImageSize(KernelSide, KernelSide), bWholeTaps, Random);
+			Filter.FilterAlpha = true;
+			for (int32 ColourChannel = (int32)EFilterColourChannel::RGB; ColourChannel <= (int32)EFilterColourChannel::Greyscale; ColourChannel++)
+			{
+				Filter.ColourChannel = (EFilterColourChannel)ColourChannel;
+
+				TArray<FColor> Result;
+				Result.SetNumUninitialized(Bitmap.Num());
+				FBitmapConvolution::Convolve(FConstBitmapView(Bitmap.GetData(), BitmapSize), Filter, FBitmapView(Result.GetData(), BitmapSize));
+
+				const int32 Error = BitmapTestUtils::MaxChannelError(BitmapTestUtils::ReferenceConvolution(Bitmap, BitmapSize, Filter), Result);
+				if (Error > BitmapTestUtils::RoundingTolerance)
+				{
+					AddError(FString::Printf(TEXT("%dx%d %s kernel, colour channel %d is off by up to %d."), KernelSide, KernelSide, bWholeTaps ? TEXT("whole") : TEXT("fractional"), ColourChannel, Error));
+				}
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapConvolutionFFTTest, "ImageIOLibrary.Convolution.FFT", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapConvolutionFFTTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapConvolutionTests;
+
+	// ApplyBitmapFilter only picks FFTs for big kernels, every kernel goes through them here
+	const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(BitmapSize, 1234);
+
+	for (FBitmapFilter Filter : MakeTestFilters())
+	{
+		for (int32 BorderMode = (int32)EBitmapBorderMode::Clamp; BorderMode <= (int32)EBitmapBorderMode::Constant; BorderMode++)
+		{
+			for (int32 ColourChannel = (int32)EFilterColourChannel::RGB; ColourChannel <= (int32)EFilterColourChannel::Greyscale; ColourChannel++)
+			{
+				Filter.BorderMode = (EBitmapBorderMode)BorderMode;
+				Filter.BorderColour = FColor(40, 120, 200, 255);
+				Filter.ColourChannel = (EFilterColourChannel)ColourChannel;
+				Filter.FilterAlpha = true;
+
+				TArray<FColor> Result;
+				Result.SetNumUninitialized(Bitmap.Num());
+				FBitmapConvolution::ConvolveFFT(FConstBitmapView(Bitmap.GetData(), BitmapSize), Filter, FBitmapView(Result.GetData(), BitmapSize));
+
+				const int32 Error = BitmapTestUtils::MaxChannelError(BitmapTestUtils::ReferenceConvolution(Bitmap, BitmapSize, Filter), Result);
+				if (Error > BitmapTestUtils::RoundingTolerance)
+				{
+					AddError(FString::Printf(TEXT("%dx%d kernel, border mode %d, colour channel %d is off by up to %d through FFTs."), Filter.Size.X, Filter.Size.Y, BorderMode, ColourChannel, Error));
+				}
+			}
+		}
+	}
+
+	// A row kernel this long needs blocks over FBitmapFFT::MaxSize: the cost model must not pick FFTs, and ConvolveFFT falls back to
+	// the direct path. The kernel is an identity so the result can be checked without the (slow) reference.
+	const FImageSize LongSize(33000, 1);
+	const TArray<FColor> LongBitmap = BitmapTestUtils::MakeRandomBitmap(LongSize, 2468);
+
+	FBitmapFilter LongFilter;
+	LongFilter.Size = FImageSize(8301, 1);
+	LongFilter.Filter.SetNumZeroed(LongFilter.Size.X);
+	LongFilter.Filter[LongFilter.Size.X / 2] = 1.0f;
+	LongFilter.ColourChannel = EFilterColourChannel::RGBA;
+
+	TestTrue(TEXT("Kernels too big for the FFT blocks aren't sent to them"), FBitmapConvolution::ChooseMethod(LongSize, LongFilter, false) != EBitmapConvolutionMethod::FFT);
+
+	TArray<FColor> LongResult;
+	LongResult.SetNumUninitialized(LongBitmap.Num());
+	FBitmapConvolution::ConvolveFFT(FConstBitmapView(LongBitmap.GetData(), LongSize), LongFilter, FBitmapView(LongResult.GetData(), LongSize));
+	TestTrue(TEXT("Kernels too big for the FFT blocks are applied directly"), BitmapTestUtils::MaxChannelError(LongBitmap, LongResult) == 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapConvolutionMethodTest, "ImageIOLibrary.Convolution.ChooseMethod", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapConvolutionMethodTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapConvolutionTests;
+
+	for (const FImageSize& Size : { BitmapSize, FImageSize(1920, 1080) })
+	{
+		// The stock blurs are rank 1 and go through the two 1D passes
+		for (EBitmapFilterType FilterType : { EBitmapFilterType::BoxBlur, EBitmapFilterType::Gaussian1, EBitmapFilterType::Gaussian2 })
+		{
+			const FBitmapFilter Filter = UImageIOLibraryBPLibrary::GetBitmapFilter(FilterType, false, EFilterColourChannel::RGBA);
+
+			TArray<float> Row;
+			TArray<float> Column;
+			const bool bSeparable = FBitmapConvolution::FindSeparableFactors(Filter, Row, Column);
+			TestTrue(FString::Printf(TEXT("Stock filter %d is found separable"), (int32)FilterType), bSeparable);
+			TestTrue(FString::Printf(TEXT("Stock filter %d is applied as two 1D passes at %dx%d"), (int32)FilterType, Size.X, Size.Y),
+				FBitmapConvolution::ChooseMethod(Size, Filter, bSeparable) == EBitmapConvolutionMethod::Separable);
+		}
+
+		// The other stock filters aren't, and are small enough to apply directly
+		for (EBitmapFilterType FilterType : { EBitmapFilterType::Sharpen, EBitmapFilterType::EdgeDetection })
+		{
+			const FBitmapFilter Filter = UImageIOLibraryBPLibrary::GetBitmapFilter(FilterType, false, EFilterColourChannel::RGBA);
+
+			TArray<float> Row;
+			TArray<float> Column;
+			const bool bSeparable = FBitmapConvolution::FindSeparableFactors(Filter, Row, Column);
+			TestFalse(FString::Printf(TEXT("Stock filter %d isn't found separable"), (int32)FilterType), bSeparable);
+			TestTrue(FString::Printf(TEXT("Stock filter %d is applied directly at %dx%d"), (int32)FilterType, Size.X, Size.Y),
+				FBitmapConvolution::ChooseMethod(Size, Filter, bSeparable) == EBitmapConvolutionMethod::Direct);
+		}
+	}
+
+	// Big kernels that don't split go through FFTs
+	FRandomStream Random(1357);
+	const FBitmapFilter Big = BitmapTestUtils::MakeRandomFilter(FImageSize(31, 31), false, Random);
+	TestTrue(TEXT("A big kernel that isn't rank 1 is applied through FFTs"), FBitmapConvolution::ChooseMethod(FImageSize(1920, 1080), Big, false) == EBitmapConvolutionMethod::FFT);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,172 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "BitmapDecodeBudget.h"
+#include "BitmapJobScheduler.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapDecodeBudgetTests
+{
+	const int64 Megabyte = 1024 * 1024;
+
+	/* What the jobs of the hold back check saw, shared with them so a job still queued after a failed check never outlives it. */
+	struct FHoldBackState
+	{
+		FThreadSafeCounter NumPlainDone;
+		FThreadSafeCounter NumBigDone;
+		FThreadSafeCounter NumSmallDone;
+		FThreadSafeCounter NumReserved;
+		FThreadSafeCounter NumSmallStartedEarly;
+	};
+
+	/* Waits for Counter to reach Value, false after 10 seconds. */
+	bool WaitFor(const FThreadSafeCounter& Counter, int32 Value)
+	{
+		const double Timeout = FPlatformTime::Seconds() + 10.0;
+		while (Counter.GetValue() < Value)
+		{
+			if (FPlatformTime::Seconds() > Timeout)
+			{
+				return false;
+			}
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return true;
+	}
+
+	TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe> MakeContext()
+	{
+		TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe> Context = MakeShared<FBitmapJobContext, ESPMode::ThreadSafe>();
+		Context->SetPriority(EBitmapJobPriority::Visible);
+		return Context;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapDecodeBudgetTest, "ImageIOLibrary.DecodeBudget", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapDecodeBudgetTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapDecodeBudgetTests;
+
+	FDecodeMemoryStats Stats = FBitmapDecodeBudget::GetStats();
+	if (Stats.Decodes > 0 || Stats.WaitingDecodes > 0)
+	{
+		AddWarning(TEXT("Image decodes are running, the decode budget can't be checked."));
+		return true;
+	}
+	if (Stats.BudgetMegabytes < 4.0f)
+	{
+		AddInfo(TEXT("ImageIO.DecodeMemoryBudget is too small or 0 (no cap), the decode budget isn't checked."));
+		return true;
+	}
+	const int64 BudgetBytes = (int64)Stats.BudgetMegabytes * Megabyte;
+
+	// Reservations are counted while they fit, the first past the budget is refused without waiting
+	TestTrue(TEXT("Most of the budget can be reserved"), FBitmapDecodeBudget::TryReserve(BudgetBytes - Megabyte));
+	TestFalse(TEXT("A reservation past the budget is refused"), FBitmapDecodeBudget::TryReserve(2 * Megabyte));
+	TestTrue(TEXT("A reservation that fills the budget exactly fits"), FBitmapDecodeBudget::TryReserve(Megabyte));
+	Stats = FBitmapDecodeBudget::GetStats();
+	TestEqual(TEXT("Both reservations are counted"), Stats.Decodes, 2);
+	TestTrue(TEXT("The whole budget is used"), FMath::IsNearlyEqual(Stats.UsedMegabytes, Stats.BudgetMegabytes, 0.01f));
+	TestTrue(TEXT("The peak is at least the whole budget"), Stats.PeakMegabytes >= Stats.BudgetMegabytes - 0.01f);
+
+	FBitmapDecodeBudget::Release(BudgetBytes - Megabyte);
+	FBitmapDecodeBudget::Release(Megabyte);
+	Stats = FBitmapDecodeBudget::GetStats();
+	TestTrue(TEXT("Released reservations give all of their memory back"), Stats.Decodes == 0 && FMath::IsNearlyEqual(Stats.UsedMegabytes, 0.0f, 0.01f));
+
+	// A decode bigger than the whole budget still runs, but alone
+	TestTrue(TEXT("A reservation bigger than the budget fits when nothing else is reserved"), FBitmapDecodeBudget::TryReserve(2 * BudgetBytes));
+	TestFalse(TEXT("Nothing fits next to a reservation bigger than the budget"), FBitmapDecodeBudget::TryReserve(1));
+	FBitmapDecodeBudget::Release(2 * BudgetBytes);
+
+	{
+		FBitmapDecodeReservation Reservation = FBitmapDecodeReservation::TryReserve(BudgetBytes);
+		TestTrue(TEXT("A reservation of the whole budget is made"), Reservation.IsReserved());
+		TestFalse(TEXT("A reservation that doesn't fit is empty"), FBitmapDecodeReservation::TryReserve(Megabyte).IsReserved());
+
+		FBitmapDecodeReservation Moved(MoveTemp(Reservation));
+		TestTrue(TEXT("A moved reservation is carried over"), Moved.IsReserved() && !Reservation.IsReserved());
+		TestEqual(TEXT("A moved reservation is counted once"), FBitmapDecodeBudget::GetStats().Decodes, 1);
+	}
+	TestEqual(TEXT("A reservation gives its memory back when destroyed"), FBitmapDecodeBudget::GetStats().Decodes, 0);
+
+	// Hold back: with the budget nearly full, a big decode waits, the small decode queued after it waits behind it although it would fit,
+	// and a job that doesn't decode runs past both
+	FBitmapDecodeReservation Held = FBitmapDecodeReservation::TryReserve(BudgetBytes - Megabyte);
+	TSharedRef<FHoldBackState, ESPMode::ThreadSafe> State = MakeShared<FHoldBackState, ESPMode::ThreadSafe>();
+	TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe> Big = MakeContext();
+	TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe> Small = MakeContext();
+	TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe> Plain = MakeContext();
+
+	// Big and Small don't fit together, so Small only starts once Big has given its memory back
+	FBitmapJobScheduler& Scheduler = FBitmapJobScheduler::Get();
+	Scheduler.Schedule(Big, [State, Small](FBitmapDecodeReservation& Reservation)
+	{
+		if (Reservation.IsReserved())
+		{
+			State->NumReserved.Increment();
+		}
+
+		// Time for a Small started too early to show
+		FPlatformProcess::Sleep(0.05f);
+		if (Small->IsStarted())
+		{
+			State->NumSmallStartedEarly.Increment();
+		}
+		State->NumBigDone.Increment();
+	}, BudgetBytes - Megabyte / 2);
+
+	Scheduler.Schedule(Small, [State](FBitmapDecodeReservation& Reservation)
+	{
+		if (Reservation.IsReserved())
+		{
+			State->NumReserved.Increment();
+		}
+		if (State->NumBigDone.GetValue() == 0)
+		{
+			State->NumSmallStartedEarly.Increment();
+		}
+		State->NumSmallDone.Increment();
+	}, Megabyte);
+
+	Scheduler.Schedule(Plain, [State](FBitmapDecodeReservation& Reservation)
+	{
+		State->NumPlainDone.Increment();
+	});
+
+	if (!WaitFor(State->NumPlainDone, 1))
+	{
+		AddError(TEXT("A job that doesn't decode waits behind the decodes the budget holds back."));
+		return true;
+	}
+	TestFalse(TEXT("A decode that doesn't fit isn't started"), Big->IsStarted());
+	TestFalse(TEXT("A decode that fits waits behind the older one that doesn't"), Small->IsStarted());
+	TestEqual(TEXT("Both held back decodes are counted as waiting"), FBitmapDecodeBudget::GetStats().WaitingDecodes, 2);
+
+	Held.Release();
+	if (!WaitFor(State->NumSmallDone, 1))
+	{
+		AddError(TEXT("The held back decodes don't run once their memory is given back."));
+		return true;
+	}
+	TestEqual(TEXT("The decodes are handed their reservations"), State->NumReserved.GetValue(), 2);
+	TestEqual(TEXT("A decode only starts once the one before it has left room"), State->NumSmallStartedEarly.GetValue(), 0);
+
+	// Small gives its memory back once its task has returned, a moment after it's done
+	const double Timeout = FPlatformTime::Seconds() + 10.0;
+	while (FBitmapDecodeBudget::GetStats().Decodes > 0 && FPlatformTime::Seconds() < Timeout)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+	TestEqual(TEXT("Finished decodes give their memory back"), FBitmapDecodeBudget::GetStats().Decodes, 0);
+
+	return true;
+}
+
+#endif
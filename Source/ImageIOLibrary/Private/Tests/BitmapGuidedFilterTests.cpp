@@ -0,0 +1,132 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapGuidedFilter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapGuidedFilterTests
+{
+	/* The guided filter as He, Sun and Tang describe it, in double precision: fits A and B in every clamped window, then averages the fits
+	of the windows covering each pixel.
+	*/
+	TArray<FColor> ReferenceGuidedFilter(const TArray<FColor>& Bitmap, FImageSize Size, int32 Radius, float Smoothness, EFilterColourChannel ColourChannel)
+	{
+		const int32 NumPixels = Size.X * Size.Y;
+		const double Regulariser = FMath::Max(FMath::Square((double)Smoothness * 255.0), 1e-4);
+
+		auto ReadChannel = [&Bitmap, Size](int32 X, int32 Y, int32 Channel)
+		{
+			const FColor& Pixel = Bitmap[FMath::Clamp(Y, 0, Size.Y - 1) * Size.X + FMath::Clamp(X, 0, Size.X - 1)];
+			return (double)(Channel == 0 ? Pixel.R : Channel == 1 ? Pixel.G : Channel == 2 ? Pixel.B : Pixel.A);
+		};
+
+		TArray<double> A;
+		TArray<double> B;
+		A.SetNumUninitialized(NumPixels * 4);
+		B.SetNumUninitialized(NumPixels * 4);
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					double Mean = 0.0;
+					double MeanOfSquares = 0.0;
+					for (int32 WindowY = Y - Radius; WindowY <= Y + Radius; WindowY++)
+					{
+						for (int32 WindowX = X - Radius; WindowX <= X + Radius; WindowX++)
+						{
+							const double Value = ReadChannel(WindowX, WindowY, Channel);
+							Mean += Value;
+							MeanOfSquares += Value * Value;
+						}
+					}
+					Mean /= FMath::Square(2 * Radius + 1);
+					MeanOfSquares /= FMath::Square(2 * Radius + 1);
+
+					const double Variance = MeanOfSquares - Mean * Mean;
+					const int32 Index = (Y * Size.X + X) * 4 + Channel;
+					A[Index] = Variance / (Variance + Regulariser);
+					B[Index] = Mean * (1.0 - A[Index]);
+				}
+			}
+		}
+
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(NumPixels);
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				uint8 Values[4];
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					double MeanA = 0.0;
+					double MeanB = 0.0;
+					for (int32 WindowY = Y - Radius; WindowY <= Y + Radius; WindowY++)
+					{
+						for (int32 WindowX = X - Radius; WindowX <= X + Radius; WindowX++)
+						{
+							const int32 Index = (FMath::Clamp(WindowY, 0, Size.Y - 1) * Size.X + FMath::Clamp(WindowX, 0, Size.X - 1)) * 4 + Channel;
+							MeanA += A[Index];
+							MeanB += B[Index];
+						}
+					}
+					MeanA /= FMath::Square(2 * Radius + 1);
+					MeanB /= FMath::Square(2 * Radius + 1);
+
+					Values[Channel] = BitmapTestUtils::QuantizeReference(MeanA * ReadChannel(X, Y, Channel) + MeanB);
+				}
+				Result[Y * Size.X + X] = BitmapChannels::FinishFilteredPixel(FColor(Values[0], Values[1], Values[2], Values[3]), ColourChannel);
+			}
+		}
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapGuidedFilterTest, "ImageIOLibrary.GuidedFilter", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapGuidedFilterTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapGuidedFilterTests;
+
+	for (int32 Width : { 1, 3, 40, 97 })
+	{
+		for (int32 Height : { 1, 2, 35, 70 })
+		{
+			// Green only takes 4 levels, so there are strong edges next to the noise
+			TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(FImageSize(Width, Height), Width * 1000 + Height);
+			for (FColor& Pixel : Bitmap)
+			{
+				Pixel.G = (Pixel.G / 64) * 60;
+			}
+
+			for (int32 Radius : { 1, 3, 8 })
+			{
+				for (float Smoothness : { 0.02f, 0.1f, 0.5f })
+				{
+					for (EFilterColourChannel ColourChannel : { EFilterColourChannel::RGBA, EFilterColourChannel::RGB, EFilterColourChannel::Greyscale })
+					{
+						const FImageSize Size(Width, Height);
+
+						TArray<FColor> Result;
+						Result.SetNumUninitialized(Bitmap.Num());
+						FBitmapGuidedFilter::Filter(FConstBitmapView(Bitmap.GetData(), Size), Radius, Smoothness, ColourChannel, FBitmapView(Result.GetData(), Size));
+
+						const int32 Error = BitmapTestUtils::MaxChannelError(ReferenceGuidedFilter(Bitmap, Size, Radius, Smoothness, ColourChannel), Result);
+						if (Error > BitmapTestUtils::RoundingTolerance)
+						{
+							AddError(FString::Printf(TEXT("%dx%d bitmap, radius %d, smoothness %.2f, colour channel %d is off by up to %d."), Width, Height, Radius, Smoothness, (int32)ColourChannel, Error));
+						}
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,244 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "BitmapJobScheduler.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapJobSchedulerTests
+{
+	typedef TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe> FContextRef;
+
+	/* What the jobs saw, shared with them so a job still queued after a failed check never outlives it. */
+	struct FJobLog
+	{
+		FCriticalSection Lock;
+
+		// Names of the jobs in the order they started
+		TArray<FString> Started;
+
+		// Set to let the jobs holding the slot finish
+		FThreadSafeCounter Released;
+
+		FThreadSafeCounter NumBlockersStarted;
+
+		void Add(const FString& Name)
+		{
+			FScopeLock ScopeLock(&Lock);
+			Started.Add(Name);
+		}
+
+		FString Join()
+		{
+			FScopeLock ScopeLock(&Lock);
+			return FString::Join(Started, TEXT(" "));
+		}
+
+		int32 Num()
+		{
+			FScopeLock ScopeLock(&Lock);
+			return Started.Num();
+		}
+	};
+
+	typedef TSharedRef<FJobLog, ESPMode::ThreadSafe> FJobLogRef;
+
+	/* Waits for Predicate to hold, false after 10 seconds. */
+	template<typename PredicateType>
+	bool WaitFor(const PredicateType& Predicate)
+	{
+		const double Timeout = FPlatformTime::Seconds() + 10.0;
+		while (!Predicate())
+		{
+			if (FPlatformTime::Seconds() > Timeout)
+			{
+				return false;
+			}
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return true;
+	}
+
+	FContextRef MakeContext(EBitmapJobPriority Priority)
+	{
+		FContextRef Context = MakeShared<FBitmapJobContext, ESPMode::ThreadSafe>();
+		Context->SetPriority(Priority);
+		return Context;
+	}
+
+	/* Queues a job that logs its name when it starts. */
+	FContextRef ScheduleLogged(const FJobLogRef& Log, const FString& Name, EBitmapJobPriority Priority, int64 DecodeBytes = 0)
+	{
+		FContextRef Context = MakeContext(Priority);
+		FBitmapJobScheduler::Get().Schedule(Context, [Log, Name](FBitmapDecodeReservation& Reservation)
+		{
+			Log->Add(Name);
+		}, DecodeBytes);
+		return Context;
+	}
+
+	/* Queues a job that holds its slot until Log is released, giving its thread to more urgent jobs meanwhile when bYield. */
+	FContextRef ScheduleBlocker(const FJobLogRef& Log, EBitmapJobPriority Priority, bool bYield, int64 DecodeBytes = 0)
+	{
+		FContextRef Context = MakeContext(Priority);
+		FBitmapJobScheduler::Get().Schedule(Context, [Log, Context, bYield](FBitmapDecodeReservation& Reservation)
+		{
+			FBitmapJobContext::FScope Scope(*Context);
+			Log->NumBlockersStarted.Increment();
+			while (Log->Released.GetValue() == 0)
+			{
+				if (bYield)
+				{
+					Context->YieldToHigherPriority();
+				}
+				FPlatformProcess::Sleep(0.001f);
+			}
+		}, DecodeBytes);
+		return Context;
+	}
+
+	/* With the only slot taken, queued jobs start most urgent first and in the order they were queued within a priority. */
+	void CheckPopOrder(FAutomationTestBase& Test)
+	{
+		FJobLogRef Log = MakeShared<FJobLog, ESPMode::ThreadSafe>();
+		ScheduleBlocker(Log, EBitmapJobPriority::Background, false);
+		if (!WaitFor([&Log]() { return Log->NumBlockersStarted.GetValue() > 0; }))
+		{
+			Test.AddError(TEXT("A job doesn't start while a slot is free."));
+			Log->Released.Increment();
+			return;
+		}
+
+		ScheduleLogged(Log, TEXT("Background1"), EBitmapJobPriority::Background);
+		ScheduleLogged(Log, TEXT("Prefetch1"), EBitmapJobPriority::Prefetch);
+		ScheduleLogged(Log, TEXT("Visible1"), EBitmapJobPriority::Visible);
+		ScheduleLogged(Log, TEXT("Interactive"), EBitmapJobPriority::Interactive);
+		ScheduleLogged(Log, TEXT("Visible2"), EBitmapJobPriority::Visible);
+		ScheduleLogged(Log, TEXT("Prefetch2"), EBitmapJobPriority::Prefetch);
+		ScheduleLogged(Log, TEXT("Background2"), EBitmapJobPriority::Background);
+
+		FPlatformProcess::Sleep(0.02f);
+		Test.TestEqual(TEXT("Nothing starts while the only slot is taken by a job that doesn't yield"), Log->Num(), 0);
+
+		Log->Released.Increment();
+		if (!WaitFor([&Log]() { return Log->Num() == 7; }))
+		{
+			Test.AddError(TEXT("Queued jobs don't start once the slot is free."));
+			return;
+		}
+		const FString Order = Log->Join();
+		if (Order != TEXT("Interactive Visible1 Visible2 Prefetch1 Prefetch2 Background1 Background2"))
+		{
+			Test.AddError(FString::Printf(TEXT("Queued jobs started in the order %s."), *Order));
+		}
+	}
+
+	/* A job holding the only slot runs the more urgent jobs queued behind it on its own thread when it yields, but not those of its own
+	priority.
+	*/
+	void CheckPreemption(FAutomationTestBase& Test)
+	{
+		FJobLogRef Log = MakeShared<FJobLog, ESPMode::ThreadSafe>();
+		ScheduleBlocker(Log, EBitmapJobPriority::Prefetch, true);
+		if (!WaitFor([&Log]() { return Log->NumBlockersStarted.GetValue() > 0; }))
+		{
+			Test.AddError(TEXT("A job doesn't start while a slot is free."));
+			Log->Released.Increment();
+			return;
+		}
+
+		ScheduleLogged(Log, TEXT("Prefetch"), EBitmapJobPriority::Prefetch);
+		ScheduleLogged(Log, TEXT("Interactive"), EBitmapJobPriority::Interactive);
+		if (!WaitFor([&Log]() { return Log->Num() > 0; }))
+		{
+			Test.AddError(TEXT("A job that yields doesn't run the more urgent job queued behind it."));
+			Log->Released.Increment();
+			return;
+		}
+
+		FPlatformProcess::Sleep(0.02f);
+		Test.TestEqual(TEXT("A job that yields only runs the jobs more urgent than it"), Log->Join(), FString(TEXT("Interactive")));
+
+		Log->Released.Increment();
+		if (!WaitFor([&Log]() { return Log->Num() == 2; }))
+		{
+			Test.AddError(TEXT("A job of the same priority doesn't start once the slot is free."));
+		}
+	}
+
+	/* A running decode holding the memory an urgent decode waits for takes on its priority, and stops giving its thread to jobs less urgent
+	than the one waiting on it.
+	*/
+	void CheckPriorityInheritance(FAutomationTestBase& Test, int64 BudgetBytes)
+	{
+		const int64 Megabyte = 1024 * 1024;
+		FJobLogRef Log = MakeShared<FJobLog, ESPMode::ThreadSafe>();
+		FContextRef Holder = ScheduleBlocker(Log, EBitmapJobPriority::Background, true, BudgetBytes - Megabyte);
+		if (!WaitFor([&Log]() { return Log->NumBlockersStarted.GetValue() > 0; }))
+		{
+			Test.AddError(TEXT("A decode doesn't start while its memory and a slot are free."));
+			Log->Released.Increment();
+			return;
+		}
+		Test.TestEqual(TEXT("A decode nothing waits on runs at its own priority"), (int32)Holder->GetEffectivePriority(), (int32)EBitmapJobPriority::Background);
+
+		ScheduleLogged(Log, TEXT("Interactive"), EBitmapJobPriority::Interactive, 2 * Megabyte);
+		Test.TestEqual(TEXT("A decode holding the memory an interactive one waits for runs at interactive priority"), (int32)Holder->GetEffectivePriority(),
+			(int32)EBitmapJobPriority::Interactive);
+		Test.TestEqual(TEXT("Inheriting a priority leaves the job's own alone"), (int32)Holder->GetPriority(), (int32)EBitmapJobPriority::Background);
+
+		ScheduleLogged(Log, TEXT("Visible"), EBitmapJobPriority::Visible);
+		FPlatformProcess::Sleep(0.05f);
+		Test.TestEqual(TEXT("A decode another waits on doesn't give its thread to less urgent jobs"), Log->Num(), 0);
+
+		Log->Released.Increment();
+		if (!WaitFor([&Log]() { return Log->Num() == 2; }))
+		{
+			Test.AddError(TEXT("Queued jobs don't start once the decode holding the memory is done."));
+			return;
+		}
+		Test.TestEqual(TEXT("The held back decode starts first once it fits"), Log->Join(), FString(TEXT("Interactive Visible")));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapJobSchedulerTest, "ImageIOLibrary.JobScheduler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapJobSchedulerTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapJobSchedulerTests;
+
+	IConsoleVariable* MaxJobs = IConsoleManager::Get().FindConsoleVariable(TEXT("ImageIO.MaxJobs"));
+	if (!MaxJobs)
+	{
+		AddError(TEXT("ImageIO.MaxJobs isn't registered."));
+		return true;
+	}
+
+	const FDecodeMemoryStats Stats = FBitmapDecodeBudget::GetStats();
+	if (Stats.Decodes > 0 || Stats.WaitingDecodes > 0 || FBitmapJobScheduler::Get().HasQueuedAbove(EBitmapJobPriority::Background))
+	{
+		AddWarning(TEXT("Bitmap jobs are running, the scheduler can't be checked."));
+		return true;
+	}
+
+	// A single slot, so the order jobs start in is the order they're taken out of the queues
+	const int32 PreviousMaxJobs = MaxJobs->GetInt();
+	MaxJobs->Set(1, ECVF_SetByConsole);
+
+	CheckPopOrder(*this);
+	CheckPreemption(*this);
+	if (Stats.BudgetMegabytes >= 4.0f)
+	{
+		CheckPriorityInheritance(*this, (int64)Stats.BudgetMegabytes * 1024 * 1024);
+	}
+
+	MaxJobs->Set(PreviousMaxJobs, ECVF_SetByConsole);
+	return true;
+}
+
+#endif
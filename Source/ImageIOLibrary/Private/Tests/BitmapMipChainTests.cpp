@@ -0,0 +1,160 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapMipChain.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapMipChainTests
+{
+	double DecodeSRGB(double Value)
+	{
+		return Value <= 0.04045 ? Value / 12.92 : FMath::Pow((Value + 0.055) / 1.055, 2.4);
+	}
+
+	double EncodeSRGB(double Linear)
+	{
+		return Linear <= 0.0031308 ? Linear * 12.92 : 1.055 * FMath::Pow(Linear, 1.0 / 2.4) - 0.055;
+	}
+
+	/* The levels FBitmapMipChain::Generate documents, in double precision: each one averages the 2x2 pixels of the one above it (3 along an
+	odd edge), the colours in linear light when bSRGB.
+	*/
+	TArray<TArray<FColor>> ReferenceMipChain(const TArray<FColor>& Bitmap, FImageSize Size, bool bSRGB)
+	{
+		const int32 NumChannels = 4;
+		TArray<double> Level;
+		Level.SetNumUninitialized(Bitmap.Num() * NumChannels);
+		for (int32 Index = 0; Index < Bitmap.Num(); Index++)
+		{
+			const uint8* Bytes = (const uint8*)&Bitmap[Index];
+			for (int32 Channel = 0; Channel < NumChannels; Channel++)
+			{
+				const double Value = Bytes[Channel] / 255.0;
+				Level[Index * NumChannels + Channel] = bSRGB && Channel < 3 ? DecodeSRGB(Value) : Value;
+			}
+		}
+
+		// Source pixels averaged into output pixel Out along an axis
+		auto GetFootprint = [](int32 Out, int32 OutLength, int32 InLength, int32& OutFirst, int32& OutCount)
+		{
+			OutFirst = FMath::Min(Out * 2, InLength - 1);
+			OutCount = InLength == 1 ? 1 : (Out == OutLength - 1 && (InLength & 1) ? 3 : 2);
+		};
+
+		TArray<TArray<FColor>> Mips;
+		FImageSize InSize = Size;
+		for (int32 MipIndex = 1; MipIndex < FBitmapMipChain::GetNumMips(Size); MipIndex++)
+		{
+			const FImageSize OutSize = FBitmapMipChain::GetMipSize(Size, MipIndex);
+			TArray<double> Next;
+			Next.SetNumZeroed(OutSize.X * OutSize.Y * NumChannels);
+			TArray<FColor>& Mip = Mips.AddDefaulted_GetRef();
+			Mip.SetNumUninitialized(OutSize.X * OutSize.Y);
+
+			for (int32 Y = 0; Y < OutSize.Y; Y++)
+			{
+				int32 FirstY, CountY;
+				GetFootprint(Y, OutSize.Y, InSize.Y, FirstY, CountY);
+				for (int32 X = 0; X < OutSize.X; X++)
+				{
+					int32 FirstX, CountX;
+					GetFootprint(X, OutSize.X, InSize.X, FirstX, CountX);
+
+					uint8* Bytes = (uint8*)&Mip[Y * OutSize.X + X];
+					for (int32 Channel = 0; Channel < NumChannels; Channel++)
+					{
+						double Sum = 0.0;
+						for (int32 SourceY = FirstY; SourceY < FirstY + CountY; SourceY++)
+						{
+							for (int32 SourceX = FirstX; SourceX < FirstX + CountX; SourceX++)
+							{
+								Sum += Level[(SourceY * InSize.X + SourceX) * NumChannels + Channel];
+							}
+						}
+
+						const double Average = Sum / (CountX * CountY);
+						Next[(Y * OutSize.X + X) * NumChannels + Channel] = Average;
+						Bytes[Channel] = BitmapTestUtils::QuantizeReference((bSRGB && Channel < 3 ? EncodeSRGB(Average) : Average) * 255.0);
+					}
+				}
+			}
+
+			Level = MoveTemp(Next);
+			InSize = OutSize;
+		}
+		return Mips;
+	}
+
+	/* Every level Generate builds from level 0, which is a rectangle of a bigger bitmap when Pitch is past Size.X. */
+	TArray<TArray<FColor>> GenerateMipChain(const TArray<FColor>& Bitmap, FImageSize Size, int32 Pitch, bool bSRGB)
+	{
+		TArray<FColor> Padded;
+		Padded.SetNumZeroed(Pitch * Size.Y);
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			FMemory::Memcpy(Padded.GetData() + Y * Pitch, Bitmap.GetData() + Y * Size.X, Size.X * sizeof(FColor));
+		}
+
+		TArray<TArray<FColor>> Mips;
+		TArray<FColor*> MipPixels;
+		for (int32 MipIndex = 1; MipIndex < FBitmapMipChain::GetNumMips(Size); MipIndex++)
+		{
+			const FImageSize MipSize = FBitmapMipChain::GetMipSize(Size, MipIndex);
+			Mips.AddDefaulted_GetRef().SetNumUninitialized(MipSize.X * MipSize.Y);
+		}
+		for (TArray<FColor>& Mip : Mips)
+		{
+			MipPixels.Add(Mip.GetData());
+		}
+
+		FBitmapMipChain::Generate(FConstBitmapView(Padded.GetData(), Size.X, Size.Y, Pitch), bSRGB, MipPixels);
+		return Mips;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapMipChainTest, "ImageIOLibrary.MipChain", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapMipChainTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapMipChainTests;
+
+	TestEqual(TEXT("A 1x1 bitmap has a single level"), FBitmapMipChain::GetNumMips(FImageSize(1, 1)), 1);
+	TestEqual(TEXT("A 300x3 bitmap has 9 levels"), FBitmapMipChain::GetNumMips(FImageSize(300, 3)), 9);
+	const FImageSize ThinMip = FBitmapMipChain::GetMipSize(FImageSize(300, 3), 4);
+	TestTrue(TEXT("Levels stop shrinking at 1 pixel"), ThinMip.X == 18 && ThinMip.Y == 1);
+
+	// Even sizes take the SIMD path, odd ones fold their last row or column, thin ones reach 1 pixel on one axis first
+	for (const FImageSize& Size : { FImageSize(64, 32), FImageSize(37, 21), FImageSize(1, 9), FImageSize(300, 3) })
+	{
+		const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, Size.X * 1000 + Size.Y);
+		for (bool bSRGB : { false, true })
+		{
+			const TArray<TArray<FColor>> Expected = ReferenceMipChain(Bitmap, Size, bSRGB);
+			const TArray<TArray<FColor>> Actual = GenerateMipChain(Bitmap, Size, Size.X, bSRGB);
+			for (int32 Level = 0; Level < Expected.Num(); Level++)
+			{
+				const int32 Error = BitmapTestUtils::MaxChannelError(Expected[Level], Actual[Level]);
+				if (Error > BitmapTestUtils::RoundingTolerance)
+				{
+					AddError(FString::Printf(TEXT("Level %d of a %dx%d bitmap (sRGB %d) is off by up to %d."), Level + 1, Size.X, Size.Y, (int32)bSRGB, Error));
+				}
+			}
+
+			const TArray<TArray<FColor>> FromView = GenerateMipChain(Bitmap, Size, Size.X + 13, bSRGB);
+			for (int32 Level = 0; Level < Actual.Num(); Level++)
+			{
+				if (BitmapTestUtils::MaxChannelError(Actual[Level], FromView[Level]) != 0)
+				{
+					AddError(FString::Printf(TEXT("Level %d of a %dx%d bitmap (sRGB %d) differs when level 0 is a rectangle of a bigger bitmap."), Level + 1, Size.X, Size.Y, (int32)bSRGB));
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,157 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapMorphology.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapMorphologyTests
+{
+	/* Minimum or maximum of each byte over the part of the rectangle inside the bitmap, row then column, one pixel at a time. */
+	TArray<FColor> ReferenceExtremum(const TArray<FColor>& Bitmap, FImageSize Size, int32 RadiusX, int32 RadiusY, bool bMaximum)
+	{
+		auto Extremum = [bMaximum](const FColor& A, const FColor& B)
+		{
+			const uint8* BytesA = (const uint8*)&A;
+			const uint8* BytesB = (const uint8*)&B;
+			FColor Result;
+			uint8* ResultBytes = (uint8*)&Result;
+			for (int32 Byte = 0; Byte < 4; Byte++)
+			{
+				ResultBytes[Byte] = bMaximum ? FMath::Max(BytesA[Byte], BytesB[Byte]) : FMath::Min(BytesA[Byte], BytesB[Byte]);
+			}
+			return Result;
+		};
+
+		TArray<FColor> Rows;
+		Rows.SetNumUninitialized(Bitmap.Num());
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				FColor Value = Bitmap[Y * Size.X + X];
+				for (int32 WindowX = FMath::Max(X - RadiusX, 0); WindowX <= FMath::Min(X + RadiusX, Size.X - 1); WindowX++)
+				{
+					Value = Extremum(Value, Bitmap[Y * Size.X + WindowX]);
+				}
+				Rows[Y * Size.X + X] = Value;
+			}
+		}
+
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				FColor Value = Rows[Y * Size.X + X];
+				for (int32 WindowY = FMath::Max(Y - RadiusY, 0); WindowY <= FMath::Min(Y + RadiusY, Size.Y - 1); WindowY++)
+				{
+					Value = Extremum(Value, Rows[WindowY * Size.X + X]);
+				}
+				Result[Y * Size.X + X] = Value;
+			}
+		}
+		return Result;
+	}
+
+	TArray<FColor> ReferenceMorphology(const TArray<FColor>& Bitmap, FImageSize Size, EBitmapMorphologyOperation Operation, int32 RadiusX, int32 RadiusY, EFilterColourChannel ColourChannel)
+	{
+		TArray<FColor> Result;
+		switch (Operation)
+		{
+		case EBitmapMorphologyOperation::Erode:
+			Result = ReferenceExtremum(Bitmap, Size, RadiusX, RadiusY, false);
+			break;
+
+		case EBitmapMorphologyOperation::Dilate:
+			Result = ReferenceExtremum(Bitmap, Size, RadiusX, RadiusY, true);
+			break;
+
+		case EBitmapMorphologyOperation::Open:
+			Result = ReferenceExtremum(ReferenceExtremum(Bitmap, Size, RadiusX, RadiusY, false), Size, RadiusX, RadiusY, true);
+			break;
+
+		case EBitmapMorphologyOperation::Close:
+			Result = ReferenceExtremum(ReferenceExtremum(Bitmap, Size, RadiusX, RadiusY, true), Size, RadiusX, RadiusY, false);
+			break;
+
+		default:
+		{
+			Result = ReferenceExtremum(Bitmap, Size, RadiusX, RadiusY, true);
+			const TArray<FColor> Eroded = ReferenceExtremum(Bitmap, Size, RadiusX, RadiusY, false);
+			for (int32 Index = 0; Index < Result.Num(); Index++)
+			{
+				const FColor& Dilated = Result[Index];
+				Result[Index] = FColor((uint8)(Dilated.R - Eroded[Index].R), (uint8)(Dilated.G - Eroded[Index].G), (uint8)(Dilated.B - Eroded[Index].B), (uint8)(Dilated.A - Eroded[Index].A));
+			}
+			break;
+		}
+		}
+
+		for (FColor& Pixel : Result)
+		{
+			Pixel = BitmapChannels::FinishFilteredPixel(Pixel, ColourChannel);
+		}
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapMorphologyTest, "ImageIOLibrary.Morphology", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapMorphologyTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapMorphologyTests;
+
+	auto Check = [this](FImageSize Size, EBitmapMorphologyOperation Operation, int32 RadiusX, int32 RadiusY, EFilterColourChannel ColourChannel)
+	{
+		const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, Size.X * 1000 + Size.Y);
+
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+		FBitmapMorphology::Apply(FConstBitmapView(Bitmap.GetData(), Size), Operation, RadiusX, RadiusY, ColourChannel, FBitmapView(Result.GetData(), Size));
+
+		const int32 Error = BitmapTestUtils::MaxChannelError(ReferenceMorphology(Bitmap, Size, Operation, RadiusX, RadiusY, ColourChannel), Result);
+		if (Error > 0)
+		{
+			AddError(FString::Printf(TEXT("%dx%d bitmap, operation %d, radius %dx%d, colour channel %d is off by up to %d."), Size.X, Size.Y, (int32)Operation, RadiusX, RadiusY, (int32)ColourChannel, Error));
+		}
+	};
+
+	// Sizes around the 16 byte blocks and the transpose tiles, radii from nothing to past the bitmap
+	for (const FImageSize& Size : { FImageSize(1, 1), FImageSize(5, 4), FImageSize(17, 33), FImageSize(300, 33) })
+	{
+		for (int32 Operation = (int32)EBitmapMorphologyOperation::Erode; Operation <= (int32)EBitmapMorphologyOperation::Gradient; Operation++)
+		{
+			for (int32 RadiusX : { 0, 1, 2, 7 })
+			{
+				for (int32 RadiusY : { 0, 1, 3, 40 })
+				{
+					Check(Size, (EBitmapMorphologyOperation)Operation, RadiusX, RadiusY, EFilterColourChannel::RGBA);
+				}
+			}
+		}
+	}
+
+	// Single channels go through byte planes, the others through whole pixels
+	for (int32 ColourChannel = (int32)EFilterColourChannel::RGB; ColourChannel <= (int32)EFilterColourChannel::Greyscale; ColourChannel++)
+	{
+		for (int32 Operation = (int32)EBitmapMorphologyOperation::Erode; Operation <= (int32)EBitmapMorphologyOperation::Gradient; Operation++)
+		{
+			Check(FImageSize(70, 45), (EBitmapMorphologyOperation)Operation, 3, 2, (EFilterColourChannel)ColourChannel);
+		}
+	}
+
+	// Dst may be Src
+	const FImageSize Size(50, 40);
+	TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, 97);
+	const TArray<FColor> Expected = ReferenceMorphology(Bitmap, Size, EBitmapMorphologyOperation::Close, 3, 2, EFilterColourChannel::RGBA);
+	FBitmapMorphology::Apply(FConstBitmapView(Bitmap.GetData(), Size), EBitmapMorphologyOperation::Close, 3, 2, EFilterColourChannel::RGBA, FBitmapView(Bitmap.GetData(), Size));
+	TestTrue(TEXT("Filtering in place matches the reference"), BitmapTestUtils::MaxChannelError(Expected, Bitmap) == 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,157 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapOrientation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapOrientationTests
+{
+	/* Each operation as its enum documents it, one pixel at a time: the source pixel that lands at (X, Y) of the result. */
+	TArray<FColor> ReferenceReorient(const TArray<FColor>& Bitmap, FImageSize Size, EBitmapOrientation Orientation, FImageSize& OutSize)
+	{
+		const int32 Width = Size.X;
+		const int32 Height = Size.Y;
+		const bool bSwapsAxes = Orientation == EBitmapOrientation::Rotate90 || Orientation == EBitmapOrientation::Rotate270
+			|| Orientation == EBitmapOrientation::Transpose || Orientation == EBitmapOrientation::Transverse;
+		OutSize = bSwapsAxes ? FImageSize(Height, Width) : Size;
+
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+		for (int32 Y = 0; Y < OutSize.Y; Y++)
+		{
+			for (int32 X = 0; X < OutSize.X; X++)
+			{
+				FIntPoint Source;
+				switch (Orientation)
+				{
+				case EBitmapOrientation::Rotate90:			Source = FIntPoint(Y, Height - 1 - X); break;
+				case EBitmapOrientation::Rotate180:			Source = FIntPoint(Width - 1 - X, Height - 1 - Y); break;
+				case EBitmapOrientation::Rotate270:			Source = FIntPoint(Width - 1 - Y, X); break;
+				case EBitmapOrientation::FlipHorizontal:	Source = FIntPoint(Width - 1 - X, Y); break;
+				case EBitmapOrientation::FlipVertical:		Source = FIntPoint(X, Height - 1 - Y); break;
+				case EBitmapOrientation::Transpose:			Source = FIntPoint(Y, X); break;
+				default:									Source = FIntPoint(Width - 1 - Y, Height - 1 - X); break;
+				}
+				Result[Y * OutSize.X + X] = Bitmap[Source.Y * Width + Source.X];
+			}
+		}
+		return Result;
+	}
+
+	/* How a camera stores an upright picture under each EXIF orientation tag, from the tag's definition: which side of the picture the
+	stored first row and first column are. Tags 5 to 8 store the rows along the picture's columns, so the stored size is swapped.
+	*/
+	TArray<FColor> MakeExifStored(const TArray<FColor>& Upright, FImageSize Size, int32 Tag, FImageSize& OutSize)
+	{
+		enum ESide { Top, Bottom, Left, Right };
+		static const ESide FirstRow[9] = { Top, Top, Top, Bottom, Bottom, Left, Right, Right, Left };
+		static const ESide FirstColumn[9] = { Left, Left, Right, Right, Left, Top, Top, Bottom, Bottom };
+
+		const bool bRowsAreColumns = FirstRow[Tag] == Left || FirstRow[Tag] == Right;
+		OutSize = bRowsAreColumns ? FImageSize(Size.Y, Size.X) : Size;
+
+		TArray<FColor> Stored;
+		Stored.SetNumUninitialized(Upright.Num());
+		for (int32 Row = 0; Row < OutSize.Y; Row++)
+		{
+			for (int32 Column = 0; Column < OutSize.X; Column++)
+			{
+				int32 X;
+				int32 Y;
+				if (bRowsAreColumns)
+				{
+					X = FirstRow[Tag] == Left ? Row : Size.X - 1 - Row;
+					Y = FirstColumn[Tag] == Top ? Column : Size.Y - 1 - Column;
+				}
+				else
+				{
+					X = FirstColumn[Tag] == Left ? Column : Size.X - 1 - Column;
+					Y = FirstRow[Tag] == Top ? Row : Size.Y - 1 - Row;
+				}
+				Stored[Row * OutSize.X + Column] = Upright[Y * Size.X + X];
+			}
+		}
+		return Stored;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapOrientationTest, "ImageIOLibrary.Orientation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapOrientationTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapOrientationTests;
+
+	// Sizes around the 4x4 blocks and the 32x32 tiles. The squares also go through the in place transposes.
+	for (const FImageSize& Size : { FImageSize(1, 1), FImageSize(5, 3), FImageSize(37, 70), FImageSize(33, 33), FImageSize(64, 64) })
+	{
+		const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, Size.X * 1000 + Size.Y);
+		for (int32 Orientation = (int32)EBitmapOrientation::Rotate90; Orientation <= (int32)EBitmapOrientation::Transverse; Orientation++)
+		{
+			FImageSize ExpectedSize;
+			const TArray<FColor> Expected = ReferenceReorient(Bitmap, Size, (EBitmapOrientation)Orientation, ExpectedSize);
+
+			const FImageSize OrientedSize = FBitmapOrientation::GetOrientedSize(Size, (EBitmapOrientation)Orientation);
+			if (OrientedSize.X != ExpectedSize.X || OrientedSize.Y != ExpectedSize.Y)
+			{
+				AddError(FString::Printf(TEXT("Operation %d gives a %dx%d bitmap a size of %dx%d."), Orientation, Size.X, Size.Y, OrientedSize.X, OrientedSize.Y));
+				continue;
+			}
+
+			TArray<FColor> Result;
+			Result.SetNumUninitialized(Bitmap.Num());
+			FBitmapOrientation::Reorient(FConstBitmapView(Bitmap.GetData(), Size), (EBitmapOrientation)Orientation, FBitmapView(Result.GetData(), OrientedSize));
+			if (BitmapTestUtils::MaxChannelError(Expected, Result) != 0)
+			{
+				AddError(FString::Printf(TEXT("Operation %d on a %dx%d bitmap doesn't move the pixels where it should."), Orientation, Size.X, Size.Y));
+			}
+
+			// Quarter turns of rectangles can't be done in place and have to leave the pixels alone
+			TArray<FColor> InPlace = Bitmap;
+			const bool bInPlace = FBitmapOrientation::ReorientInPlace(FBitmapView(InPlace.GetData(), Size), (EBitmapOrientation)Orientation);
+			if (bInPlace != (Size.X == Size.Y || !FBitmapOrientation::SwapsAxes((EBitmapOrientation)Orientation)))
+			{
+				AddError(FString::Printf(TEXT("Operation %d on a %dx%d bitmap is wrongly reported as %s in place."), Orientation, Size.X, Size.Y, bInPlace ? TEXT("done") : TEXT("not done")));
+			}
+			else if (BitmapTestUtils::MaxChannelError(bInPlace ? Expected : Bitmap, InPlace) != 0)
+			{
+				AddError(FString::Printf(TEXT("Operation %d on a %dx%d bitmap in place doesn't leave the pixels where it should."), Orientation, Size.X, Size.Y));
+			}
+		}
+	}
+
+	// Every EXIF tag puts the stored pixels back upright
+	const FImageSize UprightSize(13, 7);
+	const TArray<FColor> Upright = BitmapTestUtils::MakeRandomBitmap(UprightSize, 88);
+	for (int32 Tag = 1; Tag <= 8; Tag++)
+	{
+		FImageSize StoredSize;
+		const TArray<FColor> Stored = MakeExifStored(Upright, UprightSize, Tag, StoredSize);
+
+		EBitmapOrientation Orientation;
+		if (!FBitmapOrientation::FromExifOrientation(Tag, Orientation))
+		{
+			TestTrue(TEXT("Only EXIF orientation 1 needs no operation"), Tag == 1 && BitmapTestUtils::MaxChannelError(Upright, Stored) == 0);
+			continue;
+		}
+
+		const FImageSize OrientedSize = FBitmapOrientation::GetOrientedSize(StoredSize, Orientation);
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Stored.Num());
+		FBitmapOrientation::Reorient(FConstBitmapView(Stored.GetData(), StoredSize), Orientation, FBitmapView(Result.GetData(), OrientedSize));
+		if (OrientedSize.X != UprightSize.X || OrientedSize.Y != UprightSize.Y || BitmapTestUtils::MaxChannelError(Upright, Result) != 0)
+		{
+			AddError(FString::Printf(TEXT("EXIF orientation %d doesn't put the picture upright."), Tag));
+		}
+	}
+
+	EBitmapOrientation Unused;
+	TestFalse(TEXT("EXIF orientation 0 is out of range"), FBitmapOrientation::FromExifOrientation(0, Unused));
+	TestFalse(TEXT("EXIF orientation 9 is out of range"), FBitmapOrientation::FromExifOrientation(9, Unused));
+
+	return true;
+}
+
+#endif
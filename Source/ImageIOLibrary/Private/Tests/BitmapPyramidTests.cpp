@@ -0,0 +1,226 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapPyramid.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapPyramidTests
+{
+	const int32 NumChannels = 4;
+
+	/* Mirrors an index past either edge back inside without repeating the edge pixel, staying on the bitmap when it's too small to mirror. */
+	int32 ReferenceReflect(int32 Index, int32 Length)
+	{
+		if (Index < 0)
+		{
+			Index = -Index;
+		}
+		if (Index >= Length)
+		{
+			Index = 2 * (Length - 1) - Index;
+		}
+		return FMath::Clamp(Index, 0, Length - 1);
+	}
+
+	/* [1 4 6 4 1] / 16 */
+	double KernelWeight(int32 Offset)
+	{
+		static const double Weights[5] = { 1.0 / 16.0, 4.0 / 16.0, 6.0 / 16.0, 4.0 / 16.0, 1.0 / 16.0 };
+		return Offset >= -2 && Offset <= 2 ? Weights[Offset + 2] : 0.0;
+	}
+
+	/* Channels of a level in double precision, in the memory order of FColor (B, G, R, A). */
+	struct FReferenceLevel
+	{
+		FImageSize Size;
+		TArray<double> Values;
+	};
+
+	/* The Gaussian pyramid as FBitmapPyramid documents it: every level filters the one above it with the 5 tap kernel and keeps every
+	other pixel of every other row.
+	*/
+	TArray<FReferenceLevel> ReferenceGaussian(const TArray<FColor>& Bitmap, FImageSize Size, int32 NumLevels)
+	{
+		TArray<FReferenceLevel> Levels;
+		FReferenceLevel& Base = Levels.AddDefaulted_GetRef();
+		Base.Size = Size;
+		for (const FColor& Pixel : Bitmap)
+		{
+			Base.Values.Append({ Pixel.B / 255.0, Pixel.G / 255.0, Pixel.R / 255.0, Pixel.A / 255.0 });
+		}
+
+		for (int32 Level = 1; Level < NumLevels; Level++)
+		{
+			const FReferenceLevel& In = Levels[Level - 1];
+			FReferenceLevel Out;
+			Out.Size = FImageSize((In.Size.X + 1) / 2, (In.Size.Y + 1) / 2);
+			Out.Values.SetNumZeroed(Out.Size.X * Out.Size.Y * NumChannels);
+			for (int32 Y = 0; Y < Out.Size.Y; Y++)
+			{
+				for (int32 X = 0; X < Out.Size.X; X++)
+				{
+					for (int32 TapY = -2; TapY <= 2; TapY++)
+					{
+						for (int32 TapX = -2; TapX <= 2; TapX++)
+						{
+							const int32 SourceX = ReferenceReflect(X * 2 + TapX, In.Size.X);
+							const int32 SourceY = ReferenceReflect(Y * 2 + TapY, In.Size.Y);
+							const double Weight = KernelWeight(TapX) * KernelWeight(TapY);
+							for (int32 Channel = 0; Channel < NumChannels; Channel++)
+							{
+								Out.Values[(Y * Out.Size.X + X) * NumChannels + Channel] += In.Values[(SourceY * In.Size.X + SourceX) * NumChannels + Channel] * Weight;
+							}
+						}
+					}
+				}
+			}
+			Levels.Add(MoveTemp(Out));
+		}
+		return Levels;
+	}
+
+	/* Small upsampled to BigSize: each big pixel gathers the small pixels the kernel, stretched twice as wide, reaches from it. The weights
+	are doubled on each axis, as only every other tap lands on a small pixel.
+	*/
+	TArray<double> ReferenceExpand(const FReferenceLevel& Small, FImageSize BigSize)
+	{
+		TArray<double> Big;
+		Big.SetNumZeroed(BigSize.X * BigSize.Y * NumChannels);
+		for (int32 Y = 0; Y < BigSize.Y; Y++)
+		{
+			for (int32 X = 0; X < BigSize.X; X++)
+			{
+				for (int32 SmallY = Y / 2 - 1; SmallY <= Y / 2 + 1; SmallY++)
+				{
+					for (int32 SmallX = X / 2 - 1; SmallX <= X / 2 + 1; SmallX++)
+					{
+						const double Weight = 4.0 * KernelWeight(X - SmallX * 2) * KernelWeight(Y - SmallY * 2);
+						const int32 Index = ReferenceReflect(SmallY, Small.Size.Y) * Small.Size.X + ReferenceReflect(SmallX, Small.Size.X);
+						for (int32 Channel = 0; Channel < NumChannels; Channel++)
+						{
+							Big[(Y * BigSize.X + X) * NumChannels + Channel] += Small.Values[Index * NumChannels + Channel] * Weight;
+						}
+					}
+				}
+			}
+		}
+		return Big;
+	}
+
+	/* Biggest difference between a level of Pyramid and Expected. */
+	double MaxLevelError(const FBitmapPyramid& Pyramid, int32 Level, const TArray<double>& Expected)
+	{
+		const FImageSize Size = Pyramid.GetLevelSize(Level);
+		const VectorRegister* Values = Pyramid.GetLevel(Level);
+		double MaxError = 0.0;
+		for (int32 Index = 0; Index < Size.X * Size.Y; Index++)
+		{
+			float Channels[4];
+			VectorStore(Values[Index], Channels);
+			for (int32 Channel = 0; Channel < NumChannels; Channel++)
+			{
+				MaxError = FMath::Max(MaxError, FMath::Abs(Channels[Channel] - Expected[Index * NumChannels + Channel]));
+			}
+		}
+		return MaxError;
+	}
+
+	TArray<FColor> GetPixels(const FBitmapPyramid& Pyramid, int32 Level)
+	{
+		const FImageSize Size = Pyramid.GetLevelSize(Level);
+		TArray<FColor> Pixels;
+		Pixels.SetNumUninitialized(Size.X * Size.Y);
+		Pyramid.GetPixels(Level, FBitmapView(Pixels.GetData(), Size));
+		return Pixels;
+	}
+
+	TArray<FColor> Blend(const TArray<FColor>& A, const TArray<FColor>& B, const TArray<FColor>& Mask, FImageSize Size)
+	{
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Size.X * Size.Y);
+		FBitmapPyramid::BlendMultiband(FConstBitmapView(A.GetData(), Size), FConstBitmapView(B.GetData(), Size), FConstBitmapView(Mask.GetData(), Size), 0, FBitmapView(Result.GetData(), Size));
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapPyramidTest, "ImageIOLibrary.Pyramid", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapPyramidTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapPyramidTests;
+
+	TestEqual(TEXT("A 1x1 bitmap has a single level"), FBitmapPyramid::GetMaxLevels(FImageSize(1, 1)), 1);
+	TestEqual(TEXT("A 300x3 bitmap has 10 levels"), FBitmapPyramid::GetMaxLevels(FImageSize(300, 3)), 10);
+	const FImageSize ThinLevel = FBitmapPyramid::GetLevelSize(FImageSize(300, 3), 4);
+	TestTrue(TEXT("Levels halve rounding up and stop shrinking at 1 pixel"), ThinLevel.X == 19 && ThinLevel.Y == 1);
+
+	// Odd sizes leave a last pixel with no partner below, thin ones run out of pixels to mirror on one axis first
+	const double FloatTolerance = 1e-5;
+	for (const FImageSize& Size : { FImageSize(64, 64), FImageSize(37, 21), FImageSize(1, 9), FImageSize(300, 3) })
+	{
+		const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, Size.X * 1000 + Size.Y);
+		const TArray<FReferenceLevel> Gaussian = ReferenceGaussian(Bitmap, Size, FBitmapPyramid::GetMaxLevels(Size));
+
+		FBitmapPyramid Pyramid;
+		Pyramid.BuildGaussian(FConstBitmapView(Bitmap.GetData(), Size), 0);
+		TestEqual(TEXT("A pyramid of all levels goes down to 1x1"), Pyramid.GetNumLevels(), Gaussian.Num());
+		for (int32 Level = 0; Level < Gaussian.Num() && Level < Pyramid.GetNumLevels(); Level++)
+		{
+			if (MaxLevelError(Pyramid, Level, Gaussian[Level].Values) > FloatTolerance)
+			{
+				AddError(FString::Printf(TEXT("Gaussian level %d of a %dx%d bitmap doesn't match the 5 tap reduction."), Level, Size.X, Size.Y));
+			}
+		}
+
+		// Every Laplacian level but the last holds what the level below it misses, the last one stays Gaussian
+		Pyramid.ToLaplacian();
+		for (int32 Level = 0; Level < Gaussian.Num() && Level < Pyramid.GetNumLevels(); Level++)
+		{
+			TArray<double> Expected = Gaussian[Level].Values;
+			if (Level + 1 < Gaussian.Num())
+			{
+				const TArray<double> Expanded = ReferenceExpand(Gaussian[Level + 1], Gaussian[Level].Size);
+				for (int32 Index = 0; Index < Expected.Num(); Index++)
+				{
+					Expected[Index] -= Expanded[Index];
+				}
+			}
+			if (MaxLevelError(Pyramid, Level, Expected) > FloatTolerance)
+			{
+				AddError(FString::Printf(TEXT("Laplacian level %d of a %dx%d bitmap doesn't match the level minus the expanded one below it."), Level, Size.X, Size.Y));
+			}
+		}
+
+		// Collapsing adds back exactly what was taken away, so the bitmap comes back to the bit
+		Pyramid.Collapse();
+		if (BitmapTestUtils::MaxChannelError(Bitmap, GetPixels(Pyramid, 0)) != 0)
+		{
+			AddError(FString::Printf(TEXT("Collapsing the Laplacian pyramid of a %dx%d bitmap doesn't give the bitmap back."), Size.X, Size.Y));
+		}
+
+		FBitmapPyramid Partial;
+		Partial.BuildLaplacian(FConstBitmapView(Bitmap.GetData(), Size), 2);
+		Partial.Collapse();
+		TestTrue(TEXT("A Laplacian pyramid of a few levels collapses back to the bitmap"), BitmapTestUtils::MaxChannelError(Bitmap, GetPixels(Partial, 0)) == 0);
+	}
+
+	// A mask that is all A or all B gives back that bitmap, and blending a bitmap with itself changes nothing whatever the mask
+	const FImageSize Size(96, 70);
+	const TArray<FColor> A = BitmapTestUtils::MakeRandomBitmap(Size, 41);
+	const TArray<FColor> B = BitmapTestUtils::MakeRandomBitmap(Size, 42);
+	const TArray<FColor> RandomMask = BitmapTestUtils::MakeRandomBitmap(Size, 43);
+	TArray<FColor> AllA;
+	TArray<FColor> AllB;
+	AllA.Init(FColor(255, 0, 0, 0), Size.X * Size.Y);
+	AllB.Init(FColor(0, 255, 255, 255), Size.X * Size.Y);
+	TestTrue(TEXT("A mask of 255 keeps A"), BitmapTestUtils::MaxChannelError(A, Blend(A, B, AllA, Size)) <= BitmapTestUtils::RoundingTolerance);
+	TestTrue(TEXT("A mask of 0 keeps B"), BitmapTestUtils::MaxChannelError(B, Blend(A, B, AllB, Size)) <= BitmapTestUtils::RoundingTolerance);
+	TestTrue(TEXT("Blending a bitmap with itself gives it back"), BitmapTestUtils::MaxChannelError(A, Blend(A, A, RandomMask, Size)) <= BitmapTestUtils::RoundingTolerance);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,101 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapRankFilter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapRankFilterTests
+{
+	/* FBitmapRankFilter::Filter the slow way: counts the values of each channel in the clamped window around each pixel and walks the counts up to the rank. */
+	TArray<FColor> ReferenceRankFilter(const TArray<FColor>& Bitmap, FImageSize Size, int32 Radius, float Percentile, EFilterColourChannel ColourChannel)
+	{
+		const int32 Rank = FBitmapRankFilter::GetRank(Radius, Percentile);
+
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				int32 Counts[4][256] = {};
+				for (int32 WindowY = Y - Radius; WindowY <= Y + Radius; WindowY++)
+				{
+					for (int32 WindowX = X - Radius; WindowX <= X + Radius; WindowX++)
+					{
+						const FColor Sample = Bitmap[FMath::Clamp(WindowY, 0, Size.Y - 1) * Size.X + FMath::Clamp(WindowX, 0, Size.X - 1)];
+						Counts[0][Sample.R]++;
+						Counts[1][Sample.G]++;
+						Counts[2][Sample.B]++;
+						Counts[3][Sample.A]++;
+					}
+				}
+
+				uint8 Values[4];
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					int32 Value = 0;
+					for (int32 Below = Counts[Channel][0]; Below <= Rank; Below += Counts[Channel][Value])
+					{
+						Value++;
+					}
+					Values[Channel] = (uint8)Value;
+				}
+				Result[Y * Size.X + X] = BitmapChannels::FinishFilteredPixel(FColor(Values[0], Values[1], Values[2], Values[3]), ColourChannel);
+			}
+		}
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapRankFilterTest, "ImageIOLibrary.RankFilter", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapRankFilterTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapRankFilterTests;
+
+	auto Check = [this](FImageSize Size, int32 Radius, float Percentile, EFilterColourChannel ColourChannel)
+	{
+		const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, Size.X * 1000 + Size.Y);
+
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+		FBitmapRankFilter::Filter(FConstBitmapView(Bitmap.GetData(), Size), Radius, Percentile, ColourChannel, FBitmapView(Result.GetData(), Size));
+
+		// Both sides pick a sample, there is no rounding to allow for
+		const int32 Error = BitmapTestUtils::MaxChannelError(ReferenceRankFilter(Bitmap, Size, Radius, Percentile, ColourChannel), Result);
+		if (Error > 0)
+		{
+			AddError(FString::Printf(TEXT("%dx%d bitmap, radius %d, percentile %.0f, colour channel %d is off by up to %d."), Size.X, Size.Y, Radius, Percentile, (int32)ColourChannel, Error));
+		}
+	};
+
+	// Radius 1 is the sorting network, the others the histograms. Narrow bitmaps have strips narrower than the window.
+	for (int32 Width : { 1, 5, 70, 131 })
+	{
+		for (int32 Height : { 1, 3, 66 })
+		{
+			for (int32 Radius : { 1, 2, 7, FBitmapRankFilter::MaxRadius })
+			{
+				for (float Percentile : { 0.0f, 50.0f, 83.0f, 100.0f })
+				{
+					Check(FImageSize(Width, Height), Radius, Percentile, EFilterColourChannel::RGBA);
+				}
+			}
+		}
+	}
+
+	for (int32 ColourChannel = (int32)EFilterColourChannel::RGB; ColourChannel <= (int32)EFilterColourChannel::Greyscale; ColourChannel++)
+	{
+		for (int32 Radius : { 1, 3 })
+		{
+			Check(FImageSize(70, 66), Radius, 50.0f, (EFilterColourChannel)ColourChannel);
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,42 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapRegion.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapRegionPasteOverlapTest, "ImageIOLibrary.Region.PasteOntoItself", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapRegionPasteOverlapTest::RunTest(const FString& Parameters)
+{
+	// Big enough for the copy to be split across threads, moved by less than its size in every direction so source and destination overlap
+	const FImageSize Size(700, 300);
+	const FImageRect Rect(100, 50, 500, 200);
+	for (int32 OffsetY : { -7, 0, 7 })
+	{
+		for (int32 OffsetX : { -5, 0, 5 })
+		{
+			TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, 31);
+
+			// What pasting a separate copy of the rectangle gives
+			TArray<FColor> Expected = Bitmap;
+			TArray<FColor> Cropped;
+			Cropped.SetNumUninitialized(Rect.Width * Rect.Height);
+			FBitmapRegion::Copy(FConstBitmapView(Bitmap.GetData(), Size).GetSubView(Rect), FBitmapView(Cropped.GetData(), FImageSize(Rect.Width, Rect.Height)));
+			FBitmapRegion::Paste(FConstBitmapView(Cropped.GetData(), FImageSize(Rect.Width, Rect.Height)), FBitmapView(Expected.GetData(), Size), Rect.X + OffsetX, Rect.Y + OffsetY);
+
+			const FConstBitmapView Source = FConstBitmapView(Bitmap.GetData(), Size).GetSubView(Rect);
+			FBitmapRegion::Paste(Source, FBitmapView(Bitmap.GetData(), Size), Rect.X + OffsetX, Rect.Y + OffsetY);
+
+			if (BitmapTestUtils::MaxChannelError(Expected, Bitmap) != 0)
+			{
+				AddError(FString::Printf(TEXT("Moving a rectangle by %d, %d within its bitmap doesn't match pasting a copy of it."), OffsetX, OffsetY));
+			}
+		}
+	}
+	return true;
+}
+
+#endif
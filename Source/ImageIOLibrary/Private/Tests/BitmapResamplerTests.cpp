@@ -0,0 +1,181 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapResampler.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapResamplerTests
+{
+	double DecodeSRGB(double Value)
+	{
+		return Value <= 0.04045 ? Value / 12.92 : FMath::Pow((Value + 0.055) / 1.055, 2.4);
+	}
+
+	double EncodeSRGB(double Value)
+	{
+		Value = FMath::Clamp(Value, 0.0, 1.0);
+		return Value <= 0.0031308 ? Value * 12.92 : 1.055 * FMath::Pow(Value, 1.0 / 2.4) - 0.055;
+	}
+
+	/* Source pixels and normalised weights each output pixel of one axis reads: the filter is stretched when shrinking, edges clamp. */
+	TArray<TArray<TPair<int32, double>>> ReferenceTaps(int32 Length, int32 NewLength, EBitmapResampleFilter Filter)
+	{
+		TArray<TArray<TPair<int32, double>>> Taps;
+		Taps.SetNum(NewLength);
+		if (Length == NewLength)
+		{
+			for (int32 Index = 0; Index < NewLength; Index++)
+			{
+				Taps[Index].Add(TPair<int32, double>(Index, 1.0));
+			}
+			return Taps;
+		}
+
+		const double Scale = (double)Length / NewLength;
+		const double FilterScale = FMath::Max(Scale, 1.0);
+		const double Support = FBitmapResampler::GetFilterSupport(Filter) * FilterScale;
+		for (int32 Index = 0; Index < NewLength; Index++)
+		{
+			const double Centre = (Index + 0.5) * Scale - 0.5;
+			double WeightSum = 0.0;
+			for (int32 Tap = FMath::CeilToInt(Centre - Support); Tap <= FMath::FloorToInt(Centre + Support); Tap++)
+			{
+				const double Weight = FBitmapResampler::EvaluateFilter(Filter, (float)((Tap - Centre) / FilterScale));
+				Taps[Index].Add(TPair<int32, double>(FMath::Clamp(Tap, 0, Length - 1), Weight));
+				WeightSum += Weight;
+			}
+			for (TPair<int32, double>& Tap : Taps[Index])
+			{
+				Tap.Value /= WeightSum;
+			}
+		}
+		return Taps;
+	}
+
+	/* FBitmapResampler::Resize in double precision, each output pixel summing its whole footprint at once. Pixels whose premultiplied alpha
+	ends up under MinCheckedAlpha are left black: dividing by such a small alpha amplifies float rounding past what can be compared.
+	*/
+	TArray<FColor> ReferenceResize(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize, EBitmapResampleFilter Filter, bool bLinearLight, bool bPremultipliedAlpha, uint8 MinCheckedAlpha)
+	{
+		const TArray<TArray<TPair<int32, double>>> TapsX = ReferenceTaps(Size.X, NewSize.X, Filter);
+		const TArray<TArray<TPair<int32, double>>> TapsY = ReferenceTaps(Size.Y, NewSize.Y, Filter);
+
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(NewSize.X * NewSize.Y);
+		for (int32 Y = 0; Y < NewSize.Y; Y++)
+		{
+			for (int32 X = 0; X < NewSize.X; X++)
+			{
+				double Sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+				for (const TPair<int32, double>& TapY : TapsY[Y])
+				{
+					for (const TPair<int32, double>& TapX : TapsX[X])
+					{
+						const FColor& Pixel = Bitmap[TapY.Key * Size.X + TapX.Key];
+						const double Alpha = Pixel.A / 255.0;
+						const double Weight = TapY.Value * TapX.Value;
+						const uint8 Colour[3] = { Pixel.R, Pixel.G, Pixel.B };
+						for (int32 Channel = 0; Channel < 3; Channel++)
+						{
+							const double Value = bLinearLight ? DecodeSRGB(Colour[Channel] / 255.0) : Colour[Channel] / 255.0;
+							Sum[Channel] += Weight * (bPremultipliedAlpha ? Value * Alpha : Value);
+						}
+						Sum[3] += Weight * Alpha;
+					}
+				}
+
+				const uint8 Alpha = BitmapTestUtils::QuantizeReference(FMath::Clamp(Sum[3], 0.0, 1.0) * 255.0);
+				uint8 Colour[3] = { 0, 0, 0 };
+				if (!bPremultipliedAlpha || Alpha >= FMath::Max<uint8>(MinCheckedAlpha, 1))
+				{
+					for (int32 Channel = 0; Channel < 3; Channel++)
+					{
+						const double Value = bPremultipliedAlpha ? Sum[Channel] / FMath::Clamp(Sum[3], 0.0, 1.0) : Sum[Channel];
+						Colour[Channel] = BitmapTestUtils::QuantizeReference((bLinearLight ? EncodeSRGB(Value) : FMath::Clamp(Value, 0.0, 1.0)) * 255.0);
+					}
+				}
+				Result[Y * NewSize.X + X] = FColor(Colour[0], Colour[1], Colour[2], Alpha);
+			}
+		}
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapResamplerTest, "ImageIOLibrary.Resampler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapResamplerTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapResamplerTests;
+
+	const uint8 MinCheckedAlpha = 8;
+
+	for (const FImageSize& Size : { FImageSize(1, 1), FImageSize(7, 13), FImageSize(64, 40) })
+	{
+		// A third of the pixels fully transparent, for the premultiplied path to keep their colour out
+		TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, Size.X * 1000 + Size.Y);
+		for (int32 Index = 0; Index < Bitmap.Num(); Index += 3)
+		{
+			Bitmap[Index].A = 0;
+		}
+
+		for (const FImageSize& NewSize : { FImageSize(1, 3), FImageSize(5, 13), FImageSize(64, 97), FImageSize(150, 13) })
+		{
+			for (int32 Filter = (int32)EBitmapResampleFilter::Box; Filter <= (int32)EBitmapResampleFilter::Lanczos3; Filter++)
+			{
+				for (bool bLinearLight : { false, true })
+				{
+					for (bool bPremultipliedAlpha : { false, true })
+					{
+						TArray<FColor> Result;
+						Result.SetNumUninitialized(NewSize.X * NewSize.Y);
+						FBitmapResampler::Resize(FConstBitmapView(Bitmap.GetData(), Size), (EBitmapResampleFilter)Filter, bLinearLight, bPremultipliedAlpha, FBitmapView(Result.GetData(), NewSize));
+
+						const TArray<FColor> Expected = ReferenceResize(Bitmap, Size, NewSize, (EBitmapResampleFilter)Filter, bLinearLight, bPremultipliedAlpha, MinCheckedAlpha);
+						if (bPremultipliedAlpha)
+						{
+							for (int32 Index = 0; Index < Result.Num(); Index++)
+							{
+								if (Expected[Index].A < MinCheckedAlpha)
+								{
+									Result[Index] = FColor(0, 0, 0, Result[Index].A);
+								}
+							}
+						}
+
+						const int32 Error = BitmapTestUtils::MaxChannelError(Expected, Result);
+						if (Error > BitmapTestUtils::RoundingTolerance)
+						{
+							AddError(FString::Printf(TEXT("%dx%d to %dx%d, filter %d, linear light %d, premultiplied %d is off by up to %d."), Size.X, Size.Y, NewSize.X, NewSize.Y, Filter, (int32)bLinearLight, (int32)bPremultipliedAlpha, Error));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Every filter's weights sum to 1: a flat bitmap stays flat
+	const FColor Flat(10, 200, 77, 255);
+	TArray<FColor> FlatBitmap;
+	FlatBitmap.Init(Flat, 100 * 80);
+	for (int32 Filter = (int32)EBitmapResampleFilter::Box; Filter <= (int32)EBitmapResampleFilter::Lanczos3; Filter++)
+	{
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(33 * 51);
+		FBitmapResampler::Resize(FConstBitmapView(FlatBitmap.GetData(), FImageSize(100, 80)), (EBitmapResampleFilter)Filter, true, true, FBitmapView(Result.GetData(), FImageSize(33, 51)));
+		TestTrue(FString::Printf(TEXT("Filter %d keeps a flat bitmap flat"), Filter), !Result.ContainsByPredicate([Flat](const FColor& Pixel) { return Pixel != Flat; }));
+	}
+
+	// Resizing to the same size copies
+	const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(FImageSize(90, 60), 55);
+	TArray<FColor> Copy;
+	Copy.SetNumUninitialized(Bitmap.Num());
+	FBitmapResampler::Resize(FConstBitmapView(Bitmap.GetData(), FImageSize(90, 60)), EBitmapResampleFilter::Mitchell, false, false, FBitmapView(Copy.GetData(), FImageSize(90, 60)));
+	TestTrue(TEXT("Resizing to the same size copies the bitmap"), BitmapTestUtils::MaxChannelError(Bitmap, Copy) == 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,174 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapSampler.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapSamplerTests
+{
+	/* Where a coordinate outside [0, Length) reads from, spelt out one step at a time. INDEX_NONE for the Constant border. */
+	int32 ReferenceBorderIndex(int32 Index, int32 Length, EBitmapBorderMode BorderMode)
+	{
+		switch (BorderMode)
+		{
+		case EBitmapBorderMode::Clamp:
+			return FMath::Clamp(Index, 0, Length - 1);
+
+		case EBitmapBorderMode::Wrap:
+			while (Index < 0)
+			{
+				Index += Length;
+			}
+			return Index % Length;
+
+		case EBitmapBorderMode::Mirror:
+			// Walk back and forth across the bitmap, turning around on the edge pixels
+			while (Length > 1 && (Index < 0 || Index >= Length))
+			{
+				Index = Index < 0 ? -Index : 2 * (Length - 1) - Index;
+			}
+			return Length > 1 ? Index : 0;
+
+		default:
+			return Index >= 0 && Index < Length ? Index : INDEX_NONE;
+		}
+	}
+
+	FColor ReferencePixel(const TArray<FColor>& Bitmap, FImageSize Size, int32 X, int32 Y, EBitmapBorderMode BorderMode, FColor BorderColour)
+	{
+		const int32 ResolvedX = ReferenceBorderIndex(X, Size.X, BorderMode);
+		const int32 ResolvedY = ReferenceBorderIndex(Y, Size.Y, BorderMode);
+		return ResolvedX == INDEX_NONE || ResolvedY == INDEX_NONE ? BorderColour : Bitmap[ResolvedY * Size.X + ResolvedX];
+	}
+
+	/* Bilinear filtering in double precision, texel centres at whole coordinates once the UV is scaled to the bitmap. */
+	FColor ReferenceBilinear(const TArray<FColor>& Bitmap, FImageSize Size, FVector2D UV, EBitmapBorderMode BorderMode, FColor BorderColour)
+	{
+		const double X = (double)UV.X * Size.X - 0.5;
+		const double Y = (double)UV.Y * Size.Y - 0.5;
+		const int32 Left = (int32)FMath::FloorToDouble(X);
+		const int32 Top = (int32)FMath::FloorToDouble(Y);
+		const double FractionX = X - Left;
+		const double FractionY = Y - Top;
+
+		double Sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+		for (int32 Tap = 0; Tap < 4; Tap++)
+		{
+			const FColor Texel = ReferencePixel(Bitmap, Size, Left + Tap % 2, Top + Tap / 2, BorderMode, BorderColour);
+			const double Weight = (Tap % 2 ? FractionX : 1.0 - FractionX) * (Tap / 2 ? FractionY : 1.0 - FractionY);
+			Sum[0] += Texel.R * Weight;
+			Sum[1] += Texel.G * Weight;
+			Sum[2] += Texel.B * Weight;
+			Sum[3] += Texel.A * Weight;
+		}
+		return FColor(BitmapTestUtils::QuantizeReference(Sum[0]), BitmapTestUtils::QuantizeReference(Sum[1]), BitmapTestUtils::QuantizeReference(Sum[2]), BitmapTestUtils::QuantizeReference(Sum[3]));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapSamplerTest, "ImageIOLibrary.Sampler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapSamplerTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapSamplerTests;
+
+	const FImageSize Size(23, 14);
+	const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, 77);
+	const FColor BorderColour(10, 20, 30, 40);
+	FRandomStream Random(78);
+
+	// Enough points to be split across threads, many of them past the edges, some far past them
+	TArray<FIntPoint> Points;
+	for (int32 Index = 0; Index < 10000; Index++)
+	{
+		const int32 Reach = Index % 10 == 0 ? 100 : 5;
+		Points.Add(FIntPoint(Random.RandRange(-Reach, Size.X - 1 + Reach), Random.RandRange(-Reach, Size.Y - 1 + Reach)));
+	}
+
+	for (int32 BorderMode = (int32)EBitmapBorderMode::Clamp; BorderMode <= (int32)EBitmapBorderMode::Constant; BorderMode++)
+	{
+		TArray<FColor> Expected;
+		for (const FIntPoint& Point : Points)
+		{
+			Expected.Add(ReferencePixel(Bitmap, Size, Point.X, Point.Y, (EBitmapBorderMode)BorderMode, BorderColour));
+		}
+
+		TArray<FColor> Actual;
+		Actual.SetNumUninitialized(Points.Num());
+		FBitmapSampler::SamplePixels(FConstBitmapView(Bitmap.GetData(), Size), Points.GetData(), Points.Num(), (EBitmapBorderMode)BorderMode, BorderColour, Actual.GetData());
+		if (BitmapTestUtils::MaxChannelError(Expected, Actual) != 0)
+		{
+			AddError(FString::Printf(TEXT("Sampling pixels with border mode %d doesn't read the pixels the border mode describes."), BorderMode));
+		}
+	}
+
+	// Points are relative to a rectangle of a bigger bitmap, and its edges are where the border mode starts
+	const FImageSize CanvasSize(Size.X + 9, Size.Y + 7);
+	TArray<FColor> Canvas = BitmapTestUtils::MakeRandomBitmap(CanvasSize, 79);
+	for (int32 Y = 0; Y < Size.Y; Y++)
+	{
+		FMemory::Memcpy(Canvas.GetData() + (Y + 4) * CanvasSize.X + 5, Bitmap.GetData() + Y * Size.X, Size.X * sizeof(FColor));
+	}
+	const FConstBitmapView Rectangle = FConstBitmapView(Canvas.GetData(), CanvasSize).GetSubView(FImageRect(5, 4, Size.X, Size.Y));
+	TArray<FColor> Expected;
+	for (const FIntPoint& Point : Points)
+	{
+		Expected.Add(ReferencePixel(Bitmap, Size, Point.X, Point.Y, EBitmapBorderMode::Mirror, BorderColour));
+	}
+	TArray<FColor> Actual;
+	Actual.SetNumUninitialized(Points.Num());
+	FBitmapSampler::SamplePixels(Rectangle, Points.GetData(), Points.Num(), EBitmapBorderMode::Mirror, BorderColour, Actual.GetData());
+	TestTrue(TEXT("Sampling a rectangle of a bigger bitmap reads the rectangle"), BitmapTestUtils::MaxChannelError(Expected, Actual) == 0);
+
+	// Pixel centres give back the pixels with every filter, the Catmull-Rom weights being 0 on the other texels there
+	TArray<FVector2D> Centres;
+	TArray<FColor> Pixels;
+	for (int32 Y = 0; Y < Size.Y; Y++)
+	{
+		for (int32 X = 0; X < Size.X; X++)
+		{
+			Centres.Add(FVector2D((X + 0.5f) / Size.X, (Y + 0.5f) / Size.Y));
+			Pixels.Add(Bitmap[Y * Size.X + X]);
+		}
+	}
+	for (int32 Filter = (int32)EBitmapSampleFilter::Nearest; Filter <= (int32)EBitmapSampleFilter::Bicubic; Filter++)
+	{
+		TArray<FColor> Sampled;
+		Sampled.SetNumUninitialized(Centres.Num());
+		FBitmapSampler::SampleUVs(FConstBitmapView(Bitmap.GetData(), Size), Centres.GetData(), Centres.Num(), (EBitmapSampleFilter)Filter, EBitmapBorderMode::Clamp, BorderColour, Sampled.GetData());
+		if (BitmapTestUtils::MaxChannelError(Pixels, Sampled) != 0)
+		{
+			AddError(FString::Printf(TEXT("Sampling the pixel centres with filter %d doesn't give back the pixels."), Filter));
+		}
+	}
+
+	// Bilinear weights are rounded to 1/256, which moves a blend by less than one step
+	TArray<FVector2D> UVs;
+	for (int32 Index = 0; Index < 5000; Index++)
+	{
+		UVs.Add(FVector2D(Random.FRandRange(-0.2f, 1.2f), Random.FRandRange(-0.2f, 1.2f)));
+	}
+	for (EBitmapBorderMode BorderMode : { EBitmapBorderMode::Clamp, EBitmapBorderMode::Wrap, EBitmapBorderMode::Constant })
+	{
+		TArray<FColor> Reference;
+		for (const FVector2D& UV : UVs)
+		{
+			Reference.Add(ReferenceBilinear(Bitmap, Size, UV, BorderMode, BorderColour));
+		}
+
+		TArray<FColor> Sampled;
+		Sampled.SetNumUninitialized(UVs.Num());
+		FBitmapSampler::SampleUVs(FConstBitmapView(Bitmap.GetData(), Size), UVs.GetData(), UVs.Num(), EBitmapSampleFilter::Bilinear, BorderMode, BorderColour, Sampled.GetData());
+		const int32 Error = BitmapTestUtils::MaxChannelError(Reference, Sampled);
+		if (Error > BitmapTestUtils::RoundingTolerance)
+		{
+			AddError(FString::Printf(TEXT("Bilinear sampling with border mode %d is off by up to %d."), (int32)BorderMode, Error));
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,110 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Helpers shared by the bitmap automation tests: random bitmaps, and straightforward double precision references the optimised
+// operations are checked against.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "BitmapChannels.h"
+#include "BitmapBorder.h"
+#include "ImageIOLibraryBPLibrary.h"
+
+namespace BitmapTestUtils
+{
+	// Biggest difference allowed per channel where the optimised paths round once in float and the references in double
+	const int32 RoundingTolerance = 1;
+
+	inline TArray<FColor> MakeRandomBitmap(FImageSize Size, int32 Seed)
+	{
+		FRandomStream Random(Seed);
+
+		TArray<FColor> Bitmap;
+		Bitmap.SetNumUninitialized(Size.X * Size.Y);
+		for (FColor& Pixel : Bitmap)
+		{
+			Pixel = FColor(Random.RandRange(0, 255), Random.RandRange(0, 255), Random.RandRange(0, 255), Random.RandRange(0, 255));
+		}
+		return Bitmap;
+	}
+
+	inline uint8 QuantizeReference(double Value)
+	{
+		return (uint8)FMath::Clamp((int32)FMath::FloorToDouble(Value + 0.5), 0, 255);
+	}
+
+	/* Biggest difference between two bitmaps in any channel, 255 when their sizes differ. */
+	inline int32 MaxChannelError(const TArray<FColor>& Expected, const TArray<FColor>& Actual)
+	{
+		if (Expected.Num() != Actual.Num())
+		{
+			return 255;
+		}
+
+		int32 MaxError = 0;
+		for (int32 Index = 0; Index < Expected.Num(); Index++)
+		{
+			MaxError = FMath::Max(MaxError, FMath::Abs((int32)Expected[Index].R - Actual[Index].R));
+			MaxError = FMath::Max(MaxError, FMath::Abs((int32)Expected[Index].G - Actual[Index].G));
+			MaxError = FMath::Max(MaxError, FMath::Abs((int32)Expected[Index].B - Actual[Index].B));
+			MaxError = FMath::Max(MaxError, FMath::Abs((int32)Expected[Index].A - Actual[Index].A));
+		}
+		return MaxError;
+	}
+
+	/* ApplyBitmapFilter as its documentation describes it, one pixel at a time in double precision. Set the filter's FilterAlpha to check
+	the FBitmapConvolution methods, which always filter alpha.
+	*/
+	inline TArray<FColor> ReferenceConvolution(const TArray<FColor>& Bitmap, FImageSize Size, const FBitmapFilter& Filter)
+	{
+		const int32 KernelWidth = Filter.Size.X;
+		const int32 KernelHeight = Filter.Size.Y;
+
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(Bitmap.Num());
+
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				double Sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+				for (int32 KernelY = 0; KernelY < KernelHeight; KernelY++)
+				{
+					for (int32 KernelX = 0; KernelX < KernelWidth; KernelX++)
+					{
+						const FColor Tap = BitmapBorder::ReadPixel(FConstBitmapView(Bitmap.GetData(), Size), X + KernelX - KernelWidth / 2, Y + KernelY - KernelHeight / 2, Filter.BorderMode, Filter.BorderColour);
+						const double Weight = (double)Filter.Filter[KernelY * KernelWidth + KernelX] * Filter.Factor;
+						Sum[0] += Tap.R * Weight;
+						Sum[1] += Tap.G * Weight;
+						Sum[2] += Tap.B * Weight;
+						Sum[3] += Tap.A * Weight;
+					}
+				}
+
+				FColor Pixel(QuantizeReference(Sum[0] + Filter.Bias), QuantizeReference(Sum[1] + Filter.Bias), QuantizeReference(Sum[2] + Filter.Bias), QuantizeReference(Sum[3] + Filter.Bias));
+				if (Filter.ColourChannel == EFilterColourChannel::RGBA && !Filter.FilterAlpha)
+				{
+					Pixel.A = Bitmap[Y * Size.X + X].A;
+				}
+				Result[Y * Size.X + X] = BitmapChannels::FinishFilteredPixel(Pixel, Filter.ColourChannel);
+			}
+		}
+		return Result;
+	}
+
+	/* A kernel of random taps: whole numbers from -8 to 8 (the fixed point path) or fractions from -1 to 1 (the float path). */
+	inline FBitmapFilter MakeRandomFilter(FImageSize KernelSize, bool bWholeTaps, FRandomStream& Random)
+	{
+		FBitmapFilter Filter;
+		Filter.Size = KernelSize;
+		Filter.Filter.Reset();
+		for (int32 Index = 0; Index < KernelSize.X * KernelSize.Y; Index++)
+		{
+			Filter.Filter.Add(bWholeTaps ? (float)Random.RandRange(-8, 8) : Random.FRandRange(-1.0f, 1.0f));
+		}
+		Filter.Factor = bWholeTaps ? 1.0f / (KernelSize.X * KernelSize.Y) : 0.5f;
+		Filter.Bias = bWholeTaps ? 64.0f : -16.0f;
+		return Filter;
+	}
+}
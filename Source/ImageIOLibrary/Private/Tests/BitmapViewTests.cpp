@@ -0,0 +1,208 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapView.h"
+#include "BitmapRegion.h"
+#include "BitmapConvolution.h"
+#include "BitmapBlur.h"
+#include "BitmapMorphology.h"
+#include "BitmapRankFilter.h"
+#include "BitmapGuidedFilter.h"
+#include "BitmapOrientation.h"
+#include "BitmapResampler.h"
+#include "BitmapWarp.h"
+#include "BitmapPyramid.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapViewTests
+{
+	typedef TFunction<void(FConstBitmapView, FBitmapView)> FViewOperation;
+
+	TArray<FColor> CropToArray(FConstBitmapView Src)
+	{
+		TArray<FColor> Cropped;
+		Cropped.SetNumUninitialized(Src.Width * Src.Height);
+		FBitmapRegion::Copy(Src, FBitmapView(Cropped.GetData(), Src.GetSize()));
+		return Cropped;
+	}
+
+	/* Runs Operation from a rectangle of one bitmap into a rectangle of another and checks it against running it between contiguous copies:
+	the rectangle has to end up the same, and the rest of the destination untouched.
+	*/
+	bool MatchesContiguous(FAutomationTestBase& Test, const TCHAR* Name, FImageSize OutSize, const FViewOperation& Operation)
+	{
+		const FImageSize SourceSize(300, 200);
+		const FImageRect SourceRect(37, 21, 150, 110);
+		const FImageSize CanvasSize(OutSize.X + 45, OutSize.Y + 30);
+		const FImageRect CanvasRect(11, 19, OutSize.X, OutSize.Y);
+
+		const TArray<FColor> Source = BitmapTestUtils::MakeRandomBitmap(SourceSize, 41);
+		const TArray<FColor> Canvas = BitmapTestUtils::MakeRandomBitmap(CanvasSize, 42);
+
+		const TArray<FColor> Cropped = CropToArray(FConstBitmapView(Source.GetData(), SourceSize).GetSubView(SourceRect));
+		TArray<FColor> Contiguous;
+		Contiguous.SetNumUninitialized(OutSize.X * OutSize.Y);
+		Operation(FConstBitmapView(Cropped.GetData(), FImageSize(SourceRect.Width, SourceRect.Height)), FBitmapView(Contiguous.GetData(), OutSize));
+
+		TArray<FColor> Expected = Canvas;
+		FBitmapRegion::Paste(FConstBitmapView(Contiguous.GetData(), OutSize), FBitmapView(Expected.GetData(), CanvasSize), CanvasRect.X, CanvasRect.Y);
+
+		TArray<FColor> Actual = Canvas;
+		Operation(FConstBitmapView(Source.GetData(), SourceSize).GetSubView(SourceRect), FBitmapView(Actual.GetData(), CanvasSize).GetSubView(CanvasRect));
+
+		if (BitmapTestUtils::MaxChannelError(Expected, Actual) != 0)
+		{
+			Test.AddError(FString::Printf(TEXT("%s between rectangles of bigger bitmaps doesn't match it between contiguous bitmaps."), Name));
+			return false;
+		}
+		return true;
+	}
+
+	/* Runs Operation on Region grown by Reach on each side (clipped to the bitmap) and checks Region against running it on the whole bitmap. */
+	void MatchesWhole(FAutomationTestBase& Test, const TCHAR* Name, int32 Reach, int32 Tolerance, const FViewOperation& Operation)
+	{
+		const FImageSize Size(240, 180);
+		const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, 43);
+
+		TArray<FColor> Whole;
+		Whole.SetNumUninitialized(Bitmap.Num());
+		Operation(FConstBitmapView(Bitmap.GetData(), Size), FBitmapView(Whole.GetData(), Size));
+
+		// One rectangle in the middle, one against the top left corner
+		for (const FImageRect& Region : { FImageRect(70, 60, 90, 50), FImageRect(0, 0, 60, 40) })
+		{
+			const int32 Left = FMath::Max(Region.X - Reach, 0);
+			const int32 Top = FMath::Max(Region.Y - Reach, 0);
+			const FConstBitmapView Apron = FConstBitmapView(Bitmap.GetData(), Size).GetSubView(FImageRect(Left, Top, Region.X + Region.Width + Reach - Left, Region.Y + Region.Height + Reach - Top));
+
+			TArray<FColor> Filtered;
+			Filtered.SetNumUninitialized(Apron.Width * Apron.Height);
+			Operation(Apron, FBitmapView(Filtered.GetData(), Apron.GetSize()));
+
+			const TArray<FColor> Expected = CropToArray(FConstBitmapView(Whole.GetData(), Size).GetSubView(Region));
+			const TArray<FColor> Actual = CropToArray(FConstBitmapView(Filtered.GetData(), Apron.GetSize()).GetSubView(FImageRect(Region.X - Left, Region.Y - Top, Region.Width, Region.Height)));
+
+			const int32 Error = BitmapTestUtils::MaxChannelError(Expected, Actual);
+			if (Error > Tolerance)
+			{
+				Test.AddError(FString::Printf(TEXT("%s of a rectangle and %d pixels around it is off by %d from it on the whole bitmap, at %d, %d."), Name, Reach, Error, Region.X, Region.Y));
+			}
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapViewSubRectanglesTest, "ImageIOLibrary.Views.SubRectangles", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapViewSubRectanglesTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapViewTests;
+
+	const FImageSize SameSize(150, 110);
+
+	FBitmapFilter Small(FImageSize(5, 3), { 1, 2, 3, 2, 1, 2, 4, 6, 4, 2, 1, 2, 3, 2, 1 }, 1.0f / 36.0f, 0.0f, EFilterColourChannel::RGBA);
+	Small.BorderMode = EBitmapBorderMode::Mirror;
+	MatchesContiguous(*this, TEXT("A 5x3 convolution"), SameSize, [&Small](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapConvolution::Apply(Src, Small, Dst);
+	});
+
+	// Big enough to go through the FFTs
+	TArray<float> Weights;
+	for (int32 Index = 0; Index < 17 * 17; Index++)
+	{
+		Weights.Add((float)(Index % 7 + 1));
+	}
+	const FBitmapFilter Big(FImageSize(17, 17), Weights, 1.0f / 1024.0f, 0.0f, EFilterColourChannel::RGBA);
+	MatchesContiguous(*this, TEXT("A 17x17 convolution"), SameSize, [&Big](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapConvolution::Apply(Src, Big, Dst);
+	});
+
+	for (EBitmapBlurMethod Method : { EBitmapBlurMethod::Box, EBitmapBlurMethod::FastGaussian, EBitmapBlurMethod::Gaussian })
+	{
+		MatchesContiguous(*this, TEXT("A blur"), SameSize, [Method](FConstBitmapView Src, FBitmapView Dst)
+		{
+			FBitmapBlur::Blur(Src, 7.0f, Method, EFilterColourChannel::RGBA, Dst);
+		});
+	}
+
+	MatchesContiguous(*this, TEXT("An RGBA open"), SameSize, [](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapMorphology::Apply(Src, EBitmapMorphologyOperation::Open, 3, 2, EFilterColourChannel::RGBA, Dst);
+	});
+	MatchesContiguous(*this, TEXT("An alpha erode"), SameSize, [](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapMorphology::Apply(Src, EBitmapMorphologyOperation::Erode, 2, 4, EFilterColourChannel::A, Dst);
+	});
+
+	// Radius 1 goes through the sorting network, bigger radii through the histograms
+	for (int32 Radius : { 1, 3 })
+	{
+		MatchesContiguous(*this, TEXT("A median"), SameSize, [Radius](FConstBitmapView Src, FBitmapView Dst)
+		{
+			FBitmapRankFilter::Filter(Src, Radius, 50.0f, EFilterColourChannel::RGBA, Dst);
+		});
+	}
+	MatchesContiguous(*this, TEXT("A guided filter"), SameSize, [](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapGuidedFilter::Filter(Src, 4, 0.1f, EFilterColourChannel::RGBA, Dst);
+	});
+
+	for (EBitmapOrientation Orientation : { EBitmapOrientation::Rotate90, EBitmapOrientation::Rotate180, EBitmapOrientation::Transverse })
+	{
+		MatchesContiguous(*this, TEXT("A reorientation"), FBitmapOrientation::GetOrientedSize(SameSize, Orientation), [Orientation](FConstBitmapView Src, FBitmapView Dst)
+		{
+			FBitmapOrientation::Reorient(Src, Orientation, Dst);
+		});
+	}
+
+	MatchesContiguous(*this, TEXT("A resize"), FImageSize(97, 61), [](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapResampler::Resize(Src, EBitmapResampleFilter::Lanczos3, true, true, Dst);
+	});
+
+	const float Rotation[9] = { 0.9f, -0.3f, 20.0f, 0.3f, 0.9f, -10.0f, 0.0005f, 0.0f, 1.0f };
+	MatchesContiguous(*this, TEXT("A warp"), FImageSize(120, 90), [&Rotation](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapWarp::Warp(Src, FBitmapHomography::FromRowMajor(Rotation), EBitmapSampleFilter::Bicubic, EBitmapBorderMode::Clamp, FColor(0, 0, 0, 0), Dst);
+	});
+
+	MatchesContiguous(*this, TEXT("A multiband blend"), SameSize, [](FConstBitmapView Src, FBitmapView Dst)
+	{
+		// Dst only gets written to here, so Src is all three inputs
+		FBitmapPyramid::BlendMultiband(Src, Src, Src, 4, Dst);
+	});
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapViewRegionApronTest, "ImageIOLibrary.Views.RegionApron", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapViewRegionApronTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapViewTests;
+
+	// The reach the region nodes grow their rectangle by has to be all the blurs read, the recursive gaussian to within rounding
+	for (EBitmapBlurMethod Method : { EBitmapBlurMethod::Box, EBitmapBlurMethod::FastGaussian, EBitmapBlurMethod::Gaussian })
+	{
+		const float Radius = 9.0f;
+		MatchesWhole(*this, TEXT("A blur"), FBitmapBlur::GetReach(Radius, Method), Method == EBitmapBlurMethod::Gaussian ? BitmapTestUtils::RoundingTolerance : 0,
+			[Method, Radius](FConstBitmapView Src, FBitmapView Dst)
+		{
+			FBitmapBlur::Blur(Src, Radius, Method, EFilterColourChannel::RGBA, Dst);
+		});
+	}
+
+	// Open and close run two operators, each a radius further
+	MatchesWhole(*this, TEXT("A close"), 2 * 4, 0, [](FConstBitmapView Src, FBitmapView Dst)
+	{
+		FBitmapMorphology::Apply(Src, EBitmapMorphologyOperation::Close, 4, 4, EFilterColourChannel::RGBA, Dst);
+	});
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,114 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BitmapTestUtils.h"
+#include "BitmapWarp.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BitmapWarpTests
+{
+	FVector2D Project(const FBitmapHomography& Homography, FVector2D Point)
+	{
+		const double X = Homography.M[0][0] * Point.X + Homography.M[0][1] * Point.Y + Homography.M[0][2];
+		const double Y = Homography.M[1][0] * Point.X + Homography.M[1][1] * Point.Y + Homography.M[1][2];
+		const double W = Homography.M[2][0] * Point.X + Homography.M[2][1] * Point.Y + Homography.M[2][2];
+		return FVector2D((float)(X / W), (float)(Y / W));
+	}
+
+	TArray<FColor> Warp(const TArray<FColor>& Bitmap, FImageSize Size, const FBitmapHomography& OutputToSource, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode,
+		FImageSize OutSize)
+	{
+		TArray<FColor> Result;
+		Result.SetNumUninitialized(OutSize.X * OutSize.Y);
+		FBitmapWarp::Warp(FConstBitmapView(Bitmap.GetData(), Size), OutputToSource, Filter, BorderMode, FColor(1, 2, 3, 4), FBitmapView(Result.GetData(), OutSize));
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBitmapWarpTest, "ImageIOLibrary.Warp", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBitmapWarpTest::RunTest(const FString& Parameters)
+{
+	using namespace BitmapWarpTests;
+
+	// Wider than a tile, so rows are stepped across several of them
+	const FImageSize Size(150, 90);
+	const TArray<FColor> Bitmap = BitmapTestUtils::MakeRandomBitmap(Size, 61);
+
+	// The identity lands every output pixel on the centre of its source pixel, where every filter gives the pixel back
+	for (int32 Filter = (int32)EBitmapSampleFilter::Nearest; Filter <= (int32)EBitmapSampleFilter::Bicubic; Filter++)
+	{
+		const TArray<FColor> Result = Warp(Bitmap, Size, FBitmapHomography(), (EBitmapSampleFilter)Filter, EBitmapBorderMode::Clamp, Size);
+		if (BitmapTestUtils::MaxChannelError(Bitmap, Result) != 0)
+		{
+			AddError(FString::Printf(TEXT("The identity warp with filter %d changes the bitmap."), Filter));
+		}
+	}
+
+	// A whole pixel translation moves the pixels and shows the border colour where it uncovers the edge
+	const float Translation[9] = { 1.0f, 0.0f, 7.0f, 0.0f, 1.0f, -3.0f, 0.0f, 0.0f, 1.0f };
+	const TArray<FColor> Translated = Warp(Bitmap, Size, FBitmapHomography::FromRowMajor(Translation), EBitmapSampleFilter::Bilinear, EBitmapBorderMode::Constant, Size);
+	TArray<FColor> ExpectedTranslated;
+	for (int32 Y = 0; Y < Size.Y; Y++)
+	{
+		for (int32 X = 0; X < Size.X; X++)
+		{
+			ExpectedTranslated.Add(X + 7 < Size.X && Y - 3 >= 0 ? Bitmap[(Y - 3) * Size.X + X + 7] : FColor(1, 2, 3, 4));
+		}
+	}
+	TestTrue(TEXT("A whole pixel translation moves the pixels"), BitmapTestUtils::MaxChannelError(ExpectedTranslated, Translated) == 0);
+
+	// A quarter turn with a flip sends pixel centres to pixel centres, so its inverse gives back the bitmap exactly
+	const float QuarterTurn[9] = { 0.0f, -1.0f, (float)Size.X, -1.0f, 0.0f, (float)Size.Y, 0.0f, 0.0f, 1.0f };
+	const FBitmapHomography Turn = FBitmapHomography::FromRowMajor(QuarterTurn);
+	FBitmapHomography TurnInverse;
+	TestTrue(TEXT("A quarter turn can be inverted"), Turn.Inverse(TurnInverse));
+	const FImageSize TurnedSize(Size.Y, Size.X);
+	const TArray<FColor> Turned = Warp(Bitmap, Size, Turn, EBitmapSampleFilter::Nearest, EBitmapBorderMode::Constant, TurnedSize);
+	const TArray<FColor> TurnedBack = Warp(Turned, TurnedSize, TurnInverse, EBitmapSampleFilter::Nearest, EBitmapBorderMode::Constant, Size);
+	TestTrue(TEXT("A warp then its inverse gives back the bitmap"), BitmapTestUtils::MaxChannelError(Bitmap, TurnedBack) == 0);
+
+	bool bTurnedRight = true;
+	for (int32 Y = 0; Y < TurnedSize.Y; Y++)
+	{
+		for (int32 X = 0; X < TurnedSize.X; X++)
+		{
+			bTurnedRight &= Turned[Y * TurnedSize.X + X] == Bitmap[(Size.Y - 1 - X) * Size.X + Size.X - 1 - Y];
+		}
+	}
+	TestTrue(TEXT("The quarter turn moves each pixel where the matrix sends it"), bTurnedRight);
+
+	// Perspective: the inverse undoes the homography, and the unit square lands on the quad it was built from
+	const FVector2D Corners[4] = { FVector2D(10.0f, 5.0f), FVector2D(140.0f, 20.0f), FVector2D(120.0f, 85.0f), FVector2D(25.0f, 70.0f) };
+	FBitmapHomography SquareToQuad;
+	TestTrue(TEXT("A quad with no 3 corners on a line has a homography"), FBitmapHomography::MakeUnitSquareToQuad(Corners, SquareToQuad));
+	const FVector2D UnitCorners[4] = { FVector2D(0.0f, 0.0f), FVector2D(1.0f, 0.0f), FVector2D(1.0f, 1.0f), FVector2D(0.0f, 1.0f) };
+	for (int32 Corner = 0; Corner < 4; Corner++)
+	{
+		TestTrue(FString::Printf(TEXT("Unit square corner %d lands on the quad's"), Corner), Project(SquareToQuad, UnitCorners[Corner]).Equals(Corners[Corner], 1e-3f));
+	}
+	TestFalse(TEXT("A homography built from a quad isn't affine"), SquareToQuad.IsAffine());
+
+	FBitmapHomography QuadToSquare;
+	TestTrue(TEXT("A perspective homography can be inverted"), SquareToQuad.Inverse(QuadToSquare));
+	const FBitmapHomography Product = SquareToQuad * QuadToSquare;
+	bool bIdentity = true;
+	for (int32 Row = 0; Row < 3; Row++)
+	{
+		for (int32 Column = 0; Column < 3; Column++)
+		{
+			bIdentity &= FMath::Abs(Product.M[Row][Column] / Product.M[2][2] - (Row == Column ? 1.0 : 0.0)) < 1e-9;
+		}
+	}
+	TestTrue(TEXT("A homography times its inverse is the identity"), bIdentity);
+
+	const FVector2D Collinear[4] = { FVector2D(0.0f, 0.0f), FVector2D(1.0f, 1.0f), FVector2D(2.0f, 2.0f), FVector2D(0.0f, 5.0f) };
+	FBitmapHomography Degenerate;
+	TestFalse(TEXT("A quad with 3 corners on a line has no homography"), FBitmapHomography::MakeUnitSquareToQuad(Collinear, Degenerate));
+
+	return true;
+}
+
+#endif
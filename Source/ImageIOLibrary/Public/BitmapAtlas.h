@@ -0,0 +1,62 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Many small images packed into a few big textures (pages), so the widgets showing them share a handful of textures instead of binding one each.
+// Images can be added at any time: each page keeps its packer, new images go in the space left and those already placed never move.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapAtlasPacker.h"
+#include "BitmapView.h"
+#include "BitmapAtlas.generated.h"
+
+class UTexture2D;
+
+/* Created with CreateBitmapAtlas, filled with AddBitmapToAtlas and AddImageFilesToAtlas. */
+UCLASS(BlueprintType)
+class UBitmapAtlas : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UBitmapAtlas();
+
+	/* Sets the atlas up before anything is added to it.
+	@param InPageSize	Width and height of every page.
+	@param InPadding	Pixels around each image, filled with copies of its edge so bilinear filtering doesn't pick up its neighbours.
+	*/
+	void Init(int32 InPageSize, int32 InPadding);
+
+	/* Packs Bitmaps into the pages, opening new pages when they are full, and uploads them. Biggest images are placed first.
+	@param OutEntries	Where each of Bitmaps went, in the same order. Empty images and images too big for a page get a null texture and a Page of INDEX_NONE.
+	@return				How many of Bitmaps were added.
+	*/
+	int32 Add(const TArray<FConstBitmapView>& Bitmaps, TArray<FBitmapAtlasEntry>& OutEntries);
+
+	const TArray<UTexture2D*>& GetPages() const
+	{
+		return Pages;
+	}
+
+	int32 GetPageSize() const
+	{
+		return PageSize;
+	}
+
+private:
+
+	/* Opens a new empty page. */
+	bool AddPage();
+
+	UPROPERTY(Transient)
+	TArray<UTexture2D*> Pages;
+
+	// One per page, with the free space left in it
+	TArray<FBitmapAtlasPacker> Packers;
+
+	int32 PageSize;
+	int32 Padding;
+};
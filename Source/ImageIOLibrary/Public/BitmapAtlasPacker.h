@@ -0,0 +1,42 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Rectangle packing for texture atlases: MaxRects with the best short side fit heuristic. Free space is kept as maximal (overlapping) rectangles,
+// so rectangles can be added one at a time, long after the first ones, without moving anything already placed.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+
+class FBitmapAtlasPacker
+{
+public:
+
+	explicit FBitmapAtlasPacker(FImageSize InBinSize);
+
+	/* Finds room for a Size rectangle, in the free rectangle it leaves the least space in on its shorter side, and marks it as used.
+	Rectangles are never rotated.
+	@return		False, with nothing changed, when there is no room left for it.
+	*/
+	bool Insert(FImageSize Size, FIntPoint& OutPosition);
+
+	/* Share of the bin taken by the rectangles inserted so far, from 0 to 1. */
+	float GetOccupancy() const;
+
+	FImageSize GetBinSize() const
+	{
+		return BinSize;
+	}
+
+private:
+
+	/* Replaces every free rectangle Used overlaps with the parts of it Used leaves free. */
+	void SplitFreeRects(const FImageRect& Used);
+
+	/* Drops the free rectangles inside another one. */
+	void PruneFreeRects();
+
+	FImageSize BinSize;
+	TArray<FImageRect> FreeRects;
+	int64 UsedArea;
+};
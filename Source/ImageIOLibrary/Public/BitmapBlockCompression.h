@@ -0,0 +1,28 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Block compression of texture data on the CPU, spread across threads by rows of 4x4 blocks.
+// BC1 and BC3 colours are fitted along the principal axis of each block, then refined by least squares. BC7 only uses mode 6 (one RGBA line
+// per block with 16 levels), which is much faster to search than the full format and still beats BC1 and BC3 on photos.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapBlockCompression
+{
+public:
+
+	/* Pixel format of a texture stored with Compression (PF_R8G8B8A8 when uncompressed). */
+	static EPixelFormat GetPixelFormat(EBitmapTextureCompression Compression);
+
+	/* Bytes needed to store Size pixels with Compression. Partial blocks on the right and bottom edges count as whole blocks. */
+	static int64 GetCompressedSize(FImageSize Size, EBitmapTextureCompression Compression);
+
+	/* Compresses RGBA pixels (the byte order textures are created from, held in FColors) into GetCompressedSize(Pixels.GetSize(), Compression)
+	bytes of Dst. Pixels may be a rectangle of a bigger bitmap. Partial blocks repeat their last row and column. Compression must not be None.
+	*/
+	static void Compress(FConstBitmapView Pixels, EBitmapTextureCompression Compression, void* Dst);
+};
@@ -0,0 +1,36 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Blurs whose cost per pixel doesn't depend on the radius, for the big radii ApplyBitmapFilter can't handle.
+// Every blur runs as a horizontal then a vertical pass (see FBitmapLinePass), spread across threads. Src and Dst are the same size,
+// may be rectangles of bigger bitmaps and may be the same pixels.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapBlur
+{
+public:
+
+	/* Each pixel becomes the average of the (2 * Radius + 1)² square around it, using a sliding window sum. */
+	static void BoxBlur(FConstBitmapView Src, int32 Radius, EFilterColourChannel ColourChannel, FBitmapView Dst);
+
+	/* Gaussian blur approximated by three box blurs in a row, with box sizes picked to match Sigma. */
+	static void BoxGaussianBlur(FConstBitmapView Src, float Sigma, EFilterColourChannel ColourChannel, FBitmapView Dst);
+
+	/* Gaussian blur using the Young / van Vliet recursive filter, a forward and a backward 3rd order pass per line. Works for any Sigma >= 0.5. */
+	static void RecursiveGaussianBlur(FConstBitmapView Src, float Sigma, EFilterColourChannel ColourChannel, FBitmapView Dst);
+
+	/* Runs the blur picked by Method. For the gaussians, Radius is taken as 3 sigmas (where the gaussian is close enough to 0). */
+	static void Blur(FConstBitmapView Src, float Radius, EBitmapBlurMethod Method, EFilterColourChannel ColourChannel, FBitmapView Dst);
+
+	/* How many pixels away from a pixel Blur reads, so that a rectangle grown by that much on each side blurs its middle as the whole bitmap
+	would. The recursive gaussian reads whole lines, its reach is where its weights fall well below what 8 bit pixels can show (12 sigmas).
+	*/
+	static int32 GetReach(float Radius, EBitmapBlurMethod Method);
+
+	/* Box radii whose three successive box blurs approximate a gaussian of this sigma. */
+	static void GetBoxRadiiForGaussian(float Sigma, int32 OutRadii[3]);
+};
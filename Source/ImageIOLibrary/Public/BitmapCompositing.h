@@ -0,0 +1,29 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Premultiplied alpha conversions and Porter-Duff compositing on 8 bit bitmaps.
+// Compositing only ever runs on premultiplied pixels, so it is a couple of multiplies per channel and no division.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapCompositing
+{
+public:
+
+	/* Multiplies the colour channels by alpha. Src and Dst may be the same buffer. */
+	static void Premultiply(const FColor* Src, FColor* Dst, int32 NumPixels);
+
+	/* Divides the colour channels by alpha (using a reciprocal table). Fully transparent pixels become transparent black. Src and Dst may be the same buffer. */
+	static void Unpremultiply(const FColor* Src, FColor* Dst, int32 NumPixels);
+
+	/* Out = Source <Operation> Destination. All three buffers hold premultiplied pixels, Out may alias either input. */
+	static void Composite(EBitmapCompositeOperation Operation, const FColor* Source, const FColor* Destination, FColor* Out, int32 NumPixels);
+
+	/* Destination = Source <Operation> Destination on straight alpha pixels. Both are premultiplied and the result converted back a row at a
+	time, so neither needs a premultiplied copy. Source and Destination are the same size and may be rectangles of bigger bitmaps.
+	*/
+	static void CompositeStraight(EBitmapCompositeOperation Operation, FConstBitmapView Source, FBitmapView Destination);
+};
@@ -0,0 +1,55 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Convolution engine behind ApplyBitmapFilter.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+/* The ways FBitmapConvolution::Apply can run a filter. */
+enum class EBitmapConvolutionMethod : uint8
+{
+	Direct,
+	Separable,
+	FFT,
+};
+
+class FBitmapConvolution
+{
+public:
+
+	/* Applies the filter with the path ChooseMethod estimates to be the fastest. With the RGBA channel, pixels keep their alpha unless the
+	filter's FilterAlpha is set; the methods below always filter it.
+	@param Src		The pixels to filter, e.g. a rectangle of a bigger bitmap. The filter's border mode applies past the edges of the view.
+	@param Dst		Receives Src's size in pixels, can't overlap Src.
+	*/
+	static void Apply(FConstBitmapView Src, const FBitmapFilter& Filter, FBitmapView Dst);
+
+	/* Direct 2D convolution. The output is split in cache sized tiles spread across threads; tiles whose taps all land inside
+	the bitmap read it directly, only the tiles along the edges go through the border mode.
+	*/
+	static void Convolve(FConstBitmapView Src, const FBitmapFilter& Filter, FBitmapView Dst);
+
+	/* Convolution through the frequency domain, for big kernels: its cost per pixel barely depends on the kernel size. The output is
+	split in tiles computed from overlapping blocks of input, spread across threads. Kernel spectra are cached, so applying the same
+	filter to many bitmaps only transforms the kernel once. Kernels too big for the biggest FFT block go through Convolve instead.
+	*/
+	static void ConvolveFFT(FConstBitmapView Src, const FBitmapFilter& Filter, FBitmapView Dst);
+
+	/* Cost model behind Apply: estimates the work per pixel of each method for this bitmap size and kernel and returns the cheapest.
+	@param bSeparable	Whether FindSeparableFactors succeeded on the filter.
+	*/
+	static EBitmapConvolutionMethod ChooseMethod(FImageSize Size, const FBitmapFilter& Filter, bool bSeparable);
+
+	/* Checks whether the filter's matrix is rank 1, i.e. the outer product of a column and a row vector. Box blurs and gaussians are.
+	If it is, OutColumn[Y] * OutRow[X] == Filter.Filter[Y * Width + X] (Factor isn't folded in).
+	*/
+	static bool FindSeparableFactors(const FBitmapFilter& Filter, TArray<float>& OutRow, TArray<float>& OutColumn);
+
+	/* Convolves with a separable kernel as two 1D passes: Row.Num() + Column.Num() taps per pixel instead of Row.Num() * Column.Num().
+	The horizontal pass writes a transposed intermediate so the vertical pass reads contiguous memory too.
+	*/
+	static void ConvolveSeparable(FConstBitmapView Src, const FSeparableBitmapFilter& Filter, FBitmapView Dst);
+};
@@ -0,0 +1,81 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Keeps the memory held by the image files being decoded at the same time under ImageIO.DecodeMemoryBudget. Before loading a file, a decode
+// reads the size of the image from its header and reserves what it will hold at its peak. Bitmap jobs that decode get their reservation
+// when the scheduler starts them (see FBitmapJobScheduler): a job that doesn't fit stays queued, so no worker sleeps holding a thread. A job
+// holds its reservation until the game thread has completed it and created its texture, so results waiting on a busy game thread still
+// count. The game thread never waits, its decodes are only counted: it decodes one file at a time, and can't stall on a job running elsewhere.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+
+class FBitmapDecodeBudget
+{
+public:
+
+	/* Reads the width and height of a PNG, JPEG or BMP file from its header, without loading the rest of the file. */
+	static bool ProbeImageFile(const FString& PathToImage, FImageSize& OutSize);
+
+	/* Bytes a decode of the file holds at its peak: the file and the decoder's copy of it, then the decoder's pixels and the copy it hands back.
+	Images the header can't be probed for (other formats) are assumed to take 4 times their file once decoded.
+	@param bCreateTexture	Whether the decoded pixels are also turned into a texture before being freed.
+	@param bGenerateMips	Whether that texture gets every smaller mip too.
+	@param bKeepBitmap		Whether the decoded pixels are kept next to a copy in the texture's channel order until the texture is made, as
+							bitmap jobs do to hand back both.
+	*/
+	static int64 EstimateDecodeBytes(const FString& PathToImage, bool bCreateTexture, bool bGenerateMips, bool bKeepBitmap = false);
+
+	/* Counts Bytes against the budget if they fit, or if nothing else is reserved: a decode bigger than the whole budget still runs, alone.
+	Never waits.
+	*/
+	static bool TryReserve(int64 Bytes);
+
+	/* Whether TryReserve would take Bytes now. Reserves nothing, so they may no longer fit by the time they're reserved. */
+	static bool Fits(int64 Bytes);
+
+	/* Counts Bytes against the budget, waiting until they fit on the threads that can afford to. The game thread and bitmap jobs don't wait:
+	the game thread can't stall, and a job already got its decode memory when it was started, so more memory asked from one is only counted.
+	Nor should task graph threads call this, the rest of the engine shares them.
+	*/
+	static void Reserve(int64 Bytes);
+
+	/* Gives back what TryReserve or Reserve counted, from any thread. Wakes the waiting reservations and starts the queued jobs that now fit. */
+	static void Release(int64 Bytes);
+
+	static FDecodeMemoryStats GetStats();
+
+	/* Starts the peak over from what is reserved now. */
+	static void ResetPeak();
+};
+
+/* Bytes reserved in the decode budget until the reservation is released or destroyed, on any thread. */
+class FBitmapDecodeReservation
+{
+public:
+
+	FBitmapDecodeReservation();
+
+	/* Waits for Bytes to fit in the budget, see FBitmapDecodeBudget::Reserve. */
+	explicit FBitmapDecodeReservation(int64 InBytes);
+
+	/* A reservation of Bytes if they fit now, an empty one otherwise. See FBitmapDecodeBudget::TryReserve. */
+	static FBitmapDecodeReservation TryReserve(int64 InBytes);
+
+	FBitmapDecodeReservation(FBitmapDecodeReservation&& Other);
+	FBitmapDecodeReservation& operator=(FBitmapDecodeReservation&& Other);
+	~FBitmapDecodeReservation();
+
+	bool IsReserved() const { return bReserved; }
+
+	void Release();
+
+private:
+
+	FBitmapDecodeReservation(const FBitmapDecodeReservation&) = delete;
+	FBitmapDecodeReservation& operator=(const FBitmapDecodeReservation&) = delete;
+
+	int64 Bytes;
+	bool bReserved;
+};
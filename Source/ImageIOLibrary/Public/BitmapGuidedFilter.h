@@ -0,0 +1,28 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Edge preserving smoothing with the guided filter (He, Sun and Tang, "Guided Image Filtering", 2010), each channel guiding itself.
+// Everything is built from box averages computed with sliding sums, so the cost per pixel doesn't depend on the radius.
+// Rows are split in bands spread across threads, each band only keeps a few rows of sums around. Edges repeat the border pixels.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapGuidedFilter
+{
+public:
+
+	// Biggest radius the filter accepts, so the window sums of squared values fit in 32 bits
+	static const int32 MaxRadius = 64;
+
+	/* Smooths away the variations of each channel that are small compared to Smoothness while keeping the bigger ones (edges) sharp.
+	Within each (2 * Radius + 1)² window a channel is fitted as A * Value + B, A going to 0 (flat) where the window's variance is
+	well below Smoothness² and to 1 (untouched) where it's well above it. The fits of all the windows covering a pixel are then averaged.
+	@param Src			The pixels to filter, e.g. a rectangle of a bigger bitmap. Its edge pixels are repeated past it.
+	@param Smoothness	Contrast, from 0 to 1 (a full channel), below which details get smoothed.
+	@param Dst			Receives Src's size in pixels, can't overlap Src.
+	*/
+	static void Filter(FConstBitmapView Src, int32 Radius, float Smoothness, EFilterColourChannel ColourChannel, FBitmapView Dst);
+};
@@ -0,0 +1,109 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Bitmap operations run on background threads. A job is started from the game thread with the work to do and hands back a UBitmapJob right
+// away: its progress can be polled or followed through OnProgress, it can be cancelled, and its completion callback runs on the game thread
+// with the resulting bitmap (and texture, when asked for). Cancellation and progress come from FBitmapParallel, see BitmapJobContext.h.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapJobContext.h"
+#include "BitmapDecodeBudget.h"
+#include "BitmapJob.generated.h"
+
+class UTexture2D;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBitmapJobProgress, UBitmapJob*, Job, float, Progress);
+
+/* What the work of a job hands back. */
+struct FBitmapJobResult
+{
+	TArray<FColor> Bitmap;
+	FImageSize Size;
+
+	/* Whether to create a texture from Bitmap once the work is done. */
+	bool bCreateTexture = false;
+
+	/* Bitmap in the texture's RGBA order, prepared on the worker so the game thread only has to create the texture. */
+	TArray<FColor> TexturePixels;
+
+	/* Decode memory the job was started with (see FBitmapDecodeBudget), released once the job has completed on the game thread. */
+	FBitmapDecodeReservation Reservation;
+};
+
+/* Handle of a job started by one of the Async functions of UImageIOLibraryBPLibrary. */
+UCLASS(BlueprintType)
+class UBitmapJob : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UBitmapJob();
+
+	/* Queues Work to run on a background thread (see FBitmapJobScheduler), then OnCompleted on the game thread. The job is kept alive until
+	then even when nothing references it. Call from the game thread: OnCompleted never runs before the caller is done, so delegates bound to
+	the job right after are never late.
+	@param Work			Fills the result and returns whether it succeeded. Runs with the job as its thread's current FBitmapJobContext.
+	@param DecodeBytes	Decode memory Work needs (see FBitmapDecodeBudget): the job stays queued until it fits, and Work finds it reserved
+						in the result. It is held until the job has completed and made its texture. 0 for work that doesn't decode files.
+	*/
+	static UBitmapJob* Launch(TUniqueFunction<bool(FBitmapJobContext&, FBitmapJobResult&)>&& Work, TFunction<void(UBitmapJob*)>&& OnCompleted,
+		EBitmapJobPriority Priority = EBitmapJobPriority::Visible, int64 DecodeBytes = 0);
+
+	/* Asks the job to stop as soon as its current batch of rows or tiles is done. It then completes as Cancelled, without a result.
+	A job still queued is dropped without ever running, e.g. the load of a thumbnail scrolled out of view.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "ImageIOLibrary|Job")
+		void Cancel();
+
+	/* From 0 to 1. */
+	UFUNCTION(BlueprintPure, Category = "ImageIOLibrary|Job")
+		float GetProgress() const;
+
+	UFUNCTION(BlueprintPure, Category = "ImageIOLibrary|Job")
+		EBitmapJobState GetState() const;
+
+	/* Moves a queued job ahead of or behind other jobs, e.g. a prefetched thumbnail scrolled into view. A running job only changes which
+	jobs it gives its threads to and takes threads from.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "ImageIOLibrary|Job")
+		void SetPriority(EBitmapJobPriority Priority);
+
+	UFUNCTION(BlueprintPure, Category = "ImageIOLibrary|Job")
+		EBitmapJobPriority GetPriority() const;
+
+	/* Whether the job succeeded, failed or was cancelled. */
+	UFUNCTION(BlueprintPure, Category = "ImageIOLibrary|Job")
+		bool IsDone() const;
+
+	/* Broadcast on the game thread each time the progress goes past a whole percent. */
+	UPROPERTY(BlueprintAssignable, Category = "ImageIOLibrary|Job")
+	FOnBitmapJobProgress OnProgress;
+
+	/* The resulting bitmap, once the job succeeded. */
+	UPROPERTY(BlueprintReadOnly, Category = "ImageIOLibrary|Job")
+	TArray<FColor> Bitmap;
+
+	/* Resolution of Bitmap. */
+	UPROPERTY(BlueprintReadOnly, Category = "ImageIOLibrary|Job")
+	FImageSize Size;
+
+	/* The texture created from Bitmap, for jobs that make one. */
+	UPROPERTY(BlueprintReadOnly, Category = "ImageIOLibrary|Job")
+	UTexture2D* Texture;
+
+private:
+
+	/* Stores the result and runs the completion callback, on the game thread. */
+	void Complete(bool bSucceeded, FBitmapJobResult& Result);
+
+	TSharedRef<FBitmapJobContext, ESPMode::ThreadSafe> Context;
+
+	// Only touched on the game thread
+	TFunction<void(UBitmapJob*)> OnCompleted;
+
+	EBitmapJobState State;
+};
@@ -0,0 +1,97 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Progress and cancellation of the bitmap job a thread is working for (see UBitmapJob). FBitmapParallel looks the job up before splitting
+// work, skips the batches of rows or tiles left once it's cancelled and reports the batches done, so every operation built on it can be
+// followed and cancelled without knowing about jobs. It is also where jobs of a higher priority take over the threads of running ones,
+// between two batches (see FBitmapJobScheduler and FBitmapParallel::ForRange).
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+
+class FBitmapJobContext
+{
+public:
+
+	/* Makes a job the one the calling thread works for, until the scope ends. */
+	class FScope
+	{
+	public:
+		explicit FScope(FBitmapJobContext& Context);
+		~FScope();
+
+	private:
+		FBitmapJobContext* Previous;
+	};
+
+	FBitmapJobContext();
+
+	/* The job the calling thread works for, null outside jobs. */
+	static FBitmapJobContext* GetCurrent();
+
+	/* Asks the job to stop. Work already running finishes its batch, the rest is skipped. Any thread. */
+	void Cancel();
+
+	bool IsCancelled() const;
+
+	/* Maps the progress reported from now on to [Begin, End] of the whole job, e.g. 0 to 0.5 for the first of two steps of the same cost. */
+	void SetStage(float Begin, float End);
+
+	/* Progress within the current stage, from 0 to 1. The job's progress never goes back, smaller values are ignored. */
+	void ReportProgress(float StageProgress);
+
+	/* Starts a pass over rows or tiles and returns where the job's progress stood. Operations don't say how many passes they make, so each one
+	covers half of what's left of the stage: the progress keeps moving whatever their number.
+	*/
+	float BeginPass() const;
+
+	/* Progress within a pass started at PassStart, from 0 to 1. */
+	void ReportPassProgress(float PassStart, float PassProgress);
+
+	/* Progress of the whole job, from 0 to 1. Any thread. */
+	float GetProgress() const;
+
+	/* Priority the job is scheduled with. Any thread, changed through FBitmapJobScheduler::SetPriority. */
+	EBitmapJobPriority GetPriority() const;
+	void SetPriority(EBitmapJobPriority NewPriority);
+
+	/* Priority the job runs at: its own, or that of a more urgent job waiting on the decode memory it holds if higher. Any thread. */
+	EBitmapJobPriority GetEffectivePriority() const;
+
+	/* Raises the priority the job runs at to Inherited until it's done, if that's higher. Any thread, see FBitmapJobScheduler. */
+	void InheritPriority(EBitmapJobPriority Inherited);
+
+	/* Whether a thread took the job out of the queue. Any thread. */
+	bool IsStarted() const;
+	void MarkStarted();
+
+	/* Whether a job more urgent than this one's effective priority is queued. Any thread, costs an atomic read. */
+	bool HasHigherPriorityQueued() const;
+
+	/* Called on the job's own thread between batches of its rows or tiles: runs the queued jobs of a higher priority on it first, so they
+	don't wait for this one to be done. Costs an atomic read when there are none.
+	@return		Whether any ran. Queued jobs can't start while their decode memory isn't free.
+	*/
+	bool YieldToHigherPriority() const;
+
+	/* Called each time the progress goes past a whole percent, on the thread reporting it. Set before the job starts. */
+	TFunction<void(float)> OnProgressStep;
+
+private:
+
+	/* Raises the progress to Value (0 to 1) if it's higher. */
+	void RaiseProgress(float Value);
+
+	volatile int32 bCancelled;
+	volatile int32 bStarted;
+	volatile int32 Priority;
+	volatile int32 InheritedPriority;
+
+	// Fixed point, out of ProgressScale, so it can be raised with a compare and swap
+	volatile int32 Progress;
+
+	// Only changed by the job's thread, between passes
+	float StageBegin;
+	float StageEnd;
+};
@@ -0,0 +1,28 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Mip chain generation on the CPU: every level is a 2x2 box average of the one above it, done in linear light for sRGB textures.
+// Levels are kept in 16 bits per channel while the chain is built so rounding doesn't pile up from one level to the next.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapMipChain
+{
+public:
+
+	/* Number of levels of a full chain, Size itself included, down to 1x1. */
+	static int32 GetNumMips(FImageSize Size);
+
+	/* Size of a level: each one is half the previous one, rounded down, and never less than 1 pixel. */
+	static FImageSize GetMipSize(FImageSize Size, int32 MipIndex);
+
+	/* Builds levels 1 to Mips.Num() from the pixels of level 0, which may be a rectangle of a bigger bitmap. Mips[I] receives level I + 1, of
+	GetMipSize(Pixels.GetSize(), I + 1) contiguous pixels: the levels are laid out as a texture's mips, which is what they're for.
+	Pixels are 4 bytes with alpha last, so both FColor (BGRA) and RGBA data work. Odd sizes fold their last row or column into the last output pixels.
+	@param bSRGB	Whether the colour channels are sRGB encoded, in which case they are averaged in linear light. Alpha is always averaged as it is.
+	*/
+	static void Generate(FConstBitmapView Pixels, bool bSRGB, const TArray<FColor*>& Mips);
+};
@@ -0,0 +1,26 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Morphological operators with rectangular structuring elements, using the van Herk / Gil-Werman algorithm: about 3 min or max per pixel and
+// direction whatever the size of the rectangle. Columns are filtered 16 bytes at a time, rows go through the same code after a transpose.
+// Pixels outside the bitmap are ignored, as if the rectangle was cut at the edges.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapMorphology
+{
+public:
+
+	// Biggest radius the operators accept in each direction
+	static const int32 MaxRadius = 255;
+
+	/* Applies Operation with a (2 * RadiusX + 1) x (2 * RadiusY + 1) rectangle.
+	Single channels (R, G, B or A) are pulled out to one byte per pixel first, the other channel selections filter the 4 channels together.
+	@param Src		The pixels to filter, e.g. a rectangle of a bigger bitmap. The rectangle's edges are the edges the operators stop at.
+	@param Dst		Receives Src's size in pixels, may be the same pixels as Src.
+	*/
+	static void Apply(FConstBitmapView Src, EBitmapMorphologyOperation Operation, int32 RadiusX, int32 RadiusY, EFilterColourChannel ColourChannel, FBitmapView Dst);
+};
@@ -0,0 +1,37 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Rotations by quarter turns, flips and transposes. Operations that swap the axes go through 32x32 tiles of 4x4 SIMD transposes, so both
+// the rows read and the rows written stay in cache; tiles are spread across threads.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapOrientation
+{
+public:
+
+	/* Whether Orientation swaps the width and the height. */
+	static bool SwapsAxes(EBitmapOrientation Orientation);
+
+	/* Size of a Size bitmap once reoriented. */
+	static FImageSize GetOrientedSize(FImageSize Size, EBitmapOrientation Orientation);
+
+	/* Writes Src reoriented to Dst.
+	@param Src		The pixels to reorient, e.g. a rectangle of a bigger bitmap.
+	@param Dst		Receives GetOrientedSize(Src.GetSize(), Orientation) pixels, can't overlap Src.
+	*/
+	static void Reorient(FConstBitmapView Src, EBitmapOrientation Orientation, FBitmapView Dst);
+
+	/* Reorients the pixels where they are. Flips and half turns always can be, operations that swap the axes only on square views.
+	@return		False, with the pixels untouched, when the geometry doesn't allow it.
+	*/
+	static bool ReorientInPlace(FBitmapView Pixels, EBitmapOrientation Orientation);
+
+	/* The operation that puts upright a photo tagged with that EXIF orientation (1 to 8).
+	@return		False for 1 (already upright) and values out of range.
+	*/
+	static bool FromExifOrientation(int32 ExifOrientation, EBitmapOrientation& OutOrientation);
+};
@@ -0,0 +1,69 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Gaussian and Laplacian image pyramids (Burt and Adelson), and the multiband blend built on them. Every level is half the size of the one
+// above it, filtered with the separable 5 tap kernel [1 4 6 4 1] / 16. Pixels are kept as 4 floats so a Laplacian level can hold the
+// negative differences, all levels live in one allocation and each level is spread across threads by rows.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapPyramid
+{
+public:
+
+	/* Number of levels down to a 1x1 level, Size itself included. */
+	static int32 GetMaxLevels(FImageSize Size);
+
+	/* Size of a level: each one is half the previous one, rounded up. */
+	static FImageSize GetLevelSize(FImageSize Size, int32 Level);
+
+	/* Allocates NumLevels levels (all of them when 0 or less, at most GetMaxLevels) for a level 0 of Size. The pixels are left uninitialised. */
+	void Init(FImageSize Size, int32 NumLevels);
+
+	/* Level 0 from the pixels of Src, then every level from the one above it. */
+	void BuildGaussian(FConstBitmapView Src, int32 NumLevels);
+
+	/* Same as BuildGaussian followed by ToLaplacian. */
+	void BuildLaplacian(FConstBitmapView Src, int32 NumLevels);
+
+	/* Fills levels 1 and below by reducing level 0, whatever it holds. */
+	void Reduce();
+
+	/* Turns a Gaussian pyramid into a Laplacian one in place: every level but the last keeps what the level below it doesn't hold. */
+	void ToLaplacian();
+
+	/* Turns a Laplacian pyramid back into a Gaussian one in place, level 0 ending up as the image it was built from. */
+	void Collapse();
+
+	/* Writes level Level to pixels, channels clamped. Dst is GetLevelSize(Level). */
+	void GetPixels(int32 Level, FBitmapView Dst) const;
+
+	int32 GetNumLevels() const { return LevelSizes.Num(); }
+
+	FImageSize GetLevelSize(int32 Level) const { return LevelSizes[Level]; }
+
+	/* A level's pixels, a row after the other. Channels go from 0 to 1, in the memory order of FColor (B, G, R, A). */
+	VectorRegister* GetLevel(int32 Level) { return Pixels.GetData() + LevelOffsets[Level]; }
+	const VectorRegister* GetLevel(int32 Level) const { return Pixels.GetData() + LevelOffsets[Level]; }
+
+	/* Blends A into B band by band: every level of their Laplacian pyramids is mixed through the Gaussian pyramid of Mask, so fine details
+	switch over a few pixels and broad areas (colour, exposure) over a wide band, which hides the seam.
+	@param Mask			How much of A to keep, read from the red channel: 255 keeps A, 0 keeps B.
+	@param NumLevels	Levels of the pyramids. 0 or less goes down to about 8 pixels on the shorter side: past that the lowest level is little
+						more than the average colour, and blending it would tint all of A and B alike.
+	@param Dst			Receives the blend. A, B, Mask and Dst are the same size, any of them may be a rectangle of a bigger bitmap and Dst may be
+						the same pixels as A or B.
+	*/
+	static void BlendMultiband(FConstBitmapView A, FConstBitmapView B, FConstBitmapView Mask, int32 NumLevels, FBitmapView Dst);
+
+private:
+
+	/* Every level, one after the other. */
+	TArray<VectorRegister> Pixels;
+
+	TArray<int64> LevelOffsets;
+	TArray<FImageSize> LevelSizes;
+};
@@ -0,0 +1,29 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Median and percentile filters: each pixel becomes a given rank of the square of pixels around it, channel by channel.
+// Edges repeat the border pixels. Work is split in column strips spread across threads.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapRankFilter
+{
+public:
+
+	// Biggest radius the filters accept
+	static const int32 MaxRadius = 15;
+
+	/* Each pixel becomes the value at Percentile (0 to 100, 50 being the median) of the (2 * Radius + 1)² square around it.
+	Radius 1 runs a sorting network on all 4 channels of 4 pixels at once, bigger radii use the constant time histogram
+	algorithm from Perreault and Hébert ("Median Filtering in Constant Time", 2007).
+	@param Src		The pixels to filter, e.g. a rectangle of a bigger bitmap. Its edge pixels are repeated past it.
+	@param Dst		Receives Src's size in pixels, can't overlap Src.
+	*/
+	static void Filter(FConstBitmapView Src, int32 Radius, float Percentile, EFilterColourChannel ColourChannel, FBitmapView Dst);
+
+	/* Rank within the (2 * Radius + 1)² sorted samples that Percentile selects. */
+	static int32 GetRank(int32 Radius, float Percentile);
+};
@@ -0,0 +1,34 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Copies between rectangles of bitmaps: crop, paste, pad and tile. Every row is moved with memcpy (in runs when it wraps around), so working on
+// a small region of a big canvas only touches that region.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapRegion
+{
+public:
+
+	/* Copies Src into Dst, which must be the same size. The views may overlap, e.g. when moving a rectangle of a bitmap within it. */
+	static void Copy(FConstBitmapView Src, FBitmapView Dst);
+
+	/* Copies Src into Dst with its top left corner at (X, Y) of Dst. Whatever falls outside Dst is left out.
+	@return		Whether any pixel was written.
+	*/
+	static bool Paste(FConstBitmapView Src, FBitmapView Dst, int32 X, int32 Y);
+
+	/* Copies the Rect.Width x Rect.Height pixels under Rect into Dst. Rect may reach outside Src, those pixels follow BorderMode, which is also
+	how padding and tiling are done.
+	*/
+	static void Crop(FConstBitmapView Src, FImageRect Rect, EBitmapBorderMode BorderMode, FColor BorderColour, FBitmapView Dst);
+
+	/* Crop with Left, Top, Right and Bottom extra pixels on each side of Src. Dst is (Src.Width + Left + Right) x (Src.Height + Top + Bottom). */
+	static void Pad(FConstBitmapView Src, int32 Left, int32 Top, int32 Right, int32 Bottom, EBitmapBorderMode BorderMode, FColor BorderColour, FBitmapView Dst);
+
+	/* Repeats Src over the whole of Dst, starting from its top left corner. */
+	static void Tile(FConstBitmapView Src, FBitmapView Dst);
+};
@@ -0,0 +1,29 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Separable resampling: the rows are resampled to the new width, then the columns to the new height (see FBitmapLinePass), spread across threads.
+// Each output pixel reads a fixed run of source pixels with weights worked out once per row and column. Edges repeat the border pixels.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapResampler
+{
+public:
+
+	/* Resamples Src to the size of Dst. When shrinking, the filter is stretched to cover every source pixel so nothing aliases.
+	@param Src					The pixels to resample, e.g. a rectangle of a bigger bitmap.
+	@param bLinearLight			Filters in linear light: sRGB values are decoded first and encoded again at the end.
+	@param bPremultipliedAlpha	Filters colours multiplied by alpha, so transparent pixels don't bleed into their neighbours.
+	@param Dst					Receives the resampled pixels. May overlap Src, which is read whole before Dst is written.
+	*/
+	static void Resize(FConstBitmapView Src, EBitmapResampleFilter Filter, bool bLinearLight, bool bPremultipliedAlpha, FBitmapView Dst);
+
+	/* How far from its centre the filter reaches, in pixels, at scale 1. */
+	static float GetFilterSupport(EBitmapResampleFilter Filter);
+
+	/* Filter weight at X pixels from its centre, at scale 1. */
+	static float EvaluateFilter(EBitmapResampleFilter Filter, float X);
+};
@@ -0,0 +1,29 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Reads many pixels of a bitmap at once, at pixel coordinates or at UVs, for colour picking and probes.
+// Filtering is shared with the warps (see BitmapInterpolation.h). Big batches are split across threads.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class FBitmapSampler
+{
+public:
+
+	/* Reads the pixel at each of Points. Points outside the bitmap follow BorderMode.
+	@param Src		The bitmap, or a rectangle of one whose edges Points are relative to. Any 4 byte channel order works, it is kept as it is.
+	@param Dst		Receives Num pixels.
+	*/
+	static void SamplePixels(FConstBitmapView Src, const FIntPoint* Points, int32 Num, EBitmapBorderMode BorderMode, FColor BorderColour, FColor* Dst);
+
+	/* Samples the bitmap at each of UVs: (0, 0) is the top left corner of the first pixel and (1, 1) the bottom right corner of the last one,
+	so pixel centres are at (X + 0.5) / Src.Width. Taps outside the bitmap follow BorderMode.
+	@param Src		The bitmap, or a rectangle of one that the UVs span. Any 4 byte channel order works, it is kept as it is.
+	@param Dst		Receives Num pixels.
+	*/
+	static void SampleUVs(FConstBitmapView Src, const FVector2D* UVs, int32 Num, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode, FColor BorderColour,
+		FColor* Dst);
+};
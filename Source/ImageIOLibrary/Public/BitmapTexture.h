@@ -0,0 +1,62 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Runtime textures made from pixels held on the CPU.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+class UTexture2D;
+
+class FBitmapTexture
+{
+public:
+
+	/* Creates a transient texture from Size.X * Size.Y RGBA pixels (4 bytes each, red first).
+	@param bGenerateMips	Also fills in the rest of the mip chain, down to 1x1 (see FBitmapMipChain), averaged in linear light since the texture is sRGB.
+	@param Compression		GPU format to compress every mip to (see FBitmapBlockCompression). Block compressed textures need a width and height that are
+							multiples of 4, other sizes are created uncompressed with a warning.
+	@return					The texture, with its resource already updated, or null if it couldn't be created.
+	*/
+	static UTexture2D* CreateTransient(const void* Pixels, FImageSize Size, bool bGenerateMips, EBitmapTextureCompression Compression);
+
+	/* Copies Rects of Bitmap, which is as big as Texture's first mip, to that mip: on the GPU through a render command that owns its own copy of
+	the pixels, and to the CPU copy of the mip when the texture kept it. Texture must be PF_R8G8B8A8 or PF_B8G8R8A8, Rects inside the bitmap.
+	*/
+	static void UpdateRegions(UTexture2D* Texture, const FColor* Bitmap, const TArray<FImageRect>& Rects);
+
+	/* Same as UpdateRegions, for pixels that aren't part of a bitmap as big as the texture: each of Sources is copied with its top left corner
+	at the matching Positions, which must keep it inside the texture.
+	*/
+	static void UploadBitmaps(UTexture2D* Texture, const TArray<FConstBitmapView>& Sources, const TArray<FIntPoint>& Positions);
+
+	/* Rebuilds every mip past the first from the CPU copy of the first one and uploads them, the same way as UpdateRegions.
+	Does nothing for textures without mips or without their pixels on the CPU.
+	*/
+	static void UpdateMips(UTexture2D* Texture);
+
+	/* Copies the first mip of Texture to Dst as FColor (BGRA), straight from its CPU copy: the texture and its resource are left untouched.
+	In the editor, textures that can't be read that way (compressed imported assets) are read from their source pixels instead.
+	@param Dst		Receives GetSizeX() * GetSizeY() pixels.
+	@return			False if the texture isn't PF_R8G8B8A8 or PF_B8G8R8A8, or has no CPU copy of its pixels (cooked textures usually don't), and
+					has no source pixels of the same size in a format that converts to FColor (BGRA8, G8 or RGBA16).
+	*/
+	static bool ReadPixels(UTexture2D* Texture, FColor* Dst);
+
+	/* Locks the CPU copy of the first mip of Texture for reading, to be unlocked with UnlockPixels.
+	@param bOutSwapRedBlue	Whether red and blue are swapped compared to FColor (PF_R8G8B8A8 textures).
+	@return					Null, with nothing locked, if the texture isn't PF_R8G8B8A8 or PF_B8G8R8A8 or has no CPU copy of its pixels.
+	*/
+	static const FColor* LockPixels(UTexture2D* Texture, bool& bOutSwapRedBlue);
+
+	static void UnlockPixels(UTexture2D* Texture);
+
+private:
+
+#if WITH_EDITORONLY_DATA
+	/* ReadPixels from the pixels the texture was imported from. */
+	static bool ReadSourcePixels(UTexture2D* Texture, FColor* Dst);
+#endif
+};
@@ -0,0 +1,68 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Recycles runtime textures: released textures are kept, with their GPU resource, until a texture of the same size, format and mip count is
+// asked for again. Filling a recycled texture is a pixel upload instead of a new UObject and a new RHI allocation.
+// Only used from the game thread.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "ImageIOLibraryBPLibrary.h"
+
+class UTexture2D;
+
+class FBitmapTexturePool : public FGCObject
+{
+public:
+
+	/* The pool, created the first time it's asked for. */
+	static FBitmapTexturePool& Get();
+
+	/* Drops the pool and everything in it, when the module shuts down. */
+	static void Shutdown();
+
+	/* A released texture of that size, format and mip count, taken out of the pool. Its pixels are whatever it held last.
+	@return		Null when there isn't one: the caller creates the texture then, and reports it with AddCreated once it exists.
+	*/
+	UTexture2D* Acquire(FImageSize Size, EPixelFormat Format, int32 NumMips);
+
+	/* Counts a texture created because Acquire had none, in the stats. */
+	void AddCreated() { NumCreated++; }
+
+	/* Puts a texture back in the pool. The oldest textures are dropped when the pool goes over ImageIO.TexturePoolBudget.
+	@return		False if the texture can't be pooled: it isn't a transient PF_R8G8B8A8 texture with its pixels on the CPU, or it is already pooled.
+	*/
+	bool Release(UTexture2D* Texture);
+
+	/* Drops every pooled texture, the garbage collector frees them. */
+	void Empty();
+
+	FTexturePoolStats GetStats() const;
+
+	//~ FGCObject interface, keeps the pooled textures alive
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+
+private:
+
+	struct FPooledTexture
+	{
+		UTexture2D* Texture;
+		FImageSize Size;
+		EPixelFormat Format;
+		int32 NumMips;
+		int64 Bytes;
+	};
+
+	FBitmapTexturePool();
+
+	/* Drops the oldest textures until the pool holds at most MaxBytes. */
+	void Trim(int64 MaxBytes);
+
+	// Oldest released first
+	TArray<FPooledTexture> FreeTextures;
+	int64 FreeBytes;
+	int32 NumCreated;
+	int32 NumReused;
+};
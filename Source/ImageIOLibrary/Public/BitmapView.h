@@ -0,0 +1,84 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// A window onto pixels owned by someone else: a whole bitmap or a rectangle of one, without copying anything.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+
+/* Width x Height pixels starting at Data, with rows Pitch pixels apart. A view of a rectangle of a bitmap keeps the bitmap's pitch, so its rows
+aren't contiguous with each other. PixelType is FColor for views that can be written to and const FColor for read only ones.
+*/
+template<typename PixelType>
+struct TBitmapView
+{
+	PixelType* Data;
+	int32 Width;
+	int32 Height;
+	int32 Pitch;
+
+	TBitmapView()
+		: Data(nullptr)
+		, Width(0)
+		, Height(0)
+		, Pitch(0)
+	{
+	}
+
+	TBitmapView(PixelType* InData, int32 InWidth, int32 InHeight, int32 InPitch)
+		: Data(InData)
+		, Width(InWidth)
+		, Height(InHeight)
+		, Pitch(InPitch)
+	{
+	}
+
+	/* The whole of a contiguous Size.X * Size.Y bitmap. */
+	TBitmapView(PixelType* InData, FImageSize Size)
+		: Data(InData)
+		, Width(Size.X)
+		, Height(Size.Y)
+		, Pitch(Size.X)
+	{
+	}
+
+	/* Writable views can be read through. */
+	template<typename OtherPixelType>
+	TBitmapView(const TBitmapView<OtherPixelType>& Other)
+		: Data(Other.Data)
+		, Width(Other.Width)
+		, Height(Other.Height)
+		, Pitch(Other.Pitch)
+	{
+	}
+
+	FORCEINLINE PixelType* GetRow(int32 Y) const
+	{
+		return Data + (int64)Y * Pitch;
+	}
+
+	FORCEINLINE FImageSize GetSize() const
+	{
+		return FImageSize(Width, Height);
+	}
+
+	/* Whether the rows follow each other in memory, i.e. the view can be handed to operations taking a plain Width * Height bitmap. */
+	FORCEINLINE bool IsContiguous() const
+	{
+		return Pitch == Width || Height <= 1;
+	}
+
+	/* The part of this view inside Rect, which is clipped to the view first. */
+	TBitmapView GetSubView(FImageRect Rect) const
+	{
+		const int32 Left = FMath::Clamp(Rect.X, 0, Width);
+		const int32 Top = FMath::Clamp(Rect.Y, 0, Height);
+		const int32 Right = FMath::Clamp((int32)FMath::Min((int64)Rect.X + Rect.Width, (int64)MAX_int32), Left, Width);
+		const int32 Bottom = FMath::Clamp((int32)FMath::Min((int64)Rect.Y + Rect.Height, (int64)MAX_int32), Top, Height);
+		return TBitmapView(GetRow(Top) + Left, Right - Left, Bottom - Top, Pitch);
+	}
+};
+
+typedef TBitmapView<FColor> FBitmapView;
+typedef TBitmapView<const FColor> FConstBitmapView;
@@ -0,0 +1,56 @@
+// Copyright Lambda Works, Samuel Metters 2020. All rights reserved.
+
+// Affine and perspective warps. Every output pixel is mapped back into the source through a 3x3 matrix and sampled there (see
+// BitmapInterpolation.h). Source coordinates are stepped along each row instead of going through the matrix for every pixel; the output
+// is split in tiles spread across threads, each tile starting its rows from the matrix again so the stepping error can't build up.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageIOLibraryBPLibrary.h"
+#include "BitmapView.h"
+
+/* A 3x3 matrix acting on homogeneous pixel coordinates (X, Y, 1): (0, 0) is the top left corner of a bitmap, (Width, Height) its bottom right
+corner. Affine when the last row is (0, 0, 1).
+*/
+struct FBitmapHomography
+{
+	double M[3][3];
+
+	/* The identity. */
+	FBitmapHomography();
+
+	/* From 9 values, a row after the other. */
+	static FBitmapHomography FromRowMajor(const float* Values);
+
+	static FBitmapHomography MakeScale(double ScaleX, double ScaleY);
+
+	/* The homography mapping the corners of the unit square (0, 0), (1, 0), (1, 1) and (0, 1) to Corners, in that order.
+	@return		False when 3 of the corners are on a line.
+	*/
+	static bool MakeUnitSquareToQuad(const FVector2D* Corners, FBitmapHomography& OutHomography);
+
+	/* This applied after Other. */
+	FBitmapHomography operator*(const FBitmapHomography& Other) const;
+
+	/* @return		False when the matrix can't be inverted. */
+	bool Inverse(FBitmapHomography& OutInverse) const;
+
+	bool IsAffine() const;
+};
+
+class FBitmapWarp
+{
+public:
+
+	/* Fills Dst by sampling Src where OutputToSource sends the centre of each output pixel.
+	@param Src				The pixels to sample, e.g. a rectangle of a bigger bitmap: (0, 0) is its top left corner and its edges are where
+							BorderMode takes over.
+	@param OutputToSource	Maps Dst pixel coordinates to Src pixel coordinates. Output pixels sent to infinity (or behind the viewer,
+							for perspective warps) get BorderColour.
+	@param BorderMode		What samples outside the source read.
+	@param Dst				Receives the warped pixels, can't overlap Src.
+	*/
+	static void Warp(FConstBitmapView Src, const FBitmapHomography& OutputToSource, EBitmapSampleFilter Filter, EBitmapBorderMode BorderMode, FColor BorderColour,
+		FBitmapView Dst);
+};
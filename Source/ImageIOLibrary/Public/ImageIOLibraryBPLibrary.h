@@ -16,6 +16,9 @@
 #include "IImageWrapperModule.h"
 #include "ImageIOLibraryBPLibrary.generated.h"
 
+class UBitmapAtlas;
+class UBitmapJob;
+
 /* Image format to import/Export */
 UENUM(BlueprintType)
 enum class EImageIOFormat : uint8
@@ -104,6 +107,165 @@ struct FImageSize
 	}
 };
 
+/* A rectangle of pixels in a bitmap: its top left corner and its size. */
+USTRUCT(BlueprintType)
+struct FImageRect
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, Category = "Image Rect Property")
+	int X;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Image Rect Property")
+	int Y;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Image Rect Property")
+	int Width;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Image Rect Property")
+	int Height;
+
+	FImageRect()
+	{
+		X = 0;
+		Y = 0;
+		Width = 0;
+		Height = 0;
+	}
+
+	FImageRect(int InX, int InY, int InWidth, int InHeight)
+	{
+		X = InX;
+		Y = InY;
+		Width = InWidth;
+		Height = InHeight;
+	}
+};
+
+/* How the pool of reusable textures is doing (see CreatePooledTexture2DFromBitmap). */
+USTRUCT(BlueprintType)
+struct FTexturePoolStats
+{
+	GENERATED_BODY()
+
+	/* Released textures waiting to be reused. */
+	UPROPERTY(BlueprintReadOnly, Category = "Texture Pool Property")
+	int FreeTextures;
+
+	/* Memory held by the released textures, in megabytes. */
+	UPROPERTY(BlueprintReadOnly, Category = "Texture Pool Property")
+	float FreeMegabytes;
+
+	/* Pooled textures that had to be created because none of the right size was free. */
+	UPROPERTY(BlueprintReadOnly, Category = "Texture Pool Property")
+	int CreatedTextures;
+
+	/* Pooled textures that were reused instead of created. */
+	UPROPERTY(BlueprintReadOnly, Category = "Texture Pool Property")
+	int ReusedTextures;
+
+	/* Share of the pooled textures that were reused, from 0 to 1. */
+	UPROPERTY(BlueprintReadOnly, Category = "Texture Pool Property")
+	float ReuseRate;
+
+	FTexturePoolStats()
+	{
+		FreeTextures = 0;
+		FreeMegabytes = 0.0f;
+		CreatedTextures = 0;
+		ReusedTextures = 0;
+		ReuseRate = 0.0f;
+	}
+};
+
+/* Memory held by the image files being decoded (see ImageIO.DecodeMemoryBudget). */
+USTRUCT(BlueprintType)
+struct FDecodeMemoryStats
+{
+	GENERATED_BODY()
+
+	/* Memory reserved by the decodes running now, in megabytes. */
+	UPROPERTY(BlueprintReadOnly, Category = "Decode Memory Property")
+	float UsedMegabytes;
+
+	/* Most memory reserved at once since the start or the last ResetDecodeMemoryPeak, in megabytes. */
+	UPROPERTY(BlueprintReadOnly, Category = "Decode Memory Property")
+	float PeakMegabytes;
+
+	/* The cap decodes are started under, in megabytes. 0 when there is none. */
+	UPROPERTY(BlueprintReadOnly, Category = "Decode Memory Property")
+	float BudgetMegabytes;
+
+	/* Decodes running now. */
+	UPROPERTY(BlueprintReadOnly, Category = "Decode Memory Property")
+	int Decodes;
+
+	/* Decodes not started yet: decode jobs still queued for a thread or for memory, and decodes waiting for memory on other threads. */
+	UPROPERTY(BlueprintReadOnly, Category = "Decode Memory Property")
+	int WaitingDecodes;
+
+	FDecodeMemoryStats()
+	{
+		UsedMegabytes = 0.0f;
+		PeakMegabytes = 0.0f;
+		BudgetMegabytes = 0.0f;
+		Decodes = 0;
+		WaitingDecodes = 0;
+	}
+};
+
+/* Where an image added to a texture atlas ended up (see AddBitmapToAtlas). */
+USTRUCT(BlueprintType)
+struct FBitmapAtlasEntry
+{
+	GENERATED_BODY()
+
+	/* The atlas page holding the image, null if it couldn't be added. */
+	UPROPERTY(BlueprintReadOnly, Category = "Atlas Entry Property")
+	UTexture2D* Texture;
+
+	/* Index of that page in GetAtlasTextures. */
+	UPROPERTY(BlueprintReadOnly, Category = "Atlas Entry Property")
+	int Page;
+
+	/* The image's pixels in the page, padding excluded. */
+	UPROPERTY(BlueprintReadOnly, Category = "Atlas Entry Property")
+	FImageRect Rect;
+
+	/* Top left corner of the image in the page, from 0 to 1. */
+	UPROPERTY(BlueprintReadOnly, Category = "Atlas Entry Property")
+	FVector2D UVMin;
+
+	/* Bottom right corner of the image in the page, from 0 to 1. */
+	UPROPERTY(BlueprintReadOnly, Category = "Atlas Entry Property")
+	FVector2D UVMax;
+
+	FBitmapAtlasEntry()
+	{
+		Texture = nullptr;
+		Page = INDEX_NONE;
+		UVMin = FVector2D(0.0f, 0.0f);
+		UVMax = FVector2D(0.0f, 0.0f);
+	}
+};
+
+/* What filters read when they need pixels from outside the bitmap. */
+UENUM(BlueprintType)
+enum class EBitmapBorderMode : uint8
+{
+	/** Repeat the edge pixels. */
+	Clamp		UMETA(DisplayName = "Clamp"),
+
+	/** Read from the opposite side, as if the bitmap was tiled. */
+	Wrap		UMETA(DisplayName = "Wrap"),
+
+	/** Mirror the bitmap around its edge pixels. */
+	Mirror		UMETA(DisplayName = "Mirror"),
+
+	/** Read a constant colour (BorderColour). */
+	Constant	UMETA(DisplayName = "Constant"),
+};
+
 /* Bitmap filter, Kernel, Convolution Matrix there are so many names for these. See https://en.wikipedia.org/wiki/Kernel_(image_processing) .*/
 USTRUCT(BlueprintType)
 struct FBitmapFilter 
@@ -130,6 +292,18 @@ struct FBitmapFilter
 	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
 	EFilterColourChannel ColourChannel;
 
+	/* What the filter reads past the edges of the bitmap. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	EBitmapBorderMode BorderMode;
+
+	/* The colour read past the edges when BorderMode is Constant. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	FColor BorderColour;
+
+	/* With the RGBA channel, filters alpha along with the colours. Off by default: each pixel keeps its alpha, as ApplyBitmapFilter always has. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	bool FilterAlpha;
+
 	FBitmapFilter()
 	{
 		Size = FImageSize(3,3);
@@ -141,6 +315,9 @@ struct FBitmapFilter
 		Factor = 1.0f;
 		Bias = 0.0f;
 		ColourChannel = EFilterColourChannel::RGB;
+		BorderMode = EBitmapBorderMode::Clamp;
+		BorderColour = FColor(0, 0, 0, 0);
+		FilterAlpha = false;
 	}
 
 	FBitmapFilter(FImageSize InSize, TArray<float> InFilter)
@@ -150,6 +327,9 @@ struct FBitmapFilter
 		Factor = 1.0f;
 		Bias = 0.0f;
 		ColourChannel = EFilterColourChannel::RGB;
+		BorderMode = EBitmapBorderMode::Clamp;
+		BorderColour = FColor(0, 0, 0, 0);
+		FilterAlpha = false;
 	}
 
 	FBitmapFilter(FImageSize InSize, TArray<float> InFilter, float InFactor, float InBias, EFilterColourChannel InColourChannel)
@@ -159,6 +339,66 @@ struct FBitmapFilter
 		Factor = InFactor;
 		Bias = InBias; 
 		ColourChannel = InColourChannel;
+		BorderMode = EBitmapBorderMode::Clamp;
+		BorderColour = FColor(0, 0, 0, 0);
+		FilterAlpha = false;
+	}
+};
+
+/* A filter given as a row and a column vector, the full matrix being Column * Row. Blurs are usually separable, applying them this way costs Width + Height taps per pixel instead of Width * Height. */
+USTRUCT(BlueprintType)
+struct FSeparableBitmapFilter
+{
+	GENERATED_BODY()
+
+	/* The horizontal taps, applied first. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	TArray<float> RowFilter;
+
+	/* The vertical taps. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	TArray<float> ColumnFilter;
+
+	/* Matrix value multiplier, useful only if you want to work with integer matrix values, else leave default (=1). */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	float Factor;
+
+	/* Value added to every filtered pixel. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	float Bias;
+
+	/* Useful if you want to only apply the filter to a specifc channel. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	EFilterColourChannel ColourChannel;
+
+	/* What the filter reads past the edges of the bitmap. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	EBitmapBorderMode BorderMode;
+
+	/* The colour read past the edges when BorderMode is Constant. */
+	UPROPERTY(BlueprintReadWrite, Category = "FilterProperty")
+	FColor BorderColour;
+
+	FSeparableBitmapFilter()
+	{
+		RowFilter = { 1 };
+		ColumnFilter = { 1 };
+		Factor = 1.0f;
+		Bias = 0.0f;
+		ColourChannel = EFilterColourChannel::RGB;
+		BorderMode = EBitmapBorderMode::Clamp;
+		BorderColour = FColor(0, 0, 0, 0);
+	}
+
+	FSeparableBitmapFilter(TArray<float> InRowFilter, TArray<float> InColumnFilter, float InFactor, float InBias, EFilterColourChannel InColourChannel)
+	{
+		RowFilter = InRowFilter;
+		ColumnFilter = InColumnFilter;
+		Factor = InFactor;
+		Bias = InBias;
+		ColourChannel = InColourChannel;
+		BorderMode = EBitmapBorderMode::Clamp;
+		BorderColour = FColor(0, 0, 0, 0);
 	}
 };
 
@@ -174,9 +414,229 @@ enum EBitmapFilterType
 	EdgeDetection		UMETA(DisplayName = "Edge Detection"),
 };
 
+/* Blur algorithms. They all cost the same per pixel whatever the radius. */
+UENUM(BlueprintType)
+enum class EBitmapBlurMethod : uint8
+{
+	/** Plain average of the square around each pixel. Fastest, but looks boxy. */
+	Box				UMETA(DisplayName = "Box"),
+
+	/** Gaussian approximated by three box blurs. Nearly as fast as Box. */
+	FastGaussian	UMETA(DisplayName = "Fast Gaussian"),
+
+	/** Recursive (IIR) gaussian, the closest to a true gaussian blur. */
+	Gaussian		UMETA(DisplayName = "Gaussian"),
+};
+
+/* Morphological operators. Each one looks at the rectangle of pixels around each pixel, channel by channel. */
+UENUM(BlueprintType)
+enum class EBitmapMorphologyOperation : uint8
+{
+	/** Minimum of the rectangle: bright areas shrink, small bright specks disappear. */
+	Erode			UMETA(DisplayName = "Erode"),
+
+	/** Maximum of the rectangle: bright areas grow, small dark holes fill up. */
+	Dilate			UMETA(DisplayName = "Dilate"),
+
+	/** Erode then dilate: removes bright specks smaller than the rectangle and keeps the rest of the shapes as they were. */
+	Open			UMETA(DisplayName = "Open"),
+
+	/** Dilate then erode: fills dark holes and gaps smaller than the rectangle and keeps the rest of the shapes as they were. */
+	Close			UMETA(DisplayName = "Close"),
+
+	/** Dilate minus erode: outlines the edges of the shapes. */
+	Gradient		UMETA(DisplayName = "Gradient"),
+};
+
+/* Filters used to resample bitmaps, from the fastest and blurriest to the sharpest. */
+UENUM(BlueprintType)
+enum class EBitmapResampleFilter : uint8
+{
+	/** Average of the pixels each new pixel covers (nearest pixel when enlarging). */
+	Box				UMETA(DisplayName = "Box"),
+
+	/** Linear interpolation, a tent over 2 pixels. */
+	Bilinear		UMETA(DisplayName = "Bilinear"),
+
+	/** Catmull-Rom cubic, sharp with a little ringing. */
+	Bicubic			UMETA(DisplayName = "Bicubic"),
+
+	/** Mitchell-Netravali cubic, a balance between blur and ringing. */
+	Mitchell		UMETA(DisplayName = "Mitchell"),
+
+	/** Windowed sinc over 6 pixels, the sharpest. Can ring around hard edges. */
+	Lanczos3		UMETA(DisplayName = "Lanczos3"),
+};
+
+/* How pixels are read between pixel centres. */
+UENUM(BlueprintType)
+enum class EBitmapSampleFilter : uint8
+{
+	/** The pixel the point falls in. */
+	Nearest			UMETA(DisplayName = "Nearest"),
+
+	/** Blend of the 4 pixels around the point, like a texture sampled with bilinear filtering. */
+	Bilinear		UMETA(DisplayName = "Bilinear"),
+
+	/** Catmull-Rom blend of the 16 pixels around the point. Sharper than bilinear, especially when enlarging. */
+	Bicubic			UMETA(DisplayName = "Bicubic"),
+};
+
+/* Rotations and flips of a whole bitmap. Those that swap the axes turn a Width x Height bitmap into a Height x Width one. */
+UENUM(BlueprintType)
+enum class EBitmapOrientation : uint8
+{
+	/** Quarter turn clockwise. */
+	Rotate90		UMETA(DisplayName = "Rotate 90"),
+
+	/** Half turn. */
+	Rotate180		UMETA(DisplayName = "Rotate 180"),
+
+	/** Quarter turn counter clockwise. */
+	Rotate270		UMETA(DisplayName = "Rotate 270"),
+
+	/** Mirror left to right. */
+	FlipHorizontal	UMETA(DisplayName = "Flip Horizontal"),
+
+	/** Mirror top to bottom. */
+	FlipVertical	UMETA(DisplayName = "Flip Vertical"),
+
+	/** Mirror around the diagonal from the top left corner: rows become columns. */
+	Transpose		UMETA(DisplayName = "Transpose"),
+
+	/** Mirror around the diagonal from the top right corner. */
+	Transverse		UMETA(DisplayName = "Transverse"),
+};
+
+/* GPU formats runtime textures can be stored in. Compressed textures take less video memory and are decoded by the GPU as it samples them. */
+UENUM(BlueprintType)
+enum class EBitmapTextureCompression : uint8
+{
+	/** Uncompressed, 4 bytes per pixel. */
+	None			UMETA(DisplayName = "None"),
+
+	/** Half a byte per pixel. Alpha is either opaque or fully transparent (under 128). */
+	BC1				UMETA(DisplayName = "BC1 (DXT1)"),
+
+	/** A byte per pixel: BC1 colours plus a smooth alpha channel. */
+	BC3				UMETA(DisplayName = "BC3 (DXT5)"),
+
+	/** A byte per pixel, with better colours and alpha than BC3. Slower to compress. */
+	BC7				UMETA(DisplayName = "BC7"),
+};
+
+/* Porter-Duff compositing operators. "Source" is the layer being composited (the decal), "Destination" is what it gets composited onto (the photo). */
+UENUM(BlueprintType)
+enum class EBitmapCompositeOperation : uint8
+{
+	/** Both layers are removed. */
+	Clear				UMETA(DisplayName = "Clear"),
+
+	/** Only the source is kept. */
+	Source				UMETA(DisplayName = "Source"),
+
+	/** Only the destination is kept. */
+	Destination			UMETA(DisplayName = "Destination"),
+
+	/** Source on top of the destination (the usual "normal" layer blending). */
+	SourceOver			UMETA(DisplayName = "Source Over"),
+
+	/** Destination on top of the source. */
+	DestinationOver		UMETA(DisplayName = "Destination Over"),
+
+	/** Source, only where the destination is. */
+	SourceIn			UMETA(DisplayName = "Source In"),
+
+	/** Destination, only where the source is. */
+	DestinationIn		UMETA(DisplayName = "Destination In"),
+
+	/** Source, only where the destination isn't. */
+	SourceOut			UMETA(DisplayName = "Source Out"),
+
+	/** Destination, only where the source isn't. */
+	DestinationOut		UMETA(DisplayName = "Destination Out"),
+
+	/** Source on top of the destination, only where the destination is. */
+	SourceAtop			UMETA(DisplayName = "Source Atop"),
+
+	/** Destination on top of the source, only where the source is. */
+	DestinationAtop		UMETA(DisplayName = "Destination Atop"),
+
+	/** Source and destination, only where they don't overlap. */
+	Xor					UMETA(DisplayName = "Xor"),
+
+	/** Source + destination (clamped). */
+	Plus				UMETA(DisplayName = "Plus"),
+};
+
+/* Order in which bitmap jobs (see UBitmapJob) get threads. A job queued behind work of a lower priority runs first, and one queued while
+lower priority jobs hold every thread takes over one of them between two batches of their rows or tiles.
+*/
+UENUM(BlueprintType)
+enum class EBitmapJobPriority : uint8
+{
+	/** Work the user is waiting on, e.g. the image they just opened. */
+	Interactive			UMETA(DisplayName = "Interactive"),
+
+	/** Work whose result is on screen, e.g. the thumbnails in view. */
+	Visible				UMETA(DisplayName = "Visible"),
+
+	/** Work likely to be needed soon, e.g. the thumbnails just past the edge of the view. Never takes the last free thread. */
+	Prefetch			UMETA(DisplayName = "Prefetch"),
+
+	/** Work nobody waits on, e.g. bulk exports. Never takes the last free thread. */
+	Background			UMETA(DisplayName = "Background"),
+};
+
+/* Where a bitmap job (see UBitmapJob) stands. */
+UENUM(BlueprintType)
+enum class EBitmapJobState : uint8
+{
+	/** Waiting for a thread, see EBitmapJobPriority. */
+	Queued				UMETA(DisplayName = "Queued"),
+
+	/** Running on a background thread. */
+	Running				UMETA(DisplayName = "Running"),
+
+	/** Done, the result is in the job. */
+	Succeeded			UMETA(DisplayName = "Succeeded"),
+
+	/** Done without a result: see the log. */
+	Failed				UMETA(DisplayName = "Failed"),
+
+	/** Stopped by Cancel before it was done, without a result. */
+	Cancelled			UMETA(DisplayName = "Cancelled"),
+};
+
+/* A bitmap whose colour channels have already been multiplied by alpha. Keeping layers in this format means compositing them needs no per-pixel division. */
+USTRUCT(BlueprintType)
+struct FPremultipliedBitmap
+{
+	GENERATED_BODY()
+
+	/* The premultiplied pixels. */
+	UPROPERTY(BlueprintReadWrite, Category = "PremultipliedBitmapProperty")
+	TArray<FColor> Bitmap;
+
+	/* Resolution of the bitmap. */
+	UPROPERTY(BlueprintReadWrite, Category = "PremultipliedBitmapProperty")
+	FImageSize Size;
+
+	FPremultipliedBitmap()
+	{
+	}
+
+	FPremultipliedBitmap(TArray<FColor> InBitmap, FImageSize InSize)
+	{
+		Bitmap = MoveTemp(InBitmap);
+		Size = InSize;
+	}
+};
+
 
 //DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnBitmapBlurred, TArray<FColor>, OutBitmap, FImageSize, OutSize);
 DECLARE_DYNAMIC_DELEGATE_OneParam(FOnBitmapBlurred, UTexture2D*, Texture2D);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnBitmapJobCompleted, UBitmapJob*, Job);
 
 UCLASS()
 class UImageIOLibraryBPLibrary : public UBlueprintFunctionLibrary
@@ -189,15 +649,19 @@ public:
 
 	/* Loads the image at the specified path and returns a Texture2D. Supports PNG, JPEG, EXR, BMP, ICO and ICNS.
 	@param PathToImage	Path to the image file to load.
+	@param GenerateMips	Also creates every smaller mip of the texture, so it doesn't shimmer or waste bandwidth when drawn small. Takes a third more memory.
+	@param Compression	Compresses the texture on the CPU so it takes 4 to 8 times less video memory. Needs a width and height that are multiples of 4.
 	*/
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "CreateTexture2DFromImageFile", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
-		static bool CreateTexture2DFromImageFile(UTexture2D*& Texture2D, FImageSize &Size, FString PathToImage);
+		static bool CreateTexture2DFromImageFile(UTexture2D*& Texture2D, FImageSize &Size, FString PathToImage, bool GenerateMips = false, EBitmapTextureCompression Compression = EBitmapTextureCompression::None);
 
 	/* Creates a texture 2D from the specified Bitmap and image size.
-	@param Bitmap	The bitmap to create the Texture2D from.
+	@param Bitmap		The bitmap to create the Texture2D from.
+	@param GenerateMips	Also creates every smaller mip of the texture, so it doesn't shimmer or waste bandwidth when drawn small. Takes a third more memory.
+	@param Compression	Compresses the texture on the CPU so it takes 4 to 8 times less video memory. Needs a width and height that are multiples of 4.
 	*/
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "CreateTexture2DFromBitmap", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
-		static bool CreateTexture2DFromBitmap(UTexture2D*& Texture2D, TArray<FColor> Bitmap, FImageSize Size);
+		static bool CreateTexture2DFromBitmap(UTexture2D*& Texture2D, TArray<FColor> Bitmap, FImageSize Size, bool GenerateMips = false, EBitmapTextureCompression Compression = EBitmapTextureCompression::None);
 
 	/* Takes a screenshot and returns it as a Texture 2D. This doesn't capture the UI.
 	@param WorldContextObject	This has to be any valid object that is instanced in the world (if called from an actor or widget, you can use the Self node).
@@ -205,6 +669,63 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContextObject", UnsafeDuringActorConstruction = "true", DisplayName = "CreateTexture2DFromScreenshot(PIEEditorOnly)", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
 		static bool CreateTexture2DFromScreenshot(UTexture2D*& Texture2D, UObject* WorldContextObject);
 
+	/* Uploads the changed parts of a bitmap to a texture created from it, instead of creating a new texture. The upload is queued for the
+	render thread, the game thread doesn't wait for it. Only the first mip is updated.
+	@param Texture2D	An uncompressed texture of the same size as the bitmap (see CreateTexture2DFromBitmap).
+	@param Bitmap		The whole bitmap, with its changes.
+	@param DirtyRects	The rectangles that changed, clipped to the bitmap. The whole texture is updated when empty.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "UpdateTexture2DFromBitmap", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
+		static bool UpdateTexture2DFromBitmap(UTexture2D* Texture2D, const TArray<FColor>& Bitmap, FImageSize Size, TArray<FImageRect> DirtyRects);
+
+	/* Same as CreateTexture2DFromBitmap, but reuses a texture of the same size released with ReleasePooledTexture2D when there is one.
+	The bitmap is then uploaded to it instead of a new texture being created, which is much cheaper for thumbnails and previews.
+	@param Bitmap		The bitmap to create the Texture2D from.
+	@param GenerateMips	Also creates every smaller mip of the texture. Only textures with mips are reused for it, and the other way round.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CreatePooledTexture2DFromBitmap", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
+		static bool CreatePooledTexture2DFromBitmap(UTexture2D*& Texture2D, const TArray<FColor>& Bitmap, FImageSize Size, bool GenerateMips = false);
+
+	/* Gives a texture back to the pool so CreatePooledTexture2DFromBitmap can reuse it. Don't use the texture after releasing it.
+	Works with any uncompressed texture this library created. The pool keeps up to ImageIO.TexturePoolBudget megabytes (256 by default).
+	@param Texture2D	The texture you're done with.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ReleasePooledTexture2D", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
+		static bool ReleasePooledTexture2D(UTexture2D* Texture2D);
+
+	/* Drops every texture waiting in the pool, so the garbage collector can free them. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "EmptyTexturePool", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
+		static void EmptyTexturePool();
+
+	/* Returns how many textures the pool holds and how often it saved creating one. */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetTexturePoolStats", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
+		static FTexturePoolStats GetTexturePoolStats();
+
+
+	/* Creates an empty texture atlas. Many small images (icons, thumbnails) added to it end up in a few big textures, which widgets can share instead
+	of binding one texture per image. Images can be added at any time, those already in the atlas never move.
+	@param PageSize		Width and height of each texture of the atlas. New textures are added when the ones there are full.
+	@param Padding		Pixels kept around each image, filled with copies of its edge so neighbouring images don't bleed into each other when filtered.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CreateBitmapAtlas", Keywords = "ImageIOLibrary atlas sprite sheet"), Category = "Texture2D I/O")
+		static UBitmapAtlas* CreateBitmapAtlas(int32 PageSize = 2048, int32 Padding = 2);
+
+	/* Adds a bitmap to an atlas and uploads it.
+	@param Entry	The texture the bitmap went in, and its rectangle and UVs there (UVMin and UVMax make the UV region of a brush).
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "AddBitmapToAtlas", Keywords = "ImageIOLibrary atlas sprite sheet"), Category = "Texture2D I/O")
+		static bool AddBitmapToAtlas(FBitmapAtlasEntry& Entry, UBitmapAtlas* Atlas, const TArray<FColor>& Bitmap, FImageSize Size);
+
+	/* Loads image files and adds them all to an atlas at once, which packs them better than adding them one by one. Files are decoded in parallel.
+	@param Entries		Where each image went, in the same order as PathsToImages. Images that couldn't be loaded or added have a null Texture.
+	@return				Whether every image was added.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "AddImageFilesToAtlas", Keywords = "ImageIOLibrary atlas sprite sheet"), Category = "Texture2D I/O")
+		static bool AddImageFilesToAtlas(TArray<FBitmapAtlasEntry>& Entries, UBitmapAtlas* Atlas, const TArray<FString>& PathsToImages);
+
+	/* The textures of an atlas, in the order of the Page of its entries. */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetAtlasTextures", Keywords = "ImageIOLibrary atlas sprite sheet"), Category = "Texture2D I/O")
+		static TArray<UTexture2D*> GetAtlasTextures(UBitmapAtlas* Atlas);
 
 	/***** Texture 2D *****/
 
@@ -220,14 +741,16 @@ public:
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetTextureSize", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
 		static bool GetTextureSize(FImageSize &Size, int &PixelCount, UTexture2D* Texture2D);
 
-	/* It will return a FColor for every single pixel of the specified texture. 
+	/* It will return a FColor for every single pixel of the specified texture, read from its CPU copy without changing its settings or resource.
+	Only uncompressed 8 bit RGBA textures can be read back, like the ones this library creates; in the editor, other textures are read from the
+	pixels they were imported from. Passing the same array again reuses its memory.
 	This process is not async! This means it can freeze the game while processing.
 	@param Texture2D	The texture to get the bitmap from.
 	*/
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetTextureBitmap", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
 		static bool GetTextureBitmap(TArray<FColor> &Bitmap, FImageSize &Size, UTexture2D* Texture2D);
 
-	/* Returns the FColor of a specific pixel in the input Texture 2D.
+	/* Returns the FColor of a specific pixel in the input Texture 2D. To read many pixels, SampleTexturePixels is much faster.
 	@param Texture2D	The texture to get the pixel from.
 	@param XIndex		X position of the pixel to read.
 	@param YIndex		Y position of the pixel to read.
@@ -235,6 +758,24 @@ public:
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetTexturePixelColor", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
 		static bool GetTexturePixelColor(FColor &PixelColor, UTexture2D* Texture2D, int XIndex, int YIndex);
 
+	/* Returns the colour of the texture at each of Pixels, reading the texture once. Use it instead of GetTexturePixelColor for many pixels.
+	Only uncompressed 8 bit RGBA textures with their pixels on the CPU can be read, like the ones this library creates.
+	@param Pixels		X and Y of the pixels to read.
+	@param BorderMode	What pixels outside the texture read. Constant reads transparent black.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "SampleTexturePixels", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
+		static bool SampleTexturePixels(TArray<FColor> &Colours, UTexture2D* Texture2D, const TArray<FIntPoint>& Pixels, EBitmapBorderMode BorderMode = EBitmapBorderMode::Clamp);
+
+	/* Samples the texture at each of UVs, reading the texture once. (0, 0) is the top left corner of the texture and (1, 1) its bottom right corner.
+	Only uncompressed 8 bit RGBA textures with their pixels on the CPU can be read, like the ones this library creates.
+	@param UVs			Where to sample the texture.
+	@param Filter		Nearest texel, bilinear blend of 4 texels or bicubic blend of 16 (sharper, slower).
+	@param BorderMode	What samples outside the texture read. Constant reads transparent black.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "SampleTextureUVs", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
+		static bool SampleTextureUVs(TArray<FColor> &Colours, UTexture2D* Texture2D, const TArray<FVector2D>& UVs, EBitmapSampleFilter Filter = EBitmapSampleFilter::Bilinear,
+			EBitmapBorderMode BorderMode = EBitmapBorderMode::Clamp);
+
 
 	/***** Save to disk *****/
 
@@ -274,13 +815,142 @@ public:
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetBitmapBytes", Keywords = "ImageIOLibrary bitmap resize"), Category = "ImageIOLibrary")
 	static TArray<uint8> GetBitmapBytes(TArray<FColor> Bitmap, FImageSize Size);
 
-	/* This resizes the resolution of a Bitmap image. Use this to make sure two bitmaps have the same resolution before performing operations on them. 
-	@param Bitmap		The bitmap to edit.
-	@param Size			The resolution of the bitmap to edit.
-	@param NewSize		The bitmap's new resolution.
+	/* Returns the colour of the bitmap at each of Pixels. Much faster than reading the pixels one by one in Blueprint.
+	@param Pixels		X and Y of the pixels to read.
+	@param BorderMode	What pixels outside the bitmap read. Constant reads transparent black.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "SampleBitmapPixels", Keywords = "ImageIOLibrary bitmap pixel colour picker"), Category = "ImageIOLibrary")
+		static TArray<FColor> SampleBitmapPixels(const TArray<FColor>& Bitmap, FImageSize Size, const TArray<FIntPoint>& Pixels, EBitmapBorderMode BorderMode = EBitmapBorderMode::Clamp);
+
+	/* Samples the bitmap at each of UVs. (0, 0) is the top left corner of the bitmap and (1, 1) its bottom right corner.
+	@param UVs			Where to sample the bitmap.
+	@param Filter		Nearest reads the pixel each UV falls in, Bilinear blends the 4 pixels around it and Bicubic the 16 pixels around it.
+	@param BorderMode	What samples outside the bitmap read. Constant reads transparent black.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "SampleBitmapUVs", Keywords = "ImageIOLibrary bitmap pixel colour picker bilinear"), Category = "ImageIOLibrary")
+		static TArray<FColor> SampleBitmapUVs(const TArray<FColor>& Bitmap, FImageSize Size, const TArray<FVector2D>& UVs, EBitmapSampleFilter Filter = EBitmapSampleFilter::Bilinear,
+			EBitmapBorderMode BorderMode = EBitmapBorderMode::Clamp);
+
+	/* Copies a rectangle of the bitmap into a new bitmap of the rectangle's size. The rectangle may reach outside the bitmap.
+	@param Rect			The pixels to copy.
+	@param BorderMode	What the parts of Rect outside the bitmap read. Constant reads transparent black.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "CropBitmap", Keywords = "ImageIOLibrary bitmap crop region sub image"), Category = "ImageIOLibrary")
+		static TArray<FColor> CropBitmap(const TArray<FColor>& Bitmap, FImageSize Size, FImageRect Rect, EBitmapBorderMode BorderMode = EBitmapBorderMode::Constant);
+
+	/* Copies Source into the bitmap with its top left corner at X, Y. The bitmap is edited in place and only the pixels under Source are touched,
+	so pasting a small region back into a big canvas is cheap. The parts of Source outside the bitmap are left out. Source may be the bitmap itself.
+	@param Bitmap		The bitmap to paste into.
+	@param Size			The resolution of the bitmap to paste into.
+	@param Source		The bitmap to paste.
+	@param SourceSize	The resolution of the bitmap to paste.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "PasteBitmap", Keywords = "ImageIOLibrary bitmap paste region sub image"), Category = "ImageIOLibrary")
+		static bool PasteBitmap(UPARAM(ref) TArray<FColor>& Bitmap, FImageSize Size, const TArray<FColor>& Source, FImageSize SourceSize, int32 X, int32 Y);
+
+	/* Adds Left, Top, Right and Bottom pixels around the bitmap.
+	@param NewSize		The resolution of the padded bitmap.
+	@param BorderMode	What the new pixels are: copies of the edge (Clamp), of the other side (Wrap), of the pixels next to the edge (Mirror) or transparent black (Constant).
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "PadBitmap", Keywords = "ImageIOLibrary bitmap pad border extend"), Category = "ImageIOLibrary")
+		static TArray<FColor> PadBitmap(FImageSize& NewSize, const TArray<FColor>& Bitmap, FImageSize Size, int32 Left, int32 Top, int32 Right, int32 Bottom,
+			EBitmapBorderMode BorderMode = EBitmapBorderMode::Constant);
+
+	/* Repeats the bitmap over a bitmap of NewSize, starting from the top left corner.
+	@param NewSize		The resolution of the tiled bitmap.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "TileBitmap", Keywords = "ImageIOLibrary bitmap tile repeat pattern"), Category = "ImageIOLibrary")
+		static TArray<FColor> TileBitmap(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize);
+
+	/* Rotates or flips the bitmap, e.g. to turn camera images upright (see GetExifOrientationFix).
+	@param NewSize		The resolution of the returned bitmap: width and height are swapped by quarter turns and transposes.
+	@param Orientation	The rotation or flip to apply.
 	*/
-	UFUNCTION(BlueprintPure, meta = (DisplayName = "ResizeBitmap", Keywords = "ImageIOLibrary bitmap resize"), Category = "ImageIOLibrary")
-		static TArray<FColor> ResizeBitmap(TArray<FColor> Bitmap, FImageSize Size, FImageSize NewSize);
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "ReorientBitmap", Keywords = "ImageIOLibrary bitmap rotate flip mirror transpose"), Category = "ImageIOLibrary")
+		static TArray<FColor> ReorientBitmap(FImageSize& NewSize, const TArray<FColor>& Bitmap, FImageSize Size, EBitmapOrientation Orientation);
+
+	/* Same as ReorientBitmap, but edits the bitmap and its size in place. Flips and half turns never copy the bitmap, quarter turns and
+	transposes only don't on square bitmaps.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ReorientBitmapInPlace", Keywords = "ImageIOLibrary bitmap rotate flip mirror transpose"), Category = "ImageIOLibrary")
+		static bool ReorientBitmapInPlace(UPARAM(ref) TArray<FColor>& Bitmap, UPARAM(ref) FImageSize& Size, EBitmapOrientation Orientation);
+
+	/* The orientation that turns a photo upright, from the value of its EXIF Orientation tag (1 to 8).
+	@return		False when there is nothing to do (1) or the value isn't a valid EXIF orientation.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetExifOrientationFix", Keywords = "ImageIOLibrary bitmap rotate exif camera photo"), Category = "ImageIOLibrary")
+		static bool GetExifOrientationFix(EBitmapOrientation& Orientation, int32 ExifOrientation);
+
+	/* Warps the bitmap through a 3x3 matrix, e.g. to rotate it by any angle, shear it or give it perspective. Every pixel of the result is
+	sampled where the inverse of the matrix sends it in the bitmap.
+	@param NewSize		The resolution of the returned bitmap.
+	@param Matrix		9 values, a row after the other, mapping pixel coordinates (X, Y, 1) of the bitmap to pixel coordinates of the result.
+						(0, 0) is the top left corner of a bitmap and (Width, Height) its bottom right corner.
+	@param Filter		Nearest pixel, bilinear blend of 4 pixels or bicubic blend of 16 (sharper, slower).
+	@param BorderMode	What the result shows where it falls outside the bitmap. Constant shows transparent black.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "WarpBitmap", Keywords = "ImageIOLibrary bitmap warp affine perspective homography rotate skew"), Category = "ImageIOLibrary")
+		static TArray<FColor> WarpBitmap(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize, const TArray<float>& Matrix,
+			EBitmapSampleFilter Filter = EBitmapSampleFilter::Bilinear, EBitmapBorderMode BorderMode = EBitmapBorderMode::Constant);
+
+	/* Warps a rectangle of the bitmap through a 3x3 matrix, as WarpBitmap would warp a bitmap holding only that rectangle. The rectangle is
+	read where it is, without copying it out first.
+	@param Region		The pixels to warp, clipped to the bitmap. The matrix's (0, 0) is its top left corner.
+	@param NewSize		The resolution of the returned bitmap.
+	@param Matrix		9 values, a row after the other, mapping pixel coordinates (X, Y, 1) of the rectangle to pixel coordinates of the result.
+	@param Filter		Nearest pixel, bilinear blend of 4 pixels or bicubic blend of 16 (sharper, slower).
+	@param BorderMode	What the result shows where it falls outside the rectangle. Constant shows transparent black.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "WarpBitmapRegion", Keywords = "ImageIOLibrary bitmap warp region affine perspective homography rotate skew"), Category = "ImageIOLibrary")
+		static TArray<FColor> WarpBitmapRegion(const TArray<FColor>& Bitmap, FImageSize Size, FImageRect Region, FImageSize NewSize, const TArray<float>& Matrix,
+			EBitmapSampleFilter Filter = EBitmapSampleFilter::Bilinear, EBitmapBorderMode BorderMode = EBitmapBorderMode::Constant);
+
+	/* Straightens a quadrilateral of the bitmap (e.g. a document or a screen photographed at an angle) into a NewSize bitmap.
+	The corners are pixel coordinates of the bitmap, (0, 0) being its top left corner and (Width, Height) its bottom right corner.
+	@param NewSize		The resolution of the returned bitmap.
+	@param Filter		Nearest pixel, bilinear blend of 4 pixels or bicubic blend of 16 (sharper, slower).
+	@param BorderMode	What the result shows where the quadrilateral goes outside the bitmap. Constant shows transparent black.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "WarpBitmapFromQuad", Keywords = "ImageIOLibrary bitmap warp perspective deskew rectify quad"), Category = "ImageIOLibrary")
+		static TArray<FColor> WarpBitmapFromQuad(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize, FVector2D TopLeft, FVector2D TopRight,
+			FVector2D BottomRight, FVector2D BottomLeft, EBitmapSampleFilter Filter = EBitmapSampleFilter::Bilinear, EBitmapBorderMode BorderMode = EBitmapBorderMode::Clamp);
+
+	/* Draws the whole bitmap onto a quadrilateral of a transparent NewSize bitmap, the opposite of WarpBitmapFromQuad.
+	The corners are pixel coordinates of the result, (0, 0) being its top left corner and (NewSize.X, NewSize.Y) its bottom right corner.
+	@param NewSize		The resolution of the returned bitmap.
+	@param Filter		Nearest pixel, bilinear blend of 4 pixels or bicubic blend of 16 (sharper, slower).
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "WarpBitmapOntoQuad", Keywords = "ImageIOLibrary bitmap warp perspective quad project"), Category = "ImageIOLibrary")
+		static TArray<FColor> WarpBitmapOntoQuad(const TArray<FColor>& Bitmap, FImageSize Size, FImageSize NewSize, FVector2D TopLeft, FVector2D TopRight,
+			FVector2D BottomRight, FVector2D BottomLeft, EBitmapSampleFilter Filter = EBitmapSampleFilter::Bilinear);
+
+	/* This resizes the resolution of a Bitmap image. Use this to make sure two bitmaps have the same resolution before performing operations on them.
+	Nodes placed before Filter, LinearLight and PremultipliedAlpha existed now get Lanczos3 with premultiplied alpha, which is sharper than the old
+	resize (an average of the covered pixels, rounded down) and doesn't bleed transparent colours: their output changes. Box without
+	PremultipliedAlpha is the closest to the old result.
+	@param Bitmap				The bitmap to edit.
+	@param Size					The resolution of the bitmap to edit.
+	@param NewSize				The bitmap's new resolution.
+	@param Filter				The resampling filter. Lanczos3 is the sharpest, Mitchell rings less around hard edges, Box and Bilinear are the fastest.
+	@param LinearLight			Tick this to resample in linear light (gamma correct). Keeps thin bright lines and high contrast textures from darkening when shrunk, but costs a bit more.
+	@param PremultipliedAlpha	Tick this to keep the colour of fully transparent pixels from bleeding into their neighbours. Makes no difference on opaque bitmaps.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "ResizeBitmap", Keywords = "ImageIOLibrary bitmap resize scale resample lanczos bicubic"), Category = "ImageIOLibrary")
+		static TArray<FColor> ResizeBitmap(TArray<FColor> Bitmap, FImageSize Size, FImageSize NewSize, EBitmapResampleFilter Filter = EBitmapResampleFilter::Lanczos3, bool LinearLight = false, bool PremultipliedAlpha = true);
+
+	/* Resizes a rectangle of the bitmap to NewSize, e.g. to make a thumbnail of part of a big image. The rectangle is read where it is, without
+	cropping it out first, and resized as ResizeBitmap would resize a bitmap holding only that rectangle.
+	@param Bitmap				The bitmap to read from.
+	@param Size					The resolution of the bitmap.
+	@param Region				The pixels to resize, clipped to the bitmap.
+	@param NewSize				The resolution of the returned bitmap.
+	@param Filter				The resampling filter. Lanczos3 is the sharpest, Mitchell rings less around hard edges, Box and Bilinear are the fastest.
+	@param LinearLight			Tick this to resample in linear light (gamma correct).
+	@param PremultipliedAlpha	Tick this to keep the colour of fully transparent pixels from bleeding into their neighbours.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "ResizeBitmapRegion", Keywords = "ImageIOLibrary bitmap resize region crop scale resample thumbnail"), Category = "ImageIOLibrary")
+		static TArray<FColor> ResizeBitmapRegion(const TArray<FColor>& Bitmap, FImageSize Size, FImageRect Region, FImageSize NewSize, EBitmapResampleFilter Filter = EBitmapResampleFilter::Lanczos3,
+			bool LinearLight = false, bool PremultipliedAlpha = true);
 
 	/** Sets the bitmap's Hue, Saturation and Lumniance values (HSV values). Value range from 0 to 2 except hue which is 0-360. This is a destructive action! Changes cannot be undone using the returned bitmap.
 	@param Bitmap		The bitmap to edit.
@@ -336,6 +1006,8 @@ public:
 	/***** Bitmap Filters *****/
 
 /* This applies the input filter on the input bitmap by convolution. Use GetBitmapFilter() or look up Image filtering kernels to create your own filters.
+Big kernels (roughly 13x13 and up) are run through FFTs, which makes their cost nearly independent of their size.
+With the RGBA channel each pixel keeps its alpha, set the filter's FilterAlpha to filter alpha as well.
 @param Bitmap		The bitmap to edit.
 @param Size			The resolution of the bitmap to edit.
 @param Filter		This is the filter you wish to apply to the bitmap. (See "Kernel (Image Processing)" on Wikipedia).
@@ -343,6 +1015,101 @@ public:
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "ApplyBitmapFilter", Keywords = "ImageIOLibrary bitmap filter blur sharpen"), Category = "ImageIOLibrary")
 		static TArray<FColor> ApplyBitmapFilter(TArray<FColor> Bitmap, FImageSize Size, FBitmapFilter Filter);
 
+/* Applies the filter to a rectangle of the bitmap, in place. Only the rectangle and the pixels the filter reads around it are touched, and the
+rectangle ends up as ApplyBitmapFilter would leave it, so editing a small part of a big canvas doesn't cost a pass over the whole of it.
+@param Bitmap		The bitmap to edit.
+@param Size			The resolution of the bitmap to edit.
+@param Filter		The filter to apply.
+@param Region		The pixels to filter, clipped to the bitmap.
+*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ApplyBitmapFilterToRegion", Keywords = "ImageIOLibrary bitmap filter region blur sharpen"), Category = "ImageIOLibrary")
+		static bool ApplyBitmapFilterToRegion(UPARAM(ref) TArray<FColor>& Bitmap, FImageSize Size, FBitmapFilter Filter, FImageRect Region);
+
+/* This applies a filter given as separate row and column vectors, as a horizontal pass followed by a vertical pass. ApplyBitmapFilter already does this on its own when the filter allows it.
+@param Bitmap		The bitmap to edit.
+@param Size			The resolution of the bitmap to edit.
+@param Filter		The row and column vectors to apply.
+*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "ApplySeparableBitmapFilter", Keywords = "ImageIOLibrary bitmap filter blur separable"), Category = "ImageIOLibrary")
+		static TArray<FColor> ApplySeparableBitmapFilter(TArray<FColor> Bitmap, FImageSize Size, FSeparableBitmapFilter Filter);
+
+	/* Blurs the bitmap. Unlike ApplyBitmapFilter, the cost doesn't grow with the radius so this is the one to use for big blurs (UI backgrounds etc).
+	@param Bitmap			The bitmap to edit.
+	@param Size				The resolution of the bitmap to edit.
+	@param Radius			Blur radius in pixels. For the gaussians this is 3 sigmas.
+	@param Method			The blur algorithm.
+	@param ColourChannel	The colour channel(s) to blur.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "BlurBitmap", Keywords = "ImageIOLibrary bitmap filter blur gaussian box"), Category = "ImageIOLibrary")
+		static TArray<FColor> BlurBitmap(TArray<FColor> Bitmap, FImageSize Size, float Radius = 10.0f, EBitmapBlurMethod Method = EBitmapBlurMethod::FastGaussian, EFilterColourChannel ColourChannel = EFilterColourChannel::RGBA);
+
+	/* Blurs a rectangle of the bitmap, in place. Only the rectangle and the pixels the blur reads around it are touched, and the rectangle ends
+	up as BlurBitmap would leave it (the Gaussian method, which reads whole rows, to within rounding).
+	@param Bitmap			The bitmap to edit.
+	@param Size				The resolution of the bitmap to edit.
+	@param Region			The pixels to blur, clipped to the bitmap.
+	@param Radius			Blur radius in pixels. For the gaussians this is 3 sigmas.
+	@param Method			The blur algorithm.
+	@param ColourChannel	The colour channel(s) to blur.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "BlurBitmapRegion", Keywords = "ImageIOLibrary bitmap filter blur region gaussian box"), Category = "ImageIOLibrary")
+		static bool BlurBitmapRegion(UPARAM(ref) TArray<FColor>& Bitmap, FImageSize Size, FImageRect Region, float Radius = 10.0f, EBitmapBlurMethod Method = EBitmapBlurMethod::FastGaussian,
+			EFilterColourChannel ColourChannel = EFilterColourChannel::RGBA);
+
+	/* Replaces each pixel by the median of the square around it, channel by channel. Removes noise and dust from scans while keeping edges sharp.
+	@param Bitmap			The bitmap to edit.
+	@param Size				The resolution of the bitmap to edit.
+	@param Radius			Half the size of the square, from 1 (3x3) to 15 (31x31). The cost doesn't grow with it.
+	@param ColourChannel	The colour channel(s) to filter.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "MedianFilterBitmap", Keywords = "ImageIOLibrary bitmap filter median denoise"), Category = "ImageIOLibrary")
+		static TArray<FColor> MedianFilterBitmap(TArray<FColor> Bitmap, FImageSize Size, int32 Radius = 1, EFilterColourChannel ColourChannel = EFilterColourChannel::RGBA);
+
+	/* Replaces each pixel by a percentile of the square around it, channel by channel. 50 is the median, 0 the minimum (erodes bright areas) and 100 the maximum (dilates them).
+	@param Bitmap			The bitmap to edit.
+	@param Size				The resolution of the bitmap to edit.
+	@param Radius			Half the size of the square, from 1 (3x3) to 15 (31x31). The cost doesn't grow with it.
+	@param Percentile		Which value of the sorted square to keep, from 0 to 100.
+	@param ColourChannel	The colour channel(s) to filter.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "PercentileFilterBitmap", Keywords = "ImageIOLibrary bitmap filter percentile rank median"), Category = "ImageIOLibrary")
+		static TArray<FColor> PercentileFilterBitmap(TArray<FColor> Bitmap, FImageSize Size, int32 Radius = 1, float Percentile = 50.0f, EFilterColourChannel ColourChannel = EFilterColourChannel::RGBA);
+
+	/* Smooths a bitmap while keeping its edges sharp (guided filter): small variations such as skin texture or noise are flattened, strong contrasts stay untouched.
+	@param Bitmap			The bitmap to edit.
+	@param Size				The resolution of the bitmap to edit.
+	@param Radius			Radius of the area the smoothing works over, from 1 to 64. The cost doesn't grow with it.
+	@param Smoothness		Contrast (0 to 1) below which details get smoothed away. Around 0.05 cleans up noise, 0.1 to 0.2 smooths skin.
+	@param ColourChannel	The colour channel(s) to filter.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "SmoothBitmap", Keywords = "ImageIOLibrary bitmap filter smooth edge preserving guided bilateral skin denoise"), Category = "ImageIOLibrary")
+		static TArray<FColor> SmoothBitmap(TArray<FColor> Bitmap, FImageSize Size, int32 Radius = 8, float Smoothness = 0.1f, EFilterColourChannel ColourChannel = EFilterColourChannel::RGBA);
+
+	/* Applies a morphological operator (erode, dilate, open, close or gradient) with a rectangle of any size. Meant for cleaning up masks, such as chroma key alpha or painted masks.
+	@param Bitmap			The bitmap to edit.
+	@param Size				The resolution of the bitmap to edit.
+	@param Operation		The operator to apply.
+	@param RadiusX			Half the width of the rectangle, from 0 to 255 (0 leaves the rows alone). The cost doesn't grow with it.
+	@param RadiusY			Half the height of the rectangle, from 0 to 255 (0 leaves the columns alone). The cost doesn't grow with it.
+	@param ColourChannel	The colour channel(s) to filter. Single channels (e.g. A for a mask) run the fastest.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "ApplyBitmapMorphology", Keywords = "ImageIOLibrary bitmap filter morphology erode dilate open close gradient mask"), Category = "ImageIOLibrary")
+		static TArray<FColor> ApplyBitmapMorphology(TArray<FColor> Bitmap, FImageSize Size, EBitmapMorphologyOperation Operation, int32 RadiusX = 1, int32 RadiusY = 1, EFilterColourChannel ColourChannel = EFilterColourChannel::A);
+
+	/* Applies a morphological operator to a rectangle of the bitmap, in place. Only the rectangle and the pixels the operator reads around it
+	are touched, and the rectangle ends up as ApplyBitmapMorphology would leave it.
+	@param Bitmap			The bitmap to edit.
+	@param Size				The resolution of the bitmap to edit.
+	@param Region			The pixels to filter, clipped to the bitmap.
+	@param Operation		The operator to apply.
+	@param RadiusX			Half the width of the rectangle the operator works over, from 0 to 255.
+	@param RadiusY			Half the height of the rectangle the operator works over, from 0 to 255.
+	@param ColourChannel	The colour channel(s) to filter.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ApplyBitmapMorphologyToRegion", Keywords = "ImageIOLibrary bitmap filter morphology region erode dilate open close gradient mask"), Category = "ImageIOLibrary")
+		static bool ApplyBitmapMorphologyToRegion(UPARAM(ref) TArray<FColor>& Bitmap, FImageSize Size, FImageRect Region, EBitmapMorphologyOperation Operation, int32 RadiusX = 1, int32 RadiusY = 1,
+			EFilterColourChannel ColourChannel = EFilterColourChannel::A);
+
 	/* This returns filters based on the BitmapFilter enum. Some filters won't work if applied to all channels (RGBA) though you can override it if you wish so.
 	@param BitmapFilter				Select which hardcode filter to return.
 	@param OverrideColourChannel	Tick this if you want to override the default colour channel(s) the filter is applied on.
@@ -360,6 +1127,128 @@ public:
 		static FColor SetPixelColourChannel(FColor Pixel, EFilterColourChannel ColourChannel);
 
 
+	/***** Alpha Compositing *****/
+
+	/* Converts a bitmap to premultiplied alpha (colour channels multiplied by alpha). Keep layers premultiplied while compositing them and only convert back at the end.
+	@param Bitmap		The bitmap to convert.
+	@param Size			The resolution of the bitmap.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "PremultiplyBitmap", Keywords = "ImageIOLibrary bitmap alpha premultiply"), Category = "ImageIOLibrary")
+		static FPremultipliedBitmap PremultiplyBitmap(TArray<FColor> Bitmap, FImageSize Size);
+
+	/* Converts a premultiplied bitmap back to straight alpha. Fully transparent pixels come back as transparent black.
+	@param PremultipliedBitmap	The bitmap to convert.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "UnpremultiplyBitmap", Keywords = "ImageIOLibrary bitmap alpha premultiply unpremultiply"), Category = "ImageIOLibrary")
+		static TArray<FColor> UnpremultiplyBitmap(FPremultipliedBitmap PremultipliedBitmap);
+
+	/* Composites two premultiplied bitmaps with a Porter-Duff operator. Both bitmaps need the same resolution.
+	@param Source		The layer being composited (e.g. a decal).
+	@param Destination	The layer it is composited onto (e.g. a photo).
+	@param Operation	The Porter-Duff operator to use.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "CompositePremultipliedBitmaps", Keywords = "ImageIOLibrary bitmap alpha composite porter duff over blend"), Category = "ImageIOLibrary")
+		static FPremultipliedBitmap CompositePremultipliedBitmaps(FPremultipliedBitmap Source, FPremultipliedBitmap Destination, EBitmapCompositeOperation Operation = EBitmapCompositeOperation::SourceOver);
+
+	/* Composites two straight alpha bitmaps with a Porter-Duff operator. This premultiplies both inputs and converts the result back, use the premultiplied version when layering many bitmaps.
+	@param Source		The layer being composited (e.g. a decal).
+	@param Destination	The layer it is composited onto (e.g. a photo).
+	@param Size			The resolution of both bitmaps.
+	@param Operation	The Porter-Duff operator to use.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "CompositeBitmaps", Keywords = "ImageIOLibrary bitmap alpha composite porter duff over blend"), Category = "ImageIOLibrary")
+		static TArray<FColor> CompositeBitmaps(TArray<FColor> Source, TArray<FColor> Destination, FImageSize Size, EBitmapCompositeOperation Operation = EBitmapCompositeOperation::SourceOver);
+
+	/* Composites a rectangle of Source onto the same rectangle of Destination, in place, with a Porter-Duff operator. The rest of Destination
+	is left as it is.
+	@param Source		The layer being composited (e.g. a decal).
+	@param Destination	The layer it is composited onto (e.g. a photo).
+	@param Size			The resolution of both bitmaps.
+	@param Region		The pixels to composite, clipped to the bitmaps.
+	@param Operation	The Porter-Duff operator to use.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CompositeBitmapsInRegion", Keywords = "ImageIOLibrary bitmap alpha composite region porter duff over blend"), Category = "ImageIOLibrary")
+		static bool CompositeBitmapsInRegion(const TArray<FColor>& Source, UPARAM(ref) TArray<FColor>& Destination, FImageSize Size, FImageRect Region,
+			EBitmapCompositeOperation Operation = EBitmapCompositeOperation::SourceOver);
+
+	/* Blends two bitmaps through a mask one frequency band at a time (multiband blending): fine details switch over a few pixels, broad areas
+	like colour and exposure over a wide band, which hides the seams between stitched photos. A hard edged mask is fine.
+	@param BitmapA		The bitmap kept where the mask is white.
+	@param BitmapB		The bitmap kept where the mask is black.
+	@param Mask			How much of BitmapA to keep, read from the red channel.
+	@param Size			The resolution of the three bitmaps.
+	@param NumLevels	Number of frequency bands. 0 picks as many as the size allows, fewer bands give narrower transitions.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "BlendBitmapsMultiband", Keywords = "ImageIOLibrary bitmap blend seam panorama stitch pyramid laplacian"), Category = "ImageIOLibrary")
+		static TArray<FColor> BlendBitmapsMultiband(const TArray<FColor>& BitmapA, const TArray<FColor>& BitmapB, const TArray<FColor>& Mask, FImageSize Size, int32 NumLevels = 0);
+
+	/* Blends a rectangle of BitmapA into the same rectangle of BitmapB band by band, in place, e.g. the overlap of two stitched photos. The
+	rectangle is blended as a bitmap of its own: the bands don't reach past it, and the rest of BitmapB is left as it is.
+	@param BitmapA		The bitmap kept where the mask is white.
+	@param BitmapB		The bitmap kept where the mask is black, which receives the blend.
+	@param Mask			How much of BitmapA to keep, read from the red channel.
+	@param Size			The resolution of the three bitmaps.
+	@param Region		The pixels to blend, clipped to the bitmaps.
+	@param NumLevels	Number of frequency bands. 0 picks as many as the rectangle's size allows.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "BlendBitmapsMultibandInRegion", Keywords = "ImageIOLibrary bitmap blend region seam panorama stitch pyramid laplacian"), Category = "ImageIOLibrary")
+		static bool BlendBitmapsMultibandInRegion(const TArray<FColor>& BitmapA, UPARAM(ref) TArray<FColor>& BitmapB, const TArray<FColor>& Mask, FImageSize Size, FImageRect Region,
+			int32 NumLevels = 0);
+
+
+	/***** Async Jobs *****/
+
+	/* The functions below run on background threads and return a job right away. Its progress can be read or followed with its OnProgress event,
+	it can be cancelled, and OnCompleted runs on the game thread once it's done, with the result in the job (see its state first).
+	Anything bound to the job right after starting it is never too late: the job can't complete before the calling Blueprint is done.
+	Jobs run in the order of their Priority, which can still be changed once started (see UBitmapJob::SetPriority).
+	*/
+
+	/* Loads and decodes an image file (see CreateTexture2DFromImageFile) on a background thread.
+	@param PathToImage		The path to the image file.
+	@param CreateTexture	Whether to also create a texture (uncompressed, without mips) from the image once loaded.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "LoadImageFileAsync", Keywords = "ImageIOLibrary async job load image file", AutoCreateRefTerm = "OnCompleted"), Category = "ImageIOLibrary|Async")
+		static UBitmapJob* LoadImageFileAsync(const FOnBitmapJobCompleted& OnCompleted, FString PathToImage, bool CreateTexture = true, EBitmapJobPriority Priority = EBitmapJobPriority::Visible);
+
+	/* ResizeBitmap on a background thread. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ResizeBitmapAsync", Keywords = "ImageIOLibrary async job bitmap resize scale resample", AutoCreateRefTerm = "OnCompleted"), Category = "ImageIOLibrary|Async")
+		static UBitmapJob* ResizeBitmapAsync(const FOnBitmapJobCompleted& OnCompleted, TArray<FColor> Bitmap, FImageSize Size, FImageSize NewSize,
+			EBitmapResampleFilter Filter = EBitmapResampleFilter::Lanczos3, bool LinearLight = false, bool PremultipliedAlpha = true, EBitmapJobPriority Priority = EBitmapJobPriority::Visible);
+
+	/* ApplyBitmapFilter on a background thread. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ApplyBitmapFilterAsync", Keywords = "ImageIOLibrary async job bitmap filter blur sharpen", AutoCreateRefTerm = "OnCompleted"), Category = "ImageIOLibrary|Async")
+		static UBitmapJob* ApplyBitmapFilterAsync(const FOnBitmapJobCompleted& OnCompleted, TArray<FColor> Bitmap, FImageSize Size, FBitmapFilter Filter, EBitmapJobPriority Priority = EBitmapJobPriority::Visible);
+
+	/* Blurs the bitmap on a background thread and makes a texture of the result, handed to OnBitmapBlurComplete on the game thread (null when
+	the blur failed or was cancelled).
+	@param BlurStrength		From 0 (the original bitmap) to 1 (a full gaussian blur of BlurRadius).
+	@param BlurRadius		Radius of the blur, in pixels.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "BlurBitmapAsync", Keywords = "ImageIOLibrary async job bitmap blur", AutoCreateRefTerm = "OnBitmapBlurComplete"), Category = "ImageIOLibrary|Async")
+		static UBitmapJob* BlurBitmapAsync(const FOnBitmapBlurred& OnBitmapBlurComplete, TArray<FColor> Bitmap, FImageSize Size, float BlurStrength, int BlurRadius, EBitmapJobPriority Priority = EBitmapJobPriority::Visible);
+
+	/* BlendBitmapsMultiband on a background thread. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "BlendBitmapsMultibandAsync", Keywords = "ImageIOLibrary async job bitmap blend seam panorama", AutoCreateRefTerm = "OnCompleted"), Category = "ImageIOLibrary|Async")
+		static UBitmapJob* BlendBitmapsMultibandAsync(const FOnBitmapJobCompleted& OnCompleted, TArray<FColor> BitmapA, TArray<FColor> BitmapB, TArray<FColor> Mask,
+			FImageSize Size, int32 NumLevels = 0, EBitmapJobPriority Priority = EBitmapJobPriority::Visible);
+
+	/* Encodes the bitmap as a PNG file and saves it on a background thread. The job holds no bitmap once done. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "SaveBitmapAsPNGAsync", Keywords = "ImageIOLibrary async job save png", AutoCreateRefTerm = "OnCompleted"), Category = "ImageIOLibrary|Async")
+		static UBitmapJob* SaveBitmapAsPNGAsync(const FOnBitmapJobCompleted& OnCompleted, FString FilePath, TArray<FColor> Bitmap, FImageSize Size, EBitmapJobPriority Priority = EBitmapJobPriority::Visible);
+
+	/* Returns how much memory the image files being decoded hold, and held at most. Loading many large files at once (LoadImageFileAsync,
+	AddImageFilesToAtlas) keeps it under ImageIO.DecodeMemoryBudget megabytes (1024 by default): decodes wait for the memory of the running
+	ones. The console variable can be set per platform, the peak tells how much a given budget actually needs.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetDecodeMemoryStats", Keywords = "ImageIOLibrary async memory budget decode"), Category = "ImageIOLibrary|Async")
+		static FDecodeMemoryStats GetDecodeMemoryStats();
+
+	/* Starts the peak of GetDecodeMemoryStats over from the memory held now. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ResetDecodeMemoryPeak", Keywords = "ImageIOLibrary async memory budget decode"), Category = "ImageIOLibrary|Async")
+		static void ResetDecodeMemoryPeak();
+
+
 	/***** Open/Save file dialogs *****/
 
 	/*This will open a Folder Select dialog. The FilePath return value contain the path for the file selected, its name and its extension.
@@ -547,11 +1436,6 @@ public:
 	//UFUNCTION(BlueprintCallable, meta = (DisplayName = "SaveTexture2D", Keywords = "ImageIOLibrary"), Category = "Texture2D I/O")
 	static bool SaveTexture2D(UTexture2D* Texture2D, EImageIOFormat ImageFormat, FString FilePath);
 
-
-	/* This applies a standard average blur to the specified bitmap. BlurStrength is a value between 0 and 1. */
-	//UFUNCTION(BlueprintCallable, meta = (DisplayName = "BlurBitmapAsync", Keywords = "ImageIOLibrary bitmap blur", AutoCreateRefTerm = "OnBitmapBlurred"), Category = "ImageIOLibrary")
-		static void BlurBitmapAsync(const FOnBitmapBlurred& OnBitmapBlurComplete, TArray<FColor> Bitmap, FImageSize Size, float BlurStrength, int BlurRadius);
-
 private:
 
 	// These convert from the engine's EImageFormat (not supported in BPs) to EImageIOFormat and vice versa.